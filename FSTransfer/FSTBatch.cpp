@@ -0,0 +1,338 @@
+#if !defined(_WIN32)
+// 32λϵͳoff_tʹ64λ
+#define _FILE_OFFSET_BITS 64
+#endif
+#include "FSTBatch.h"
+#include <string.h>
+#include <algorithm>
+#if defined(_WIN32)
+#include <windows.h>
+#include <direct.h>
+#else
+#include <dirent.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#endif
+
+#if defined(_WIN32)
+#define fst_fseek _fseeki64
+#else
+#define fst_fseek fseeko
+#endif
+
+static bool FST_isDirectory(const std::string& path)
+{
+#if defined(_WIN32)
+	DWORD attr = GetFileAttributesA(path.c_str());
+	return attr != INVALID_FILE_ATTRIBUTES && (attr & FILE_ATTRIBUTE_DIRECTORY);
+#else
+	struct stat st;
+	return stat(path.c_str(), &st) == 0 && S_ISDIR(st.st_mode);
+#endif
+}
+
+static bool FST_scanDirectory(const std::string& dir, const std::string& sub, std::vector<FST_BatchFile>& outFiles)
+{
+	std::string path = sub.empty() ? dir : dir + "/" + sub;
+
+#if defined(_WIN32)
+	WIN32_FIND_DATAA data;
+	HANDLE handle = FindFirstFileA((path + "/*").c_str(), &data);
+	if (handle == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+	bool isSuccess = true;
+	do
+	{
+		if (strcmp(data.cFileName, ".") == 0 || strcmp(data.cFileName, "..") == 0)
+		{
+			continue;
+		}
+		if (data.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT)
+		{
+			continue;
+		}
+		std::string name = sub.empty() ? data.cFileName : sub + "/" + data.cFileName;
+		if (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+		{
+			if (!FST_scanDirectory(dir, name, outFiles))
+			{
+				isSuccess = false;
+				break;
+			}
+		}
+		else
+		{
+			FST_BatchFile file;
+			file.name = name;
+			file.size = ((uint64_t)data.nFileSizeHigh << 32) | data.nFileSizeLow;
+			file.offset = 0;
+			outFiles.push_back(file);
+		}
+	} while (FindNextFileA(handle, &data));
+	FindClose(handle);
+	return isSuccess;
+#else
+	DIR* dirp = opendir(path.c_str());
+	if (dirp == NULL)
+	{
+		return false;
+	}
+	bool isSuccess = true;
+	struct dirent* ent;
+	while ((ent = readdir(dirp)) != NULL)
+	{
+		if (strcmp(ent->d_name, ".") == 0 || strcmp(ent->d_name, "..") == 0)
+		{
+			continue;
+		}
+		std::string name = sub.empty() ? ent->d_name : sub + "/" + ent->d_name;
+		struct stat st;
+		if (lstat((dir + "/" + name).c_str(), &st) != 0)
+		{
+			continue;
+		}
+		if (S_ISDIR(st.st_mode))
+		{
+			if (!FST_scanDirectory(dir, name, outFiles))
+			{
+				isSuccess = false;
+				break;
+			}
+		}
+		else if (S_ISREG(st.st_mode))
+		{
+			FST_BatchFile file;
+			file.name = name;
+			file.size = (uint64_t)st.st_size;
+			file.offset = 0;
+			outFiles.push_back(file);
+		}
+	}
+	closedir(dirp);
+	return isSuccess;
+#endif
+}
+
+bool FST_scanDirectory(const std::string& dir, std::vector<FST_BatchFile>& outFiles)
+{
+	outFiles.clear();
+	if (!FST_scanDirectory(dir, "", outFiles))
+	{
+		return false;
+	}
+	// ,ͬһĿ¼µļ
+	std::sort(outFiles.begin(), outFiles.end(), [](const FST_BatchFile& a, const FST_BatchFile& b)
+	{
+		return a.name < b.name;
+	});
+	return true;
+}
+
+bool FST_makeDirs(const std::string& dir)
+{
+	for (size_t pos = 1; pos <= dir.size(); ++pos)
+	{
+		if (pos == dir.size() || dir[pos] == '/' || dir[pos] == '\\')
+		{
+			std::string path = dir.substr(0, pos);
+			if (FST_isDirectory(path))
+			{
+				continue;
+			}
+#if defined(_WIN32)
+			_mkdir(path.c_str());
+#else
+			mkdir(path.c_str(), 0755);
+#endif
+		}
+	}
+	return FST_isDirectory(dir);
+}
+
+bool FST_checkBatchName(const std::string& name)
+{
+	if (name.empty() || name.size() > FST_BATCH_NAME_MAX_LEN)
+	{
+		return false;
+	}
+	if (name[0] == '/' || name[0] == '\\' || name.find(':') != std::string::npos)
+	{
+		return false;
+	}
+	// 𼶼,Ŀ¼"."".."
+	size_t begin = 0;
+	while (begin <= name.size())
+	{
+		size_t end = name.find_first_of("/\\", begin);
+		if (end == std::string::npos)
+		{
+			end = name.size();
+		}
+		std::string part = name.substr(begin, end - begin);
+		if (part.empty() || part == "." || part == "..")
+		{
+			return false;
+		}
+		begin = end + 1;
+	}
+	return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+FST_BatchStream::FST_BatchStream(const std::string& dir, bool isWrite)
+	: m_dir(dir)
+	, m_isWrite(isWrite)
+	, m_totalSize(0)
+	, m_curFp(NULL)
+	, m_curIndex(0)
+{}
+
+FST_BatchStream::~FST_BatchStream()
+{
+	closeFile();
+}
+
+bool FST_BatchStream::addFile(const std::string& name, uint64_t size)
+{
+	if (m_isWrite)
+	{
+		std::string path = m_dir + "/" + name;
+		size_t pos = path.find_last_of("/\\");
+		std::string parent = path.substr(0, pos);
+		if (parent != m_lastDir)
+		{
+			if (!FST_makeDirs(parent))
+			{
+				return false;
+			}
+			m_lastDir = parent;
+		}
+
+		// ļ,еͬļض
+		FILE* fp = fopen(path.c_str(), "wb");
+		if (fp == NULL)
+		{
+			return false;
+		}
+		fclose(fp);
+	}
+
+	FST_BatchFile file;
+	file.name = name;
+	file.size = size;
+	file.offset = m_totalSize;
+	m_files.push_back(file);
+	m_totalSize += size;
+	return true;
+}
+
+bool FST_BatchStream::read(uint64_t pos, char* buf, uint32_t len)
+{
+	if (m_isWrite)
+	{
+		return false;
+	}
+	return access(pos, buf, len);
+}
+
+bool FST_BatchStream::write(uint64_t pos, const char* data, uint32_t len)
+{
+	if (!m_isWrite)
+	{
+		return false;
+	}
+	return access(pos, (char*)data, len);
+}
+
+bool FST_BatchStream::access(uint64_t pos, char* buf, uint32_t len)
+{
+	if (pos > m_totalSize || len > m_totalSize - pos)
+	{
+		return false;
+	}
+
+	while (len > 0)
+	{
+		uint32_t index = findFile(pos);
+		if (index >= (uint32_t)m_files.size())
+		{
+			return false;
+		}
+		const FST_BatchFile& file = m_files[index];
+
+		uint64_t fileOffset = pos - file.offset;
+		uint32_t size = len;
+		if (file.size - fileOffset < size)
+		{
+			size = (uint32_t)(file.size - fileOffset);
+		}
+
+		FILE* fp = openFile(index);
+		if (fp == NULL)
+		{
+			return false;
+		}
+		fst_fseek(fp, fileOffset, SEEK_SET);
+		if (m_isWrite)
+		{
+			if (fwrite(buf, size, 1, fp) != 1)
+			{
+				return false;
+			}
+		}
+		else if (fread(buf, size, 1, fp) != 1)
+		{
+			return false;
+		}
+
+		pos += size;
+		buf += size;
+		len -= size;
+	}
+	return true;
+}
+
+uint32_t FST_BatchStream::findFile(uint64_t pos)
+{
+	// һʼλòposļ,ļļʼλͬ,ᱻѡ
+	auto it = std::upper_bound(m_files.begin(), m_files.end(), pos, [](uint64_t value, const FST_BatchFile& file)
+	{
+		return value < file.offset;
+	});
+	if (it == m_files.begin())
+	{
+		return (uint32_t)m_files.size();
+	}
+	--it;
+	if (pos >= it->offset + it->size)
+	{
+		return (uint32_t)m_files.size();
+	}
+	return (uint32_t)(it - m_files.begin());
+}
+
+FILE* FST_BatchStream::openFile(uint32_t index)
+{
+	if (m_curFp != NULL && m_curIndex == index)
+	{
+		return m_curFp;
+	}
+	closeFile();
+
+	std::string path = m_dir + "/" + m_files[index].name;
+	m_curFp = fopen(path.c_str(), m_isWrite ? "rb+" : "rb");
+	m_curIndex = index;
+	return m_curFp;
+}
+
+void FST_BatchStream::closeFile()
+{
+	if (m_curFp)
+	{
+		fclose(m_curFp);
+		m_curFp = NULL;
+	}
+}
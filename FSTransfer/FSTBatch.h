@@ -0,0 +1,91 @@
+#pragma once
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+// 
+// ͷȷļ嵥,嵥еļ˳βΪһ,ļı߽嵥еĴСȷ
+// ķƬȷϡطУ뵥ļͬ,Сļȷ
+
+// 嵥ļ󳤶
+#define FST_BATCH_NAME_MAX_LEN 1024
+
+struct FST_BatchFile
+{
+	// Ŀ¼·,'/'ָ
+	std::string name;
+	uint64_t size;
+	// еλ
+	uint64_t offset;
+};
+
+// ɨĿ¼µļ(Ŀ¼),Ŀ¼ͷӲ
+bool FST_scanDirectory(const std::string& dir, std::vector<FST_BatchFile>& outFiles);
+
+// 𼶴Ŀ¼
+bool FST_makeDirs(const std::string& dir);
+
+// 嵥еļ,·ϼĿ¼
+bool FST_checkBatchName(const std::string& name);
+
+// 嵥д
+// ֻͬһ߳ʹ(ô߳ʱΪôӦĴ߳)
+class FST_BatchStream
+{
+public:
+
+	FST_BatchStream(const std::string& dir, bool isWrite);
+
+	FST_BatchStream(const FST_BatchStream&) = delete;
+
+	~FST_BatchStream();
+
+	// ļ,дʱļĿ¼
+	bool addFile(const std::string& name, uint64_t size);
+
+	inline uint64_t getTotalSize();
+
+	inline const std::vector<FST_BatchFile>& getFiles();
+
+	// д[pos, pos + len),ɿԽļ
+	bool read(uint64_t pos, char* buf, uint32_t len);
+
+	bool write(uint64_t pos, const char* data, uint32_t len);
+
+protected:
+
+	bool access(uint64_t pos, char* buf, uint32_t len);
+
+	// λposڵļ
+	uint32_t findFile(uint64_t pos);
+
+	// ͬһʱֻһļ,˳дʱҪظ
+	FILE* openFile(uint32_t index);
+
+	void closeFile();
+
+protected:
+	std::string m_dir;
+	bool m_isWrite;
+
+	std::vector<FST_BatchFile> m_files;
+	uint64_t m_totalSize;
+
+	FILE* m_curFp;
+	uint32_t m_curIndex;
+
+	// Ŀ¼,ͬһĿ¼µļظ
+	std::string m_lastDir;
+};
+
+uint64_t FST_BatchStream::getTotalSize()
+{
+	return m_totalSize;
+}
+
+const std::vector<FST_BatchFile>& FST_BatchStream::getFiles()
+{
+	return m_files;
+}
@@ -0,0 +1,212 @@
+#if !defined(_WIN32)
+// 32λϵͳoff_tʹ64λ
+#define _FILE_OFFSET_BITS 64
+#endif
+#include "FSTDelta.h"
+#include <string.h>
+#include <math.h>
+#include <unordered_map>
+#include "net_uv/net_uv.h"
+
+#if defined(_WIN32)
+#define fst_fseek _fseeki64
+#else
+#define fst_fseek fseeko
+#endif
+
+// ֿСΧ
+#define FST_DELTA_BLOCK_MIN_SIZE (1024 * 2)
+#define FST_DELTA_BLOCK_MAX_SIZE (1024 * 64)
+
+// ʱļȡ
+#define FST_DELTA_READ_SIZE (1024 * 1024)
+
+// У͹˱С(λ),󲿷ֲƥλòҪѯϣ
+#define FST_DELTA_FILTER_BITS 20
+
+static uint32_t FST_weakFilterIndex(uint32_t weak)
+{
+	return (weak * 0x9E3779B1U) >> (32 - FST_DELTA_FILTER_BITS);
+}
+
+// У(rsync)
+// a = sum(x[i]), b = sum((len - i) * x[i]), ȡ16λ
+static void FST_weakSum(const uint8_t* data, uint32_t len, uint32_t* outA, uint32_t* outB)
+{
+	uint32_t a = 0, b = 0;
+	for (uint32_t i = 0; i < len; ++i)
+	{
+		a += data[i];
+		b += a;
+	}
+	*outA = a & 0xFFFF;
+	*outB = b & 0xFFFF;
+}
+
+uint32_t FST_getDeltaBlockSize(uint64_t fileSize)
+{
+	// СȡļСƽ,ǩСƽ
+	uint64_t blockSize = (uint64_t)sqrt((double)fileSize);
+	blockSize = (blockSize + 1023) / 1024 * 1024;
+	if (blockSize < FST_DELTA_BLOCK_MIN_SIZE)
+	{
+		blockSize = FST_DELTA_BLOCK_MIN_SIZE;
+	}
+	if (blockSize > FST_DELTA_BLOCK_MAX_SIZE)
+	{
+		blockSize = FST_DELTA_BLOCK_MAX_SIZE;
+	}
+	return (uint32_t)blockSize;
+}
+
+bool FST_makeSignature(FILE* fp, uint64_t fileSize, uint32_t blockSize, std::vector<FST_BlockSignature>& outSignature)
+{
+	outSignature.clear();
+	if (blockSize == 0)
+	{
+		return false;
+	}
+
+	uint64_t blockCount = fileSize / blockSize;
+	outSignature.resize((size_t)blockCount);
+
+	std::vector<uint8_t> buf(blockSize);
+	fst_fseek(fp, 0, SEEK_SET);
+	for (uint64_t i = 0; i < blockCount; ++i)
+	{
+		if (fread(buf.data(), blockSize, 1, fp) != 1)
+		{
+			outSignature.clear();
+			return false;
+		}
+		FST_BlockSignature& sig = outSignature[(size_t)i];
+
+		uint32_t a, b;
+		FST_weakSum(buf.data(), blockSize, &a, &b);
+		sig.weak = (b << 16) | a;
+
+		net_uv::MD5 md5(buf.data(), blockSize);
+		memcpy(sig.strong, md5.digest(), sizeof(sig.strong));
+	}
+	return true;
+}
+
+bool FST_makeDelta(FILE* fp, uint64_t fileSize, uint32_t blockSize, const std::vector<FST_BlockSignature>& signature, std::vector<FST_DeltaCopy>& outCopy)
+{
+	outCopy.clear();
+	if (signature.empty() || blockSize == 0 || fileSize < blockSize)
+	{
+		return true;
+	}
+
+	std::vector<uint8_t> filter((1 << FST_DELTA_FILTER_BITS) / 8, 0);
+	std::unordered_multimap<uint32_t, uint32_t> weakMap;
+	weakMap.reserve(signature.size());
+	for (uint32_t i = 0; i < (uint32_t)signature.size(); ++i)
+	{
+		uint32_t index = FST_weakFilterIndex(signature[i].weak);
+		filter[index / 8] |= (uint8_t)(1 << (index % 8));
+		weakMap.emplace(signature[i].weak, i);
+	}
+
+	// еΪļ[bufBegin, bufBegin + bufLen)
+	uint32_t bufCapacity = FST_DELTA_READ_SIZE;
+	if (bufCapacity < blockSize * 2)
+	{
+		bufCapacity = blockSize * 2;
+	}
+	std::vector<uint8_t> buf(bufCapacity);
+	uint64_t bufBegin = 0;
+	uint32_t bufLen = 0;
+
+	// ֤[pos, pos + blockSize)ڻ
+	auto fill = [&](uint64_t pos) -> bool
+	{
+		if (pos + blockSize <= bufBegin + bufLen)
+		{
+			return true;
+		}
+		uint32_t keep = (uint32_t)(bufBegin + bufLen - pos);
+		memmove(buf.data(), buf.data() + (pos - bufBegin), keep);
+		bufBegin = pos;
+		bufLen = keep;
+
+		fst_fseek(fp, bufBegin + bufLen, SEEK_SET);
+		bufLen += (uint32_t)fread(buf.data() + bufLen, 1, bufCapacity - bufLen, fp);
+		return pos + blockSize <= bufBegin + bufLen;
+	};
+
+	uint64_t pos = 0;
+	uint32_t a = 0, b = 0;
+	bool isSumValid = false;
+	while (pos + blockSize <= fileSize)
+	{
+		if (!fill(pos))
+		{
+			return false;
+		}
+		const uint8_t* window = buf.data() + (pos - bufBegin);
+		if (!isSumValid)
+		{
+			FST_weakSum(window, blockSize, &a, &b);
+			isSumValid = true;
+		}
+
+		uint32_t weak = (b << 16) | a;
+		uint32_t index = FST_weakFilterIndex(weak);
+		if (filter[index / 8] & (1 << (index % 8)))
+		{
+			auto range = weakMap.equal_range(weak);
+			if (range.first != range.second)
+			{
+				net_uv::MD5 md5(window, blockSize);
+				const uint8_t* digest = md5.digest();
+
+				auto it = range.first;
+				for (; it != range.second; ++it)
+				{
+					if (memcmp(signature[it->second].strong, digest, 16) == 0)
+					{
+						break;
+					}
+				}
+				if (it != range.second)
+				{
+					uint64_t oldBegin = (uint64_t)it->second * blockSize;
+					FST_DeltaCopy* last = outCopy.empty() ? NULL : &outCopy.back();
+					if (last && last->newBegin + last->size == pos && last->oldBegin + last->size == oldBegin && last->size <= 0x7FFFFFFF - blockSize)
+					{
+						last->size += blockSize;
+					}
+					else
+					{
+						FST_DeltaCopy copy;
+						copy.newBegin = pos;
+						copy.oldBegin = oldBegin;
+						copy.size = blockSize;
+						outCopy.push_back(copy);
+					}
+					pos += blockSize;
+					isSumValid = false;
+					continue;
+				}
+			}
+		}
+
+		// ںһֽ
+		if (pos + blockSize >= fileSize)
+		{
+			break;
+		}
+		uint32_t out = window[0];
+		if (!fill(pos + 1))
+		{
+			return false;
+		}
+		uint32_t in = buf[(size_t)(pos + blockSize - bufBegin)];
+		a = (a - out + in) & 0xFFFF;
+		b = (b - blockSize * out + a) & 0xFFFF;
+		pos++;
+	}
+	return true;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <vector>
+
+// ͬ
+// շļֿ,ÿĹУmd5Ϊǩ
+// ͷԼļֽڹǩͬĿ,ЩɽշӾļ,ֻ
+
+#pragma pack(4)
+// ǩ
+struct FST_BlockSignature
+{
+	uint32_t weak;			// У
+	uint8_t strong[16];		// md5
+};
+
+// :ļ[newBegin, newBegin + size)ļ[oldBegin, oldBegin + size)ͬ
+struct FST_DeltaCopy
+{
+	uint64_t newBegin;
+	uint64_t oldBegin;
+	uint32_t size;
+};
+#pragma pack()
+
+// ݾļСѡֿС
+uint32_t FST_getDeltaBlockSize(uint64_t fileSize);
+
+// ļĿǩ,ĩβһݲ
+bool FST_makeSignature(FILE* fp, uint64_t fileSize, uint32_t blockSize, std::vector<FST_BlockSignature>& outSignature);
+
+// ļǩͬĿ,newBeginĸ,ڵϲ
+bool FST_makeDelta(FILE* fp, uint64_t fileSize, uint32_t blockSize, const std::vector<FST_BlockSignature>& signature, std::vector<FST_DeltaCopy>& outCopy);
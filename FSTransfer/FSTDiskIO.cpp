@@ -0,0 +1,168 @@
+#include "FSTDiskIO.h"
+
+class FSTDiskIOWorker : public net_uv::Runnable
+{
+public:
+
+	FSTDiskIOWorker(FSTDiskIO* io)
+		: m_io(io)
+		, m_isStop(false)
+	{
+		uv_sem_init(&m_sem, 0);
+	}
+
+	virtual ~FSTDiskIOWorker()
+	{
+		while (!m_jobQue.empty())
+		{
+			delete m_jobQue.front();
+			m_jobQue.pop();
+		}
+		uv_sem_destroy(&m_sem);
+	}
+
+	void post(FSTDiskIO::Job* job)
+	{
+		m_mutex.lock();
+		m_jobQue.push(job);
+		m_mutex.unlock();
+		uv_sem_post(&m_sem);
+	}
+
+	void stop()
+	{
+		m_mutex.lock();
+		m_isStop = true;
+		m_mutex.unlock();
+		uv_sem_post(&m_sem);
+		join();
+	}
+
+protected:
+
+	virtual void run()override
+	{
+		while (true)
+		{
+			uv_sem_wait(&m_sem);
+
+			m_mutex.lock();
+			FSTDiskIO::Job* job = NULL;
+			if (!m_jobQue.empty())
+			{
+				job = m_jobQue.front();
+				m_jobQue.pop();
+			}
+			// ֹͣʱִύ,ⶪʧδд̵
+			else if (m_isStop)
+			{
+				m_mutex.unlock();
+				break;
+			}
+			m_mutex.unlock();
+
+			if (job)
+			{
+				job->work();
+				m_io->pushDone(job);
+			}
+		}
+	}
+
+protected:
+	FSTDiskIO* m_io;
+	net_uv::Mutex m_mutex;
+	uv_sem_t m_sem;
+	std::queue<FSTDiskIO::Job*> m_jobQue;
+	bool m_isStop;
+};
+
+//////////////////////////////////////////////////////////////////////////
+
+FSTDiskIO::FSTDiskIO(uint32_t threadCount)
+	: m_channelSpawn(0)
+	, m_pendingSize(0)
+{
+	if (threadCount < 1)
+	{
+		threadCount = 1;
+	}
+	for (uint32_t i = 0; i < threadCount; ++i)
+	{
+		FSTDiskIOWorker* worker = new FSTDiskIOWorker(this);
+		worker->startThread();
+		m_workerArr.push_back(worker);
+	}
+}
+
+FSTDiskIO::~FSTDiskIO()
+{
+	for (auto worker : m_workerArr)
+	{
+		worker->stop();
+	}
+	for (auto worker : m_workerArr)
+	{
+		delete worker;
+	}
+	m_workerArr.clear();
+
+	// ߳˳ǰִȫ,δִеɻصֱӶ
+	while (!m_doneQue.empty())
+	{
+		delete m_doneQue.front();
+		m_doneQue.pop();
+	}
+	while (!m_doneDispatchQue.empty())
+	{
+		delete m_doneDispatchQue.front();
+		m_doneDispatchQue.pop();
+	}
+}
+
+uint32_t FSTDiskIO::allocChannel()
+{
+	return m_channelSpawn++;
+}
+
+void FSTDiskIO::post(uint32_t channel, uint32_t memSize, const FST_IOWork& work, const FST_IODone& done)
+{
+	Job* job = new Job();
+	job->work = work;
+	job->done = done;
+	job->memSize = memSize;
+
+	m_pendingSize += memSize;
+	m_workerArr[channel % m_workerArr.size()]->post(job);
+}
+
+void FSTDiskIO::pushDone(Job* job)
+{
+	m_doneMutex.lock();
+	m_doneQue.push(job);
+	m_doneMutex.unlock();
+}
+
+void FSTDiskIO::updateFrame()
+{
+	if (m_doneMutex.trylock() != 0)
+	{
+		return;
+	}
+	while (!m_doneQue.empty())
+	{
+		m_doneDispatchQue.push(m_doneQue.front());
+		m_doneQue.pop();
+	}
+	m_doneMutex.unlock();
+
+	while (!m_doneDispatchQue.empty())
+	{
+		Job* job = m_doneDispatchQue.front();
+		m_doneDispatchQue.pop();
+
+		m_pendingSize -= job->memSize;
+		job->done();
+		delete job;
+	}
+}
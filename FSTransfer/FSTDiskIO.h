@@ -0,0 +1,67 @@
+#pragma once
+
+#include "net_uv/net_uv.h"
+#include <functional>
+#include <vector>
+#include <queue>
+
+// ̶д߳
+// ļдڹִ߳,ɻصڵupdateFrameִ߳,дʱϢ
+// ͬһͨͬһ̰߳ύ˳ִ,ɻص˳ύ˳һ
+
+using FST_IOWork = std::function<void()>;
+using FST_IODone = std::function<void()>;
+
+class FSTDiskIOWorker;
+
+class FSTDiskIO
+{
+public:
+
+	FSTDiskIO(uint32_t threadCount);
+
+	FSTDiskIO(const FSTDiskIO&) = delete;
+
+	~FSTDiskIO();
+
+	// ͨ,ͨ䵽߳
+	uint32_t allocChannel();
+
+	// ύ,memSize:ռõĻС,ƶд
+	void post(uint32_t channel, uint32_t memSize, const FST_IOWork& work, const FST_IODone& done);
+
+	// ִĻص
+	void updateFrame();
+
+	// ύδִɻصռõĻС
+	inline uint64_t getPendingSize();
+
+protected:
+
+	friend class FSTDiskIOWorker;
+
+	struct Job
+	{
+		FST_IOWork work;
+		FST_IODone done;
+		uint32_t memSize;
+	};
+
+	// ̵߳
+	void pushDone(Job* job);
+
+protected:
+	std::vector<FSTDiskIOWorker*> m_workerArr;
+	uint32_t m_channelSpawn;
+
+	net_uv::Mutex m_doneMutex;
+	std::queue<Job*> m_doneQue;
+	std::queue<Job*> m_doneDispatchQue;
+
+	uint64_t m_pendingSize;
+};
+
+uint64_t FSTDiskIO::getPendingSize()
+{
+	return m_pendingSize;
+}
@@ -0,0 +1,161 @@
+#include "FSTRateLimit.h"
+#include <algorithm>
+
+FSTTokenBucket::FSTTokenBucket()
+	: m_rate(0)
+	, m_burst(0)
+	, m_tokens(0)
+{
+	m_lastTime = std::chrono::steady_clock::now();
+}
+
+void FSTTokenBucket::setRate(uint64_t rate)
+{
+	if (rate == m_rate)
+	{
+		return;
+	}
+	refill();
+	bool isStart = (m_rate == 0);
+	m_rate = rate;
+	m_burst = (int64_t)(rate * FST_RATE_BURST_TIME / 1000);
+	if (m_burst < FST_RATE_MIN_BURST)
+	{
+		m_burst = FST_RATE_MIN_BURST;
+	}
+	// ʼʱͰΪ
+	if (isStart || m_tokens > m_burst)
+	{
+		m_tokens = m_burst;
+	}
+}
+
+bool FSTTokenBucket::isAllow()
+{
+	if (m_rate == 0)
+	{
+		return true;
+	}
+	refill();
+	return m_tokens > 0;
+}
+
+void FSTTokenBucket::consume(uint32_t size)
+{
+	if (m_rate == 0)
+	{
+		return;
+	}
+	m_tokens -= size;
+}
+
+void FSTTokenBucket::refill()
+{
+	auto curTime = std::chrono::steady_clock::now();
+	int64_t us = std::chrono::duration_cast<std::chrono::microseconds>(curTime - m_lastTime).count();
+	if (m_rate == 0)
+	{
+		m_lastTime = curTime;
+		return;
+	}
+	// һֽʱʱ,Ƶʱʧ
+	int64_t tokens = (int64_t)(m_rate * us / 1000000);
+	if (tokens <= 0)
+	{
+		return;
+	}
+	m_lastTime = curTime;
+	m_tokens += tokens;
+	if (m_tokens > m_burst)
+	{
+		m_tokens = m_burst;
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+void FST_shareRate(uint64_t total, uint64_t minRate, std::vector<FST_RateShare*>& shareArr)
+{
+	std::stable_sort(shareArr.begin(), shareArr.end(), [](const FST_RateShare* a, const FST_RateShare* b)
+	{
+		return a->priority < b->priority;
+	});
+
+	uint64_t remain = total;
+	size_t begin = 0;
+	while (begin < shareArr.size())
+	{
+		// ͬһȼ[begin, end)
+		size_t end = begin + 1;
+		while (end < shareArr.size() && shareArr[end]->priority == shareArr[begin]->priority)
+		{
+			end++;
+		}
+
+		std::vector<FST_RateShare*> activeArr(shareArr.begin() + begin, shareArr.begin() + end);
+		for (auto it : activeArr)
+		{
+			it->rate = 0;
+		}
+
+		while (!activeArr.empty() && remain > 0)
+		{
+			uint64_t totalWeight = 0;
+			for (auto it : activeArr)
+			{
+				totalWeight += std::max(it->weight, 1u);
+			}
+
+			// Сڹƽݶ,ʣ·
+			bool isSatisfy = false;
+			for (auto it = activeArr.begin(); it != activeArr.end(); )
+			{
+				FST_RateShare* share = *it;
+				uint64_t fairRate = remain / totalWeight * std::max(share->weight, 1u);
+				uint64_t need = share->demand;
+				if (share->limit > 0 && share->limit < need)
+				{
+					need = share->limit;
+				}
+				if (need <= fairRate)
+				{
+					share->rate = need;
+					remain -= need;
+					it = activeArr.erase(it);
+					isSatisfy = true;
+				}
+				else
+				{
+					++it;
+				}
+			}
+			if (isSatisfy)
+			{
+				continue;
+			}
+
+			// ڹƽݶ,Ȩط
+			uint64_t fairUnit = remain / totalWeight;
+			for (auto it : activeArr)
+			{
+				it->rate = fairUnit * std::max(it->weight, 1u);
+				remain -= it->rate;
+			}
+			activeArr.clear();
+		}
+		begin = end;
+	}
+
+	for (auto it : shareArr)
+	{
+		uint64_t floorRate = minRate;
+		if (it->limit > 0 && it->limit < floorRate)
+		{
+			floorRate = it->limit;
+		}
+		if (it->rate < floorRate)
+		{
+			it->rate = floorRate;
+		}
+	}
+}
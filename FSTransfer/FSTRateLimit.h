@@ -0,0 +1,69 @@
+#pragma once
+
+#include <inttypes.h>
+#include <chrono>
+#include <vector>
+
+// 
+// ͷͰƷƬķ,շҪͷ
+
+// ͰӦʱ(),ƿкͻ
+#define FST_RATE_BURST_TIME 50
+
+// ͰС,֤һοԷһƬ
+#define FST_RATE_MIN_BURST (1024 * 64)
+
+class FSTTokenBucket
+{
+public:
+
+	FSTTokenBucket();
+
+	// (ֽ/),0Ϊ
+	void setRate(uint64_t rate);
+
+	inline uint64_t getRate();
+
+	// ǷԷ,ƿ͸֧,ֻҪʣƼɷһƬ
+	bool isAllow();
+
+	// ͺ۳
+	void consume(uint32_t size);
+
+protected:
+
+	void refill();
+
+protected:
+	uint64_t m_rate;
+	int64_t m_burst;
+	int64_t m_tokens;
+	std::chrono::steady_clock::time_point m_lastTime;
+};
+
+uint64_t FSTTokenBucket::getRate()
+{
+	return m_rate;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+// 
+struct FST_RateShare
+{
+	// ȼ,ֵԽСԽ
+	uint32_t priority;
+	// ͬһȼڰȨط
+	uint32_t weight;
+	// ,UINT64_MAXΪȷ
+	uint64_t demand;
+	// ,0Ϊ
+	uint64_t limit;
+	// 
+	uint64_t rate;
+};
+
+// ܴtotalȼη,ͬһȼڰȨعƽ(עˮ㷨):
+// Сڹƽݶֻ,ʣಿȨؼ
+// δ䵽ٷminRate,֤ȼĴ䲻ȫֹͣ
+void FST_shareRate(uint64_t total, uint64_t minRate, std::vector<FST_RateShare*>& shareArr);
@@ -1,11 +1,76 @@
+#if !defined(_WIN32)
+// 32λϵͳoff_tʹ64λ
+#define _FILE_OFFSET_BITS 64
+#endif
 #include "FSTransfer.h"
+#include "FSTDelta.h"
+#include "FSTDiskIO.h"
+#include "FSTBatch.h"
 #include <vector>
 #include <assert.h>
 #include <chrono>
 #include "net_uv/net_uv.h"
+#if defined(_WIN32)
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
 
 // ƬС
-#define FST_SLICES_SIZE 4216
+// ʼƬС,ȶFST_SLICES_MAX_SIZE
+#define FST_SLICES_MIN_SIZE 4216
+#define FST_SLICES_MAX_SIZE (1024 * 64)
+
+// ĬϷʹ(δȷϵֽͷƬ)
+#define FST_WINDOW_MAX_BYTES (1024 * 1024 * 4)
+#define FST_WINDOW_MAX_SLICES 256
+
+// ̶߳д,ʱͣȡ·Ƭ
+#define FST_IO_MAX_PENDING_SIZE (1024 * 1024 * 64)
+
+// Ƭʱδȷʱط()
+#define FST_RESEND_TIME 3000
+
+// ͬһƬУʧܵ,ʱΪļڴб޸
+#define FST_SLICE_CHECK_MAX_FAIL 8
+
+// ӲдʱÿСС
+#define FST_PART_MIN_SIZE (1024 * 1024)
+
+// ͳ()
+#define FST_STATS_INTERVAL 1000
+// ƽʵļȨϵ
+#define FST_STATS_EWMA_ALPHA 0.25f
+
+// ͬ
+#define FST_FLAG_DELTA 0x1
+// ƬУ:ÿƬЯCRC32C,շУʧʱҪط÷Ƭ
+#define FST_FLAG_SLICE_CHECK 0x2
+// :Ŀ¼
+#define FST_FLAG_BATCH 0x4
+
+// ͬʱշдʱļ׺,Уͨ滻ԭļ
+#define FST_DELTA_FILE_SUFFIX ".fstdelta"
+
+// ϢЯǩ/
+#define FST_DELTA_COUNT_PER_MSG 2048
+
+// 嵥Ϣ󳤶
+#define FST_BATCH_MANIFEST_MAX_SIZE (1024 * 60)
+
+// Э汾,˫һʱܾ
+// ֽΪ0:δЯ汾ŵľЭ齫ֶνΪļʱõļ,ܾͬ
+#define FST_NET_VERSION 0x0600
+
+#if defined(_WIN32)
+#define fst_fseek _fseeki64
+#define fst_ftell _ftelli64
+#define fst_ftruncate(_FP, _SIZE) _chsize_s(_fileno(_FP), _SIZE)
+#else
+#define fst_fseek fseeko
+#define fst_ftell ftello
+#define fst_ftruncate(_FP, _SIZE) ftruncate(fileno(_FP), (off_t)(_SIZE))
+#endif
 
 enum FST_ErrorCode
 {
@@ -14,20 +79,204 @@ enum FST_ErrorCode
 	FST_E_NO_MEMERY,		// ڴ治
 	FST_E_FILE_EXSIT,		// ļѴ
 	FST_E_NAME_ERROR,		// ļ
+	FST_E_VERSION,			// Э汾һ
+	FST_E_CHECK_FAIL,		// Уʧ
+};
+
+// ѷδȷϵķƬ
+struct FST_Slices
+{
+	uint32_t size;
+	uint32_t sendTime;
+	// ƬУֵ,طʱҪ¼
+	uint32_t crc;
+	// Уʧܴ
+	uint32_t failCount;
+	// ڴӴ̶ȡ,δ
+	bool isReading;
+	// Ƿط,طķƬRTT
+	bool isResend;
+};
+
+// 򵽴
+struct FST_RecvRange
+{
+	uint64_t end;
+	uint32_t crc;
+};
+
+// ̶߳д
+struct FST_IOResult
+{
+	bool isSuccess;
+	uint32_t crc;
 };
 
 struct FST_Task
 {
-	// ܴС
-	uint32_t totalSize;
+	FST_Task()
+		: fp(NULL)
+		, baseFp(NULL)
+		, isDeltaPending(false)
+		, pendingIO(0)
+		, batchFileCount(0)
+		, batchRecvCount(0)
+		, batchRecvSize(0)
+		, instantSpeed(0.0f)
+		, avgSpeed(0.0f)
+		, resendSlices(0)
+		, diskReadTime(0.0f)
+		, diskWriteTime(0.0f)
+	{}
+
+	// ̵߳ͬ,һͷʱرļ
+	~FST_Task()
+	{
+		if (fp)
+		{
+			fclose(fp);
+		}
+		if (baseFp)
+		{
+			fclose(baseFp);
+		}
+		// ͬδ,ɾʱļ,ԭļ
+		if (!deltaName.empty())
+		{
+			std::remove(deltaName.c_str());
+		}
+	}
+
+	// ļС
+	uint64_t fileSize;
+	// [beginPos, endPos),ļʱΪ[0, fileSize)
+	uint64_t beginPos;
+	uint64_t endPos;
 	FILE* fp;
-	// ѴС
-	uint32_t transmittedSize;
+	// ѴС(շΪյλ,ͷΪۼȷϵλ)
+	uint64_t transmittedSize;
+	// CRC32C,洫𲽼
+	// շΪ[beginPos, transmittedSize)Уֵ,ͷΪ[beginPos, sendPos)Уֵ
+	uint32_t crc;
+	bool isSliceCheck;
 
 	std::chrono::time_point<std::chrono::high_resolution_clock> lastTime;
-	uint32_t lastSize;
+	uint64_t lastSize;
+
+	/// ͷ
+	// һͷƬλ
+	uint64_t sendPos;
+	// ǰƬС
+	uint32_t slicesSize;
+	// ѷδȷϵķƬ begin -> FST_Slices
+	std::map<uint64_t, FST_Slices> inflightMap;
+	uint32_t inflightSize;
+	// ƽʱ()
+	uint32_t srtt;
+
+	/// շ
+	// 򵽴 begin -> FST_RecvRange
+	std::map<uint64_t, FST_RecvRange> recvRangeMap;
+
+	/// ͬ
+	uint32_t blockSize;
+	// ǩ(շ/ͷѽ)
+	std::vector<FST_BlockSignature> signature;
+	// ͷ:δյǩ
+	uint32_t waitSignatureCount;
+	// ͷ:շӾļõ begin -> end
+	std::map<uint64_t, uint64_t> copyRangeMap;
+	// շ:ļ,дʱļdeltaName
+	FILE* baseFp;
+	uint64_t baseSize;
+	std::string deltaName;
+	// ͷ:ڼ㸴
+	bool isDeltaPending;
+
+	/// ̶д
+	// δɵĴ
+	uint32_t pendingIO;
+	// շ:дδʱյУϢ
+	std::vector<char> pendingCheck;
+
+	/// 
+	// Ϊʱ嵥ļɵ,fpΪNULL
+	std::shared_ptr<FST_BatchStream> batch;
+	// շ:嵥еļ,յļС֮
+	uint32_t batchFileCount;
+	uint32_t batchRecvCount;
+	uint64_t batchRecvSize;
+
+	/// ͳ
+	float instantSpeed;
+	float avgSpeed;
+	uint32_t resendSlices;
+	float diskReadTime;
+	float diskWriteTime;
 };
 
+static uint32_t FST_getTime()
+{
+	return (uint32_t)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// ύɵʱƽӳ
+static void FST_updateDiskTime(float& value, const std::chrono::steady_clock::time_point& postTime)
+{
+	float ms = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - postTime).count() / 1000.0f;
+	value = (value == 0.0f) ? ms : value * 0.875f + ms * 0.125f;
+}
+
+// partIndex,䰴ƬС,ļСΪ
+static void FST_getPartRange(uint64_t fileSize, uint32_t partIndex, uint32_t partCount, uint64_t* outBegin, uint64_t* outSize)
+{
+	if (partCount <= 1)
+	{
+		*outBegin = 0;
+		*outSize = fileSize;
+		return;
+	}
+
+	uint64_t partSize = (fileSize + partCount - 1) / partCount;
+	partSize = (partSize + FST_SLICES_MAX_SIZE - 1) / FST_SLICES_MAX_SIZE * FST_SLICES_MAX_SIZE;
+	if (partSize < FST_PART_MIN_SIZE)
+	{
+		partSize = FST_PART_MIN_SIZE;
+	}
+
+	uint64_t begin = partSize * partIndex;
+	if (begin >= fileSize)
+	{
+		*outBegin = fileSize;
+		*outSize = 0;
+		return;
+	}
+	*outBegin = begin;
+	*outSize = (fileSize - begin < partSize) ? (fileSize - begin) : partSize;
+}
+
+// ȡļ[begin, end)Уֵ,ڴ̵߳
+static bool FST_readFileCrc(FILE* fp, uint64_t begin, uint64_t end, uint32_t* crc)
+{
+	std::vector<char> buf(FST_SLICES_MAX_SIZE);
+	fst_fseek(fp, begin, SEEK_SET);
+	while (begin < end)
+	{
+		uint32_t readSize = FST_SLICES_MAX_SIZE;
+		if (end - begin < readSize)
+		{
+			readSize = (uint32_t)(end - begin);
+		}
+		if (fread(buf.data(), readSize, 1, fp) != 1)
+		{
+			return false;
+		}
+		*crc = net_uv::net_crc32c(*crc, buf.data(), readSize);
+		begin += readSize;
+	}
+	return true;
+}
+
 //////////////////////////////////////////////////////////////////////////
 
 enum FST_NET_MSGID
@@ -45,13 +294,34 @@ enum FST_NET_MSGID
 	// ļ
 	FST_NET_DOWNLOAD,
 
+	// ͬ:շļĿǩ
+	FST_NET_SIGNATURE,
+	// ͬ:շɸõ
+	FST_NET_DELTA,
+
 	// Уļ
 	FST_NET_CHECK,
+	// У
+	FST_NET_CHECK_RESULT,
+
+	// :Ŀ¼
+	FST_NET_POST_BATCH,
+	// :ļ嵥
+	FST_NET_BATCH_MANIFEST,
+
+	// շҪķ
+	FST_NET_RATE_LIMIT,
 };
 
+// Ϣṹ4ֽڶ,32λ64λ֮䱣һ
+#pragma pack(4)
 struct FST_Net_Base
 {
-	FST_NET_MSGID id;
+	FST_Net_Base()
+		: version(FST_NET_VERSION)
+	{}
+	uint32_t id;
+	uint32_t version;
 };
 
 struct FST_Net_SendFileBegin : FST_Net_Base
@@ -61,7 +331,11 @@ struct FST_Net_SendFileBegin : FST_Net_Base
 		id = FST_NET_POST_FILE;
 	}
 	char name[256];	// 
-	uint32_t size;  // С
+	uint64_t size;  // С
+	// δ,ļСһʱΪӲдһ
+	uint64_t rangeBegin;
+	uint64_t rangeSize;
+	uint32_t flag;
 };
 
 struct FST_Net_SendFileBeginResult : FST_Net_Base
@@ -69,10 +343,16 @@ struct FST_Net_SendFileBeginResult : FST_Net_Base
 	FST_Net_SendFileBeginResult()
 	{
 		id = FST_NET_POST_FILE_RESULT;
+		blockSize = 0;
+		blockCount = 0;
 	}
 	char name[256];
 	uint32_t code;
-	uint32_t recvSize;
+	// ѽյĴС
+	uint64_t recvSize;
+	// ͬ:С͵Ŀǩ
+	uint32_t blockSize;
+	uint32_t blockCount;
 };
 
 struct FST_TransferSlices : FST_Net_Base
@@ -81,8 +361,10 @@ struct FST_TransferSlices : FST_Net_Base
 	{
 		id = FST_NET_TRANSFER_SLICES;
 	}
-	uint32_t begin;
+	uint64_t begin;
 	uint32_t size;
+	// ƬУʱΪƬݵCRC32C
+	uint32_t crc;
 };
 
 struct FST_TransferSlicesResult : FST_Net_Base
@@ -91,7 +373,13 @@ struct FST_TransferSlicesResult : FST_Net_Base
 	{
 		id = FST_NET_TRANSFER_SLICES_RESULT;
 	}
-	uint32_t begin;
+	// ۼȷ:λ֮ǰȫյ
+	uint64_t begin;
+	// ѡȷ:յķƬ
+	uint64_t sackBegin;
+	uint32_t sackSize;
+	// Ϊ0ʱʾ÷ƬУʧ,Ҫط
+	uint32_t code;
 };
 
 struct FST_Net_Download : FST_Net_Base
@@ -101,6 +389,31 @@ struct FST_Net_Download : FST_Net_Base
 		id = FST_NET_DOWNLOAD;
 	}
 	char name[256];
+	// ӲʱɷͷļС
+	uint32_t partIndex;
+	uint32_t partCount;
+	uint32_t flag;
+};
+
+// countFST_BlockSignature
+struct FST_Signature : FST_Net_Base
+{
+	FST_Signature()
+	{
+		id = FST_NET_SIGNATURE;
+	}
+	uint32_t index;
+	uint32_t count;
+};
+
+// countFST_DeltaCopy
+struct FST_Delta : FST_Net_Base
+{
+	FST_Delta()
+	{
+		id = FST_NET_DELTA;
+	}
+	uint32_t count;
 };
 
 struct FST_Check : FST_Net_Base
@@ -109,16 +422,62 @@ struct FST_Check : FST_Net_Base
 	{
 		id = FST_NET_CHECK;
 	}
-	uint32_t size;
+	// ļС
+	uint64_t size;
+	// CRC32C
+	uint32_t crc;
+};
+
+struct FST_CheckResult : FST_Net_Base
+{
+	FST_CheckResult()
+	{
+		id = FST_NET_CHECK_RESULT;
+	}
+	uint32_t code;
+};
+
+// fileCountļ嵥,嵥ֱ֮ӷ,ȴշظ
+struct FST_Net_PostBatch : FST_Net_Base
+{
+	FST_Net_PostBatch()
+	{
+		id = FST_NET_POST_BATCH;
+	}
+	char name[256];	// Ŀ¼
+	uint64_t size;	// С(ļС֮)
+	uint32_t fileCount;
+	uint32_t flag;
+};
+
+// countFST_BatchEntry,ÿFST_BatchEntrynameLenֽڵļ('\0')
+struct FST_BatchManifest : FST_Net_Base
+{
+	FST_BatchManifest()
+	{
+		id = FST_NET_BATCH_MANIFEST;
+	}
+	// һļ嵥е
+	uint32_t index;
+	uint32_t count;
+};
 
-	uint32_t begin1;
-	uint32_t size1;
-	uint32_t hash1;
+struct FST_BatchEntry
+{
+	uint64_t size;
+	uint32_t nameLen;
+};
 
-	uint32_t begin2;
-	uint32_t size2;
-	uint32_t hash2;
+struct FST_Net_RateLimit : FST_Net_Base
+{
+	FST_Net_RateLimit()
+	{
+		id = FST_NET_RATE_LIMIT;
+	}
+	// ֽ/,0Ϊ
+	uint64_t rate;
 };
+#pragma pack()
 
 
 //////////////////////////////////////////////////////////////////////////
@@ -129,20 +488,139 @@ struct FST_Check : FST_Net_Base
 //////////////////////////////////////////////////////////////////////////
 
 FSTransfer::FSTransfer()
-	: m_duty(Duty::None)
+	: m_output(nullptr)
+	, m_finishCall(nullptr)
 	, m_task(nullptr)
-	, m_output(nullptr)
+	, m_duty(Duty::None)
+	, m_partIndex(0)
+	, m_partCount(1)
+	, m_rangeBegin(0)
+	, m_rangeSize(0)
+	, m_windowBytes(FST_WINDOW_MAX_BYTES)
+	, m_windowSlices(FST_WINDOW_MAX_SLICES)
+	, m_isDeltaSync(false)
+	, m_isSliceCheck(false)
+	, m_isBatch(false)
+	, m_diskIO(NULL)
+	, m_ioChannel(0)
+	, m_rateLimit(0)
+	, m_remoteRateLimit(0)
+	, m_sentRateLimit(0)
+	, m_transferBytes(0)
 {
-	m_readBuf = new char[FST_SLICES_SIZE];
+	m_self = std::make_shared<FSTransfer*>(this);
 }
 
 FSTransfer::~FSTransfer()
 {
-	delete[] m_readBuf;
+	// ֮ɵĴٻص
+	*m_self = NULL;
+	m_task = NULL;
+}
+
+void FSTransfer::setDiskIO(FSTDiskIO* diskIO)
+{
+	m_diskIO = diskIO;
+	m_ioChannel = diskIO ? diskIO->allocChannel() : 0;
+}
+
+void FSTransfer::setRateLimit(uint64_t rate)
+{
+	m_rateLimit = rate;
+	updateRateLimit();
+	if (m_duty == Duty::Recv)
+	{
+		sendRateLimit(false);
+	}
+}
+
+void FSTransfer::sendRateLimit(bool isForce)
+{
+	if (!isForce)
+	{
+		// 仯Сʱ,Ƶ
+		uint64_t diff = m_rateLimit > m_sentRateLimit ? m_rateLimit - m_sentRateLimit : m_sentRateLimit - m_rateLimit;
+		if (diff == 0 || ((m_rateLimit != 0 && m_sentRateLimit != 0) && diff * 8 < m_sentRateLimit))
+		{
+			return;
+		}
+	}
+	else if (m_rateLimit == 0 && m_sentRateLimit == 0)
+	{
+		return;
+	}
+	m_sentRateLimit = m_rateLimit;
+
+	FST_Net_RateLimit data;
+	data.rate = m_rateLimit;
+	FST_SEND(data);
+}
+
+void FSTransfer::updateRateLimit()
+{
+	uint64_t rate = m_rateLimit;
+	if (m_remoteRateLimit > 0 && (rate == 0 || m_remoteRateLimit < rate))
+	{
+		rate = m_remoteRateLimit;
+	}
+	m_bucket.setRate(rate);
+}
+
+void FSTransfer::postIO(uint32_t memSize, const std::function<void()>& work, const std::function<void()>& done)
+{
+	std::shared_ptr<FST_Task> task = m_task;
+	std::shared_ptr<FSTransfer*> self = m_self;
+	task->pendingIO++;
+
+	auto onDone = [=]()
+	{
+		task->pendingIO--;
+		// ٻѽ
+		if (*self == NULL || (*self)->m_task != task)
+		{
+			return;
+		}
+		done();
+	};
+
+	if (m_diskIO == NULL)
+	{
+		work();
+		onDone();
+		return;
+	}
+	m_diskIO->post(m_ioChannel, memSize, work, onDone);
+}
+
+void FSTransfer::postFileCrc(uint64_t begin, uint64_t end)
+{
+	FILE* fp = m_task->fp;
+	auto result = std::make_shared<FST_IOResult>();
+	postIO(0, [=]()
+	{
+		result->crc = 0;
+		result->isSuccess = FST_readFileCrc(fp, begin, end, &result->crc);
+	}, [=]()
+	{
+		if (!result->isSuccess)
+		{
+			printf("read file: %s fail\n", m_filename.c_str());
+			finish(false);
+			return;
+		}
+		m_task->crc = net_uv::net_crc32cCombine(m_task->crc, result->crc, end - begin);
+		checkPendingCheck();
+	});
 }
 
-int32_t FSTransfer::postFile(const std::string& file)
+int32_t FSTransfer::postFile(const std::string& file, uint32_t partIndex, uint32_t partCount)
 {
+	m_duty = Duty::Send;
+	m_filename = file;
+	m_partIndex = partIndex;
+	m_partCount = partCount;
+	m_isBatch = false;
+
 	if (file.empty())
 	{
 		return FST_E_NOT_FOUND;
@@ -153,29 +631,150 @@ int32_t FSTransfer::postFile(const std::string& file)
 		printf("can not open file\n");
 		return FST_E_OPEN_FAIL;
 	}
-	fseek(fp, 0, SEEK_END);
-	uint32_t fileSize = ftell(fp);
+	fst_fseek(fp, 0, SEEK_END);
+	uint64_t fileSize = fst_ftell(fp);
 	fclose(fp);
 	
 	FST_Net_SendFileBegin sendData;
 	sendData.size = fileSize;
+	FST_getPartRange(fileSize, partIndex, partCount, &sendData.rangeBegin, &sendData.rangeSize);
+	// Ӳдʱʹͬ
+	sendData.flag = (m_isDeltaSync && partCount <= 1) ? FST_FLAG_DELTA : 0;
+	if (m_isSliceCheck)
+	{
+		sendData.flag |= FST_FLAG_SLICE_CHECK;
+	}
 	strcpy(sendData.name, file.c_str());
 	FST_SEND(sendData);
 
-	m_duty = Duty::Send;
-	m_filename = file;
+	m_rangeBegin = sendData.rangeBegin;
+	m_rangeSize = sendData.rangeSize;
 	
 	return 0;
 }
 
-void FSTransfer::downLoadFile(const std::string& file)
+void FSTransfer::downLoadFile(const std::string& file, uint32_t partIndex, uint32_t partCount)
 {
 	FST_Net_Download data;
 	strcpy(data.name, file.c_str());
+	data.partIndex = partIndex;
+	data.partCount = partCount;
+	data.flag = m_isDeltaSync ? FST_FLAG_DELTA : 0;
+	if (m_isSliceCheck)
+	{
+		data.flag |= FST_FLAG_SLICE_CHECK;
+	}
 	FST_SEND(data);
 
 	m_duty = Duty::Recv;
 	m_filename = file;
+	m_partIndex = partIndex;
+	m_partCount = partCount;
+	m_isBatch = false;
+
+	// ͷʼǰ֪
+	m_sentRateLimit = 0;
+	sendRateLimit(true);
+}
+
+int32_t FSTransfer::postDir(const std::string& dir)
+{
+	m_duty = Duty::Send;
+	m_filename = dir;
+	m_partIndex = 0;
+	m_partCount = 1;
+	m_isBatch = true;
+
+	if (dir.empty() || dir.size() >= sizeof(FST_Net_PostBatch::name))
+	{
+		return FST_E_NAME_ERROR;
+	}
+
+	std::vector<FST_BatchFile> files;
+	if (!FST_scanDirectory(dir, files))
+	{
+		printf("can not open dir\n");
+		return FST_E_NOT_FOUND;
+	}
+
+	auto batch = std::make_shared<FST_BatchStream>(dir, false);
+	for (auto& it : files)
+	{
+		if (it.name.size() > FST_BATCH_NAME_MAX_LEN)
+		{
+			printf("file: %s name too long\n", it.name.c_str());
+			return FST_E_NAME_ERROR;
+		}
+		batch->addFile(it.name, it.size);
+	}
+
+	FST_Net_PostBatch sendData;
+	strcpy(sendData.name, dir.c_str());
+	sendData.size = batch->getTotalSize();
+	sendData.fileCount = (uint32_t)files.size();
+	sendData.flag = m_isSliceCheck ? FST_FLAG_SLICE_CHECK : 0;
+	FST_SEND(sendData);
+	sendBatchManifest(batch->getFiles());
+
+	// 嵥,շܾʱظ
+	createSendTask(NULL, sendData.size, 0, sendData.size, 0);
+	m_task->batch = batch;
+	sendWindow();
+	return 0;
+}
+
+void FSTransfer::downLoadDir(const std::string& dir)
+{
+	FST_Net_Download data;
+	strcpy(data.name, dir.c_str());
+	data.partIndex = 0;
+	data.partCount = 1;
+	data.flag = FST_FLAG_BATCH;
+	if (m_isSliceCheck)
+	{
+		data.flag |= FST_FLAG_SLICE_CHECK;
+	}
+	FST_SEND(data);
+
+	m_duty = Duty::Recv;
+	m_filename = dir;
+	m_partIndex = 0;
+	m_partCount = 1;
+	m_isBatch = true;
+
+	m_sentRateLimit = 0;
+	sendRateLimit(true);
+}
+
+void FSTransfer::sendBatchManifest(const std::vector<FST_BatchFile>& files)
+{
+	std::vector<char> buf(FST_BATCH_MANIFEST_MAX_SIZE);
+
+	uint32_t index = 0;
+	while (index < (uint32_t)files.size())
+	{
+		FST_BatchManifest* msg = new (buf.data()) FST_BatchManifest();
+		msg->index = index;
+		msg->count = 0;
+
+		uint32_t len = sizeof(FST_BatchManifest);
+		for (; index < (uint32_t)files.size(); ++index)
+		{
+			const FST_BatchFile& file = files[index];
+			FST_BatchEntry entry;
+			entry.size = file.size;
+			entry.nameLen = (uint32_t)file.name.size();
+			if (len + sizeof(FST_BatchEntry) + entry.nameLen > buf.size())
+			{
+				break;
+			}
+			memcpy(buf.data() + len, &entry, sizeof(FST_BatchEntry));
+			memcpy(buf.data() + len + sizeof(FST_BatchEntry), file.name.c_str(), entry.nameLen);
+			len += sizeof(FST_BatchEntry) + entry.nameLen;
+			msg->count++;
+		}
+		FST_SEND_SIZE(buf.data(), len);
+	}
 }
 
 void FSTransfer::online(bool isOnline)
@@ -186,12 +785,27 @@ void FSTransfer::online(bool isOnline)
 		{
 		case FSTransfer::Send:
 		{
-			postFile(m_filename);
+			// Ӻͷ
+			if (m_isBatch)
+			{
+				postDir(m_filename);
+			}
+			else
+			{
+				postFile(m_filename, m_partIndex, m_partCount);
+			}
 		}
 			break;
 		case FSTransfer::Recv:
 		{
-			downLoadFile(m_filename);
+			if (m_isBatch)
+			{
+				downLoadDir(m_filename);
+			}
+			else
+			{
+				downLoadFile(m_filename, m_partIndex, m_partCount);
+			}
 		}
 			break;
 		case FSTransfer::None:
@@ -203,6 +817,9 @@ void FSTransfer::online(bool isOnline)
 	else
 	{
 		clearTask();
+		// ӺԷΪµĴ
+		m_remoteRateLimit = 0;
+		updateRateLimit();
 	}
 }
 
@@ -211,6 +828,18 @@ void FSTransfer::updateFrame()
 	if (m_task == NULL)
 		return;
 
+	if (m_duty == Duty::Send)
+	{
+		checkResend();
+		if (m_task == NULL)
+			return;
+
+		// ̶ȡ治ʱͣ˷,ڴ˼
+		sendWindow();
+		if (m_task == NULL)
+			return;
+	}
+
 	std::chrono::time_point<std::chrono::high_resolution_clock> curTime = std::chrono::high_resolution_clock::now();
 
 	int32_t milliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(curTime - m_task->lastTime).count();
@@ -218,28 +847,75 @@ void FSTransfer::updateFrame()
 	{
 		return;
 	}
-	if (milliseconds > 1000)
+	if (milliseconds >= FST_STATS_INTERVAL)
 	{
-		int32_t totalSize = m_task->transmittedSize - m_task->lastSize;
+		int64_t totalSize = (int64_t)(m_task->transmittedSize - m_task->lastSize);
 		if (totalSize < 0)
 		{
 			totalSize = 0;
 		}
-		totalSize = totalSize * 1000;
-
-		float percent = (float)m_task->transmittedSize / (float)m_task->totalSize;
-		percent *= 100.0f;
-		float speed = (float)totalSize / 1024.0f / milliseconds;
-		printf("[%.02f] %fkb/1s\n", percent, speed);
+		m_task->instantSpeed = (float)totalSize * 1000.0f / milliseconds;
+		if (m_task->avgSpeed == 0.0f)
+		{
+			m_task->avgSpeed = m_task->instantSpeed;
+		}
+		else
+		{
+			m_task->avgSpeed += (m_task->instantSpeed - m_task->avgSpeed) * FST_STATS_EWMA_ALPHA;
+		}
 
 		m_task->lastSize = m_task->transmittedSize;
 		m_task->lastTime = curTime;
 	}
 }
 
+bool FSTransfer::getStats(FST_Stats& outStats)
+{
+	if (m_task == NULL)
+	{
+		return false;
+	}
+	outStats.name = m_filename;
+	outStats.isSend = (m_duty == Duty::Send);
+	outStats.totalSize = m_task->endPos - m_task->beginPos;
+	outStats.doneSize = m_task->transmittedSize - m_task->beginPos;
+	outStats.instantSpeed = m_task->instantSpeed;
+	outStats.avgSpeed = m_task->avgSpeed;
+	outStats.inflightBytes = m_task->inflightSize;
+	outStats.inflightSlices = (uint32_t)m_task->inflightMap.size();
+	outStats.srtt = m_task->srtt;
+	outStats.resendSlices = m_task->resendSlices;
+	outStats.diskReadTime = m_task->diskReadTime;
+	outStats.diskWriteTime = m_task->diskWriteTime;
+	outStats.transferBytes = m_transferBytes;
+	outStats.rateLimit = m_bucket.getRate();
+	return true;
+}
+
 void FSTransfer::input(char* data, int32_t len)
 {
+	if (len < (int32_t)sizeof(FST_Net_Base))
+	{
+		return;
+	}
+
 	FST_Net_Base* baseData = (FST_Net_Base*)data;
+	if (baseData->version != FST_NET_VERSION)
+	{
+		printf("net version mismatch: %u (local %u)\n", baseData->version, FST_NET_VERSION);
+		// Էʱ֪汾һ
+		if (baseData->id == FST_NET_POST_FILE || baseData->id == FST_NET_DOWNLOAD || baseData->id == FST_NET_POST_BATCH)
+		{
+			FST_Net_SendFileBeginResult resultData;
+			memset(resultData.name, 0, sizeof(resultData.name));
+			resultData.code = FST_E_VERSION;
+			resultData.recvSize = 0;
+			FST_SEND(resultData);
+		}
+		clearTask();
+		return;
+	}
+
 	switch (baseData->id)
 	{
 	case FST_NET_POST_FILE:
@@ -253,22 +929,73 @@ void FSTransfer::input(char* data, int32_t len)
 	case FST_NET_TRANSFER_SLICES:
 	{
 		FST_TransferSlices* msg = (FST_TransferSlices*)data;
-		recvFileData(msg->begin, (char*)&msg[1], msg->size);
+		if (len < (int32_t)sizeof(FST_TransferSlices) || len - sizeof(FST_TransferSlices) < msg->size)
+		{
+			return;
+		}
+		recvFileData(msg->begin, (char*)&msg[1], msg->size, msg->crc);
 	}break;
 	case FST_NET_TRANSFER_SLICES_RESULT:
 	{
-		FST_TransferSlicesResult* msg = (FST_TransferSlicesResult*)data;
-		sendFileData(msg->begin);
+		on_TransferSlicesResult(data, len);
 	}break;
 	case FST_NET_DOWNLOAD:
 	{
 		FST_Net_Download* msg = (FST_Net_Download*)data;
-		postFile(msg->name);
+		if (len < (int32_t)sizeof(FST_Net_Download) || msg->partCount == 0 || msg->partIndex >= msg->partCount)
+		{
+			return;
+		}
+		msg->name[sizeof(msg->name) - 1] = '\0';
+		m_isDeltaSync = (msg->flag & FST_FLAG_DELTA) != 0;
+		m_isSliceCheck = (msg->flag & FST_FLAG_SLICE_CHECK) != 0;
+		int32_t code = (msg->flag & FST_FLAG_BATCH) ? postDir(msg->name) : postFile(msg->name, msg->partIndex, msg->partCount);
+		if (code != 0)
+		{
+			// ֪طļ޷
+			FST_Net_SendFileBeginResult resultData;
+			strcpy(resultData.name, msg->name);
+			resultData.code = code;
+			resultData.recvSize = 0;
+			FST_SEND(resultData);
+		}
+	}break;
+	case FST_NET_SIGNATURE:
+	{
+		on_Signature(data, len);
+	}break;
+	case FST_NET_DELTA:
+	{
+		on_Delta(data, len);
 	}break;
 	case FST_NET_CHECK:
 	{
 		on_Check(data, len);
 	}break;
+	case FST_NET_POST_BATCH:
+	{
+		on_PostBatch(data, len);
+	}break;
+	case FST_NET_BATCH_MANIFEST:
+	{
+		on_BatchManifest(data, len);
+	}break;
+	case FST_NET_RATE_LIMIT:
+	{
+		if (len >= (int32_t)sizeof(FST_Net_RateLimit))
+		{
+			m_remoteRateLimit = ((FST_Net_RateLimit*)data)->rate;
+			updateRateLimit();
+		}
+	}break;
+	case FST_NET_CHECK_RESULT:
+	{
+		if (m_duty == Duty::Send && len >= (int32_t)sizeof(FST_CheckResult))
+		{
+			FST_CheckResult* msg = (FST_CheckResult*)data;
+			finish(msg->code == 0);
+		}
+	}break;
 	default:
 	{}break;
 	}
@@ -291,12 +1018,72 @@ void FSTransfer::on_PostFile(void* data, uint32_t len)
 	}
 
 	FST_Net_SendFileBegin* msg = (FST_Net_SendFileBegin*)data;
+	if (len < sizeof(FST_Net_SendFileBegin) || msg->rangeBegin > msg->size || msg->rangeSize > msg->size - msg->rangeBegin)
+	{
+		return;
+	}
+	msg->name[sizeof(msg->name) - 1] = '\0';
+	m_isSliceCheck = (msg->flag & FST_FLAG_SLICE_CHECK) != 0;
 
 	FST_Net_SendFileBeginResult resultData;
 	resultData.code = 0;
+	resultData.recvSize = 0;
 	strcpy(resultData.name, msg->name);
 
-	if (strlen(msg->name) > 0)
+	// Ӳдһ,дͬһļĲͬ
+	bool isRange = (msg->rangeSize != msg->size);
+
+	// ͬʱļΪ׼,Сж
+	uint64_t baseSize = 0;
+	if (!isRange && (msg->flag & FST_FLAG_DELTA) && strlen(msg->name) > 0)
+	{
+		baseSize = getFileSize(msg->name);
+	}
+
+	if (strlen(msg->name) <= 0)
+	{
+		resultData.code = FST_E_NAME_ERROR;
+	}
+	else if (isRange && msg->rangeSize == 0)
+	{
+		// 贫
+		resultData.code = FST_E_FILE_EXSIT;
+	}
+	else if (isRange)
+	{
+		m_filename = msg->name;
+
+		// ӿѴļ,ܽض
+		FILE* fp = fopen(msg->name, "rb+");
+		if (fp == NULL)
+		{
+			fp = fopen(msg->name, "wb+");
+		}
+		if (fp == NULL)
+		{
+			resultData.code = FST_E_OPEN_FAIL;
+		}
+		else
+		{
+			fst_fseek(fp, 0, SEEK_END);
+			if ((uint64_t)fst_ftell(fp) != msg->size)
+			{
+				fst_ftruncate(fp, msg->size);
+			}
+			createRecvTask(fp, msg->size, msg->rangeBegin, msg->rangeBegin + msg->rangeSize, 0);
+		}
+	}
+	else if (baseSize > 0)
+	{
+		m_filename = msg->name;
+		// ǩɺظ
+		if (startDeltaRecv(msg->name, msg->size, baseSize))
+		{
+			return;
+		}
+		resultData.code = FST_E_OPEN_FAIL;
+	}
+	else
 	{
 		resultData.recvSize = getFileSize(msg->name);
 		if (msg->size == resultData.recvSize)
@@ -312,206 +1099,1078 @@ void FSTransfer::on_PostFile(void* data, uint32_t len)
 			}
 			m_filename = msg->name;
 
-			FILE* fp = fopen(msg->name, "wb+");
+			// ʱѽյ
+			FILE* fp = fopen(msg->name, resultData.recvSize > 0 ? "rb+" : "wb+");
 			if (fp == NULL)
 			{
 				resultData.code = FST_E_OPEN_FAIL;
 			}
 			else
 			{
-				m_task = std::make_shared<FST_Task>();
-				m_task->fp = fp;
-				m_task->totalSize = msg->size;
-				m_task->lastTime = std::chrono::high_resolution_clock::now();
-				m_task->lastSize = resultData.recvSize;
-				m_task->transmittedSize = resultData.recvSize;
+				createRecvTask(fp, msg->size, 0, msg->size, resultData.recvSize);
 			}
 		}
 	}
-	else
+	FST_SEND(resultData);
+
+	// շڴ˽
+	if (resultData.code == FST_E_FILE_EXSIT)
+	{
+		printf("file: %s is recv finish\n", msg->name);
+		finish(true);
+	}
+	else if (resultData.code != 0)
+	{
+		finish(false);
+	}
+}
+
+void FSTransfer::on_PostBatch(void* data, uint32_t len)
+{
+	if (m_duty == Duty::None)
+	{
+		m_duty = Duty::Recv;
+	}
+	if (m_duty != Duty::Recv || m_task)
+	{
+		return;
+	}
+
+	FST_Net_PostBatch* msg = (FST_Net_PostBatch*)data;
+	if (len < sizeof(FST_Net_PostBatch))
+	{
+		return;
+	}
+	msg->name[sizeof(msg->name) - 1] = '\0';
+	m_isSliceCheck = (msg->flag & FST_FLAG_SLICE_CHECK) != 0;
+
+	FST_Net_SendFileBeginResult resultData;
+	resultData.code = 0;
+	resultData.recvSize = 0;
+	strcpy(resultData.name, msg->name);
+
+	if (strlen(msg->name) <= 0)
 	{
 		resultData.code = FST_E_NAME_ERROR;
 	}
+	else if (!FST_makeDirs(msg->name))
+	{
+		resultData.code = FST_E_OPEN_FAIL;
+	}
+	else
+	{
+		m_filename = msg->name;
+		createRecvTask(NULL, msg->size, 0, msg->size, 0);
+		m_task->batch = std::make_shared<FST_BatchStream>(msg->name, true);
+		m_task->batchFileCount = msg->fileCount;
+	}
 	FST_SEND(resultData);
+
+	if (resultData.code != 0)
+	{
+		finish(false);
+	}
+}
+
+void FSTransfer::on_BatchManifest(void* data, uint32_t len)
+{
+	if (m_task == NULL || m_duty != Duty::Recv || m_task->batch == NULL)
+	{
+		return;
+	}
+
+	FST_BatchManifest* msg = (FST_BatchManifest*)data;
+	if (len < sizeof(FST_BatchManifest))
+	{
+		return;
+	}
+
+	// 嵥˳,ļС֮ͲܳС
+	auto files = std::make_shared<std::vector<FST_BatchFile>>();
+	bool isValid = (msg->index == m_task->batchRecvCount && msg->count <= m_task->batchFileCount - m_task->batchRecvCount);
+	uint32_t offset = sizeof(FST_BatchManifest);
+	for (uint32_t i = 0; isValid && i < msg->count; ++i)
+	{
+		FST_BatchEntry entry;
+		if (len - offset < sizeof(FST_BatchEntry))
+		{
+			isValid = false;
+			break;
+		}
+		memcpy(&entry, (char*)data + offset, sizeof(FST_BatchEntry));
+		offset += sizeof(FST_BatchEntry);
+		if (len - offset < entry.nameLen || entry.size > m_task->fileSize - m_task->batchRecvSize)
+		{
+			isValid = false;
+			break;
+		}
+
+		FST_BatchFile file;
+		file.name.assign((char*)data + offset, entry.nameLen);
+		file.size = entry.size;
+		file.offset = m_task->batchRecvSize;
+		offset += entry.nameLen;
+		if (!FST_checkBatchName(file.name))
+		{
+			printf("file: %s name error\n", file.name.c_str());
+			isValid = false;
+			break;
+		}
+		m_task->batchRecvSize += entry.size;
+		files->push_back(file);
+	}
+
+	if (!isValid)
+	{
+		printf("dir: %s manifest error\n", m_filename.c_str());
+		FST_CheckResult resultData;
+		resultData.code = FST_E_NAME_ERROR;
+		FST_SEND(resultData);
+		finish(false);
+		return;
+	}
+	m_task->batchRecvCount += msg->count;
+
+	// ڴ̴߳ļ,֮ķƬд밴˳ִ
+	std::shared_ptr<FST_BatchStream> batch = m_task->batch;
+	auto result = std::make_shared<FST_IOResult>();
+	postIO(0, [=]()
+	{
+		result->isSuccess = true;
+		for (auto& it : *files)
+		{
+			if (!batch->addFile(it.name, it.size))
+			{
+				result->isSuccess = false;
+				break;
+			}
+		}
+	}, [=]()
+	{
+		if (!result->isSuccess)
+		{
+			printf("dir: %s create file fail\n", m_filename.c_str());
+			FST_CheckResult resultData;
+			resultData.code = FST_E_OPEN_FAIL;
+			FST_SEND(resultData);
+			finish(false);
+			return;
+		}
+		checkPendingCheck();
+	});
+}
+
+void FSTransfer::createRecvTask(FILE* fp, uint64_t fileSize, uint64_t beginPos, uint64_t endPos, uint64_t recvSize)
+{
+	m_task = std::make_shared<FST_Task>();
+	m_task->fp = fp;
+	m_task->fileSize = fileSize;
+	m_task->beginPos = beginPos;
+	m_task->endPos = endPos;
+	m_task->lastTime = std::chrono::high_resolution_clock::now();
+	m_task->lastSize = beginPos + recvSize;
+	m_task->transmittedSize = beginPos + recvSize;
+	m_task->crc = 0;
+	m_task->isSliceCheck = m_isSliceCheck;
+	m_task->sendPos = 0;
+	m_task->slicesSize = 0;
+	m_task->inflightSize = 0;
+	m_task->srtt = 0;
+	m_task->blockSize = 0;
+	m_task->waitSignatureCount = 0;
+	m_task->baseSize = 0;
+
+	// ʱѽյݼУ
+	if (recvSize > 0)
+	{
+		postFileCrc(beginPos, beginPos + recvSize);
+	}
+}
+
+bool FSTransfer::startDeltaRecv(const char* name, uint64_t fileSize, uint64_t baseSize)
+{
+	FILE* baseFp = fopen(name, "rb");
+	if (baseFp == NULL)
+	{
+		return false;
+	}
+	std::string deltaName = std::string(name) + FST_DELTA_FILE_SUFFIX;
+	FILE* fp = fopen(deltaName.c_str(), "wb+");
+	if (fp == NULL)
+	{
+		fclose(baseFp);
+		return false;
+	}
+
+	uint32_t blockSize = FST_getDeltaBlockSize(baseSize);
+
+	createRecvTask(fp, fileSize, 0, fileSize, 0);
+	m_task->blockSize = blockSize;
+	m_task->baseFp = baseFp;
+	m_task->baseSize = baseSize;
+	m_task->deltaName = deltaName;
+
+	auto signature = std::make_shared<std::vector<FST_BlockSignature>>();
+	auto result = std::make_shared<FST_IOResult>();
+	postIO(0, [=]()
+	{
+		result->isSuccess = FST_makeSignature(baseFp, baseSize, blockSize, *signature);
+	}, [=]()
+	{
+		FST_Net_SendFileBeginResult resultData;
+		resultData.code = 0;
+		resultData.recvSize = 0;
+		strcpy(resultData.name, m_filename.c_str());
+
+		if (!result->isSuccess)
+		{
+			printf("read file: %s fail\n", m_filename.c_str());
+			resultData.code = FST_E_OPEN_FAIL;
+			FST_SEND(resultData);
+			finish(false);
+			return;
+		}
+
+		resultData.blockSize = blockSize;
+		resultData.blockCount = (uint32_t)signature->size();
+		FST_SEND(resultData);
+		sendSignature(*signature);
+	});
+	return true;
+}
+
+void FSTransfer::sendSignature(const std::vector<FST_BlockSignature>& signature)
+{
+	std::vector<char> buf(sizeof(FST_Signature) + sizeof(FST_BlockSignature) * FST_DELTA_COUNT_PER_MSG);
+
+	for (uint32_t index = 0; index < (uint32_t)signature.size(); index += FST_DELTA_COUNT_PER_MSG)
+	{
+		uint32_t count = (uint32_t)signature.size() - index;
+		if (count > FST_DELTA_COUNT_PER_MSG)
+		{
+			count = FST_DELTA_COUNT_PER_MSG;
+		}
+		FST_Signature* msg = new (buf.data()) FST_Signature();
+		msg->index = index;
+		msg->count = count;
+		memcpy(buf.data() + sizeof(FST_Signature), &signature[index], sizeof(FST_BlockSignature) * count);
+		FST_SEND_SIZE(buf.data(), sizeof(FST_Signature) + sizeof(FST_BlockSignature) * count);
+	}
+}
+
+void FSTransfer::on_Signature(void* data, uint32_t len)
+{
+	if (m_task == NULL || m_duty != Duty::Send || m_task->waitSignatureCount == 0)
+	{
+		return;
+	}
+
+	FST_Signature* msg = (FST_Signature*)data;
+	if (len < sizeof(FST_Signature) || (len - sizeof(FST_Signature)) / sizeof(FST_BlockSignature) < msg->count)
+	{
+		return;
+	}
+	if (msg->count > m_task->waitSignatureCount || (uint64_t)msg->index + msg->count > m_task->signature.size())
+	{
+		return;
+	}
+
+	memcpy(&m_task->signature[msg->index], &msg[1], sizeof(FST_BlockSignature) * msg->count);
+	m_task->waitSignatureCount -= msg->count;
+	if (m_task->waitSignatureCount > 0)
+	{
+		return;
+	}
+
+	// ڴ̲߳Ҹ
+	m_task->isDeltaPending = true;
+	FILE* fp = m_task->fp;
+	uint64_t fileSize = m_task->fileSize;
+	uint32_t blockSize = m_task->blockSize;
+	auto signature = std::make_shared<std::vector<FST_BlockSignature>>();
+	signature->swap(m_task->signature);
+	auto copyArr = std::make_shared<std::vector<FST_DeltaCopy>>();
+	postIO(0, [=]()
+	{
+		if (!FST_makeDelta(fp, fileSize, blockSize, *signature, *copyArr))
+		{
+			// ʧʱȫ
+			copyArr->clear();
+		}
+	}, [=]()
+	{
+		m_task->isDeltaPending = false;
+		sendDelta(*copyArr);
+		sendWindow();
+	});
+}
+
+void FSTransfer::sendDelta(const std::vector<FST_DeltaCopy>& copyArr)
+{
+	uint64_t copySize = 0;
+	for (auto& it : copyArr)
+	{
+		m_task->copyRangeMap[it.newBegin] = it.newBegin + it.size;
+		copySize += it.size;
+	}
+	printf("file: %s delta reuse %llu/%llu\n", m_filename.c_str(), (unsigned long long)copySize, (unsigned long long)m_task->fileSize);
+
+	std::vector<char> buf(sizeof(FST_Delta) + sizeof(FST_DeltaCopy) * FST_DELTA_COUNT_PER_MSG);
+	for (uint32_t index = 0; index < (uint32_t)copyArr.size(); index += FST_DELTA_COUNT_PER_MSG)
+	{
+		uint32_t count = (uint32_t)copyArr.size() - index;
+		if (count > FST_DELTA_COUNT_PER_MSG)
+		{
+			count = FST_DELTA_COUNT_PER_MSG;
+		}
+		FST_Delta* msg = new (buf.data()) FST_Delta();
+		msg->count = count;
+		memcpy(buf.data() + sizeof(FST_Delta), &copyArr[index], sizeof(FST_DeltaCopy) * count);
+		FST_SEND_SIZE(buf.data(), sizeof(FST_Delta) + sizeof(FST_DeltaCopy) * count);
+	}
+}
+
+void FSTransfer::on_Delta(void* data, uint32_t len)
+{
+	if (m_task == NULL || m_duty != Duty::Recv || m_task->baseFp == NULL)
+	{
+		return;
+	}
+
+	FST_Delta* msg = (FST_Delta*)data;
+	if (len < sizeof(FST_Delta) || (len - sizeof(FST_Delta)) / sizeof(FST_DeltaCopy) < msg->count)
+	{
+		return;
+	}
+
+	FST_DeltaCopy* copyBegin = (FST_DeltaCopy*)&msg[1];
+	auto copyArr = std::make_shared<std::vector<FST_DeltaCopy>>(copyBegin, copyBegin + msg->count);
+	auto resultArr = std::make_shared<std::vector<FST_IOResult>>(msg->count);
+	FILE* fp = m_task->fp;
+	FILE* baseFp = m_task->baseFp;
+	uint64_t endPos = m_task->endPos;
+	uint64_t baseSize = m_task->baseSize;
+
+	// ڴ̴߳ӾļƵʱļ
+	postIO(0, [=]()
+	{
+		std::vector<char> buf(FST_SLICES_MAX_SIZE);
+		for (size_t i = 0; i < copyArr->size(); ++i)
+		{
+			const FST_DeltaCopy& copy = (*copyArr)[i];
+			FST_IOResult& result = (*resultArr)[i];
+			result.isSuccess = false;
+			result.crc = 0;
+			if (copy.size == 0 || copy.newBegin > endPos || copy.size > endPos - copy.newBegin
+				|| copy.oldBegin > baseSize || copy.size > baseSize - copy.oldBegin)
+			{
+				continue;
+			}
+
+			uint32_t offset = 0;
+			while (offset < copy.size)
+			{
+				uint32_t readSize = copy.size - offset;
+				if (readSize > FST_SLICES_MAX_SIZE)
+				{
+					readSize = FST_SLICES_MAX_SIZE;
+				}
+				fst_fseek(baseFp, copy.oldBegin + offset, SEEK_SET);
+				if (fread(buf.data(), readSize, 1, baseFp) != 1)
+				{
+					break;
+				}
+				fst_fseek(fp, copy.newBegin + offset, SEEK_SET);
+				if (fwrite(buf.data(), readSize, 1, fp) != 1)
+				{
+					break;
+				}
+				result.crc = net_uv::net_crc32c(result.crc, buf.data(), readSize);
+				offset += readSize;
+			}
+			result.isSuccess = (offset == copy.size);
+		}
+	}, [=]()
+	{
+		for (size_t i = 0; i < copyArr->size(); ++i)
+		{
+			const FST_DeltaCopy& copy = (*copyArr)[i];
+			if ((*resultArr)[i].isSuccess)
+			{
+				addRecvRange(copy.newBegin, copy.newBegin + copy.size, (*resultArr)[i].crc);
+			}
+		}
+		checkPendingCheck();
+	});
+}
+
+uint64_t FSTransfer::skipCopyRange(uint64_t pos)
+{
+	auto& rangeMap = m_task->copyRangeMap;
+	while (!rangeMap.empty())
+	{
+		auto it = rangeMap.upper_bound(pos);
+		if (it == rangeMap.begin())
+		{
+			break;
+		}
+		--it;
+		if (it->second <= pos)
+		{
+			break;
+		}
+		pos = it->second;
+	}
+	return pos;
 }
 
 void FSTransfer::on_PostFileResult(void* data, uint32_t len)
 {
+	FST_Net_SendFileBeginResult* msg = (FST_Net_SendFileBeginResult*)data;
+	if (len < sizeof(FST_Net_SendFileBeginResult))
+	{
+		return;
+	}
+	msg->name[sizeof(msg->name) - 1] = '\0';
+
 	if (m_duty == Duty::None)
 	{
 		m_duty = Duty::Send;
 	}
+	// 󱻷ͷܾ
+	if (m_duty == Duty::Recv)
+	{
+		if (m_task == NULL && msg->code != 0)
+		{
+			printf("download file: %s fail, code: %u\n", m_filename.c_str(), msg->code);
+			finish(false);
+		}
+		return;
+	}
 	if (m_duty != Duty::Send)
 	{
 		return;
 	}
 	if (m_task)
 	{
+		// 䲻ȴظ,շܾʱ
+		if (m_task->batch && msg->code != 0)
+		{
+			printf("dir: %s post fail, code: %u\n", m_filename.c_str(), msg->code);
+			finish(false);
+		}
 		return;
 	}
 
-	FST_Net_SendFileBeginResult* msg = (FST_Net_SendFileBeginResult*)data;
-
 	if (msg->code == 0)
 	{
 		FILE* fp = fopen(msg->name, "rb");
 		if (fp == NULL)
 		{
 			printf("open file: %s fail\n", msg->name);
+			finish(false);
 			return;
 		}
 
-		fseek(fp, 0, SEEK_END);
-		uint32_t curSize = ftell(fp);
+		fst_fseek(fp, 0, SEEK_END);
+		uint64_t curSize = fst_ftell(fp);
+
+		if (m_rangeBegin + m_rangeSize > curSize || msg->recvSize > m_rangeSize)
+		{
+			printf("file: %s size changed\n", msg->name);
+			fclose(fp);
+			finish(false);
+			return;
+		}
 
 		m_filename = msg->name;
-		m_task = std::make_shared<FST_Task>();
-		m_task->fp = fp;
-		m_task->totalSize = curSize;
-		m_task->lastTime = std::chrono::high_resolution_clock::now();
-		m_task->lastSize = curSize;
-		m_task->transmittedSize = curSize;
+		createSendTask(fp, curSize, m_rangeBegin, m_rangeBegin + m_rangeSize, msg->recvSize);
+
+		// շʱеݼУ
+		if (msg->recvSize > 0)
+		{
+			postFileCrc(m_rangeBegin, m_rangeBegin + msg->recvSize);
+			if (m_task == NULL)
+			{
+				return;
+			}
+		}
+
+		// ͬ:յȫǩٿʼ
+		if (msg->blockCount > 0 && msg->blockSize > 0 && m_rangeSize == curSize)
+		{
+			m_task->blockSize = msg->blockSize;
+			m_task->waitSignatureCount = msg->blockCount;
+			m_task->signature.resize(msg->blockCount);
+			return;
+		}
 
-		sendFileData(msg->recvSize);
+		sendWindow();
 		return;
 	}
 	else if (msg->code == FST_E_FILE_EXSIT)
 	{
 		printf("file: %s is send finish\n", msg->name);
+		finish(true);
+		return;
 	}
 	else if (msg->code == FST_E_NAME_ERROR)
 	{
 		printf("file: %s is name error\n", msg->name);
 	}
-	clearTask();
+	else if (msg->code == FST_E_VERSION)
+	{
+		printf("file: %s net version mismatch\n", m_filename.c_str());
+	}
+	finish(false);
 }
 
-static const uint32_t FST_constCheckBlockSize = 1024;
+void FSTransfer::createSendTask(FILE* fp, uint64_t fileSize, uint64_t beginPos, uint64_t endPos, uint64_t recvSize)
+{
+	m_task = std::make_shared<FST_Task>();
+	m_task->fp = fp;
+	m_task->fileSize = fileSize;
+	m_task->beginPos = beginPos;
+	m_task->endPos = endPos;
+	m_task->lastTime = std::chrono::high_resolution_clock::now();
+	m_task->lastSize = beginPos + recvSize;
+	m_task->transmittedSize = beginPos + recvSize;
+	m_task->crc = 0;
+	m_task->isSliceCheck = m_isSliceCheck;
+	m_task->sendPos = beginPos + recvSize;
+	m_task->slicesSize = FST_SLICES_MIN_SIZE;
+	m_task->inflightSize = 0;
+	m_task->srtt = 0;
+	m_task->blockSize = 0;
+	m_task->waitSignatureCount = 0;
+	m_task->baseSize = 0;
+}
 
 void FSTransfer::on_Check(void* data, uint32_t len)
 {
 	FST_Check* msg = (FST_Check*)data;
+	if (m_task == NULL || len < sizeof(FST_Check))
+	{
+		return;
+	}
 
-	fseek(m_task->fp, 0, SEEK_END);
-	uint32_t totalSize = ftell(m_task->fp);
+	// ȴдɺУ
+	if (m_task->pendingIO > 0)
+	{
+		m_task->pendingCheck.assign((char*)data, (char*)data + len);
+		return;
+	}
 
-	if (totalSize == msg->size)
+	uint64_t totalSize = m_task->fileSize;
+	if (m_task->fp)
 	{
-		char szBuf[FST_constCheckBlockSize];
+		fst_fseek(m_task->fp, 0, SEEK_END);
+		totalSize = fst_ftell(m_task->fp);
+	}
+
+	// Уֵڽչм,Ҫٴζȡļ
+	bool isSuccess = (totalSize == msg->size && m_task->transmittedSize >= m_task->endPos && m_task->crc == msg->crc);
+	if (m_task->batch && (m_task->batchRecvCount != m_task->batchFileCount || m_task->batchRecvSize != m_task->fileSize))
+	{
+		printf("dir: %s manifest incomplete\n", m_filename.c_str());
+		isSuccess = false;
+	}
 
-		fseek(m_task->fp, msg->begin1, SEEK_SET);
-		fread(szBuf, msg->size1, 1, m_task->fp);
-		uint32_t hash1 = net_uv::net_getBufHash(szBuf, msg->size1);
+	if (isSuccess && m_task->baseFp != NULL)
+	{
+		// ͬ,ʱļ滻ԭļ
+		fclose(m_task->fp);
+		fclose(m_task->baseFp);
+		m_task->fp = NULL;
+		m_task->baseFp = NULL;
+		std::remove(m_filename.c_str());
+		if (std::rename(m_task->deltaName.c_str(), m_filename.c_str()) != 0)
+		{
+			printf("rename file: %s fail\n", m_task->deltaName.c_str());
+			isSuccess = false;
+		}
+		else
+		{
+			m_task->deltaName.clear();
+		}
+	}
+	printf(isSuccess ? "check suc\n" : "check fail\n");
 
-		fseek(m_task->fp, msg->begin2, SEEK_SET);
-		fread(szBuf, msg->size2, 1, m_task->fp);
-		uint32_t hash2 = net_uv::net_getBufHash(szBuf, msg->size2);
+	FST_CheckResult resultData;
+	resultData.code = isSuccess ? 0 : FST_E_CHECK_FAIL;
+	FST_SEND(resultData);
 
-		if (msg->hash1 == hash1 && msg->hash2 == hash2)
+	finish(isSuccess);
+}
+
+void FSTransfer::on_TransferSlicesResult(void* data, uint32_t len)
+{
+	if (m_task == NULL || m_duty != Duty::Send)
+	{
+		return;
+	}
+
+	if (len < sizeof(FST_TransferSlicesResult))
+	{
+		return;
+	}
+
+	FST_TransferSlicesResult* msg = (FST_TransferSlicesResult*)data;
+	uint32_t curTime = FST_getTime();
+
+	// ѡȷ
+	auto it = m_task->inflightMap.find(msg->sackBegin);
+	if (it != m_task->inflightMap.end() && it->second.size == msg->sackSize)
+	{
+		if (msg->code != 0)
 		{
-			printf("check suc\n");
+			// ƬУʧ,ط
+			printf("slices %llu check fail, resend\n", (unsigned long long)msg->sackBegin);
+			if (++it->second.failCount > FST_SLICE_CHECK_MAX_FAIL)
+			{
+				finish(false);
+				return;
+			}
+			m_task->resendSlices++;
+			if (!sendSlices(it->first, it->second.size))
+			{
+				return;
+			}
+			it->second.sendTime = curTime;
+			it->second.isResend = true;
 		}
 		else
 		{
-			printf("check fail\n");
+			// ޷ȷϵһη,طķƬ(Karn㷨)
+			if (!it->second.isResend)
+			{
+				uint32_t rtt = curTime - it->second.sendTime;
+				m_task->srtt = (m_task->srtt == 0) ? rtt : (m_task->srtt * 7 + rtt) / 8;
+			}
+
+			m_task->inflightSize -= it->second.size;
+			m_task->inflightMap.erase(it);
 		}
 	}
-	else
+
+	// ۼȷ
+	if (msg->begin > m_task->transmittedSize && msg->begin <= m_task->endPos)
 	{
-		printf("check fail\n");
+		m_task->transmittedSize = msg->begin;
+
+		while (!m_task->inflightMap.empty())
+		{
+			auto first = m_task->inflightMap.begin();
+			if (first->first + first->second.size > msg->begin)
+			{
+				break;
+			}
+			m_task->inflightSize -= first->second.size;
+			m_task->inflightMap.erase(first);
+		}
+
+		// ѱռʱƬ,Ϣ
+		if (m_task->slicesSize < FST_SLICES_MAX_SIZE && isWindowFull())
+		{
+			m_task->slicesSize = m_task->slicesSize * 2;
+			if (m_task->slicesSize > FST_SLICES_MAX_SIZE)
+			{
+				m_task->slicesSize = FST_SLICES_MAX_SIZE;
+			}
+			// 4Ƭ
+			if (m_task->slicesSize > m_windowBytes / 4 && m_windowBytes / 4 >= FST_SLICES_MIN_SIZE)
+			{
+				m_task->slicesSize = m_windowBytes / 4;
+			}
+		}
 	}
-	clearTask();
+	sendWindow();
 }
 
-void FSTransfer::sendFileData(uint32_t begin)
+bool FSTransfer::isWindowFull()
 {
-	m_task->transmittedSize = begin;
+	// СڷƬСʱٱ֤һƬڴ
+	if (m_task->inflightMap.empty())
+	{
+		return false;
+	}
+	return m_task->inflightSize + m_task->slicesSize > m_windowBytes || m_task->inflightMap.size() >= m_windowSlices;
+}
 
-	int32_t readSize = m_task->totalSize - begin;
-	assert(readSize >= 0);
-	if (readSize > FST_SLICES_SIZE)
+void FSTransfer::sendWindow()
+{
+	// ȴշĿǩڲҸ
+	if (m_task->waitSignatureCount > 0 || m_task->isDeltaPending)
 	{
-		readSize = FST_SLICES_SIZE;
+		return;
 	}
-	if (readSize <= 0)
+
+	// ɽշи,յȷ
+	m_task->transmittedSize = skipCopyRange(m_task->transmittedSize);
+
+	while (!isWindowFull())
 	{
-		fseek(m_task->fp, 0, SEEK_END);
-		uint32_t totalSize = ftell(m_task->fp);
+		uint64_t sendPos = skipCopyRange(m_task->sendPos);
+		if (sendPos != m_task->sendPos)
+		{
+			// 䲻,ͬУ
+			postFileCrc(m_task->sendPos, sendPos);
+			if (m_task == NULL)
+			{
+				return;
+			}
+			m_task->sendPos = sendPos;
+		}
+		if (m_task->sendPos >= m_task->endPos)
+		{
+			break;
+		}
 
-		FST_Check checkData;
-		checkData.size = totalSize;
+		// ̶ȡ
+		if (m_diskIO != NULL && m_diskIO->getPendingSize() >= FST_IO_MAX_PENDING_SIZE)
+		{
+			return;
+		}
 
-		uint32_t checkBlockSize = FST_constCheckBlockSize;
-		if (totalSize < checkBlockSize)
+		// ,ƲupdateFrameм
+		if (!m_bucket.isAllow())
 		{
-			checkBlockSize = totalSize;
+			return;
 		}
-		char szBuf[FST_constCheckBlockSize];
 
-		checkData.begin1 = 0;
-		checkData.size1 = checkBlockSize;
-		fseek(m_task->fp, checkData.begin1, SEEK_SET);
-		fread(szBuf, checkData.size1, 1, m_task->fp);
-		checkData.hash1 = net_uv::net_getBufHash(szBuf, checkData.size1);
+		uint64_t leftSize = m_task->endPos - m_task->sendPos;
+		// ƬԽ
+		auto next = m_task->copyRangeMap.upper_bound(m_task->sendPos);
+		if (next != m_task->copyRangeMap.end() && next->first - m_task->sendPos < leftSize)
+		{
+			leftSize = next->first - m_task->sendPos;
+		}
+		uint32_t readSize = m_task->slicesSize;
+		if (leftSize < readSize)
+		{
+			readSize = (uint32_t)leftSize;
+		}
 
-		checkData.begin2 = totalSize - checkBlockSize;
-		checkData.size2 = checkBlockSize;
-		fseek(m_task->fp, checkData.begin2, SEEK_SET);
-		fread(szBuf, checkData.size2, 1, m_task->fp);
-		checkData.hash2 = net_uv::net_getBufHash(szBuf, checkData.size2);
+		// ȡڼͬռô
+		FST_Slices& slices = m_task->inflightMap[m_task->sendPos];
+		slices.size = readSize;
+		slices.sendTime = FST_getTime();
+		slices.crc = 0;
+		slices.failCount = 0;
+		slices.isReading = true;
+		slices.isResend = false;
+		m_task->inflightSize += readSize;
+
+		uint64_t begin = m_task->sendPos;
+		m_task->sendPos += readSize;
+		m_bucket.consume(readSize);
+		m_transferBytes += readSize;
+		readSlices(begin, readSize, true);
+		if (m_task == NULL)
+		{
+			return;
+		}
+	}
 
-		FST_SEND(checkData);
+	// ȫȷУֵ
+	if (m_task->transmittedSize >= m_task->endPos && m_task->sendPos >= m_task->endPos && m_task->pendingIO == 0)
+	{
+		sendCheck();
+	}
+}
+
+void FSTransfer::readSlices(uint64_t begin, uint32_t size, bool isNew)
+{
+	FILE* fp = m_task->fp;
+	std::shared_ptr<FST_BatchStream> batch = m_task->batch;
+	auto buf = std::make_shared<std::vector<char>>(sizeof(FST_TransferSlices) + size);
+	auto result = std::make_shared<FST_IOResult>();
+	auto postTime = std::chrono::steady_clock::now();
+	postIO(size, [=]()
+	{
+		char* data = buf->data() + sizeof(FST_TransferSlices);
+		if (batch)
+		{
+			result->isSuccess = batch->read(begin, data, size);
+		}
+		else
+		{
+			fst_fseek(fp, begin, SEEK_SET);
+			result->isSuccess = (fread(data, size, 1, fp) == 1);
+		}
+		result->crc = result->isSuccess ? net_uv::net_crc32c(0, data, size) : 0;
+	}, [=]()
+	{
+		FST_updateDiskTime(m_task->diskReadTime, postTime);
+		onReadSlices(begin, size, isNew, *buf, *result);
+	});
+}
+
+void FSTransfer::onReadSlices(uint64_t begin, uint32_t size, bool isNew, std::vector<char>& buf, const FST_IOResult& result)
+{
+	if (!result.isSuccess)
+	{
+		printf("read file: %s fail\n", m_filename.c_str());
 		clearTask();
 		return;
 	}
-	fseek(m_task->fp, begin, SEEK_SET);
-	fread(m_readBuf, readSize, 1, m_task->fp);
 
-	uint32_t datalen = sizeof(FST_TransferSlices) + readSize;
-	char* pData = new char[datalen];
+	// ·Ƭȡ˳У
+	if (isNew)
+	{
+		m_task->crc = net_uv::net_crc32cCombine(m_task->crc, result.crc, size);
+	}
 
-	FST_TransferSlices* transferData = (FST_TransferSlices*)pData;
-	new (transferData) FST_TransferSlices();
+	// ȡڼƬѱȷ
+	auto it = m_task->inflightMap.find(begin);
+	if (it == m_task->inflightMap.end() || it->second.size != size)
+	{
+		return;
+	}
+	if (isNew)
+	{
+		it->second.crc = m_task->isSliceCheck ? result.crc : 0;
+		it->second.isReading = false;
+	}
+	it->second.sendTime = FST_getTime();
+
+	FST_TransferSlices* transferData = new (buf.data()) FST_TransferSlices();
 	transferData->begin = begin;
-	transferData->size = readSize;
-	memcpy(&transferData[1], m_readBuf, readSize);
+	transferData->size = size;
+	transferData->crc = it->second.crc;
+
+	// ͵ݼΪУֵ,ɴ¶ȡļ
+	FST_SEND_SIZE(buf.data(), buf.size());
+}
+
+bool FSTransfer::sendSlices(uint64_t begin, uint32_t size)
+{
+	// طͬڴ߳жȡ,ʱʹ÷Ƭ¼Уֵ
+	readSlices(begin, size, false);
+	return m_task != NULL;
+}
+
+void FSTransfer::checkResend()
+{
+	// ȡʧʱ,ڼ䱣
+	std::shared_ptr<FST_Task> task = m_task;
+
+	uint32_t curTime = FST_getTime();
+	uint32_t resendTime = FST_RESEND_TIME;
+	if (task->srtt * 4 > resendTime)
+	{
+		resendTime = task->srtt * 4;
+	}
 
-	FST_SEND_SIZE(pData, datalen);
-	delete[]pData;
+	bool isResend = false;
+	for (auto& it : task->inflightMap)
+	{
+		if (!it.second.isReading && curTime - it.second.sendTime >= resendTime)
+		{
+			if (!sendSlices(it.first, it.second.size))
+			{
+				return;
+			}
+			// طӰ,ͬ
+			m_bucket.consume(it.second.size);
+			m_transferBytes += it.second.size;
+			task->resendSlices++;
+			it.second.sendTime = curTime;
+			it.second.isResend = true;
+			isResend = true;
+		}
+	}
+
+	// ֳʱطʱ˵СƬ
+	if (isResend)
+	{
+		task->slicesSize = FST_SLICES_MIN_SIZE;
+	}
 }
 
-uint32_t FSTransfer::getFileSize(const char* name)
+void FSTransfer::sendCheck()
+{
+	uint64_t totalSize = m_task->fileSize;
+	if (m_task->fp)
+	{
+		fst_fseek(m_task->fp, 0, SEEK_END);
+		totalSize = fst_ftell(m_task->fp);
+	}
+
+	FST_Check checkData;
+	checkData.size = totalSize;
+	checkData.crc = m_task->crc;
+
+	// ȴշظУ
+	FST_SEND(checkData);
+	clearTask();
+}
+
+uint64_t FSTransfer::getFileSize(const char* name)
 {
 	FILE* fp = fopen(name, "rb");
 	if (fp == NULL)
 	{
 		return 0;
 	}
-	fseek(fp, 0, SEEK_END);
-	uint32_t fileSize = ftell(fp);
+	fst_fseek(fp, 0, SEEK_END);
+	uint64_t fileSize = fst_ftell(fp);
 	fclose(fp);
 	return fileSize;
 }
 
-void FSTransfer::recvFileData(uint32_t begin, char* data, uint32_t len)
+void FSTransfer::recvFileData(uint64_t begin, char* data, uint32_t len, uint32_t sliceCrc)
+{
+	if (m_task == NULL)
+	{
+		return;
+	}
+
+	m_transferBytes += len;
+
+	uint64_t end = begin + len;
+	if (len > 0 && begin >= m_task->beginPos && end > m_task->transmittedSize && end <= m_task->endPos)
+	{
+		// ڴ߳У鲢д,дɺٻظȷ,δдܷͷ
+		FILE* fp = m_task->fp;
+		std::shared_ptr<FST_BatchStream> batch = m_task->batch;
+		bool isSliceCheck = m_task->isSliceCheck;
+		auto buf = std::make_shared<std::vector<char>>(data, data + len);
+		auto result = std::make_shared<FST_IOResult>();
+		auto postTime = std::chrono::steady_clock::now();
+		postIO(len, [=]()
+		{
+			result->crc = net_uv::net_crc32c(0, buf->data(), len);
+			result->isSuccess = !(isSliceCheck && result->crc != sliceCrc);
+			if (result->isSuccess && batch)
+			{
+				result->isSuccess = batch->write(begin, buf->data(), len);
+			}
+			else if (result->isSuccess)
+			{
+				fst_fseek(fp, begin, SEEK_SET);
+				// дʧ()ʱȷϸ÷Ƭ,ҲУ
+				result->isSuccess = (fwrite(buf->data(), len, 1, fp) == 1);
+			}
+		}, [=]()
+		{
+			FST_updateDiskTime(m_task->diskWriteTime, postTime);
+			onWriteSlices(begin, *buf, *result);
+		});
+		return;
+	}
+
+	// ظķƬͬظ,ͷδյһεȷ
+	sendSlicesResult(begin, len, 0);
+}
+
+void FSTransfer::onWriteSlices(uint64_t begin, const std::vector<char>& buf, const FST_IOResult& result)
 {
-	if (len > 0)
+	uint32_t len = (uint32_t)buf.size();
+	uint64_t end = begin + len;
+	if (!result.isSuccess)
+	{
+		printf("slices %llu check fail\n", (unsigned long long)begin);
+	}
+	else if (begin >= m_task->transmittedSize)
 	{
-		fseek(m_task->fp, begin, SEEK_SET);
-		fwrite(data, len, 1, m_task->fp);
+		addRecvRange(begin, end, result.crc);
+	}
+	else if (end > m_task->transmittedSize)
+	{
+		// ֻδյĲ
+		uint32_t offset = (uint32_t)(m_task->transmittedSize - begin);
+		addRecvRange(m_task->transmittedSize, end, net_uv::net_crc32c(0, buf.data() + offset, len - offset));
 	}
-	m_task->transmittedSize = begin + len;
 
+	sendSlicesResult(begin, len, result.isSuccess ? 0 : FST_E_CHECK_FAIL);
+	checkPendingCheck();
+}
+
+void FSTransfer::sendSlicesResult(uint64_t begin, uint32_t len, uint32_t code)
+{
 	FST_TransferSlicesResult result;
 	result.begin = m_task->transmittedSize;
+	result.sackBegin = begin;
+	result.sackSize = len;
+	result.code = code;
 	FST_SEND(result);
 }
 
+void FSTransfer::checkPendingCheck()
+{
+	if (m_task == NULL || m_task->pendingIO > 0 || m_task->pendingCheck.empty())
+	{
+		return;
+	}
+	std::vector<char> data;
+	data.swap(m_task->pendingCheck);
+	on_Check(data.data(), (uint32_t)data.size());
+}
+
+void FSTransfer::addRecvRange(uint64_t begin, uint64_t end, uint32_t crc)
+{
+	if (end <= m_task->transmittedSize)
+	{
+		return;
+	}
+	if (begin > m_task->transmittedSize)
+	{
+		FST_RecvRange& range = m_task->recvRangeMap[begin];
+		if (range.end < end)
+		{
+			range.end = end;
+			range.crc = crc;
+		}
+		return;
+	}
+
+	appendRecvCrc(begin, end, crc);
+
+	// ϲ򵽴
+	auto& rangeMap = m_task->recvRangeMap;
+	while (!rangeMap.empty() && rangeMap.begin()->first <= m_task->transmittedSize)
+	{
+		auto first = rangeMap.begin();
+		if (first->second.end > m_task->transmittedSize)
+		{
+			appendRecvCrc(first->first, first->second.end, first->second.crc);
+		}
+		rangeMap.erase(first);
+	}
+}
+
+void FSTransfer::appendRecvCrc(uint64_t begin, uint64_t end, uint32_t crc)
+{
+	if (begin == m_task->transmittedSize)
+	{
+		m_task->crc = net_uv::net_crc32cCombine(m_task->crc, crc, end - begin);
+	}
+	else
+	{
+		// Ƭ߽ɷͷ,ص˵쳣,޷Уֵ
+		printf("file: %s recv range overlap\n", m_filename.c_str());
+		m_task->crc = ~m_task->crc;
+	}
+	m_task->transmittedSize = end;
+}
+
+void FSTransfer::finish(bool isSuccess)
+{
+	clearTask();
+	// ѽ,Ӻټ
+	m_duty = Duty::None;
+	if (m_finishCall)
+	{
+		m_finishCall(this, isSuccess);
+	}
+}
+
 void FSTransfer::clearTask()
 {
 	if (m_task)
 	{
-		fclose(m_task->fp);
+		// ļͷʱر
 		m_task = NULL;
 		printf("clearTask\n");
 	}
@@ -1,16 +1,54 @@
 #pragma once
 
 #include <inttypes.h>
+#include <stdio.h>
 #include <string>
 #include <map>
+#include <vector>
 #include <functional>
 #include <memory>
+#include "FSTRateLimit.h"
 
 class FSTransfer;
 
 using FST_Output = std::function<void(FSTransfer* fst, char* data, uint32_t len)>;
 
+// ,isSuccess:շУǷͨ
+using FST_FinishCall = std::function<void(FSTransfer* fst, bool isSuccess)>;
+
+// ͳ
+struct FST_Stats
+{
+	std::string name;
+	bool isSend;
+	// СɴС(ͷΪȷ,շΪ)
+	uint64_t totalSize;
+	uint64_t doneSize;
+	// һͳڵʼָȨƽ(ֽ/)
+	float instantSpeed;
+	float avgSpeed;
+	// ͷ:ѷδȷϵֽͷƬ
+	uint32_t inflightBytes;
+	uint32_t inflightSlices;
+	// ͷ:ƽʱ()
+	uint32_t srtt;
+	// ͷ:طķƬ
+	uint32_t resendSlices;
+	// ̶дӳ(,ύ),ָȨƽ
+	float diskReadTime;
+	float diskWriteTime;
+	// ѷ(ط)ѽյķƬ
+	uint64_t transferBytes;
+	// ǰ,0Ϊ
+	uint64_t rateLimit;
+};
+
 struct FST_Task;
+struct FST_IOResult;
+struct FST_BlockSignature;
+struct FST_DeltaCopy;
+struct FST_BatchFile;
+class FSTDiskIO;
 
 class FSTransfer
 {
@@ -20,9 +58,15 @@ public:
 
 	virtual ~FSTransfer();
 
-	int32_t postFile(const std::string& file);
+	// partIndex/partCount:ӲдʱӸ,ɷͷļС
+	int32_t postFile(const std::string& file, uint32_t partIndex = 0, uint32_t partCount = 1);
 
-	void downLoadFile(const std::string& file);
+	void downLoadFile(const std::string& file, uint32_t partIndex = 0, uint32_t partCount = 1);
+
+	// Ŀ¼µļ(Ŀ¼),շдͬĿ¼
+	int32_t postDir(const std::string& dir);
+
+	void downLoadDir(const std::string& dir);
 
 	void input(char* data, int32_t len);
 
@@ -30,6 +74,31 @@ public:
 	
 	inline void setOutput(FST_Output output);
 
+	inline void setFinishCallback(FST_FinishCall call);
+
+	// ÷ʹ:δȷϵֽƬ
+	inline void setWindow(uint32_t maxBytes, uint32_t maxSlices);
+
+	// ͬ:շͬļʱֻ仯,ʱط
+	inline void setDeltaSync(bool enable);
+
+	// ƬУ:ÿƬЯCRC32C,𻵵ķƬط,ʱط
+	// Ƿ,ʱУCRC32C
+	inline void setSliceCheck(bool enable);
+
+	// ô̶д߳,úļдڵִ߳
+	void setDiskIO(FSTDiskIO* diskIO);
+
+	// (ֽ/),0Ϊ,пʱ
+	// ͷֱƷƬķ,շ֪ͨͷʷ
+	void setRateLimit(uint64_t rate);
+
+	// ѷ(ط)ѽյķƬ
+	inline uint64_t getTransferBytes();
+
+	// ȡǰͳ,ûִеĴʱfalse
+	bool getStats(FST_Stats& outStats);
+
 	void updateFrame();
 
 protected:
@@ -38,18 +107,88 @@ protected:
 
 	void on_PostFileResult(void* data, uint32_t len);
 
+	void on_PostBatch(void* data, uint32_t len);
+
+	void on_BatchManifest(void* data, uint32_t len);
+
+	void sendBatchManifest(const std::vector<FST_BatchFile>& files);
+
 	void on_Check(void* data, uint32_t len);
 
-	uint32_t getFileSize(const char* name);
+	// շ:֪ͷ,isForce:δ仯ʱͬ
+	void sendRateLimit(bool isForce);
+
+	// ȡշҪнСһ
+	void updateRateLimit();
+
+	uint64_t getFileSize(const char* name);
+
+	void on_TransferSlicesResult(void* data, uint32_t len);
+
+	// շ:ļǩ,дʱļ
+	bool startDeltaRecv(const char* name, uint64_t fileSize, uint64_t baseSize);
+
+	void sendSignature(const std::vector<FST_BlockSignature>& signature);
+
+	void on_Signature(void* data, uint32_t len);
+
+	// ͷ:ǩ㸴䲢֪շ
+	void sendDelta(const std::vector<FST_DeltaCopy>& copyArr);
+
+	void on_Delta(void* data, uint32_t len);
+
+	// շɴӾļõ
+	uint64_t skipCopyRange(uint64_t pos);
+
+	// ڴΧڷͷƬ
+	void sendWindow();
+
+	// ȡƬ,isNew:·Ƭͬʱ봫У
+	void readSlices(uint64_t begin, uint32_t size, bool isNew);
+
+	void onReadSlices(uint64_t begin, uint32_t size, bool isNew, std::vector<char>& buf, const FST_IOResult& result);
+
+	// طƬ
+	bool sendSlices(uint64_t begin, uint32_t size);
+
+	bool isWindowFull();
 
-	void sendFileData(uint32_t begin);
+	void checkResend();
 
-	void recvFileData(uint32_t begin, char* data, uint32_t len);
+	void sendCheck();
+
+	void recvFileData(uint64_t begin, char* data, uint32_t len, uint32_t sliceCrc);
+
+	// Ƭд
+	void onWriteSlices(uint64_t begin, const std::vector<char>& buf, const FST_IOResult& result);
+
+	void sendSlicesResult(uint64_t begin, uint32_t len, uint32_t code);
+
+	// дȫɺУϢ
+	void checkPendingCheck();
+
+	void addRecvRange(uint64_t begin, uint64_t end, uint32_t crc);
+
+	// [begin, end)շУ
+	void appendRecvCrc(uint64_t begin, uint64_t end, uint32_t crc);
+
+	// ȡļ[begin, end)봫У
+	void postFileCrc(uint64_t begin, uint64_t end);
+
+	// ύ,workڴִ߳,doneupdateFrameִ,doneִ
+	void postIO(uint32_t memSize, const std::function<void()>& work, const std::function<void()>& done);
+
+	void createRecvTask(FILE* fp, uint64_t fileSize, uint64_t beginPos, uint64_t endPos, uint64_t recvSize);
+
+	void createSendTask(FILE* fp, uint64_t fileSize, uint64_t beginPos, uint64_t endPos, uint64_t recvSize);
+
+	void finish(bool isSuccess);
 
 	void clearTask();
 
 protected:
 	FST_Output m_output;
+	FST_FinishCall m_finishCall;
 
 	std::shared_ptr<FST_Task> m_task;
 
@@ -63,7 +202,32 @@ protected:
 	};
 	Duty m_duty;
 
-	char* m_readBuf;
+	uint32_t m_partIndex;
+	uint32_t m_partCount;
+	// ͷδ
+	uint64_t m_rangeBegin;
+	uint64_t m_rangeSize;
+
+	uint32_t m_windowBytes;
+	uint32_t m_windowSlices;
+
+	bool m_isDeltaSync;
+	bool m_isSliceCheck;
+	bool m_isBatch;
+
+	FSTDiskIO* m_diskIO;
+	uint32_t m_ioChannel;
+	// ʱжϴǷ
+	std::shared_ptr<FSTransfer*> m_self;
+
+	/// 
+	uint64_t m_rateLimit;
+	// շҪ
+	uint64_t m_remoteRateLimit;
+	// շ:һθ֪ͷ
+	uint64_t m_sentRateLimit;
+	FSTTokenBucket m_bucket;
+	uint64_t m_transferBytes;
 };
 
 void FSTransfer::setOutput(FST_Output output)
@@ -71,3 +235,29 @@ void FSTransfer::setOutput(FST_Output output)
 	m_output = output;
 }
 
+void FSTransfer::setFinishCallback(FST_FinishCall call)
+{
+	m_finishCall = call;
+}
+
+void FSTransfer::setWindow(uint32_t maxBytes, uint32_t maxSlices)
+{
+	m_windowBytes = maxBytes;
+	m_windowSlices = maxSlices;
+}
+
+void FSTransfer::setDeltaSync(bool enable)
+{
+	m_isDeltaSync = enable;
+}
+
+void FSTransfer::setSliceCheck(bool enable)
+{
+	m_isSliceCheck = enable;
+}
+
+uint64_t FSTransfer::getTransferBytes()
+{
+	return m_transferBytes;
+}
+
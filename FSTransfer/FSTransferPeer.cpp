@@ -0,0 +1,202 @@
+#include "FSTransferPeer.h"
+
+NS_NET_UV_OPEN
+
+FSTransferPeer::FSTransferPeer(P2PPeer* peer)
+	: m_peer(peer)
+	, m_diskIO(FST_PEER_IO_THREAD_COUNT)
+	, m_finishCall(nullptr)
+	, m_isDeltaSync(false)
+	, m_isSliceCheck(false)
+{
+	KCPProfile profile = KCP_PROFILE_BULK;
+	m_peer->setStreamConfig(FST_PEER_REQUEST_STREAM, P2P_STREAM_RELIABLE, FST_PEER_STREAM_PRIORITY);
+	m_peer->setStreamConfig(FST_PEER_RESPONSE_STREAM, P2P_STREAM_RELIABLE, FST_PEER_STREAM_PRIORITY);
+	m_peer->setStreamKcpProfile(FST_PEER_REQUEST_STREAM, profile);
+	m_peer->setStreamKcpProfile(FST_PEER_RESPONSE_STREAM, profile);
+}
+
+FSTransferPeer::~FSTransferPeer()
+{}
+
+void FSTransferPeer::upload(uint64_t key, const char* filename)
+{
+	addTask(key, filename, false, false);
+}
+
+void FSTransferPeer::download(uint64_t key, const char* filename)
+{
+	addTask(key, filename, true, false);
+}
+
+void FSTransferPeer::uploadDir(uint64_t key, const char* dirname)
+{
+	addTask(key, dirname, false, true);
+}
+
+void FSTransferPeer::downloadDir(uint64_t key, const char* dirname)
+{
+	addTask(key, dirname, true, true);
+}
+
+void FSTransferPeer::addTask(uint64_t key, const char* name, bool isdownload, bool isBatch)
+{
+	if (strlen(name) <= 0)
+		return;
+
+	TaskInfo task;
+	task.name = name;
+	task.isdownload = isdownload;
+	task.isBatch = isBatch;
+
+	PeerInfo& info = m_peerMap[key];
+	info.waitTask.push_back(task);
+	executeTask(key, info);
+}
+
+void FSTransferPeer::executeTask(uint64_t key, PeerInfo& info)
+{
+	if (info.request != NULL || info.waitTask.empty())
+	{
+		return;
+	}
+
+	info.task = info.waitTask.front();
+	info.waitTask.pop_front();
+	info.isFinish = false;
+
+	// ÿʹµFSTransfer,һ״̬Ӱ
+	info.request = createTransfer(key, FST_PEER_REQUEST_STREAM);
+	info.request->setDeltaSync(m_isDeltaSync);
+	info.request->setSliceCheck(m_isSliceCheck);
+	info.request->setFinishCallback([=](FSTransfer*, bool isSuccess)
+	{
+		onTransferFinish(key, isSuccess);
+	});
+
+	const TaskInfo& task = info.task;
+	if (task.isBatch)
+	{
+		if (task.isdownload)
+		{
+			info.request->downLoadDir(task.name);
+		}
+		else if (info.request->postDir(task.name) != 0)
+		{
+			onTransferFinish(key, false);
+		}
+	}
+	else if (task.isdownload)
+	{
+		info.request->downLoadFile(task.name);
+	}
+	else if (info.request->postFile(task.name) != 0)
+	{
+		onTransferFinish(key, false);
+	}
+}
+
+std::shared_ptr<FSTransfer> FSTransferPeer::createTransfer(uint64_t key, uint32_t streamID)
+{
+	std::shared_ptr<FSTransfer> transfer = std::make_shared<FSTransfer>();
+	transfer->setDiskIO(&m_diskIO);
+	transfer->setOutput([=](FSTransfer*, char* data, uint32_t len)
+	{
+		m_peer->send(key, streamID, data, len);
+	});
+	return transfer;
+}
+
+bool FSTransferPeer::input(uint64_t key, uint32_t streamID, char* data, uint32_t len)
+{
+	if (streamID == FST_PEER_REQUEST_STREAM)
+	{
+		// ԷĴ,ظɻظ
+		PeerInfo& info = m_peerMap[key];
+		if (info.response == NULL)
+		{
+			info.response = createTransfer(key, FST_PEER_RESPONSE_STREAM);
+		}
+		info.response->input(data, len);
+		return true;
+	}
+	if (streamID == FST_PEER_RESPONSE_STREAM)
+	{
+		auto it = m_peerMap.find(key);
+		if (it != m_peerMap.end() && it->second.request && !it->second.isFinish)
+		{
+			it->second.request->input(data, len);
+		}
+		return true;
+	}
+	return false;
+}
+
+void FSTransferPeer::disconnect(uint64_t key)
+{
+	auto it = m_peerMap.find(key);
+	if (it == m_peerMap.end())
+	{
+		return;
+	}
+
+	std::vector<TaskInfo> failTask;
+	if (it->second.request && !it->second.isFinish)
+	{
+		failTask.push_back(it->second.task);
+	}
+	failTask.insert(failTask.end(), it->second.waitTask.begin(), it->second.waitTask.end());
+	m_peerMap.erase(it);
+
+	if (m_finishCall)
+	{
+		for (auto& task : failTask)
+		{
+			m_finishCall(key, task.name, task.isdownload, false);
+		}
+	}
+}
+
+void FSTransferPeer::onTransferFinish(uint64_t key, bool isSuccess)
+{
+	auto it = m_peerMap.find(key);
+	if (it == m_peerMap.end() || it->second.isFinish)
+	{
+		return;
+	}
+	// ڻص޷ͷִеFSTransfer,updateFrameƳ
+	it->second.isFinish = true;
+
+	if (m_finishCall)
+	{
+		m_finishCall(key, it->second.task.name, it->second.task.isdownload, isSuccess);
+	}
+}
+
+void FSTransferPeer::updateFrame()
+{
+	// ƳѽĴ,ʼһ
+	for (auto& it : m_peerMap)
+	{
+		if (it.second.request && it.second.isFinish)
+		{
+			it.second.request = NULL;
+			executeTask(it.first, it.second);
+		}
+	}
+
+	// ̶дɻص
+	m_diskIO.updateFrame();
+
+	for (auto& it : m_peerMap)
+	{
+		if (it.second.request)
+		{
+			it.second.request->updateFrame();
+		}
+		if (it.second.response)
+		{
+			it.second.response->updateFrame();
+		}
+	}
+}
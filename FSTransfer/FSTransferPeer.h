@@ -0,0 +1,123 @@
+#pragma once
+
+#include "net_uv/net_uv.h"
+#include "FSTransfer.h"
+#include "FSTDiskIO.h"
+#include <memory>
+#include <deque>
+
+// Եļ
+// ͨP2PPeerɿ,Ҫת:
+// طĴ,ԷĻظɻظ;ԷĴ෴
+// ʹKCP_PROFILE_BULKͽϵ͵ȼ,ӰʵʱϢ
+// ˫IDһ
+
+// 
+#define FST_PEER_REQUEST_STREAM 6
+// ظ
+#define FST_PEER_RESPONSE_STREAM 7
+// ȼ(ֵԽСȼԽ)
+#define FST_PEER_STREAM_PRIORITY 200
+
+// ̶д߳
+#define FST_PEER_IO_THREAD_COUNT 1
+
+// ļ
+using FSTPeerFinishCall = std::function<void(uint64_t key, const std::string& name, bool isDownload, bool isSuccess)>;
+
+class FSTransferPeer
+{
+public:
+
+	// peerɵ÷ºͷ,peer֮ǰ
+	FSTransferPeer(net_uv::P2PPeer* peer);
+
+	FSTransferPeer(const FSTransferPeer&) = delete;
+
+	~FSTransferPeer();
+
+	// ͬһڵĴ䰴˳ִ,ýڵ㽨
+	void upload(uint64_t key, const char* filename);
+
+	void download(uint64_t key, const char* filename);
+
+	void uploadDir(uint64_t key, const char* dirname);
+
+	void downloadDir(uint64_t key, const char* dirname);
+
+	// P2PPeerջصе,falseʾļ
+	bool input(uint64_t key, uint32_t streamID, char* data, uint32_t len);
+
+	// P2PPeerĶϿصе,ýڵδɵĴʧ
+	void disconnect(uint64_t key);
+
+	inline void setFinishCallback(const FSTPeerFinishCall& call);
+
+	// ͬ:Էͬļʱֻ仯
+	inline void setDeltaSync(bool enable);
+
+	// ƬУ:ÿƬЯCRC32C,𻵵ķƬط
+	inline void setSliceCheck(bool enable);
+
+	void updateFrame();
+
+protected:
+
+	struct TaskInfo
+	{
+		std::string name;
+		bool isdownload;
+		bool isBatch;
+	};
+
+	struct PeerInfo
+	{
+		PeerInfo()
+		{
+			isFinish = false;
+		}
+		// طĴ
+		std::shared_ptr<FSTransfer> request;
+		TaskInfo task;
+		bool isFinish;
+		std::deque<TaskInfo> waitTask;
+
+		// ԷĴ
+		std::shared_ptr<FSTransfer> response;
+	};
+
+	void addTask(uint64_t key, const char* name, bool isdownload, bool isBatch);
+
+	void executeTask(uint64_t key, PeerInfo& info);
+
+	void onTransferFinish(uint64_t key, bool isSuccess);
+
+	std::shared_ptr<FSTransfer> createTransfer(uint64_t key, uint32_t streamID);
+
+protected:
+	net_uv::P2PPeer* m_peer;
+
+	FSTDiskIO m_diskIO;
+
+	std::map<uint64_t, PeerInfo> m_peerMap;
+
+	FSTPeerFinishCall m_finishCall;
+
+	bool m_isDeltaSync;
+	bool m_isSliceCheck;
+};
+
+void FSTransferPeer::setFinishCallback(const FSTPeerFinishCall& call)
+{
+	m_finishCall = call;
+}
+
+void FSTransferPeer::setDeltaSync(bool enable)
+{
+	m_isDeltaSync = enable;
+}
+
+void FSTransferPeer::setSliceCheck(bool enable)
+{
+	m_isSliceCheck = enable;
+}
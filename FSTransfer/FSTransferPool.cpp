@@ -1,25 +1,66 @@
 #include "FSTransferPool.h"
 
 #include "uv.h"
+#include <algorithm>
 
 NS_NET_UV_OPEN
 
-FSTransferPool::FSTransferPool()
-	: m_netClient(NULL)
+FSTransferPool::FSTransferPool(FSTPoolTransport transport)
+	: m_diskIO(FST_POOL_IO_THREAD_COUNT)
+	, m_transport(transport)
+	, m_netClient(NULL)
 	, m_netServer(NULL)
 	, m_stopListenCall(NULL)
 	, m_closeClientCall(nullptr)
+	, m_finishCall(nullptr)
+	, m_isDeltaSync(false)
+	, m_isSliceCheck(false)
+	, m_rateLimit(0)
+	, m_isRateDirty(false)
+	, m_statsCall(nullptr)
+	, m_statsInterval(0)
 	, m_sessionIDSpawn(0)
+	, m_groupIDSpawn(0)
 {}
 
 FSTransferPool::~FSTransferPool()
 {}
 
+std::shared_ptr<Client> FSTransferPool::createClient()
+{
+	switch (m_transport)
+	{
+	case FST_TRANSPORT_KCP:
+	{
+		std::shared_ptr<KCPClient> client = std::make_shared<KCPClient>();
+		client->setKcpProfile(KCP_PROFILE_BULK);
+		return client;
+	}
+	default:
+		return std::make_shared<TCPClient>();
+	}
+}
+
+std::shared_ptr<Server> FSTransferPool::createServer()
+{
+	switch (m_transport)
+	{
+	case FST_TRANSPORT_KCP:
+	{
+		std::shared_ptr<KCPServer> server = std::make_shared<KCPServer>();
+		server->setKcpProfile(KCP_PROFILE_BULK);
+		return server;
+	}
+	default:
+		return std::make_shared<TCPServer>();
+	}
+}
+
 bool FSTransferPool::listen(const char* ip, uint32_t port, bool isIPV6)
 {
 	if (m_netServer == NULL)
 	{
-		m_netServer = std::make_shared<FS_Server>();
+		m_netServer = createServer();
 
 		m_netServer->setCloseCallback([=](Server* svr)
 		{
@@ -34,18 +75,28 @@ bool FSTransferPool::listen(const char* ip, uint32_t port, bool isIPV6)
 		{
 			if (m_listenTransferMap.find(session) == m_listenTransferMap.end())
 			{
-				std::shared_ptr<FSTransfer> transfer = std::make_shared<FSTransfer>();
+				ListenTransferInfo info;
+				info.transfer = std::make_shared<FSTransfer>();
+				info.lastBytes = 0;
+				info.share.priority = FST_PRIORITY_NORMAL;
+				info.share.weight = 1;
+				info.share.limit = 0;
+				info.share.rate = 0;
+
+				std::shared_ptr<FSTransfer> transfer = info.transfer;
+				transfer->setDiskIO(&m_diskIO);
 				transfer->setOutput([=](FSTransfer* fst, char* data, uint32_t len) 
 				{
 					session->send(data, len);
 				});
-				m_listenTransferMap.insert(std::make_pair(session, transfer));
+				m_listenTransferMap.insert(std::make_pair(session, info));
+				m_isRateDirty = true;
 			}
 		});
 
 		m_netServer->setRecvCallback([=](Server* svr, Session* session, char* data, uint32_t len)
 		{
-			m_listenTransferMap[session]->input(data, len);
+			m_listenTransferMap[session].transfer->input(data, len);
 		});
 
 		m_netServer->setDisconnectCallback([=](Server* svr, Session* session)
@@ -68,34 +119,158 @@ bool FSTransferPool::isListen()
 	return !m_netServer->isCloseFinish();
 }
 
-void FSTransferPool::upload(const char* ip, uint32_t port, const char* filename)
+uint32_t FSTransferPool::upload(const char* ip, uint32_t port, const char* filename, uint32_t connectCount, FSTPriority priority)
+{
+	return addTask(ip, port, filename, false, connectCount, priority);
+}
+
+uint32_t FSTransferPool::download(const char* ip, uint32_t port, const char* filename, uint32_t connectCount, FSTPriority priority)
+{
+	return addTask(ip, port, filename, true, connectCount, priority);
+}
+
+uint32_t FSTransferPool::uploadDir(const char* ip, uint32_t port, const char* dirname, FSTPriority priority)
+{
+	return addTask(ip, port, dirname, false, 1, priority, true);
+}
+
+uint32_t FSTransferPool::downloadDir(const char* ip, uint32_t port, const char* dirname, FSTPriority priority)
+{
+	return addTask(ip, port, dirname, true, 1, priority, true);
+}
+
+void FSTransferPool::setRateLimit(uint64_t rate)
+{
+	m_rateLimit = rate;
+	m_isRateDirty = true;
+}
+
+void FSTransferPool::setTaskRateLimit(uint32_t taskID, uint64_t rate)
+{
+	auto it = m_allTaskGroupMap.find(taskID);
+	if (it != m_allTaskGroupMap.end())
+	{
+		it->second.rateLimit = rate;
+		m_isRateDirty = true;
+	}
+}
+
+void FSTransferPool::setTaskPriority(uint32_t taskID, FSTPriority priority, uint32_t weight)
+{
+	auto it = m_allTaskGroupMap.find(taskID);
+	if (it != m_allTaskGroupMap.end())
+	{
+		it->second.share.priority = priority;
+		it->second.share.weight = weight;
+		m_isRateDirty = true;
+	}
+}
+
+uint32_t FSTransferPool::addTask(const char* ip, uint32_t port, const char* filename, bool isdownload, uint32_t connectCount, FSTPriority priority, bool isBatch)
 {
 	if (strlen(ip) <= 0 || strlen(filename) <= 0)
-		return;
+		return 0;
 
-	TaskInfo task;
-	task.ip = ip;
-	task.port = port;
-	task.isdownload = false;
-	task.name = filename;
-	m_allWaitTaskInfo.emplace_back(task);
+	if (connectCount < 1)
+	{
+		connectCount = 1;
+	}
+	if (connectCount > FST_POOL_MAX_CONNECT)
+	{
+		connectCount = FST_POOL_MAX_CONNECT;
+	}
+
+	m_groupIDSpawn++;
+
+	TaskGroup group;
+	group.name = filename;
+	group.isdownload = isdownload;
+	group.partCount = connectCount;
+	group.finishCount = 0;
+	group.isSuccess = true;
+	group.rateLimit = 0;
+	group.share.priority = priority;
+	group.share.weight = 1;
+	group.share.limit = 0;
+	group.share.rate = 0;
+	m_allTaskGroupMap[m_groupIDSpawn] = group;
+
+	// ÿӸļһ
+	for (uint32_t i = 0; i < connectCount; ++i)
+	{
+		TaskInfo task;
+		task.ip = ip;
+		task.port = port;
+		task.isdownload = isdownload;
+		task.name = filename;
+		task.groupID = m_groupIDSpawn;
+		task.partIndex = i;
+		task.partCount = connectCount;
+		task.isBatch = isBatch;
+		m_allWaitTaskInfo.emplace_back(task);
+	}
 
+	uint32_t taskID = m_groupIDSpawn;
 	executeTask();
+	return taskID;
 }
 
-void FSTransferPool::download(const char* ip, uint32_t port, const char* filename)
+void FSTransferPool::onTransferFinish(uint32_t sessionID, bool isSuccess)
 {
-	if (strlen(ip) <= 0 || strlen(filename) <= 0)
+	auto it = m_allExecuteTransferMap.find(sessionID);
+	if (it == m_allExecuteTransferMap.end() || it->second.isFinish)
+	{
+		return;
+	}
+	// ڻص޷ͷִеFSTransfer,updateFrameƳ
+	it->second.isFinish = true;
+
+	auto groupIt = m_allTaskGroupMap.find(it->second.task.groupID);
+	if (groupIt == m_allTaskGroupMap.end())
+	{
 		return;
+	}
+	TaskGroup& group = groupIt->second;
+	group.finishCount++;
+	group.isSuccess = group.isSuccess && isSuccess;
 
-	TaskInfo task;
-	task.ip = ip;
-	task.port = port;
-	task.isdownload = true;
-	task.name = filename;
-	m_allWaitTaskInfo.emplace_back(task);
+	if (group.finishCount >= group.partCount)
+	{
+		std::string name = group.name;
+		bool isdownload = group.isdownload;
+		bool isGroupSuccess = group.isSuccess;
+		m_allTaskGroupMap.erase(groupIt);
 
-	executeTask();
+		if (m_finishCall)
+		{
+			m_finishCall(name, isdownload, isGroupSuccess);
+		}
+	}
+}
+
+void FSTransferPool::removeFinishTransfer()
+{
+	bool isRemove = false;
+	for (auto it = m_allExecuteTransferMap.begin(); it != m_allExecuteTransferMap.end(); )
+	{
+		if (it->second.isFinish)
+		{
+			if (m_netClient)
+			{
+				m_netClient->removeSession(it->first);
+			}
+			it = m_allExecuteTransferMap.erase(it);
+			isRemove = true;
+		}
+		else
+		{
+			++it;
+		}
+	}
+	if (isRemove)
+	{
+		executeTask();
+	}
 }
 
 void FSTransferPool::close(const std::function<void()>& call)
@@ -106,6 +281,25 @@ void FSTransferPool::close(const std::function<void()>& call)
 
 void FSTransferPool::updateFrame()
 {
+	removeFinishTransfer();
+
+	scheduleRate();
+
+	if (m_statsCall != nullptr)
+	{
+		auto curTime = std::chrono::steady_clock::now();
+		if (std::chrono::duration_cast<std::chrono::milliseconds>(curTime - m_lastStatsTime).count() >= m_statsInterval)
+		{
+			m_lastStatsTime = curTime;
+			std::vector<FSTPoolTaskStats> statsArr;
+			getTaskStats(statsArr);
+			m_statsCall(statsArr);
+		}
+	}
+
+	// ̶дɻص
+	m_diskIO.updateFrame();
+
 	for (auto &it : m_allExecuteTransferMap)
 	{
 		if (it.second.transfer)
@@ -115,7 +309,7 @@ void FSTransferPool::updateFrame()
 	}
 	for (auto& it : m_listenTransferMap)
 	{
-		it.second->updateFrame();
+		it.second.transfer->updateFrame();
 	}
 	if (m_netClient)
 	{
@@ -129,37 +323,220 @@ void FSTransferPool::updateFrame()
 
 void FSTransferPool::executeTask()
 {
-	if (m_allWaitTaskInfo.empty())
-		return;
+	while (!m_allWaitTaskInfo.empty() && m_allExecuteTransferMap.size() < FST_POOL_MAX_CONNECT)
+	{
+		checkNetClient();
+
+		// ִиȼ,ͬһȼ˳ִ
+		auto getPriority = [=](const TaskInfo& task)
+		{
+			auto it = m_allTaskGroupMap.find(task.groupID);
+			return it == m_allTaskGroupMap.end() ? (uint32_t)FST_PRIORITY_NORMAL : it->second.share.priority;
+		};
+		auto taskIt = m_allWaitTaskInfo.begin();
+		for (auto it = m_allWaitTaskInfo.begin() + 1; it != m_allWaitTaskInfo.end(); ++it)
+		{
+			if (getPriority(*it) < getPriority(*taskIt))
+			{
+				taskIt = it;
+			}
+		}
+
+		TaskInfo task = *taskIt;
+		m_allWaitTaskInfo.erase(taskIt);
+		m_sessionIDSpawn++;
+
+		ConnectTransferInfo info;
+		info.task = task;
+		info.transfer = NULL;
+		info.isFinish = false;
+		info.lastBytes = 0;
+		m_allExecuteTransferMap[m_sessionIDSpawn] = info;
+		m_isRateDirty = true;
+
+		m_netClient->connect(task.ip.c_str(), task.port, m_sessionIDSpawn);
+	}
+}
+
+// ۼͬһһӵͳ
+static void FST_mergeStats(FST_Stats& stats, const FST_Stats& other)
+{
+	stats.totalSize += other.totalSize;
+	stats.doneSize += other.doneSize;
+	stats.instantSpeed += other.instantSpeed;
+	stats.avgSpeed += other.avgSpeed;
+	stats.inflightBytes += other.inflightBytes;
+	stats.inflightSlices += other.inflightSlices;
+	stats.srtt = std::max(stats.srtt, other.srtt);
+	stats.resendSlices += other.resendSlices;
+	stats.diskReadTime = std::max(stats.diskReadTime, other.diskReadTime);
+	stats.diskWriteTime = std::max(stats.diskWriteTime, other.diskWriteTime);
+	stats.transferBytes += other.transferBytes;
+	stats.rateLimit += other.rateLimit;
+}
+
+void FSTransferPool::getTaskStats(std::vector<FSTPoolTaskStats>& outStatsArr)
+{
+	outStatsArr.clear();
+
+	std::map<uint32_t, size_t> groupIndexMap;
+	for (auto& it : m_allExecuteTransferMap)
+	{
+		FST_Stats stats;
+		if (it.second.transfer == NULL || it.second.isFinish || !it.second.transfer->getStats(stats))
+		{
+			continue;
+		}
+		auto indexIt = groupIndexMap.find(it.second.task.groupID);
+		if (indexIt != groupIndexMap.end())
+		{
+			FSTPoolTaskStats& taskStats = outStatsArr[indexIt->second];
+			taskStats.connectCount++;
+			FST_mergeStats(taskStats.stats, stats);
+			continue;
+		}
+		groupIndexMap[it.second.task.groupID] = outStatsArr.size();
+
+		FSTPoolTaskStats taskStats;
+		taskStats.taskID = it.second.task.groupID;
+		taskStats.isdownload = it.second.task.isdownload;
+		taskStats.connectCount = 1;
+		taskStats.stats = stats;
+		// ͳΪĿ¼
+		taskStats.stats.name = it.second.task.name;
+		outStatsArr.push_back(taskStats);
+	}
+
+	for (auto& it : m_listenTransferMap)
+	{
+		FSTPoolTaskStats taskStats;
+		if (!it.second.transfer->getStats(taskStats.stats))
+		{
+			continue;
+		}
+		taskStats.taskID = 0;
+		taskStats.isdownload = !taskStats.stats.isSend;
+		taskStats.connectCount = 1;
+		outStatsArr.push_back(taskStats);
+	}
+}
+
+// ϸڵʹ
+static uint64_t FST_estimateDemand(const FST_RateShare& share, uint64_t measureRate)
+{
+	// δĴʱȷ,빫ƽ
+	if (share.rate == 0 || measureRate * 10 >= share.rate * 9)
+	{
+		return UINT64_MAX;
+	}
+	uint64_t demand = measureRate + measureRate / 4;
+	return demand < FST_POOL_RATE_MIN ? FST_POOL_RATE_MIN : demand;
+}
 
-	if (m_allExecuteTransferMap.size() >= 8)
+void FSTransferPool::scheduleRate()
+{
+	auto curTime = std::chrono::steady_clock::now();
+	int64_t ms = std::chrono::duration_cast<std::chrono::milliseconds>(curTime - m_lastScheduleTime).count();
+	if (!m_isRateDirty && ms < FST_POOL_RATE_INTERVAL)
 	{
 		return;
 	}
-	checkNetClient();
+	m_lastScheduleTime = curTime;
+	m_isRateDirty = false;
+	if (ms <= 0)
+	{
+		ms = 1;
+	}
 
-	TaskInfo task = m_allWaitTaskInfo.back();
-	m_allWaitTaskInfo.pop_back();
-	m_sessionIDSpawn++;
+	// ͳƸڵĴ,Ϊ֮
+	std::map<uint32_t, uint64_t> groupBytesMap;
+	std::map<uint32_t, uint32_t> groupConnectMap;
+	for (auto& it : m_allExecuteTransferMap)
+	{
+		if (it.second.transfer == NULL || it.second.isFinish)
+		{
+			continue;
+		}
+		uint64_t bytes = it.second.transfer->getTransferBytes();
+		groupBytesMap[it.second.task.groupID] += bytes - it.second.lastBytes;
+		groupConnectMap[it.second.task.groupID]++;
+		it.second.lastBytes = bytes;
+	}
+
+	std::vector<FST_RateShare*> shareArr;
+	for (auto& it : m_allTaskGroupMap)
+	{
+		FST_RateShare& share = it.second.share;
+		share.limit = it.second.rateLimit;
+		if (groupConnectMap.find(it.first) == groupConnectMap.end())
+		{
+			share.rate = 0;
+			continue;
+		}
+		if (m_rateLimit == 0)
+		{
+			share.rate = 0;
+			continue;
+		}
+		share.demand = FST_estimateDemand(share, groupBytesMap[it.first] * 1000 / ms);
+		shareArr.push_back(&share);
+	}
+	for (auto& it : m_listenTransferMap)
+	{
+		uint64_t bytes = it.second.transfer->getTransferBytes();
+		uint64_t measureRate = (bytes - it.second.lastBytes) * 1000 / ms;
+		it.second.lastBytes = bytes;
+		if (m_rateLimit == 0)
+		{
+			it.second.share.rate = 0;
+			continue;
+		}
+		it.second.share.demand = FST_estimateDemand(it.second.share, measureRate);
+		shareArr.push_back(&it.second.share);
+	}
 
-	ConnectTransferInfo info;
-	info.task = task;
-	info.transfer = NULL;
-	m_allExecuteTransferMap[m_sessionIDSpawn] = info;
+	if (m_rateLimit > 0)
+	{
+		FST_shareRate(m_rateLimit, FST_POOL_RATE_MIN, shareArr);
+	}
 
-	m_netClient->connect(task.ip.c_str(), task.port, m_sessionIDSpawn);
+	// ƽָ
+	for (auto& it : m_allExecuteTransferMap)
+	{
+		if (it.second.transfer == NULL || it.second.isFinish)
+		{
+			continue;
+		}
+		auto groupIt = m_allTaskGroupMap.find(it.second.task.groupID);
+		if (groupIt == m_allTaskGroupMap.end())
+		{
+			continue;
+		}
+		uint64_t rate = m_rateLimit > 0 ? groupIt->second.share.rate : groupIt->second.rateLimit;
+		uint32_t connectCount = groupConnectMap[it.second.task.groupID];
+		if (rate > 0 && connectCount > 1)
+		{
+			rate = std::max(rate / connectCount, (uint64_t)1);
+		}
+		it.second.transfer->setRateLimit(rate);
+	}
+	for (auto& it : m_listenTransferMap)
+	{
+		it.second.transfer->setRateLimit(it.second.share.rate);
+	}
 }
 
 void FSTransferPool::checkNetClient()
 {
 	if (m_netClient == NULL)
 	{
-		m_netClient = std::make_shared<FS_Client>();
+		m_netClient = createClient();
 
 		m_netClient->setClientCloseCallback([=](Client*)
 		{
 			m_netClient = NULL;
 			m_allExecuteTransferMap.clear();
+			m_allTaskGroupMap.clear();
 			if (m_closeClientCall)
 			{
 				m_closeClientCall();
@@ -174,17 +551,38 @@ void FSTransferPool::checkNetClient()
 				if (it->second.transfer == NULL)
 				{
 					it->second.transfer = std::make_shared<FSTransfer>();
+					it->second.transfer->setDiskIO(&m_diskIO);
 					it->second.transfer->setOutput([=](FSTransfer* fst, char* data, uint32_t len)
 					{
 						session->send(data, len);
 					});
-					if (it->second.task.isdownload)
+					it->second.transfer->setDeltaSync(m_isDeltaSync);
+					it->second.transfer->setSliceCheck(m_isSliceCheck);
+					m_isRateDirty = true;
+					uint32_t sessionID = session->getSessionID();
+					it->second.transfer->setFinishCallback([=](FSTransfer* fst, bool isSuccess)
 					{
-						it->second.transfer->downLoadFile(it->second.task.name);
+						onTransferFinish(sessionID, isSuccess);
+					});
+					const TaskInfo& task = it->second.task;
+					if (task.isBatch)
+					{
+						if (task.isdownload)
+						{
+							it->second.transfer->downLoadDir(task.name);
+						}
+						else if (it->second.transfer->postDir(task.name) != 0)
+						{
+							onTransferFinish(sessionID, false);
+						}
+					}
+					else if (task.isdownload)
+					{
+						it->second.transfer->downLoadFile(task.name, task.partIndex, task.partCount);
 					}
-					else
+					else if (it->second.transfer->postFile(task.name, task.partIndex, task.partCount) != 0)
 					{
-						it->second.transfer->postFile(it->second.task.name);
+						onTransferFinish(sessionID, false);
 					}
 				}
 				else
@@ -196,10 +594,16 @@ void FSTransferPool::checkNetClient()
 
 		m_netClient->setDisconnectCallback([=](Client*, Session* session) 
 		{
-			if (m_allExecuteTransferMap.find(session->getSessionID()) == m_allExecuteTransferMap.end())
+			auto it = m_allExecuteTransferMap.find(session->getSessionID());
+			if (it == m_allExecuteTransferMap.end())
 			{
 				m_netClient->removeSession(session->getSessionID());
 			}
+			else if (it->second.transfer)
+			{
+				// Ӻ
+				it->second.transfer->online(false);
+			}
 		});
 
 		m_netClient->setRemoveSessionCallback([](Client*, Session* session) 
@@ -209,7 +613,11 @@ void FSTransferPool::checkNetClient()
 
 		m_netClient->setRecvCallback([=](Client*, Session* session, char* data, uint32_t len)
 		{
-			m_allExecuteTransferMap[session->getSessionID()].transfer->input(data, len);
+			auto it = m_allExecuteTransferMap.find(session->getSessionID());
+			if (it != m_allExecuteTransferMap.end() && it->second.transfer)
+			{
+				it->second.transfer->input(data, len);
+			}
 		});
 	}
 }
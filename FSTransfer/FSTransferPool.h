@@ -2,16 +2,58 @@
 
 #include "net_uv/net_uv.h"
 #include "FSTransfer.h"
+#include "FSTDiskIO.h"
 #include <memory>
 
-typedef net_uv::TCPClient FS_Client;
-typedef net_uv::TCPServer FS_Server;
+// ʹõЭ
+enum FSTPoolTransport
+{
+	FST_TRANSPORT_TCP,
+	// ʹKCP_PROFILE_BULK,ʺϸӳٻ򶪰϶·
+	FST_TRANSPORT_KCP,
+};
+
+// ͬʱִе
+#define FST_POOL_MAX_CONNECT 16
+
+// ̶д߳
+#define FST_POOL_IO_THREAD_COUNT 2
+
+// ʱ·ļ()
+#define FST_POOL_RATE_INTERVAL 100
+// ʱÿС(ֽ/)
+#define FST_POOL_RATE_MIN (1024 * 8)
+
+// ȼ
+// ȴȼʼִ;ȫʱȼȷ,ͬһȼڰȨط
+enum FSTPriority
+{
+	FST_PRIORITY_HIGH,
+	FST_PRIORITY_NORMAL,
+	FST_PRIORITY_LOW,
+};
+
+// ļ(Ӿѽ)
+using FSTPoolFinishCall = std::function<void(const std::string& name, bool isDownload, bool isSuccess)>;
+
+// ͳ
+// Ϊڴ֮,ʱʹӳȡֵ
+struct FSTPoolTaskStats
+{
+	// ˵ĴΪ0
+	uint32_t taskID;
+	bool isdownload;
+	uint32_t connectCount;
+	FST_Stats stats;
+};
+using FSTPoolStatsCall = std::function<void(const std::vector<FSTPoolTaskStats>& statsArr)>;
 
 class FSTransferPool
 {
 public:
 
-	FSTransferPool();
+	// transport:ʹõЭ,˫һ
+	FSTransferPool(FSTPoolTransport transport = FST_TRANSPORT_TCP);
 
 	~FSTransferPool();
 
@@ -21,9 +63,40 @@ public:
 
 	bool isListen();
 
-	void upload(const char* ip, uint32_t port, const char* filename);
+	// connectCount:,1ʱļΪɶͬʱ
+	// ID,ڵٺȼ
+	uint32_t upload(const char* ip, uint32_t port, const char* filename, uint32_t connectCount = 1, FSTPriority priority = FST_PRIORITY_NORMAL);
+
+	uint32_t download(const char* ip, uint32_t port, const char* filename, uint32_t connectCount = 1, FSTPriority priority = FST_PRIORITY_NORMAL);
 
-	void download(const char* ip, uint32_t port, const char* filename);
+	// Ŀ¼µļ,ʹһ
+	uint32_t uploadDir(const char* ip, uint32_t port, const char* dirname, FSTPriority priority = FST_PRIORITY_NORMAL);
+
+	uint32_t downloadDir(const char* ip, uint32_t port, const char* dirname, FSTPriority priority = FST_PRIORITY_NORMAL);
+
+	// ȫ(ֽ/),0Ϊ,˵Ĵ
+	// ɱ֪ͨͷִ
+	void setRateLimit(uint64_t rate);
+
+	// ,0Ϊ,ӴʱΪӵ
+	void setTaskRateLimit(uint32_t taskID, uint64_t rate);
+
+	// ȼȨ,weight:ͬһȼڷı
+	void setTaskPriority(uint32_t taskID, FSTPriority priority, uint32_t weight = 1);
+
+	inline void setFinishCallback(const FSTPoolFinishCall& call);
+
+	// ȡڴͳ
+	void getTaskStats(std::vector<FSTPoolTaskStats>& outStatsArr);
+
+	// ʱصͳ,interval:(),updateFrameлص
+	inline void setStatsCallback(const FSTPoolStatsCall& call, uint32_t interval = 1000);
+
+	// ͬ:Էͬļʱֻ仯(ֻԵӴЧ)
+	inline void setDeltaSync(bool enable);
+
+	// ƬУ:ÿƬЯCRC32C,𻵵ķƬط
+	inline void setSliceCheck(bool enable);
 
 	void close(const std::function<void()>& call);
 
@@ -33,17 +106,42 @@ protected:
 
 	void checkNetClient();
 
+	std::shared_ptr<net_uv::Client> createClient();
+
+	std::shared_ptr<net_uv::Server> createServer();
+
 	void executeTask();
+
+	uint32_t addTask(const char* ip, uint32_t port, const char* filename, bool isdownload, uint32_t connectCount, FSTPriority priority, bool isBatch = false);
+
+	// ٺȼ
+	void scheduleRate();
+
+	void onTransferFinish(uint32_t sessionID, bool isSuccess);
+
+	// Ƴѽ
+	void removeFinishTransfer();
 	
 protected:	
-	std::shared_ptr<FS_Client> m_netClient;
-	std::shared_ptr<FS_Server> m_netServer;
+	// ļд߳,ӹ
+	FSTDiskIO m_diskIO;
+
+	FSTPoolTransport m_transport;
+
+	std::shared_ptr<net_uv::Client> m_netClient;
+	std::shared_ptr<net_uv::Server> m_netServer;
 
 	void(*m_stopListenCall)();
 
 	std::function<void()> m_closeClientCall;
 
-	std::map<net_uv::Session*, std::shared_ptr<FSTransfer> > m_listenTransferMap;
+	struct ListenTransferInfo
+	{
+		std::shared_ptr<FSTransfer> transfer;
+		uint64_t lastBytes;
+		FST_RateShare share;
+	};
+	std::map<net_uv::Session*, ListenTransferInfo> m_listenTransferMap;
 
 	struct TaskInfo
 	{
@@ -51,6 +149,10 @@ protected:
 		bool isdownload;
 		std::string ip;
 		uint32_t port;
+		uint32_t groupID;
+		uint32_t partIndex;
+		uint32_t partCount;
+		bool isBatch;
 	};
 	std::vector<TaskInfo> m_allWaitTaskInfo;
 	
@@ -58,8 +160,59 @@ protected:
 	{
 		std::shared_ptr<FSTransfer> transfer;
 		TaskInfo task;
+		bool isFinish;
+		// ϴηʱĴ
+		uint64_t lastBytes;
 	};
 	std::map<uint32_t, ConnectTransferInfo > m_allExecuteTransferMap;
 
+	// ͬһļ
+	struct TaskGroup
+	{
+		std::string name;
+		bool isdownload;
+		uint32_t partCount;
+		uint32_t finishCount;
+		bool isSuccess;
+		uint64_t rateLimit;
+		FST_RateShare share;
+	};
+	std::map<uint32_t, TaskGroup> m_allTaskGroupMap;
+
+	FSTPoolFinishCall m_finishCall;
+
+	bool m_isDeltaSync;
+	bool m_isSliceCheck;
+
+	uint64_t m_rateLimit;
+	std::chrono::steady_clock::time_point m_lastScheduleTime;
+	bool m_isRateDirty;
+
+	FSTPoolStatsCall m_statsCall;
+	uint32_t m_statsInterval;
+	std::chrono::steady_clock::time_point m_lastStatsTime;
+
 	uint32_t m_sessionIDSpawn;
+	uint32_t m_groupIDSpawn;
 };
+
+void FSTransferPool::setFinishCallback(const FSTPoolFinishCall& call)
+{
+	m_finishCall = call;
+}
+
+void FSTransferPool::setStatsCallback(const FSTPoolStatsCall& call, uint32_t interval)
+{
+	m_statsCall = call;
+	m_statsInterval = interval;
+}
+
+void FSTransferPool::setDeltaSync(bool enable)
+{
+	m_isDeltaSync = enable;
+}
+
+void FSTransferPool::setSliceCheck(bool enable)
+{
+	m_isSliceCheck = enable;
+}
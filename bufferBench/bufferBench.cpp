@@ -0,0 +1,270 @@
+#include "net_uv/net_uv.h"
+#include "net_uv/base/Buffer.h"
+#include <vector>
+#include <random>
+
+NS_NET_UV_OPEN
+
+// ջ׼
+// ģTCPSession::on_socket_recv:̶ȷֿȡϢ,ÿϢӦò
+// ԱȾɵֿ黺(ÿϢҪȫδؽ)뵱ǰ(ԭؽ)
+
+// ÿζȡĳ,libuvĶСһ
+#define BENCH_READ_LEN (64 * 1024)
+// ÿԵ
+#define BENCH_TOTAL_LEN (64 * 1024 * 1024)
+
+struct BenchHead
+{
+	uint32_t len;
+	uint32_t tag;
+};
+
+// ɵֿ黺
+class BlockBuffer
+{
+	struct block
+	{
+		uint32_t dataLen;
+		char* data;
+		block* pre;
+		block* next;
+	};
+
+	uint32_t m_blockSize;
+	uint32_t m_curDataLength;
+	block* m_headBlock;
+	block* m_tailBlock;
+public:
+	BlockBuffer(uint32_t blockSize)
+	{
+		m_blockSize = blockSize;
+		m_curDataLength = 0;
+		m_headBlock = createBlock();
+		m_tailBlock = m_headBlock;
+	}
+
+	~BlockBuffer()
+	{
+		clear();
+		fc_free(m_headBlock->data);
+		fc_free(m_headBlock);
+	}
+
+	inline uint32_t getDataLength()
+	{
+		return m_curDataLength;
+	}
+
+	void add(const char* pData, uint32_t dataLen)
+	{
+		const char* curData = pData;
+		while (dataLen > 0)
+		{
+			if (m_tailBlock->dataLen >= m_blockSize)
+			{
+				block* b = createBlock();
+				m_tailBlock->next = b;
+				b->pre = m_tailBlock;
+				m_tailBlock = b;
+			}
+			uint32_t sub = m_blockSize - m_tailBlock->dataLen;
+			uint32_t copylen = (sub > dataLen) ? dataLen : sub;
+
+			memcpy(m_tailBlock->data + m_tailBlock->dataLen, curData, copylen);
+
+			m_tailBlock->dataLen += copylen;
+			m_curDataLength += copylen;
+			curData = curData + copylen;
+			dataLen -= copylen;
+		}
+	}
+
+	void get(char* pOutData)
+	{
+		uint32_t curIndex = 0;
+		block* curBlock = m_headBlock;
+		do
+		{
+			memcpy(pOutData + curIndex, curBlock->data, curBlock->dataLen);
+			curIndex += curBlock->dataLen;
+			curBlock = curBlock->next;
+		} while (curBlock);
+	}
+
+	void clear()
+	{
+		while (m_tailBlock != m_headBlock)
+		{
+			block* pre = m_tailBlock->pre;
+			pre->next = NULL;
+			fc_free(m_tailBlock->data);
+			fc_free(m_tailBlock);
+			m_tailBlock = pre;
+		}
+		m_headBlock->dataLen = 0;
+		m_headBlock->next = NULL;
+		m_curDataLength = 0;
+	}
+
+	inline char* getHeadBlockData()
+	{
+		return m_headBlock->data;
+	}
+
+protected:
+	block* createBlock()
+	{
+		auto p = (block*)fc_malloc(sizeof(block));
+		p->next = NULL;
+		p->pre = NULL;
+		p->dataLen = 0;
+		p->data = (char*)fc_malloc(m_blockSize);
+		return p;
+	}
+};
+
+// ӦòյϢ,УֵֹŻ
+static uint64_t onRecvMsg(char* data, uint32_t len)
+{
+	uint64_t sum = len + (uint8_t)data[0] + (uint8_t)data[len - 1];
+	fc_free(data);
+	return sum;
+}
+
+static uint64_t runBlockBuffer(const std::vector<char>& stream, uint32_t* outCount)
+{
+	const static uint32_t headlen = sizeof(BenchHead);
+	BlockBuffer buffer(1024 * 4);
+	uint64_t sum = 0;
+	uint32_t count = 0;
+
+	for (size_t pos = 0; pos < stream.size(); pos += BENCH_READ_LEN)
+	{
+		uint32_t len = (uint32_t)std::min<size_t>(BENCH_READ_LEN, stream.size() - pos);
+		buffer.add(stream.data() + pos, len);
+
+		while (buffer.getDataLength() >= headlen)
+		{
+			// ͷֻڵһвֱӶȡ,ȿȫ
+			char* pMsg = (char*)fc_malloc(buffer.getDataLength());
+			buffer.get(pMsg);
+			BenchHead* h = (BenchHead*)pMsg;
+
+			int32_t subv = (int32_t)buffer.getDataLength() - (int32_t)(h->len + headlen);
+			if (subv < 0)
+			{
+				fc_free(pMsg);
+				break;
+			}
+
+			char* recvData = (char*)fc_malloc(h->len + 1);
+			memcpy(recvData, pMsg + headlen, h->len);
+			recvData[h->len] = '\0';
+			sum += onRecvMsg(recvData, h->len);
+			count++;
+
+			buffer.clear();
+			if (subv > 0)
+			{
+				buffer.add(pMsg + headlen + h->len, subv);
+			}
+			fc_free(pMsg);
+		}
+	}
+	*outCount = count;
+	return sum;
+}
+
+static uint64_t runBuffer(const std::vector<char>& stream, uint32_t* outCount)
+{
+	const static uint32_t headlen = sizeof(BenchHead);
+	Buffer buffer(1024 * 4);
+	uint64_t sum = 0;
+	uint32_t count = 0;
+
+	for (size_t pos = 0; pos < stream.size(); pos += BENCH_READ_LEN)
+	{
+		uint32_t len = (uint32_t)std::min<size_t>(BENCH_READ_LEN, stream.size() - pos);
+		buffer.add(stream.data() + pos, len);
+
+		while (buffer.getDataLength() >= headlen)
+		{
+			BenchHead* h = (BenchHead*)buffer.getReadData();
+			if (buffer.getDataLength() < h->len + headlen)
+			{
+				break;
+			}
+
+			uint32_t msgLen = h->len;
+			char* recvData = (char*)fc_malloc(msgLen + 1);
+			memcpy(recvData, buffer.getReadData() + headlen, msgLen);
+			recvData[msgLen] = '\0';
+			buffer.skip(headlen + msgLen);
+			sum += onRecvMsg(recvData, msgLen);
+			count++;
+		}
+	}
+	*outCount = count;
+	return sum;
+}
+
+// Ϣ[minLen, maxLen]֮Ϣ
+static void makeStream(std::vector<char>& stream, uint32_t minLen, uint32_t maxLen)
+{
+	std::mt19937 rng(1);
+	stream.clear();
+	stream.reserve(BENCH_TOTAL_LEN + maxLen + sizeof(BenchHead));
+	while (stream.size() < BENCH_TOTAL_LEN)
+	{
+		BenchHead h;
+		h.len = minLen + rng() % (maxLen - minLen + 1);
+		h.tag = 0;
+		stream.insert(stream.end(), (char*)&h, (char*)&h + sizeof(h));
+		size_t begin = stream.size();
+		stream.resize(begin + h.len);
+		for (uint32_t i = 0; i < h.len; i += 64)
+		{
+			stream[begin + i] = (char)rng();
+		}
+		stream[begin + h.len - 1] = (char)rng();
+	}
+}
+
+int main()
+{
+	struct
+	{
+		const char* name;
+		uint32_t minLen;
+		uint32_t maxLen;
+	} caseArr[] =
+	{
+		{ "small", 16, 256 },
+		{ "mixed", 16, 16 * 1024 },
+		{ "large", 32 * 1024, 256 * 1024 },
+	};
+
+	std::vector<char> stream;
+	for (auto& c : caseArr)
+	{
+		makeStream(stream, c.minLen, c.maxLen);
+
+		uint32_t blockCount = 0;
+		uint64_t startTime = uv_hrtime();
+		uint64_t blockSum = runBlockBuffer(stream, &blockCount);
+		uint64_t blockTime = uv_hrtime() - startTime;
+
+		uint32_t count = 0;
+		startTime = uv_hrtime();
+		uint64_t sum = runBuffer(stream, &count);
+		uint64_t time = uv_hrtime() - startTime;
+
+		double mb = stream.size() / (1024.0 * 1024.0);
+		printf("%-6s msgs=%-8u BlockBuffer %8.1f MB/s  Buffer %8.1f MB/s  %s\n",
+			c.name, count,
+			mb / (blockTime / 1e9), mb / (time / 1e9),
+			(blockSum == sum && blockCount == count) ? "" : "MISMATCH");
+	}
+	return 0;
+}
@@ -3,115 +3,179 @@
 
 NS_NET_UV_BEGIN
 
+// ڴĽջ
+// ʼΪ2,ʼձ[m_readPos, m_writePos)ڴ,
+// βռ䲻ʱȽδݰƵͷ(ѹ),Բʱٰ2,
+// ˿ֱͨgetReadData()ȡϢͷϢ,追
 class Buffer
 {
-	struct block
-	{
-		uint32_t dataLen;
-		char* data;
-		block* pre;
-		block* next;
-	};
-
-	uint32_t m_blockSize;
-	uint32_t m_curDataLength;
-	block* m_headBlock;
-	block* m_tailBlock;
+	// Ϊʱ,ʼıسʼ
+	enum { SHRINK_MULTIPLE = 16 };
+
+	// ,uint32_tܱʾ2
+	static const uint32_t MAX_CAPACITY = 0x80000000U;
+
+	char* m_data;
+	uint32_t m_capacity;
+	uint32_t m_initCapacity;
+	uint32_t m_readPos;
+	uint32_t m_writePos;
 public:
 	Buffer() = delete;
 	Buffer(const Buffer&) = delete;
-	Buffer(uint32_t blockSize)
+	Buffer(uint32_t initSize)
 	{
-		assert(blockSize > 0);
-		m_blockSize = blockSize;
-		m_curDataLength = 0;
-		m_headBlock = createBlock();
-		m_tailBlock = m_headBlock;
+		assert(initSize > 0 && initSize <= MAX_CAPACITY);
+		m_initCapacity = roundUpPowerOfTwo(initSize);
+		m_capacity = m_initCapacity;
+		m_data = (char*)fc_malloc(m_capacity);
+		m_readPos = 0;
+		m_writePos = 0;
 	}
 
 	virtual ~Buffer()
 	{
-		clear();
-		fc_free(m_headBlock->data);
-		fc_free(m_headBlock);
+		fc_free(m_data);
 	}
 
 	inline uint32_t getDataLength()
 	{
-		return m_curDataLength;
+		return m_writePos - m_readPos;
+	}
+
+	inline uint32_t getCapacity()
+	{
+		return m_capacity;
+	}
+
+	// ɶʼַ,ΪgetDataLength()
+	inline char* getReadData()
+	{
+		return m_data + m_readPos;
+	}
+
+	// ȡneedLenֽڵдռ,дcommitύ
+	// ʱNULL
+	char* getWriteData(uint32_t needLen)
+	{
+		if (!reserve(needLen))
+			return NULL;
+		return m_data + m_writePos;
 	}
 
-	void add(char* pData, uint32_t dataLen)
+	// дռ䳤
+	inline uint32_t getWriteableLength()
 	{
-		char* curData = pData;
-		while (dataLen > 0)
+		return m_capacity - m_writePos;
+	}
+
+	// ύдgetWriteData()
+	inline void commit(uint32_t len)
+	{
+		assert(m_writePos + len <= m_capacity);
+		m_writePos += len;
+	}
+
+	// Ѷȡ
+	void skip(uint32_t len)
+	{
+		assert(len <= getDataLength());
+		m_readPos += len;
+		if (m_readPos == m_writePos)
 		{
-			//ռ䲻µĽڵ
-			if (m_tailBlock->dataLen >= m_blockSize)
-			{
-				block* b = createBlock();
-				m_tailBlock->next = b;
-				b->pre = m_tailBlock;
-				m_tailBlock = b;
-			}
-			uint32_t sub = m_blockSize - m_tailBlock->dataLen;
-			uint32_t copylen = (sub > dataLen) ? dataLen : sub;
-			
-			memcpy(m_tailBlock->data + m_tailBlock->dataLen, curData, copylen);
-			
-			m_tailBlock->dataLen += copylen;
-			m_curDataLength += copylen;
-			curData = curData + copylen;
-			dataLen -= copylen;
+			m_readPos = 0;
+			m_writePos = 0;
+			shrink();
 		}
 	}
 
-	bool get(char* pOutData)
+	// ʱfalse
+	bool add(const char* pData, uint32_t dataLen)
 	{
-		if (m_curDataLength <= 0)
+		if (dataLen <= 0)
+			return true;
+		char* p = getWriteData(dataLen);
+		if (p == NULL)
 			return false;
+		memcpy(p, pData, dataLen);
+		commit(dataLen);
+		return true;
+	}
 
-		uint32_t curIndex = 0;
-		block* curBlock = m_headBlock;
-		do
-		{
-			memcpy(pOutData + curIndex, curBlock->data, curBlock->dataLen);
-			curIndex += curBlock->dataLen;
-			curBlock = curBlock->next;
-		} while (curBlock);
+	bool get(char* pOutData)
+	{
+		if (getDataLength() <= 0)
+			return false;
 
+		memcpy(pOutData, getReadData(), getDataLength());
 		return true;
 	}
 
 	void clear()
 	{
-		while (m_tailBlock != m_headBlock)
+		m_readPos = 0;
+		m_writePos = 0;
+		shrink();
+	}
+
+protected:
+	// vܳMAX_CAPACITY,Ϊ0޷ѭ
+	static uint32_t roundUpPowerOfTwo(uint32_t v)
+	{
+		assert(v <= MAX_CAPACITY);
+		uint32_t r = 1;
+		while (r < v)
 		{
-			block* pre = m_tailBlock->pre;
-			pre->next = NULL;
-			fc_free(m_tailBlock->data);
-			fc_free(m_tailBlock);
-			m_tailBlock = pre;
+			r <<= 1;
 		}
-		m_headBlock->dataLen = 0;
-		m_headBlock->next = NULL;
-		m_curDataLength = 0;
+		return r;
 	}
 
-	inline char* getHeadBlockData()
+	bool reserve(uint32_t needLen)
 	{
-		return m_headBlock->data;
+		if (m_capacity - m_writePos >= needLen)
+			return true;
+
+		uint32_t dataLen = getDataLength();
+
+		// ܿռ㹻,δݰƵͷ
+		if (m_capacity - dataLen >= needLen)
+		{
+			if (dataLen > 0)
+			{
+				memmove(m_data, m_data + m_readPos, dataLen);
+			}
+			m_readPos = 0;
+			m_writePos = dataLen;
+			return true;
+		}
+
+		// 
+		if (needLen > MAX_CAPACITY - dataLen)
+			return false;
+
+		uint32_t newCapacity = roundUpPowerOfTwo(dataLen + needLen);
+		char* newData = (char*)fc_malloc(newCapacity);
+		if (dataLen > 0)
+		{
+			memcpy(newData, m_data + m_readPos, dataLen);
+		}
+		fc_free(m_data);
+		m_data = newData;
+		m_capacity = newCapacity;
+		m_readPos = 0;
+		m_writePos = dataLen;
+		return true;
 	}
 
-protected:
-	block* createBlock()
+	void shrink()
 	{
-		auto p = (block*)fc_malloc(sizeof(block));
-		p->next = NULL;
-		p->pre = NULL;
-		p->dataLen = 0;
-		p->data = (char*)fc_malloc(m_blockSize);
-		return p;
+		if (m_capacity > m_initCapacity * SHRINK_MULTIPLE)
+		{
+			fc_free(m_data);
+			m_capacity = m_initCapacity;
+			m_data = (char*)fc_malloc(m_capacity);
+		}
 	}
 };
 
@@ -6,6 +6,7 @@ Client::Client()
 	: m_connectCall(nullptr)
 	, m_disconnectCall(nullptr)
 	, m_recvCall(nullptr)
+	, m_hotSessionCall(nullptr)
 	, m_clientStage(clientStage::STOP)
 {
 	memset(&m_idle, 0, sizeof(uv_idle_t));
@@ -28,9 +29,11 @@ void Client::pushThreadMsg(NetThreadMsgType type, Session* session, char* data,
 	msg.data = data;
 	msg.dataLen = len;
 	msg.pSession = session;
+	msg.pushTime = NetLoopStats::getPushTime();
 
 	m_msgMutex.lock();
 	m_msgQue.push(msg);
+	m_loopStats.onPushMsg(m_msgQue.size());
 	m_msgMutex.unlock();
 }
 
@@ -76,7 +79,9 @@ void Client::uv_on_idle_run(uv_idle_t* handle)
 {
 	Client* client = (Client*)handle->data;
 	client->onIdleRun();
+	client->m_loopStats.endLoop();
 	ThreadSleep(1);
+	client->m_loopStats.beginLoop();
 }
 
 void Client::uv_on_session_update_timer_run(uv_timer_t* handle)
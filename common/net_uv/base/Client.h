@@ -15,6 +15,7 @@ using ClientDisconnectCall = std::function<void(Client* client, Session* session
 using ClientRecvCall = std::function<void(Client* client, Session* session, char* data, uint32_t len)>;
 using ClientCloseCall = std::function<void(Client* client)>;
 using ClientRemoveSessionCall = std::function<void(Client* client, Session* session)>;
+using ClientHotSessionCall = std::function<void(Client* client, NetSessionTraffic* arr, uint32_t count)>;
 
 
 enum CONNECTSTATE
@@ -61,6 +62,11 @@ public:
 	
 	inline void setRemoveSessionCallback(const ClientRemoveSessionCall& call);
 
+	// ѯcountỰ,updateFrameͨص
+	virtual void queryHotSession(uint32_t count, NetHotSessionSort sort) = 0;
+
+	inline void setHotSessionCallback(const ClientHotSessionCall& call);
+
 protected:
 
 	virtual void onIdleRun() = 0;
@@ -89,6 +95,7 @@ protected:
 	ClientRecvCall m_recvCall;
 	ClientCloseCall m_clientCloseCall;
 	ClientRemoveSessionCall m_removeSessionCall;
+	ClientHotSessionCall m_hotSessionCall;
 
 
 	// ߳Ϣ
@@ -128,4 +135,9 @@ void Client::setRemoveSessionCallback(const ClientRemoveSessionCall& call)
 	m_removeSessionCall = std::move(call);
 }
 
+void Client::setHotSessionCallback(const ClientHotSessionCall& call)
+{
+	m_hotSessionCall = std::move(call);
+}
+
 NS_NET_UV_END
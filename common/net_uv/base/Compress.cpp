@@ -0,0 +1,458 @@
+#include "Compress.h"
+#include "Misc.h"
+#include <memory>
+
+NS_NET_UV_BEGIN
+
+#define NET_LZ_HASH_LOG (12)
+#define NET_LZ_MIN_MATCH (4)
+// 5ֽڱΪ
+#define NET_LZ_LAST_LITERALS (5)
+// һƥڽβ12ֽ֮ǰʼ
+#define NET_LZ_MFLIMIT (12)
+#define NET_LZ_MAX_DISTANCE (65535)
+#define NET_LZ_ML_MASK (15)
+#define NET_LZ_RUN_MASK (15)
+
+#define NET_LZ_HASH_SIZE (1 << NET_LZ_HASH_LOG)
+
+// Ԥֵ,ʱԤȼϣ,ѹʱֱӿϣ¼
+struct NetCompressDict
+{
+	std::string data;
+	uint32_t id;
+	// λ+1,0ʾ
+	uint32_t table[NET_LZ_HASH_SIZE];
+};
+
+// ͨstd::atomic_load/atomic_store,̳߳ڼֵ䲻ᱻͷ
+static std::shared_ptr<NetCompressDict> net_compressDict;
+
+static inline uint32_t net_lz_read32(const uint8_t* p)
+{
+	uint32_t v;
+	memcpy(&v, p, sizeof(v));
+	return v;
+}
+
+static inline uint32_t net_lz_hash(uint32_t v)
+{
+	return (v * 2654435761U) >> (32 - NET_LZ_HASH_LOG);
+}
+
+static inline uint8_t* net_lz_writeLen(uint8_t* op, uint32_t len)
+{
+	while (len >= 255)
+	{
+		*op++ = 255;
+		len -= 255;
+	}
+	*op++ = (uint8_t)len;
+	return op;
+}
+
+static inline uint8_t* net_lz_writeLiterals(uint8_t* op, const uint8_t* anchor, uint32_t litLen, uint8_t** token)
+{
+	*token = op++;
+	if (litLen >= NET_LZ_RUN_MASK)
+	{
+		**token = (uint8_t)(NET_LZ_RUN_MASK << 4);
+		op = net_lz_writeLen(op, litLen - NET_LZ_RUN_MASK);
+	}
+	else
+	{
+		**token = (uint8_t)(litLen << 4);
+	}
+	memcpy(op, anchor, litLen);
+	return op + litLen;
+}
+
+// λðֵѹβӼ: [0, dictLen)Ϊֵ, [dictLen, dictLen + srcLen)Ϊsrc
+// dictTableΪֵĹϣ,ֵԭ,srcһ
+static uint32_t net_lz_compress(const uint8_t* dict, uint32_t dictLen, const uint32_t* dictTable, const uint8_t* src, uint32_t srcLen, uint8_t* dst)
+{
+	uint32_t table[NET_LZ_HASH_SIZE];
+	if (dictTable)
+	{
+		memcpy(table, dictTable, sizeof(table));
+	}
+	else
+	{
+		memset(table, 0, sizeof(table));
+	}
+
+	const uint8_t* dictEnd = dict + dictLen;
+	const uint8_t* end = src + srcLen;
+	const uint8_t* anchor = src;
+	const uint8_t* ip = src;
+	uint8_t* op = dst;
+	uint8_t* token = NULL;
+
+	if (srcLen > NET_LZ_MFLIMIT)
+	{
+		const uint8_t* mflimit = end - NET_LZ_MFLIMIT;
+		const uint8_t* matchlimit = end - NET_LZ_LAST_LITERALS;
+
+		while (ip < mflimit)
+		{
+			uint32_t seq = net_lz_read32(ip);
+			uint32_t h = net_lz_hash(seq);
+			uint32_t pos = dictLen + (uint32_t)(ip - src);
+			uint32_t ref = table[h];
+			table[h] = pos + 1;
+
+			if (ref == 0 || pos - (ref - 1) > NET_LZ_MAX_DISTANCE)
+			{
+				++ip;
+				continue;
+			}
+
+			uint32_t matchPos = ref - 1;
+			bool isDictMatch = (matchPos < dictLen);
+			const uint8_t* match = isDictMatch ? dict + matchPos : src + (matchPos - dictLen);
+			if (net_lz_read32(match) != seq)
+			{
+				++ip;
+				continue;
+			}
+
+			// ǰչƥ,Խֵsrcı߽
+			const uint8_t* lowLimit = isDictMatch ? dict : src;
+			while (ip > anchor && match > lowLimit && ip[-1] == match[-1])
+			{
+				--ip;
+				--match;
+				--matchPos;
+			}
+
+			// չƥ,ֵеƥ䵽ֵĩβsrcʼȽ
+			const uint8_t* mp = ip + NET_LZ_MIN_MATCH;
+			const uint8_t* mm = match + NET_LZ_MIN_MATCH;
+			if (isDictMatch)
+			{
+				while (mp < matchlimit && mm < dictEnd && *mp == *mm)
+				{
+					++mp;
+					++mm;
+				}
+				if (mm == dictEnd)
+				{
+					mm = src;
+				}
+				else
+				{
+					mm = NULL;
+				}
+			}
+			if (mm != NULL)
+			{
+				while (mp < matchlimit && *mp == *mm)
+				{
+					++mp;
+					++mm;
+				}
+			}
+
+			op = net_lz_writeLiterals(op, anchor, (uint32_t)(ip - anchor), &token);
+
+			uint32_t offset = dictLen + (uint32_t)(ip - src) - matchPos;
+			*op++ = (uint8_t)(offset & 0xFF);
+			*op++ = (uint8_t)(offset >> 8);
+
+			uint32_t matchLen = (uint32_t)(mp - ip) - NET_LZ_MIN_MATCH;
+			if (matchLen >= NET_LZ_ML_MASK)
+			{
+				*token |= NET_LZ_ML_MASK;
+				op = net_lz_writeLen(op, matchLen - NET_LZ_ML_MASK);
+			}
+			else
+			{
+				*token |= (uint8_t)matchLen;
+			}
+
+			ip = mp;
+			anchor = ip;
+		}
+	}
+
+	// ʣȫΪ
+	op = net_lz_writeLiterals(op, anchor, (uint32_t)(end - anchor), &token);
+
+	return (uint32_t)(op - dst);
+}
+
+static inline bool net_lz_readLen(const uint8_t** ip, const uint8_t* iend, uint32_t* len)
+{
+	uint8_t s = 0;
+	do
+	{
+		if (*ip >= iend)
+			return false;
+		s = *(*ip)++;
+		*len += s;
+	} while (s == 255);
+	return true;
+}
+
+// ѹdst[0, dstLen),ƫƳѽѹȵĲֵdict[0, dictLen)ĩβ
+static bool net_lz_decompress(const uint8_t* src, uint32_t srcLen, const uint8_t* dict, uint32_t dictLen, uint8_t* dst, uint32_t dstLen)
+{
+	const uint8_t* ip = src;
+	const uint8_t* iend = src + srcLen;
+	uint8_t* op = dst;
+	uint8_t* oend = dst + dstLen;
+
+	while (ip < iend)
+	{
+		uint32_t token = *ip++;
+
+		uint32_t litLen = token >> 4;
+		if (litLen == NET_LZ_RUN_MASK && !net_lz_readLen(&ip, iend, &litLen))
+			return false;
+
+		if ((uint32_t)(iend - ip) < litLen || (uint32_t)(oend - op) < litLen)
+			return false;
+
+		memcpy(op, ip, litLen);
+		op += litLen;
+		ip += litLen;
+
+		// һֻ
+		if (ip >= iend)
+			break;
+
+		if (iend - ip < 2)
+			return false;
+
+		uint32_t offset = ip[0] | (ip[1] << 8);
+		ip += 2;
+		uint32_t outLen = (uint32_t)(op - dst);
+		if (offset == 0 || offset > outLen + dictLen)
+			return false;
+
+		uint32_t matchLen = token & NET_LZ_ML_MASK;
+		if (matchLen == NET_LZ_ML_MASK && !net_lz_readLen(&ip, iend, &matchLen))
+			return false;
+		matchLen += NET_LZ_MIN_MATCH;
+
+		if ((uint32_t)(oend - op) < matchLen)
+			return false;
+
+		const uint8_t* match = NULL;
+		if (offset > outLen)
+		{
+			// ƥʼֵ,ֵĩβĲֽŴdstʼ
+			uint32_t dictCopyLen = offset - outLen;
+			const uint8_t* dictMatch = dict + dictLen - dictCopyLen;
+			if (dictCopyLen >= matchLen)
+			{
+				memcpy(op, dictMatch, matchLen);
+				op += matchLen;
+				continue;
+			}
+			memcpy(op, dictMatch, dictCopyLen);
+			op += dictCopyLen;
+			matchLen -= dictCopyLen;
+			match = dst;
+		}
+		else
+		{
+			match = op - offset;
+		}
+
+		if ((uint32_t)(op - match) >= matchLen)
+		{
+			memcpy(op, match, matchLen);
+		}
+		else
+		{
+			// ص
+			for (uint32_t i = 0; i < matchLen; ++i)
+			{
+				op[i] = match[i];
+			}
+		}
+		op += matchLen;
+	}
+	return (op == oend);
+}
+
+void net_setCompressDict(const char* dict, uint32_t len)
+{
+	if (dict == NULL || len <= 0)
+	{
+		std::atomic_store(&net_compressDict, std::shared_ptr<NetCompressDict>());
+		return;
+	}
+	if (len > NET_LZ_MAX_DISTANCE)
+	{
+		dict = dict + (len - NET_LZ_MAX_DISTANCE);
+		len = NET_LZ_MAX_DISTANCE;
+	}
+
+	std::shared_ptr<NetCompressDict> compressDict = std::make_shared<NetCompressDict>();
+	compressDict->data.assign(dict, len);
+	compressDict->id = net_crc32c(0, dict, len);
+	memset(compressDict->table, 0, sizeof(compressDict->table));
+	const uint8_t* base = (const uint8_t*)compressDict->data.data();
+	for (uint32_t i = 0; i + NET_LZ_MIN_MATCH <= len; ++i)
+	{
+		compressDict->table[net_lz_hash(net_lz_read32(base + i))] = i + 1;
+	}
+	std::atomic_store(&net_compressDict, compressDict);
+}
+
+char* net_compressMsg(NetCompressMode mode, const char* data, uint32_t len, uint32_t* outLen, NetCompressStats* stats)
+{
+	*outLen = 0;
+	if (mode == NetCompressMode::NONE || data == NULL || len <= 0)
+	{
+		return NULL;
+	}
+
+	uint64_t startTime = uv_hrtime();
+
+	std::shared_ptr<NetCompressDict> dict;
+	if (mode == NetCompressMode::DICT)
+	{
+		dict = std::atomic_load(&net_compressDict);
+		if (dict == NULL)
+		{
+			mode = NetCompressMode::FAST;
+		}
+	}
+
+	const static uint32_t headlen = sizeof(NetCompressHead);
+
+	char* p = (char*)fc_malloc(headlen + len + len / 255 + 16);
+	uint32_t compressLen = 0;
+	if (dict)
+	{
+		compressLen = net_lz_compress((const uint8_t*)dict->data.data(), (uint32_t)dict->data.size(), dict->table, (const uint8_t*)data, len, (uint8_t*)(p + headlen));
+	}
+	else
+	{
+		compressLen = net_lz_compress(NULL, 0, NULL, (const uint8_t*)data, len, (uint8_t*)(p + headlen));
+	}
+
+	if (stats)
+	{
+		stats->compressTime += uv_hrtime() - startTime;
+	}
+
+	// ѹûбС
+	if (headlen + compressLen >= len)
+	{
+		fc_free(p);
+		return NULL;
+	}
+
+	NetCompressHead* h = (NetCompressHead*)p;
+	h->rawLen = len;
+	h->mode = mode;
+	h->dictID = dict ? dict->id : 0;
+
+	*outLen = headlen + compressLen;
+
+	if (stats)
+	{
+		stats->sendRawBytes += len;
+		stats->sendCompressBytes += *outLen;
+	}
+	return p;
+}
+
+char* net_decompressMsg(const char* data, uint32_t len, uint32_t maxLen, uint32_t* outLen, NetCompressStats* stats)
+{
+	*outLen = 0;
+
+	const static uint32_t headlen = sizeof(NetCompressHead);
+	if (data == NULL || len <= headlen)
+	{
+		return NULL;
+	}
+
+	uint64_t startTime = uv_hrtime();
+
+	NetCompressHead* h = (NetCompressHead*)data;
+	uint32_t rawLen = h->rawLen;
+	if (rawLen <= 0 || rawLen > maxLen)
+	{
+		NET_UV_LOG(NET_UV_L_WARNING, "ѹϢѹ󳤶ȲϷ: %u", rawLen);
+		return NULL;
+	}
+
+	std::shared_ptr<NetCompressDict> dict;
+	if (h->mode == NetCompressMode::DICT)
+	{
+		dict = std::atomic_load(&net_compressDict);
+		if (dict == NULL)
+		{
+			NET_UV_LOG(NET_UV_L_WARNING, "յֵѹϢ,δֵ");
+			return NULL;
+		}
+		if (dict->id != h->dictID)
+		{
+			NET_UV_LOG(NET_UV_L_WARNING, "յֵѹϢ,ֵ䲻һ");
+			return NULL;
+		}
+	}
+	else if (h->mode != NetCompressMode::FAST)
+	{
+		return NULL;
+	}
+
+	// һֽ,ݱһ'\0'β
+	char* p = (char*)fc_malloc(rawLen + 1);
+	if (p == NULL)
+	{
+		return NULL;
+	}
+
+	bool isSuccess = false;
+	if (dict)
+	{
+		isSuccess = net_lz_decompress((const uint8_t*)(data + headlen), len - headlen, (const uint8_t*)dict->data.data(), (uint32_t)dict->data.size(), (uint8_t*)p, rawLen);
+	}
+	else
+	{
+		isSuccess = net_lz_decompress((const uint8_t*)(data + headlen), len - headlen, NULL, 0, (uint8_t*)p, rawLen);
+	}
+	if (!isSuccess)
+	{
+		fc_free(p);
+		return NULL;
+	}
+	p[rawLen] = '\0';
+
+	*outLen = rawLen;
+
+	if (stats)
+	{
+		stats->decompressTime += uv_hrtime() - startTime;
+		stats->recvRawBytes += rawLen;
+		stats->recvCompressBytes += len;
+	}
+	return p;
+}
+
+void net_logCompressStats(const char* name, uint32_t sessionID, const NetCompressStats& stats)
+{
+	// ر־ʱδʹ
+	(void)name;
+	(void)sessionID;
+
+	if (stats.sendRawBytes <= 0 && stats.recvRawBytes <= 0)
+	{
+		return;
+	}
+
+	NET_UV_LOG(NET_UV_L_INFO, "%s session %u compress: send %.1f%% (%llu us) recv %.1f%% (%llu us)",
+		name, sessionID,
+		stats.sendRawBytes > 0 ? stats.sendCompressBytes * 100.0 / stats.sendRawBytes : 100.0,
+		(unsigned long long)(stats.compressTime / 1000),
+		stats.recvRawBytes > 0 ? stats.recvCompressBytes * 100.0 / stats.recvRawBytes : 100.0,
+		(unsigned long long)(stats.decompressTime / 1000));
+}
+
+NS_NET_UV_END
\ No newline at end of file
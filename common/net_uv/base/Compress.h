@@ -0,0 +1,57 @@
+#pragma once
+
+#include "Common.h"
+
+NS_NET_UV_BEGIN
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/// Ϣѹ
+/// ʹLZ4ʽĿѹ㷨,DICTģʽ»Ԥֵ,
+/// ʺظȽϸߵСϢ(JSON/protobuf)
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// ѹģʽ
+enum class NetCompressMode : uint32_t
+{
+	NONE,	// ѹ
+	FAST,	// ѹ
+	DICT,	// ʹԤֵѹ,շ˫ֵͬ
+};
+
+// ѹϢͷ,λMT_COMPRESSϢݵʼλ
+#pragma pack(4)
+struct NetCompressHead
+{
+	uint32_t rawLen;		// ѹǰ
+	NetCompressMode mode;	// ѹģʽ
+	uint32_t dictID;		// DICTģʽΪֵݵCRC32C,ѹʱֵ䲻һ
+};
+#pragma pack()
+
+// ѹͳ
+struct NetCompressStats
+{
+	uint64_t sendRawBytes;		// ѹǰֽ
+	uint64_t sendCompressBytes;	// ѹֽ
+	uint64_t compressTime;		// ѹʱ()
+	uint64_t recvRawBytes;		// սѹֽ
+	uint64_t recvCompressBytes;	// սѹǰֽ
+	uint64_t decompressTime;	// ѹʱ()
+};
+
+// Ԥֵ(ڹ),ֵĹϣڴԤȼ
+// ̵߳,ѹ/ѹϢʹþֵ
+// ֻ64KЧ
+void net_setCompressDict(const char* dict, uint32_t len);
+
+// ѹϢ,صݰNetCompressHead
+// ѹûбСʱNULL
+char* net_compressMsg(NetCompressMode mode, const char* data, uint32_t len, uint32_t* outLen, NetCompressStats* stats);
+
+// ѹϢ,ݲϷѹ󳤶ȳmaxLenʱNULL
+char* net_decompressMsg(const char* data, uint32_t len, uint32_t maxLen, uint32_t* outLen, NetCompressStats* stats);
+
+// ѹͳ
+void net_logCompressStats(const char* name, uint32_t sessionID, const NetCompressStats& stats);
+
+NS_NET_UV_END
\ No newline at end of file
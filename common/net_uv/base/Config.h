@@ -29,4 +29,7 @@
 
 #endif
 
+// ¼ѭͳ
+#define OPEN_NET_UV_STATS 1
+
 
@@ -2,6 +2,20 @@
 #include <time.h>
 #include "DNSCache.h"
 
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#include <nmmintrin.h>
+#define NET_CRC32C_HW 1
+#define NET_CRC32C_TARGET
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <cpuid.h>
+#include <nmmintrin.h>
+#define NET_CRC32C_HW 1
+#define NET_CRC32C_TARGET __attribute__((target("sse4.2")))
+#else
+#define NET_CRC32C_HW 0
+#endif
+
 NS_NET_UV_BEGIN
 
 
@@ -87,6 +101,61 @@ void net_adjustBuffSize(uv_handle_t* handle, int32_t minRecvBufSize, int32_t min
 	}
 }
 
+bool net_udp_setReusePort(uv_udp_t* handle)
+{
+#if defined(SO_REUSEPORT)
+	uv_os_fd_t fd;
+	int32_t r = uv_fileno((uv_handle_t*)handle, &fd);
+	if (r != 0)
+	{
+		NET_UV_LOG(NET_UV_L_ERROR, "uv_fileno error: %s", net_getUVError(r).c_str());
+		return false;
+	}
+
+	int32_t yes = 1;
+	if (setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, (const char*)&yes, sizeof(yes)) != 0)
+	{
+		NET_UV_LOG(NET_UV_L_ERROR, "setsockopt SO_REUSEPORT error");
+		return false;
+	}
+	return true;
+#else
+	return false;
+#endif
+}
+
+bool net_udp_setIPV6Only(uv_udp_t* handle, bool only)
+{
+#if defined(IPV6_V6ONLY)
+	uv_os_fd_t fd;
+	int32_t r = uv_fileno((uv_handle_t*)handle, &fd);
+	if (r != 0)
+	{
+		NET_UV_LOG(NET_UV_L_ERROR, "uv_fileno error: %s", net_getUVError(r).c_str());
+		return false;
+	}
+
+	int32_t value = only ? 1 : 0;
+	if (setsockopt(fd, IPPROTO_IPV6, IPV6_V6ONLY, (const char*)&value, sizeof(value)) != 0)
+	{
+		NET_UV_LOG(NET_UV_L_ERROR, "setsockopt IPV6_V6ONLY error");
+		return false;
+	}
+
+	// ȷЧ
+	int32_t result = -1;
+	socklen_t resultLen = sizeof(result);
+	if (getsockopt(fd, IPPROTO_IPV6, IPV6_V6ONLY, (char*)&result, &resultLen) != 0 || (result != 0) != only)
+	{
+		NET_UV_LOG(NET_UV_L_ERROR, "getsockopt IPV6_V6ONLY mismatch");
+		return false;
+	}
+	return true;
+#else
+	return false;
+#endif
+}
+
 // hash
 uint32_t net_getBufHash(const void *buf, uint32_t len)
 {
@@ -103,6 +172,183 @@ uint32_t net_getBufHash(const void *buf, uint32_t len)
 	return (hash & 0x7FFFFFFF);
 }
 
+// CRC32Cʽ
+#define NET_CRC32C_POLY 0x82F63B78
+
+// ʵ:ÿδ8ֽ(slicing-by-8)
+struct CRC32CTable
+{
+	uint32_t table[8][256];
+	// x^(2^n) mod p,ںϲ
+	uint32_t x2n[32];
+
+	CRC32CTable()
+	{
+		for (uint32_t i = 0; i < 256; ++i)
+		{
+			uint32_t crc = i;
+			for (int32_t k = 0; k < 8; ++k)
+			{
+				crc = (crc & 1) ? (crc >> 1) ^ NET_CRC32C_POLY : crc >> 1;
+			}
+			table[0][i] = crc;
+		}
+		for (uint32_t i = 0; i < 256; ++i)
+		{
+			for (int32_t k = 1; k < 8; ++k)
+			{
+				table[k][i] = (table[k - 1][i] >> 8) ^ table[0][table[k - 1][i] & 0xFF];
+			}
+		}
+
+		// x^1
+		uint32_t p = 1U << 30;
+		x2n[0] = p;
+		for (int32_t n = 1; n < 32; ++n)
+		{
+			x2n[n] = p = multModP(p, p);
+		}
+	}
+
+	// a * b mod p
+	static uint32_t multModP(uint32_t a, uint32_t b)
+	{
+		uint32_t m = 1U << 31;
+		uint32_t p = 0;
+		while (true)
+		{
+			if (a & m)
+			{
+				p ^= b;
+				if ((a & (m - 1)) == 0)
+				{
+					break;
+				}
+			}
+			m >>= 1;
+			b = (b & 1) ? (b >> 1) ^ NET_CRC32C_POLY : b >> 1;
+		}
+		return p;
+	}
+};
+
+static const CRC32CTable& net_crc32cTable()
+{
+	static CRC32CTable table;
+	return table;
+}
+
+static uint32_t net_crc32cSoft(uint32_t crc, const uint8_t* data, uint32_t len)
+{
+	const CRC32CTable& t = net_crc32cTable();
+	while (len > 0 && ((uintptr_t)data & 7) != 0)
+	{
+		crc = (crc >> 8) ^ t.table[0][(crc ^ *data++) & 0xFF];
+		--len;
+	}
+	while (len >= 8)
+	{
+		uint32_t lo, hi;
+		memcpy(&lo, data, 4);
+		memcpy(&hi, data + 4, 4);
+		lo ^= crc;
+		crc = t.table[7][lo & 0xFF] ^ t.table[6][(lo >> 8) & 0xFF] ^ t.table[5][(lo >> 16) & 0xFF] ^ t.table[4][lo >> 24]
+			^ t.table[3][hi & 0xFF] ^ t.table[2][(hi >> 8) & 0xFF] ^ t.table[1][(hi >> 16) & 0xFF] ^ t.table[0][hi >> 24];
+		data += 8;
+		len -= 8;
+	}
+	while (len > 0)
+	{
+		crc = (crc >> 8) ^ t.table[0][(crc ^ *data++) & 0xFF];
+		--len;
+	}
+	return crc;
+}
+
+#if NET_CRC32C_HW == 1
+NET_CRC32C_TARGET static uint32_t net_crc32cHW(uint32_t crc, const uint8_t* data, uint32_t len)
+{
+	while (len > 0 && ((uintptr_t)data & 7) != 0)
+	{
+		crc = _mm_crc32_u8(crc, *data++);
+		--len;
+	}
+#if defined(_M_X64) || defined(__x86_64__)
+	uint64_t crc64 = crc;
+	while (len >= 8)
+	{
+		uint64_t v;
+		memcpy(&v, data, 8);
+		crc64 = _mm_crc32_u64(crc64, v);
+		data += 8;
+		len -= 8;
+	}
+	crc = (uint32_t)crc64;
+#endif
+	while (len >= 4)
+	{
+		uint32_t v;
+		memcpy(&v, data, 4);
+		crc = _mm_crc32_u32(crc, v);
+		data += 4;
+		len -= 4;
+	}
+	while (len > 0)
+	{
+		crc = _mm_crc32_u8(crc, *data++);
+		--len;
+	}
+	return crc;
+}
+
+static bool net_crc32cCheckHW()
+{
+#if defined(_MSC_VER)
+	int32_t info[4];
+	__cpuid(info, 1);
+	return (info[2] & (1 << 20)) != 0;
+#else
+	uint32_t eax, ebx, ecx, edx;
+	if (__get_cpuid(1, &eax, &ebx, &ecx, &edx) == 0)
+	{
+		return false;
+	}
+	return (ecx & bit_SSE4_2) != 0;
+#endif
+}
+#endif
+
+uint32_t net_crc32c(uint32_t crc, const void* buf, uint32_t len)
+{
+	crc = ~crc;
+#if NET_CRC32C_HW == 1
+	static const bool isHW = net_crc32cCheckHW();
+	if (isHW)
+	{
+		return ~net_crc32cHW(crc, (const uint8_t*)buf, len);
+	}
+#endif
+	return ~net_crc32cSoft(crc, (const uint8_t*)buf, len);
+}
+
+uint32_t net_crc32cCombine(uint32_t crc1, uint32_t crc2, uint64_t len2)
+{
+	// crc1 * x^(8 * len2) mod p ^ crc2
+	const CRC32CTable& t = net_crc32cTable();
+	uint32_t p = 1U << 31;
+	uint32_t k = 3;
+	while (len2 > 0)
+	{
+		if (len2 & 1)
+		{
+			p = CRC32CTable::multModP(t.x2n[k & 31], p);
+		}
+		len2 >>= 1;
+		++k;
+	}
+	return CRC32CTable::multModP(p, crc1) ^ crc2;
+}
+
 uint32_t net_getsockAddrIPAndPort(const struct sockaddr* addr, std::string& outIP, uint32_t& outPort)
 {
 	if (addr == NULL)
@@ -17,9 +17,24 @@ void net_closeHandle(uv_handle_t* handle, uv_close_cb closecb);
 // socketС
 void net_adjustBuffSize(uv_handle_t* handle, int32_t minRecvBufSize, int32_t minSendBufSize);
 
+// SO_REUSEPORT,׽ֿɰͬһ˿,ں˰Ԫݰ
+// bind֮ǰ,ϵͳ֧ʱfalse
+bool net_udp_setReusePort(uv_udp_t* handle);
+
+// IPV6_V6ONLY,رպIPV6׽ֿͬʱշIPV4ӳַ
+// bind֮ǰ,ϵͳĬֵͬ(Linuxȡbindv6only,WindowsĬϿ)
+bool net_udp_setIPV6Only(uv_udp_t* handle, bool only);
+
 //hash
 uint32_t net_getBufHash(const void *buf, uint32_t len);
 
+// CRC32C(Castagnoli),֧SSE4.2CPUʹcrc32ָ
+// ɷֶμ:net_crc32c(net_crc32c(0, a, lenA), b, lenB) == net_crc32c(0, ab, lenA + lenB)
+uint32_t net_crc32c(uint32_t crc, const void* buf, uint32_t len);
+
+// ϲݵCRC32C,crc2Ϊlen2ĺһݵУֵ
+uint32_t net_crc32cCombine(uint32_t crc1, uint32_t crc2, uint64_t len2);
+
 uint32_t net_getsockAddrIPAndPort(const struct sockaddr* addr, std::string& outIP, uint32_t& outPort);
 
 struct sockaddr* net_getsocketAddr(const char* ip, uint32_t port, uint32_t* outAddrLen);
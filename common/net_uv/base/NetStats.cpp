@@ -0,0 +1,165 @@
+#include "NetStats.h"
+
+NS_NET_UV_BEGIN
+
+NetHistogram::NetHistogram()
+{
+	reset();
+}
+
+uint32_t NetHistogram::getBucketIndex(uint64_t value)
+{
+	if (value < NET_HISTOGRAM_SUB_COUNT)
+	{
+		return (uint32_t)value;
+	}
+	// λλ
+	uint32_t msb = 0;
+	uint64_t v = value;
+	while (v >>= 1)
+	{
+		msb++;
+	}
+	uint32_t shift = msb - NET_HISTOGRAM_SUB_BITS;
+	return (shift + 1) * NET_HISTOGRAM_SUB_COUNT + (uint32_t)((value >> shift) & (NET_HISTOGRAM_SUB_COUNT - 1));
+}
+
+uint64_t NetHistogram::getBucketValue(uint32_t index)
+{
+	if (index < NET_HISTOGRAM_SUB_COUNT)
+	{
+		return index;
+	}
+	uint32_t shift = index / NET_HISTOGRAM_SUB_COUNT - 1;
+	uint64_t low = (uint64_t)(NET_HISTOGRAM_SUB_COUNT + index % NET_HISTOGRAM_SUB_COUNT) << shift;
+	return low + ((uint64_t)1 << shift) - 1;
+}
+
+void NetHistogram::record(uint64_t value)
+{
+	m_buckets[getBucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+	m_sum.fetch_add(value, std::memory_order_relaxed);
+
+	uint64_t cur = m_min.load(std::memory_order_relaxed);
+	while (value < cur && !m_min.compare_exchange_weak(cur, value, std::memory_order_relaxed))
+	{}
+
+	cur = m_max.load(std::memory_order_relaxed);
+	while (value > cur && !m_max.compare_exchange_weak(cur, value, std::memory_order_relaxed))
+	{}
+}
+
+void NetHistogram::snapshot(NetHistogramSnapshot& snapshot)
+{
+	memset(&snapshot, 0, sizeof(NetHistogramSnapshot));
+
+	uint64_t counts[NET_HISTOGRAM_BUCKET_COUNT];
+	for (uint32_t i = 0; i < NET_HISTOGRAM_BUCKET_COUNT; ++i)
+	{
+		counts[i] = m_buckets[i].load(std::memory_order_relaxed);
+		snapshot.count += counts[i];
+	}
+	if (snapshot.count == 0)
+	{
+		return;
+	}
+
+	snapshot.min = m_min.load(std::memory_order_relaxed);
+	snapshot.max = m_max.load(std::memory_order_relaxed);
+	snapshot.mean = m_sum.load(std::memory_order_relaxed) / snapshot.count;
+
+	struct
+	{
+		uint64_t* value;
+		uint32_t permille;
+	} percentArr[] =
+	{
+		{ &snapshot.p50, 500 },
+		{ &snapshot.p90, 900 },
+		{ &snapshot.p99, 990 },
+		{ &snapshot.p999, 999 },
+	};
+
+	uint64_t total = 0;
+	uint32_t curPercent = 0;
+	uint32_t percentCount = sizeof(percentArr) / sizeof(percentArr[0]);
+	for (uint32_t i = 0; i < NET_HISTOGRAM_BUCKET_COUNT && curPercent < percentCount; ++i)
+	{
+		total += counts[i];
+		while (curPercent < percentCount && total * 1000 >= snapshot.count * percentArr[curPercent].permille)
+		{
+			// Ͱֵʵʼ¼ֵ
+			uint64_t value = getBucketValue(i);
+			*percentArr[curPercent].value = (value > snapshot.max) ? snapshot.max : value;
+			curPercent++;
+		}
+	}
+}
+
+void NetHistogram::reset()
+{
+	for (uint32_t i = 0; i < NET_HISTOGRAM_BUCKET_COUNT; ++i)
+	{
+		m_buckets[i].store(0, std::memory_order_relaxed);
+	}
+	m_sum.store(0, std::memory_order_relaxed);
+	m_min.store(UINT64_MAX, std::memory_order_relaxed);
+	m_max.store(0, std::memory_order_relaxed);
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+NetLoopStats::NetLoopStats()
+	: m_curOperationQueDepth(0)
+	, m_curMsgQueDepth(0)
+	, m_bytesIn(0)
+	, m_msgsIn(0)
+	, m_bytesOut(0)
+	, m_msgsOut(0)
+	, m_loopStartTime(0)
+{}
+
+void NetLoopStats::snapshot(NetLoopStatsSnapshot& snapshot)
+{
+	m_loopTime.snapshot(snapshot.loopTime);
+	m_operationDelay.snapshot(snapshot.operationDelay);
+	m_recvDelay.snapshot(snapshot.recvDelay);
+	m_operationQueDepth.snapshot(snapshot.operationQueDepth);
+	m_msgQueDepth.snapshot(snapshot.msgQueDepth);
+	m_writeQueBytes.snapshot(snapshot.writeQueBytes);
+
+	snapshot.curOperationQueDepth = m_curOperationQueDepth.load(std::memory_order_relaxed);
+	snapshot.curMsgQueDepth = m_curMsgQueDepth.load(std::memory_order_relaxed);
+	snapshot.bytesIn = m_bytesIn.load(std::memory_order_relaxed);
+	snapshot.msgsIn = m_msgsIn.load(std::memory_order_relaxed);
+	snapshot.bytesOut = m_bytesOut.load(std::memory_order_relaxed);
+	snapshot.msgsOut = m_msgsOut.load(std::memory_order_relaxed);
+}
+
+void NetLoopStats::reset()
+{
+	m_loopTime.reset();
+	m_operationDelay.reset();
+	m_recvDelay.reset();
+	m_operationQueDepth.reset();
+	m_msgQueDepth.reset();
+	m_writeQueBytes.reset();
+
+	m_bytesIn.store(0, std::memory_order_relaxed);
+	m_msgsIn.store(0, std::memory_order_relaxed);
+	m_bytesOut.store(0, std::memory_order_relaxed);
+	m_msgsOut.store(0, std::memory_order_relaxed);
+}
+
+uint64_t NetLoopStats::getDelay(uint64_t pushTime)
+{
+	uint64_t curTime = uv_hrtime();
+	if (curTime <= pushTime)
+	{
+		return 0;
+	}
+	// תΪ΢
+	return (curTime - pushTime) / 1000;
+}
+
+NS_NET_UV_END
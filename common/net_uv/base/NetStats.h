@@ -0,0 +1,269 @@
+#pragma once
+
+#include "Common.h"
+#include <atomic>
+
+NS_NET_UV_BEGIN
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/// ¼ѭͳ
+/// UV̺̼߳߳¼ʱֻԭӼӷ,;߳̿ʱȡ
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// ֱͼͰ:С8ֵռһͰ,֮ÿ2ٷΪ8Ͱ,12.5%
+#define NET_HISTOGRAM_SUB_BITS 3
+#define NET_HISTOGRAM_SUB_COUNT (1 << NET_HISTOGRAM_SUB_BITS)
+#define NET_HISTOGRAM_BUCKET_COUNT ((64 - NET_HISTOGRAM_SUB_BITS + 1) * NET_HISTOGRAM_SUB_COUNT)
+
+struct NetHistogramSnapshot
+{
+	uint64_t count;
+	uint64_t min;
+	uint64_t max;
+	uint64_t mean;
+	uint64_t p50;
+	uint64_t p90;
+	uint64_t p99;
+	uint64_t p999;
+};
+
+class NetHistogram
+{
+public:
+	NetHistogram();
+
+	NetHistogram(const NetHistogram&) = delete;
+
+	void record(uint64_t value);
+
+	// ȡڼĲ¼ֻвּ,֮΢Сƫ
+	void snapshot(NetHistogramSnapshot& snapshot);
+
+	void reset();
+
+protected:
+
+	static uint32_t getBucketIndex(uint64_t value);
+
+	// Ͱڵֵ
+	static uint64_t getBucketValue(uint32_t index);
+
+protected:
+	std::atomic<uint64_t> m_buckets[NET_HISTOGRAM_BUCKET_COUNT];
+	std::atomic<uint64_t> m_sum;
+	std::atomic<uint64_t> m_min;
+	std::atomic<uint64_t> m_max;
+};
+
+//////////////////////////////////////////////////////////////////////////
+
+struct NetLoopStatsSnapshot
+{
+	// ¼ѭεʱ(΢),ʱ
+	NetHistogramSnapshot loopTime;
+	// pushOperationUVִ߳еӳ(΢)
+	NetHistogramSnapshot operationDelay;
+	// UV߳յϢupdateFrameͶݵӳ(΢)
+	NetHistogramSnapshot recvDelay;
+	// ÿδʱеĳ
+	NetHistogramSnapshot operationQueDepth;
+	// ÿδʱϢеĳ
+	NetHistogramSnapshot msgQueDepth;
+	// Ựдֽ,Ự¶ʱв
+	NetHistogramSnapshot writeQueBytes;
+
+	// ǰг
+	uint64_t curOperationQueDepth;
+	uint64_t curMsgQueDepth;
+
+	// ͶݸӦòϢ
+	uint64_t bytesIn;
+	uint64_t msgsIn;
+	// Ӧò㷢͵Ϣ
+	uint64_t bytesOut;
+	uint64_t msgsOut;
+};
+
+class NetLoopStats
+{
+public:
+	NetLoopStats();
+
+	NetLoopStats(const NetLoopStats&) = delete;
+
+	void snapshot(NetLoopStatsSnapshot& snapshot);
+
+	void reset();
+
+	// ʱ,رͳʱΪ0
+	inline static uint64_t getPushTime();
+
+	// UV̵߳: ¼ѭ߽/ʼ
+	inline void beginLoop();
+
+	inline void endLoop();
+
+	// ʱ(Ѽ)
+	inline void onPushOperation(size_t queDepth);
+
+	inline void onPushMsg(size_t queDepth);
+
+	// ȡʱ(Ѽ)
+	inline void onDispatchOperation(size_t queDepth);
+
+	inline void onDispatchMsg(size_t queDepth);
+
+	// UVִ߳вʱ
+	inline void onExecuteOperation(uint64_t pushTime);
+
+	// ߳ͶյϢʱ
+	inline void onRecvMsg(uint64_t pushTime, uint32_t len);
+
+	// Ӧò㷢Ϣʱ
+	inline void onSendMsg(uint32_t len);
+
+	// UV̲߳Ựд
+	inline void onSampleWriteQue(uint32_t bytes);
+
+protected:
+
+	static uint64_t getDelay(uint64_t pushTime);
+
+protected:
+	NetHistogram m_loopTime;
+	NetHistogram m_operationDelay;
+	NetHistogram m_recvDelay;
+	NetHistogram m_operationQueDepth;
+	NetHistogram m_msgQueDepth;
+	NetHistogram m_writeQueBytes;
+
+	std::atomic<uint64_t> m_curOperationQueDepth;
+	std::atomic<uint64_t> m_curMsgQueDepth;
+	std::atomic<uint64_t> m_bytesIn;
+	std::atomic<uint64_t> m_msgsIn;
+	std::atomic<uint64_t> m_bytesOut;
+	std::atomic<uint64_t> m_msgsOut;
+
+	// ¼ѭʼʱ,UV̷߳
+	uint64_t m_loopStartTime;
+};
+
+uint64_t NetLoopStats::getPushTime()
+{
+#if OPEN_NET_UV_STATS == 1
+	return uv_hrtime();
+#else
+	return 0;
+#endif
+}
+
+void NetLoopStats::beginLoop()
+{
+#if OPEN_NET_UV_STATS == 1
+	m_loopStartTime = uv_hrtime();
+#endif
+}
+
+void NetLoopStats::endLoop()
+{
+#if OPEN_NET_UV_STATS == 1
+	if (m_loopStartTime > 0)
+	{
+		m_loopTime.record(getDelay(m_loopStartTime));
+	}
+#endif
+}
+
+void NetLoopStats::onPushOperation(size_t queDepth)
+{
+#if OPEN_NET_UV_STATS == 1
+	m_curOperationQueDepth.store(queDepth, std::memory_order_relaxed);
+#endif
+}
+
+void NetLoopStats::onPushMsg(size_t queDepth)
+{
+#if OPEN_NET_UV_STATS == 1
+	m_curMsgQueDepth.store(queDepth, std::memory_order_relaxed);
+#endif
+}
+
+void NetLoopStats::onDispatchOperation(size_t queDepth)
+{
+#if OPEN_NET_UV_STATS == 1
+	m_operationQueDepth.record(queDepth);
+	m_curOperationQueDepth.store(0, std::memory_order_relaxed);
+#endif
+}
+
+void NetLoopStats::onDispatchMsg(size_t queDepth)
+{
+#if OPEN_NET_UV_STATS == 1
+	m_msgQueDepth.record(queDepth);
+	m_curMsgQueDepth.store(0, std::memory_order_relaxed);
+#endif
+}
+
+void NetLoopStats::onExecuteOperation(uint64_t pushTime)
+{
+#if OPEN_NET_UV_STATS == 1
+	m_operationDelay.record(getDelay(pushTime));
+#endif
+}
+
+void NetLoopStats::onRecvMsg(uint64_t pushTime, uint32_t len)
+{
+#if OPEN_NET_UV_STATS == 1
+	m_recvDelay.record(getDelay(pushTime));
+	m_bytesIn.fetch_add(len, std::memory_order_relaxed);
+	m_msgsIn.fetch_add(1, std::memory_order_relaxed);
+#endif
+}
+
+void NetLoopStats::onSendMsg(uint32_t len)
+{
+#if OPEN_NET_UV_STATS == 1
+	m_bytesOut.fetch_add(len, std::memory_order_relaxed);
+	m_msgsOut.fetch_add(1, std::memory_order_relaxed);
+#endif
+}
+
+void NetLoopStats::onSampleWriteQue(uint32_t bytes)
+{
+#if OPEN_NET_UV_STATS == 1
+	m_writeQueBytes.record(bytes);
+#endif
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+// Ự
+// UVֱ߳ۼ,ѯʱUV̻߳ܺͶݸ߳
+struct NetSessionTraffic
+{
+	uint32_t sessionID;
+	// ׽ַ͵ֽݿ,鳤ȵϢʱΪ
+	uint64_t sendBytes;
+	uint64_t sendMsgs;
+	// Ϣֽ(Ϣͷ)Ϣ,
+	uint64_t recvBytes;
+	uint64_t recvMsgs;
+	// Ϣ:Ựʱ͵ϢϷڵϢ
+	uint64_t dropMsgs;
+	// շ()ʱ(uv_hrtime),ΪỰ¶ʱ
+	uint64_t lastActiveTime;
+	// շ(ֽ/)
+	uint64_t sendRate;
+	uint64_t recvRate;
+	// ѯʱȴ͵ֽ
+	uint32_t writeQueBytes;
+};
+
+// ȵỰʽ
+enum class NetHotSessionSort : uint32_t
+{
+	BANDWIDTH,		// շ֮
+	WRITE_QUEUE,	// ȴ͵ֽ
+};
+
+NS_NET_UV_END
@@ -8,6 +8,7 @@ Server::Server()
 	, m_newConnectCall(nullptr)
 	, m_recvCall(nullptr)
 	, m_disconnectCall(nullptr)
+	, m_hotSessionCall(nullptr)
 	, m_port(0)
 	, m_listenPort(0)
 	, m_isIPV6(false)
@@ -44,9 +45,11 @@ void Server::pushThreadMsg(NetThreadMsgType type, Session* session, char* data,
 	msg.data = data;
 	msg.dataLen = len;
 	msg.pSession = session;
+	msg.pushTime = NetLoopStats::getPushTime();
 
 	m_msgMutex.lock();
 	m_msgQue.push(msg);
+	m_loopStats.onPushMsg(m_msgQue.size());
 	m_msgMutex.unlock();
 }
 
@@ -117,7 +120,9 @@ void Server::uv_on_idle_run(uv_idle_t* handle)
 {
 	Server* svr = (Server*)handle->data;
 	svr->onIdleRun();
+	svr->m_loopStats.endLoop();
 	ThreadSleep(1);
+	svr->m_loopStats.beginLoop();
 }
 
 void Server::uv_on_session_update_timer_run(uv_timer_t* handle)
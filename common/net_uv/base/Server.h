@@ -13,6 +13,7 @@ using ServerCloseCall = std::function<void(Server* svr)>;
 using ServerNewConnectCall = std::function<void(Server* svr, Session* session)>;
 using ServerRecvCall = std::function<void(Server* svr, Session* session, char* data, uint32_t len)>;
 using ServerDisconnectCall = std::function<void(Server* svr, Session* session)>;
+using ServerHotSessionCall = std::function<void(Server* svr, NetSessionTraffic* arr, uint32_t count)>;
 
 //׶
 enum class ServerStage
@@ -45,6 +46,11 @@ public:
 
 	inline void setDisconnectCallback(const ServerDisconnectCall& call);
 
+	// ѯcountỰ,updateFrameͨص
+	virtual void queryHotSession(uint32_t count, NetHotSessionSort sort) = 0;
+
+	inline void setHotSessionCallback(const ServerHotSessionCall& call);
+
 	virtual std::string getIP();
 	
 	virtual uint32_t getPort();
@@ -84,6 +90,7 @@ protected:
 	ServerNewConnectCall m_newConnectCall;
 	ServerRecvCall m_recvCall;
 	ServerDisconnectCall m_disconnectCall;
+	ServerHotSessionCall m_hotSessionCall;
 
 	// ߳Ϣ
 	Mutex m_msgMutex;
@@ -123,6 +130,11 @@ void Server::setDisconnectCallback(const ServerDisconnectCall& call)
 	m_disconnectCall = std::move(call);
 }
 
+void Server::setHotSessionCallback(const ServerHotSessionCall& call)
+{
+	m_hotSessionCall = std::move(call);
+}
+
 void Server::setListenPort(uint32_t port)
 {
 	m_listenPort = port;
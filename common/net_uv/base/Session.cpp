@@ -9,7 +9,11 @@ Session::Session(SessionManager* manager)
 	, m_sessionID(-1)
 	, m_sessionRecvCallback(nullptr)
 	, m_sessionCloseCallback(nullptr)
-{}
+	, m_lastSendBytes(0)
+	, m_lastRecvBytes(0)
+{
+	memset(&m_traffic, 0, sizeof(NetSessionTraffic));
+}
 
 Session::~Session()
 {}
@@ -28,4 +32,31 @@ void Session::setIsOnline(bool bIsOnline)
 {
 	m_isOnline = bIsOnline;
 }
+
+void Session::updateTraffic(uint32_t time)
+{
+	if (time <= 0)
+		return;
+
+	uint64_t sendBytes = m_traffic.sendBytes - m_lastSendBytes;
+	uint64_t recvBytes = m_traffic.recvBytes - m_lastRecvBytes;
+	m_lastSendBytes = m_traffic.sendBytes;
+	m_lastRecvBytes = m_traffic.recvBytes;
+
+	if (sendBytes > 0 || recvBytes > 0)
+	{
+		m_traffic.lastActiveTime = uv_hrtime() / 1000000;
+	}
+
+	// һڵȡƽ,ٲ
+	m_traffic.sendRate = (m_traffic.sendRate + sendBytes * 1000 / time) / 2;
+	m_traffic.recvRate = (m_traffic.recvRate + recvBytes * 1000 / time) / 2;
+}
+
+void Session::getTraffic(NetSessionTraffic& traffic)
+{
+	traffic = m_traffic;
+	traffic.sessionID = m_sessionID;
+	traffic.writeQueBytes = getWriteQueueSize();
+}
 NS_NET_UV_END
\ No newline at end of file
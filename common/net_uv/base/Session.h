@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Common.h"
+#include "NetStats.h"
 
 NS_NET_UV_BEGIN
 
@@ -35,6 +36,9 @@ protected:
 
 	virtual void update(uint32_t time) = 0;
 
+	// ύδд׽ֵֽ,UV̵߳
+	virtual uint32_t getWriteQueueSize() = 0;
+
 protected:
 		
 	inline SessionManager* getSessionManager();
@@ -49,6 +53,12 @@ protected:
 
 	inline void setSessionID(uint32_t sessionId);
 
+	// Ự¶ʱе,շ
+	void updateTraffic(uint32_t time);
+
+	// UV̵߳
+	void getTraffic(NetSessionTraffic& traffic);
+
 protected:
 	friend class SessionManager;
 
@@ -59,6 +69,12 @@ protected:
 
 	bool m_isOnline;
 	uint32_t m_sessionID;
+
+	// ͳ,UV̷߳
+	NetSessionTraffic m_traffic;
+	// ϴμʱշֽ
+	uint64_t m_lastSendBytes;
+	uint64_t m_lastRecvBytes;
 };
 
 
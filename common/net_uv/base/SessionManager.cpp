@@ -1,4 +1,6 @@
 #include "SessionManager.h"
+#include "Misc.h"
+#include <algorithm>
 
 NS_NET_UV_BEGIN
 
@@ -15,12 +17,141 @@ void SessionManager::pushOperation(int32_t type, void* data, uint32_t len, uint3
 	operationData.operationData = data;
 	operationData.operationDataLen = len;
 	operationData.sessionID = sessionID;
+	operationData.pushTime = NetLoopStats::getPushTime();
 
 	m_operationMutex.lock();
 	m_operationQue.push(operationData);
+	m_loopStats.onPushOperation(m_operationQue.size());
 	m_operationMutex.unlock();
 }
 
+void SessionManager::setCompressSession(uint32_t sessionID, bool isCompress)
+{
+	m_compressMutex.lock();
+	if (isCompress)
+	{
+		m_compressSessionSet.insert(sessionID);
+	}
+	else
+	{
+		m_compressSessionSet.erase(sessionID);
+	}
+	m_compressMutex.unlock();
+}
+
+bool SessionManager::isCompressSession(uint32_t sessionID)
+{
+	m_compressMutex.lock();
+	bool isCompress = m_compressSessionSet.empty() ? false : m_compressSessionSet.count(sessionID) > 0;
+	m_compressMutex.unlock();
+	return isCompress;
+}
+
+bool SessionManager::checkStreamSendLen(uint32_t sessionID, uint32_t len, uint32_t maxLen)
+{
+	if (len > maxLen)
+	{
+		return false;
+	}
+
+	bool isOK = true;
+	m_streamSendMutex.lock();
+	auto it = m_streamSendMap.find(sessionID);
+	if (it != m_streamSendMap.end())
+	{
+		uint64_t totalLen = (uint64_t)it->second.operationLen + it->second.writeQueLen + len;
+		isOK = (totalLen <= maxLen);
+	}
+	m_streamSendMutex.unlock();
+	return isOK;
+}
+
+void SessionManager::addStreamSendLen(uint32_t sessionID, uint32_t len)
+{
+	m_streamSendMutex.lock();
+	auto it = m_streamSendMap.find(sessionID);
+	if (it == m_streamSendMap.end())
+	{
+		StreamSendLen sendLen;
+		sendLen.operationLen = len;
+		sendLen.writeQueLen = 0;
+		m_streamSendMap.insert(std::make_pair(sessionID, sendLen));
+	}
+	else
+	{
+		it->second.operationLen += len;
+	}
+	m_streamSendMutex.unlock();
+}
+
+void SessionManager::updateStreamSendLen(uint32_t sessionID, uint32_t executedLen, uint32_t writeQueLen)
+{
+	m_streamSendMutex.lock();
+	auto it = m_streamSendMap.find(sessionID);
+	if (it != m_streamSendMap.end())
+	{
+		it->second.operationLen = (it->second.operationLen > executedLen) ? it->second.operationLen - executedLen : 0;
+		it->second.writeQueLen = writeQueLen;
+		// ȫд׽
+		if (it->second.operationLen == 0 && writeQueLen == 0)
+		{
+			m_streamSendMap.erase(it);
+		}
+	}
+	m_streamSendMutex.unlock();
+}
+
+void SessionManager::clearStreamSendLen(uint32_t sessionID)
+{
+	m_streamSendMutex.lock();
+	m_streamSendMap.erase(sessionID);
+	m_streamSendMutex.unlock();
+}
+
+void SessionManager::getLoopStats(NetLoopStatsSnapshot& snapshot)
+{
+	m_loopStats.snapshot(snapshot);
+}
+
+void SessionManager::resetLoopStats()
+{
+	m_loopStats.reset();
+}
+
+NetSessionTraffic* SessionManager::makeHotSessionReport(const std::vector<Session*>& sessionArr, uint32_t count, NetHotSessionSort sort, uint32_t* outCount)
+{
+	*outCount = 0;
+	if (sessionArr.empty() || count <= 0)
+	{
+		return NULL;
+	}
+
+	std::vector<NetSessionTraffic> trafficArr(sessionArr.size());
+	for (size_t i = 0; i < sessionArr.size(); ++i)
+	{
+		sessionArr[i]->getTraffic(trafficArr[i]);
+	}
+
+	auto cmp = [=](const NetSessionTraffic& a, const NetSessionTraffic& b)
+	{
+		if (sort == NetHotSessionSort::WRITE_QUEUE)
+		{
+			return a.writeQueBytes > b.writeQueBytes;
+		}
+		return a.sendRate + a.recvRate > b.sendRate + b.recvRate;
+	};
+
+	if (count > trafficArr.size())
+	{
+		count = (uint32_t)trafficArr.size();
+	}
+	std::partial_sort(trafficArr.begin(), trafficArr.begin() + count, trafficArr.end(), cmp);
+
+	NetSessionTraffic* arr = (NetSessionTraffic*)fc_malloc(sizeof(NetSessionTraffic) * count);
+	memcpy(arr, trafficArr.data(), sizeof(NetSessionTraffic) * count);
+	*outCount = count;
+	return arr;
+}
 
 NS_NET_UV_END
 
@@ -3,6 +3,10 @@
 #include "Common.h"
 #include "Session.h"
 #include "Mutex.h"
+#include "NetStats.h"
+#include <vector>
+#include <set>
+#include <map>
 
 NS_NET_UV_BEGIN
 
@@ -17,12 +21,36 @@ public:
 	virtual void send(uint32_t sessionID, char* data, uint32_t len) = 0;
 
 	virtual void disconnect(uint32_t sessionID) = 0;
+
+	// ¼ѭͳƿ,̵߳
+	void getLoopStats(NetLoopStatsSnapshot& snapshot);
+
+	void resetLoopStats();
 	
 protected:
 
 	void pushOperation(int32_t type, void* data, uint32_t len, uint32_t sessionID);
 
 	virtual void executeOperation() = 0;
+
+	// UV̵߳: sortȡǰcountỰ,صfc_malloc,ûлỰʱNULL
+	NetSessionTraffic* makeHotSessionReport(const std::vector<Session*>& sessionArr, uint32_t count, NetHotSessionSort sort, uint32_t* outCount);
+
+	// ̼߳¼ѹĻỰ,δѹĻỰʱֱӴ,追
+	void setCompressSession(uint32_t sessionID, bool isCompress);
+
+	bool isCompressSession(uint32_t sessionID);
+
+	// ̷߳ǰỰķͻ,len󳬹maxLenʱfalse
+	bool checkStreamSendLen(uint32_t sessionID, uint32_t len, uint32_t maxLen);
+
+	// ̼߳¼ύеƬ
+	void addStreamSendLen(uint32_t sessionID, uint32_t len);
+
+	// UV̵߳: executedLenΪִеƬ,writeQueLenΪỰǰдг
+	void updateStreamSendLen(uint32_t sessionID, uint32_t executedLen, uint32_t writeQueLen);
+
+	void clearStreamSendLen(uint32_t sessionID);
 	
 protected:
 
@@ -32,11 +60,26 @@ protected:
 		void* operationData;
 		uint32_t operationDataLen;
 		uint32_t sessionID;
+		uint64_t pushTime;
+	};
+
+	struct StreamSendLen
+	{
+		uint32_t operationLen;	// δִеƬ
+		uint32_t writeQueLen;	// Ựдг
 	};
 
 protected:
 	Mutex m_operationMutex;
 	std::queue<SessionOperation> m_operationQue;
 	std::queue<SessionOperation> m_operationDispatchQue;
+
+	NetLoopStats m_loopStats;
+
+	Mutex m_compressMutex;
+	std::set<uint32_t> m_compressSessionSet;
+
+	Mutex m_streamSendMutex;
+	std::map<uint32_t, StreamSendLen> m_streamSendMap;
 };
 NS_NET_UV_END
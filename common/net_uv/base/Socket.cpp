@@ -11,6 +11,7 @@ Socket::Socket()
 	, m_userdata(nullptr)
 	, m_recvCall(nullptr)
 	, m_bindPort(0)
+	, m_recvBuffer(NULL)
 {
 	m_uvReadBuf.base = 0;
 	m_uvReadBuf.len = 0;
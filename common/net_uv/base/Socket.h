@@ -39,6 +39,10 @@ public:
 
 	inline void setRecvCallback(const SocketRecvCall& call);
 
+	// ýջ,úյֱдûύ,پм俽
+	// ʱջصеdataָ򱾴д뻺
+	inline void setRecvBuffer(Buffer* buffer);
+
 	inline uint32_t getBindPort();
 public:
 
@@ -80,6 +84,7 @@ protected:
 	SocketConnectCall m_connectCall;
 	SocketCloseCall m_closeCall;
 	SocketRecvCall m_recvCall;
+	Buffer* m_recvBuffer;
 };
 
 std::string Socket::getIp()
@@ -127,6 +132,11 @@ void Socket::setRecvCallback(const SocketRecvCall& call)
 	m_recvCall = std::move(call);
 }
 
+void Socket::setRecvBuffer(Buffer* buffer)
+{
+	m_recvBuffer = buffer;
+}
+
 void Socket::setUserdata(void* userdata)
 {
 	m_userdata = userdata;
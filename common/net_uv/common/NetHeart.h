@@ -11,6 +11,8 @@ enum NET_MSG_TYPE : NET_HEART_TYPE
 	MT_MIN = 0,
 	MT_DEFAULT,		// ĬϢ
 	MT_HEARTBEAT,	// Ϣ
+	MT_STREAM,		// ʽϢƬ
+	MT_COMPRESS,	// ѹϢ
 	MT_MAX
 };
 
@@ -17,6 +17,8 @@ enum class NetThreadMsgType : uint32_t
 	EXIT_LOOP,			//˳loop
 	RECV_DATA,			//յϢ
 	REMOVE_SESSION,		//ƳỰ
+	RECV_STREAM,		//յʽϢƬ
+	HOT_SESSION,		//ȵỰѯ
 };
 
 class Session;
@@ -28,6 +30,7 @@ struct NetThreadMsg
 	Session* pSession;
 	char* data;
 	uint32_t dataLen;
+	uint64_t pushTime;
 };
 #pragma pack()
 
@@ -18,6 +18,10 @@ enum
 	KCP_CLI_OP_CLIENT_CLOSE,	//ͻ˳
 	KCP_CLI_OP_REMOVE_SESSION,	//ƳỰ
 	KCP_CLI_OP_DELETE_SESSION,	//ɾỰ
+	KCP_CLI_OP_SEND_MSG,		//UV߳дϢ
+	KCP_CLI_OP_SET_COMPRESS,	//ûỰѹģʽ
+	KCP_CLI_OP_SEND_UNRELIABLE,	//ͲɿϢ
+	KCP_CLI_OP_QUERY_HOT_SESSION,	//ѯȵỰ
 };
 
 // Ӳ
@@ -61,6 +65,7 @@ struct KCPClientCreatePreSocketCallData
 KCPClient::KCPClient()
 	: m_reconnect(true)
 	, m_totalTime(3.0f)
+	, m_kcpProfile(KCP_PROFILE_DEFAULT)
 	, m_isStop(false)
 {
 	uv_loop_init(&m_loop);
@@ -122,6 +127,7 @@ void KCPClient::updateFrame()
 		return;
 	}
 
+	m_loopStats.onDispatchMsg(m_msgQue.size());
 	while (!m_msgQue.empty())
 	{
 		m_msgDispatchQue.push(m_msgQue.front());
@@ -137,6 +143,7 @@ void KCPClient::updateFrame()
 		{
 		case NetThreadMsgType::RECV_DATA:
 		{
+			m_loopStats.onRecvMsg(Msg.pushTime, Msg.dataLen);
 			m_recvCall(this, Msg.pSession, Msg.data, Msg.dataLen);
 			fc_free(Msg.data);
 		}break;
@@ -172,8 +179,20 @@ void KCPClient::updateFrame()
 		{
 			closeClientTag = true;
 		}break;
+		case NetThreadMsgType::HOT_SESSION:
+		{
+			if (m_hotSessionCall != nullptr)
+			{
+				m_hotSessionCall(this, (NetSessionTraffic*)Msg.data, Msg.dataLen);
+			}
+			if (Msg.data)
+			{
+				fc_free(Msg.data);
+			}
+		}break;
 		case NetThreadMsgType::REMOVE_SESSION:
 		{
+			setCompressSession(Msg.pSession->getSessionID(), false);
 			if (m_removeSessionCall != nullptr)
 			{
 				m_removeSessionCall(this, Msg.pSession);
@@ -204,6 +223,20 @@ void KCPClient::send(uint32_t sessionId, char* data, uint32_t len)
 
 	if (data == 0 || len <= 0)
 		return;
+
+	m_loopStats.onSendMsg(len);
+
+#if KCP_OPEN_COMPRESS == 1
+	// ѹĻỰϢUV̰߳Ựѹģʽ
+	if (len >= KCP_COMPRESS_MIN_LEN && isCompressSession(sessionId))
+	{
+		char* p = (char*)fc_malloc(len);
+		memcpy(p, data, len);
+		pushOperation(KCP_CLI_OP_SEND_MSG, p, len, sessionId);
+		return;
+	}
+#endif
+
 	int32_t bufCount = 0;
 
 	uv_buf_t* bufArr = kcp_packageData(data, len, &bufCount);
@@ -218,6 +251,41 @@ void KCPClient::send(uint32_t sessionId, char* data, uint32_t len)
 	fc_free(bufArr);
 }
 
+void KCPClient::setSessionCompressMode(uint32_t sessionId, NetCompressMode mode)
+{
+	if (m_isStop)
+		return;
+
+	setCompressSession(sessionId, mode != NetCompressMode::NONE);
+	pushOperation(KCP_CLI_OP_SET_COMPRESS, NULL, (uint32_t)mode, sessionId);
+}
+
+#if KCP_OPEN_UNRELIABLE_MSG == 1
+void KCPClient::sendUnreliable(uint32_t sessionId, char* data, uint32_t len, bool isSequenced)
+{
+	if (m_isStop)
+		return;
+
+	uint32_t sendlen = 0;
+	char* p = kcp_packageUnreliableData(data, len, isSequenced, &sendlen);
+	if (p == NULL)
+	{
+		NET_UV_LOG(NET_UV_L_WARNING, "unreliable msg too long: %u", len);
+		return;
+	}
+	m_loopStats.onSendMsg(len);
+	pushOperation(KCP_CLI_OP_SEND_UNRELIABLE, p, sendlen, sessionId);
+}
+#endif
+
+void KCPClient::queryHotSession(uint32_t count, NetHotSessionSort sort)
+{
+	if (m_isStop)
+		return;
+
+	pushOperation(KCP_CLI_OP_QUERY_HOT_SESSION, NULL, count, (uint32_t)sort);
+}
+
 void KCPClient::disconnect(uint32_t sessionId)
 {
 	if (m_isStop)
@@ -312,6 +380,7 @@ void KCPClient::executeOperation()
 		return;
 	}
 
+	m_loopStats.onDispatchOperation(m_operationQue.size());
 	while (!m_operationQue.empty())
 	{
 		m_operationDispatchQue.push(m_operationQue.front());
@@ -322,6 +391,7 @@ void KCPClient::executeOperation()
 	while (!m_operationDispatchQue.empty())
 	{
 		auto & curOperation = m_operationDispatchQue.front();
+		m_loopStats.onExecuteOperation(curOperation.pushTime);
 		switch (curOperation.operationType)
 		{
 		case KCP_CLI_OP_SENDDATA:		// ݷ
@@ -336,6 +406,40 @@ void KCPClient::executeOperation()
 				fc_free(curOperation.operationData);
 			}
 		}break;
+		case KCP_CLI_OP_SEND_MSG:		// Ϣ
+		{
+			auto sessionData = getClientSessionDataBySessionId(curOperation.sessionID);
+			if (sessionData && !sessionData->removeTag)
+			{
+				sessionData->session->executeSendMsg((char*)curOperation.operationData, curOperation.operationDataLen);
+			}
+			else
+			{
+				fc_free(curOperation.operationData);
+			}
+		}break;
+#if KCP_OPEN_UNRELIABLE_MSG == 1
+		case KCP_CLI_OP_SEND_UNRELIABLE:	// ͲɿϢ
+		{
+			auto sessionData = getClientSessionDataBySessionId(curOperation.sessionID);
+			if (sessionData && !sessionData->removeTag)
+			{
+				sessionData->session->executeSendUnreliable((char*)curOperation.operationData, curOperation.operationDataLen);
+			}
+			else
+			{
+				fc_free(curOperation.operationData);
+			}
+		}break;
+#endif
+		case KCP_CLI_OP_SET_COMPRESS:	// ѹģʽ
+		{
+			auto sessionData = getClientSessionDataBySessionId(curOperation.sessionID);
+			if (sessionData)
+			{
+				sessionData->session->setCompressMode((NetCompressMode)curOperation.operationDataLen);
+			}
+		}break;
 		case KCP_CLI_OP_DISCONNECT:	// Ͽ
 		{
 			auto sessionData = getClientSessionDataBySessionId(curOperation.sessionID);
@@ -439,6 +543,17 @@ void KCPClient::executeOperation()
 				m_allSessionMap.erase(it);
 			}
 		}break;
+		case KCP_CLI_OP_QUERY_HOT_SESSION:	// ѯȵỰ
+		{
+			std::vector<Session*> sessionArr;
+			for (auto& it : m_allSessionMap)
+			{
+				sessionArr.push_back(it.second->session);
+			}
+			uint32_t count = 0;
+			NetSessionTraffic* arr = makeHotSessionReport(sessionArr, curOperation.operationDataLen, (NetHotSessionSort)curOperation.sessionID, &count);
+			pushThreadMsg(NetThreadMsgType::HOT_SESSION, NULL, (char*)arr, count);
+		}break;
 		default:
 			break;
 		}
@@ -462,6 +577,8 @@ void KCPClient::onSessionUpdateRun()
 	for (auto& it : m_allSessionMap)
 	{
 		it.second->session->update(KCP_HEARTBEAT_TIMER_DELAY);
+		it.second->session->updateTraffic(KCP_HEARTBEAT_TIMER_DELAY);
+		m_loopStats.onSampleWriteQue(it.second->session->getWriteQueueSize());
 	}
 }
 
@@ -564,6 +681,7 @@ void KCPClient::createNewConnect(void* data)
 	{
 		KCPSocket* socket = socket = (KCPSocket*)fc_malloc(sizeof(KCPSocket));
 		new (socket) KCPSocket(&m_loop);
+		socket->setProfile(m_kcpProfile);
 		socket->setConnectCallback(std::bind(&KCPClient::onSocketConnect, this, std::placeholders::_1, std::placeholders::_2));
 
 		KCPSession* session = KCPSession::createSession(this, socket);
@@ -658,6 +776,8 @@ void KCPClient::clearData()
 		auto & curOperation = m_operationQue.front();
 		switch (curOperation.operationType)
 		{
+		case KCP_CLI_OP_SEND_MSG:
+		case KCP_CLI_OP_SEND_UNRELIABLE:
 		case KCP_CLI_OP_SENDDATA:			// ݷ
 		{
 			if (curOperation.operationData)
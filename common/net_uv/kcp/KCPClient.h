@@ -43,6 +43,8 @@ public:
 
 	virtual void disconnect(uint32_t sessionId)override;
 
+	virtual void queryHotSession(uint32_t count, NetHotSessionSort sort)override;
+
 	//socketǷԶ
 	void setAutoReconnect(bool isAuto);
 
@@ -55,6 +57,18 @@ public:
 	//Զʱ(λS)
 	void setAutoReconnectTimeBySessionID(uint32_t sessionID, float time);
 
+	//ûỰѹģʽ
+	void setSessionCompressMode(uint32_t sessionId, NetCompressMode mode);
+
+	//kcp,connect֮ǰ,֮󴴽Ч
+	inline void setKcpProfile(const KCPProfile& profile);
+
+#if KCP_OPEN_UNRELIABLE_MSG == 1
+	//ͲɿϢش֤
+	//isSequencedΪtrueʱշյϢɵϢ
+	void sendUnreliable(uint32_t sessionId, char* data, uint32_t len, bool isSequenced = true);
+#endif
+
 protected:
 
 	/// Runnable
@@ -91,6 +105,8 @@ protected:
 	bool m_reconnect;		// ǷԶ
 	float m_totalTime;		// ʱ
 
+	KCPProfile m_kcpProfile;
+
 	// лỰ
 	std::map<uint32_t, clientSessionData*> m_allSessionMap;
 
@@ -101,6 +117,11 @@ protected:
 	static void uv_client_update_timer_run(uv_timer_t* handle);
 };
 
+void KCPClient::setKcpProfile(const KCPProfile& profile)
+{
+	m_kcpProfile = profile;
+}
+
 
 
 NS_NET_UV_END
@@ -4,6 +4,7 @@
 #include "../base/Socket.h"
 #include "../base/Runnable.h"
 #include "../base/Misc.h"
+#include "../base/Compress.h"
 #include "../base/Session.h"
 #include "../base/SessionManager.h"
 #include "../base/Mutex.h"
@@ -29,4 +30,29 @@ struct KCPMsgHead
 };
 #pragma pack()
 
+// kcp
+struct KCPProfile
+{
+	uint32_t sndwnd;	// ʹ
+	uint32_t rcvwnd;	// մ
+	int32_t nodelay;	// Ƿnodelayģʽ
+	int32_t interval;	// ڲʱ()
+	int32_t resend;		// شָ
+	int32_t nc;			// Ƿرӵ
+};
+
+#if KCP_OPEN_UNRELIABLE_MSG == 1
+// ɿϢʶkcpconv1ʼֵͻ
+#define KCP_UNRELIABLE_MAGIC (0xFFFFFFF0)
+
+#pragma pack(4)
+struct KCPUnreliableHead
+{
+	uint32_t magic;	// KCP_UNRELIABLE_MAGIC
+	uint32_t conv;	// Ựconv
+	uint32_t seq;	//  Ϊ0ʱʾţշж
+};
+#pragma pack()
+#endif
+
 NS_NET_UV_END
@@ -27,6 +27,12 @@ NS_NET_UV_BEGIN
 // 
 #define KCP_MAX_CONNECT (0xFFFF)
 
+// kcp,KCPProfile
+// Ĭϲ,ʵʱϢ
+#define KCP_PROFILE_DEFAULT { 128, 128, 1, 10, 2, 1 }
+// ݴ(ļ),󴰿,ӳٻ򶪰·Կռ
+#define KCP_PROFILE_BULK { 1024, 1024, 1, 10, 2, 1 }
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 /// ϢУ 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -58,4 +64,34 @@ NS_NET_UV_BEGIN
 #define KCP_HEARTBEAT_COUNT_RESET_VALUE_CLIENT (-1)	
 
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/// ѹ
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Ƿѹ
+// ΪÿỰѹģʽշϢͷԶѹ
+// ѹϢͨϢͷ֣ҪKCP_OPEN_UV_THREAD_HEARTBEAT
+#define KCP_OPEN_COMPRESS 1
+
+#if KCP_OPEN_UV_THREAD_HEARTBEAT == 0
+#undef KCP_OPEN_COMPRESS
+#define KCP_OPEN_COMPRESS 0
+#endif
+
+// Ϣȴﵽֵʱųѹ
+#define KCP_COMPRESS_MIN_LEN (256)
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/// ɿϢ
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// ǷɿϢ
+// ỰƹkcpֱͨͬһUDPַݱش֤˳ʺλͬʱЧ
+#define KCP_OPEN_UNRELIABLE_MSG 1
+
+// ɿϢ󳤶ȣӦС·MTUԱIPƬ
+#define KCP_UNRELIABLE_MSG_MAX_LEN (1024)
+
+
 NS_NET_UV_END
\ No newline at end of file
@@ -10,6 +10,10 @@ enum
 	KCP_SVR_OP_DIS_SESSION,	// ϿĳỰ
 	KCP_SVR_OP_SEND_DIS_SESSION_MSG_TO_MAIN_THREAD,//̷߳ͻỰѶϿ
 	KCP_SVR_OP_SVR_SOCKET_SEND,//socket
+	KCP_SVR_OP_SEND_MSG,	// UV߳дϢ
+	KCP_SVR_OP_SET_COMPRESS,// ûỰѹģʽ
+	KCP_SVR_OP_SEND_UNRELIABLE,// ͲɿϢ
+	KCP_SVR_OP_QUERY_HOT_SESSION,// ѯȵỰ
 };
 
 // Ӳ
@@ -26,6 +30,7 @@ struct KCPServerSVRSendOperation
 KCPServer::KCPServer()
 	: m_start(false)
 	, m_server(NULL)
+	, m_kcpProfile(KCP_PROFILE_DEFAULT)
 {
 }
 
@@ -57,6 +62,7 @@ bool KCPServer::startServer(const char* ip, uint32_t port, bool isIPV6)
 	}
 
 	new (m_server) KCPSocket(&m_loop);
+	m_server->setProfile(m_kcpProfile);
 	m_server->setCloseCallback(std::bind(&KCPServer::onServerSocketClose, this, std::placeholders::_1));
 	m_server->setNewConnectionCallback(std::bind(&KCPServer::onNewConnect, this, std::placeholders::_1));
 	m_server->setConnectFilterCallback(std::bind(&KCPServer::onServerSocketConnectFilter, this, std::placeholders::_1));
@@ -119,6 +125,7 @@ void KCPServer::updateFrame()
 		return;
 	}
 
+	m_loopStats.onDispatchMsg(m_msgQue.size());
 	while (!m_msgQue.empty())
 	{
 		m_msgDispatchQue.push(m_msgQue.front());
@@ -135,6 +142,7 @@ void KCPServer::updateFrame()
 		{
 		case NetThreadMsgType::RECV_DATA:
 		{
+			m_loopStats.onRecvMsg(Msg.pushTime, Msg.dataLen);
 			m_recvCall(this, Msg.pSession, Msg.data, Msg.dataLen);
 			fc_free(Msg.data);
 		}break;
@@ -144,6 +152,7 @@ void KCPServer::updateFrame()
 		}break;
 		case NetThreadMsgType::DIS_CONNECT:
 		{
+			setCompressSession(Msg.pSession->getSessionID(), false);
 			m_disconnectCall(this, Msg.pSession);
 			pushOperation(KCP_SVR_OP_SEND_DIS_SESSION_MSG_TO_MAIN_THREAD, NULL, 0, Msg.pSession->getSessionID());
 		}break;
@@ -151,6 +160,17 @@ void KCPServer::updateFrame()
 		{
 			closeServerTag = true;
 		}break;
+		case NetThreadMsgType::HOT_SESSION:
+		{
+			if (m_hotSessionCall != nullptr)
+			{
+				m_hotSessionCall(this, (NetSessionTraffic*)Msg.data, Msg.dataLen);
+			}
+			if (Msg.data)
+			{
+				fc_free(Msg.data);
+			}
+		}break;
 		default:
 			break;
 		}
@@ -164,6 +184,19 @@ void KCPServer::updateFrame()
 
 void KCPServer::send(uint32_t sessionID, char* data, uint32_t len)
 {
+	m_loopStats.onSendMsg(len);
+
+#if KCP_OPEN_COMPRESS == 1
+	// ѹĻỰϢUV̰߳Ựѹģʽ
+	if (len >= KCP_COMPRESS_MIN_LEN && isCompressSession(sessionID))
+	{
+		char* p = (char*)fc_malloc(len);
+		memcpy(p, data, len);
+		pushOperation(KCP_SVR_OP_SEND_MSG, p, len, sessionID);
+		return;
+	}
+#endif
+
 	int32_t bufCount = 0;
 
 	uv_buf_t* bufArr = kcp_packageData(data, len, &bufCount);
@@ -178,6 +211,11 @@ void KCPServer::send(uint32_t sessionID, char* data, uint32_t len)
 	fc_free(bufArr);
 }
 
+void KCPServer::queryHotSession(uint32_t count, NetHotSessionSort sort)
+{
+	pushOperation(KCP_SVR_OP_QUERY_HOT_SESSION, NULL, count, (uint32_t)sort);
+}
+
 void KCPServer::disconnect(uint32_t sessionID)
 {
 	pushOperation(KCP_SVR_OP_DIS_SESSION, NULL, 0, sessionID);
@@ -218,6 +256,27 @@ bool KCPServer::svrUdpSend(struct sockaddr* addr, uint32_t addrlen, char* data,
 	return true;
 }
 
+void KCPServer::setSessionCompressMode(uint32_t sessionID, NetCompressMode mode)
+{
+	setCompressSession(sessionID, mode != NetCompressMode::NONE);
+	pushOperation(KCP_SVR_OP_SET_COMPRESS, NULL, (uint32_t)mode, sessionID);
+}
+
+#if KCP_OPEN_UNRELIABLE_MSG == 1
+void KCPServer::sendUnreliable(uint32_t sessionID, char* data, uint32_t len, bool isSequenced)
+{
+	uint32_t sendlen = 0;
+	char* p = kcp_packageUnreliableData(data, len, isSequenced, &sendlen);
+	if (p == NULL)
+	{
+		NET_UV_LOG(NET_UV_L_WARNING, "unreliable msg too long: %u", len);
+		return;
+	}
+	m_loopStats.onSendMsg(len);
+	pushOperation(KCP_SVR_OP_SEND_UNRELIABLE, p, sendlen, sessionID);
+}
+#endif
+
 void KCPServer::run()
 {
 	startIdle();
@@ -335,6 +394,7 @@ void KCPServer::executeOperation()
 		return;
 	}
 
+	m_loopStats.onDispatchOperation(m_operationQue.size());
 	while (!m_operationQue.empty())
 	{
 		m_operationDispatchQue.push(m_operationQue.front());
@@ -345,6 +405,7 @@ void KCPServer::executeOperation()
 	while (!m_operationDispatchQue.empty())
 	{
 		auto & curOperation = m_operationDispatchQue.front();
+		m_loopStats.onExecuteOperation(curOperation.pushTime);
 		switch (curOperation.operationType)
 		{
 		case KCP_SVR_OP_SEND_DATA:		// ݷ
@@ -359,6 +420,40 @@ void KCPServer::executeOperation()
 				fc_free(curOperation.operationData);
 			}
 		}break;
+		case KCP_SVR_OP_SEND_MSG:	// Ϣ
+		{
+			auto it = m_allSession.find(curOperation.sessionID);
+			if (it != m_allSession.end())
+			{
+				it->second.session->executeSendMsg((char*)curOperation.operationData, curOperation.operationDataLen);
+			}
+			else//ûỰʧЧ
+			{
+				fc_free(curOperation.operationData);
+			}
+		}break;
+#if KCP_OPEN_UNRELIABLE_MSG == 1
+		case KCP_SVR_OP_SEND_UNRELIABLE:	// ͲɿϢ
+		{
+			auto it = m_allSession.find(curOperation.sessionID);
+			if (it != m_allSession.end())
+			{
+				it->second.session->executeSendUnreliable((char*)curOperation.operationData, curOperation.operationDataLen);
+			}
+			else//ûỰʧЧ
+			{
+				fc_free(curOperation.operationData);
+			}
+		}break;
+#endif
+		case KCP_SVR_OP_SET_COMPRESS:	// ѹģʽ
+		{
+			auto it = m_allSession.find(curOperation.sessionID);
+			if (it != m_allSession.end())
+			{
+				it->second.session->setCompressMode((NetCompressMode)curOperation.operationDataLen);
+			}
+		}break;
 		case KCP_SVR_OP_DIS_SESSION:	// Ͽ
 		{
 			auto it = m_allSession.find(curOperation.sessionID);
@@ -400,6 +495,17 @@ void KCPServer::executeOperation()
 			opData->~KCPServerSVRSendOperation();
 			fc_free(opData);
 		}break;
+		case KCP_SVR_OP_QUERY_HOT_SESSION:	// ѯȵỰ
+		{
+			std::vector<Session*> sessionArr;
+			for (auto& it : m_allSession)
+			{
+				sessionArr.push_back(it.second.session);
+			}
+			uint32_t count = 0;
+			NetSessionTraffic* arr = makeHotSessionReport(sessionArr, curOperation.operationDataLen, (NetHotSessionSort)curOperation.sessionID, &count);
+			pushThreadMsg(NetThreadMsgType::HOT_SESSION, NULL, (char*)arr, count);
+		}break;
 		default:
 			break;
 		}
@@ -422,7 +528,7 @@ void KCPServer::clearData()
 	while (!m_operationQue.empty())
 	{
 		const auto& curOpration = m_operationQue.front();
-		if (curOpration.operationType == KCP_SVR_OP_SEND_DATA)
+		if (curOpration.operationType == KCP_SVR_OP_SEND_DATA || curOpration.operationType == KCP_SVR_OP_SEND_MSG || curOpration.operationType == KCP_SVR_OP_SEND_UNRELIABLE)
 		{
 			fc_free(curOpration.operationData);
 		}
@@ -480,6 +586,8 @@ void KCPServer::onSessionUpdateRun()
 	for (auto& it : m_allSession)
 	{
 		it.second.session->update(KCP_HEARTBEAT_TIMER_DELAY);
+		it.second.session->updateTraffic(KCP_HEARTBEAT_TIMER_DELAY);
+		m_loopStats.onSampleWriteQue(it.second.session->getWriteQueueSize());
 	}
 }
 
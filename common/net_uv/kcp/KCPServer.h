@@ -38,6 +38,8 @@ public:
 
 	virtual void disconnect(uint32_t sessionID)override;
 
+	virtual void queryHotSession(uint32_t count, NetHotSessionSort sort)override;
+
 	/// KCPServer
 	/// ʹ÷SocketĳַϢ
 	/// ip: ֧IPַ ֧
@@ -45,6 +47,18 @@ public:
 
 	bool svrUdpSend(struct sockaddr* addr, uint32_t addrlen, char* data, uint32_t len);
 
+	/// ûỰѹģʽ
+	void setSessionCompressMode(uint32_t sessionID, NetCompressMode mode);
+
+	/// kcp,startServer֮ǰ,֮ܵЧ
+	inline void setKcpProfile(const KCPProfile& profile);
+
+#if KCP_OPEN_UNRELIABLE_MSG == 1
+	/// ͲɿϢش֤
+	/// isSequencedΪtrueʱշյϢɵϢ
+	void sendUnreliable(uint32_t sessionID, char* data, uint32_t len, bool isSequenced = true);
+#endif
+
 protected:
 
 	/// Runnable
@@ -82,10 +96,17 @@ protected:
 
 	KCPSocket* m_server;
 
+	KCPProfile m_kcpProfile;
+
 	// Ự
 	std::map<uint32_t, serverSessionData> m_allSession;
 };
 
+void KCPServer::setKcpProfile(const KCPProfile& profile)
+{
+	m_kcpProfile = profile;
+}
+
 
 
 NS_NET_UV_END
@@ -32,12 +32,26 @@ KCPSession::KCPSession(SessionManager* sessionManager)
 	m_sendHeartMsg = NET_HEARTBEAT_MSG_C2S;
 	m_curHeartMaxCount = KCP_HEARTBEAT_MAX_COUNT_CLIENT;
 #endif
+
+#if KCP_OPEN_COMPRESS == 1
+	m_compressMode = NetCompressMode::NONE;
+	memset(&m_compressStats, 0, sizeof(m_compressStats));
+#endif
+
+#if KCP_OPEN_UNRELIABLE_MSG == 1
+	m_unreliableSendSeq = 0;
+	m_unreliableRecvSeq = 0;
+#endif
 }
 
 KCPSession::~KCPSession()
 {
 	if (m_recvBuffer)
 	{
+		if (m_socket)
+		{
+			m_socket->setRecvBuffer(NULL);
+		}
 		m_recvBuffer->~Buffer();
 		fc_free(m_recvBuffer);
 		m_recvBuffer = NULL;
@@ -57,9 +71,14 @@ void KCPSession::init(KCPSocket* socket)
 	m_socket = socket;
 	m_socket->setCloseCallback(std::bind(&KCPSession::on_socket_close, this, std::placeholders::_1));
 	m_socket->setRecvCallback(std::bind(&KCPSession::on_socket_recv, this, std::placeholders::_1, std::placeholders::_2));
+#if KCP_OPEN_UNRELIABLE_MSG == 1
+	m_socket->setRecvUnreliableCallback(std::bind(&KCPSession::on_socket_recv_unreliable, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
+#endif
 
 	m_recvBuffer = (Buffer*)fc_malloc(sizeof(Buffer));
-	new (m_recvBuffer)Buffer(1024 * 1);
+	new (m_recvBuffer)Buffer(1024 * 4);
+	// ׽ֱm_recvBuffer
+	m_socket->setRecvBuffer(m_recvBuffer);
 }
 
 void KCPSession::executeSend(char* data, uint32_t len)
@@ -69,11 +88,158 @@ void KCPSession::executeSend(char* data, uint32_t len)
 
 	if (isOnline())
 	{
+		m_traffic.sendBytes += len;
+		m_traffic.sendMsgs++;
 		m_socket->send(data, len);
 	}
+	else
+	{
+		m_traffic.dropMsgs++;
+	}
+	fc_free(data);
+}
+
+void KCPSession::executeSendHeartMsg(NET_HEART_TYPE msg)
+{
+	if (!isOnline())
+		return;
+
+	uint32_t sendlen = 0;
+	const char* senddata = kcp_getHeartMsgData(msg, &sendlen);
+	if (senddata == NULL)
+		return;
+
+	// ikcp_send´,ͷ
+	m_socket->send((char*)senddata, sendlen);
+}
+
+void KCPSession::executeSendMsg(char* data, uint32_t len)
+{
+	if (data == NULL || len <= 0)
+		return;
+
+	if (!isOnline())
+	{
+		m_traffic.dropMsgs++;
+		fc_free(data);
+		return;
+	}
+
+	char* senddata = data;
+	uint32_t sendlen = len;
+	NET_HEART_TYPE tag = NET_MSG_TYPE::MT_DEFAULT;
+
+#if KCP_OPEN_COMPRESS == 1
+	uint32_t compressLen = 0;
+	char* compressData = net_compressMsg(m_compressMode, data, len, &compressLen, &m_compressStats);
+	if (compressData != NULL)
+	{
+		senddata = compressData;
+		sendlen = compressLen;
+		tag = NET_MSG_TYPE::MT_COMPRESS;
+	}
+#endif
+
+	int32_t bufCount = 0;
+	uv_buf_t* bufArr = kcp_packageData(senddata, sendlen, &bufCount, tag);
+
+	if (senddata != data)
+	{
+		fc_free(senddata);
+	}
+	fc_free(data);
+
+	if (bufArr == NULL)
+		return;
+
+	for (int32_t i = 0; i < bufCount; ++i)
+	{
+		executeSend((bufArr + i)->base, (bufArr + i)->len);
+	}
+	fc_free(bufArr);
+}
+
+#if KCP_OPEN_UNRELIABLE_MSG == 1
+void KCPSession::executeSendUnreliable(char* data, uint32_t len)
+{
+	if (data == NULL || len <= 0)
+		return;
+
+	if (isOnline())
+	{
+		KCPUnreliableHead* h = (KCPUnreliableHead*)data;
+		if (h->seq != 0)
+		{
+			// 0ʾţʱ
+			m_unreliableSendSeq++;
+			if (m_unreliableSendSeq == 0)
+			{
+				m_unreliableSendSeq = 1;
+			}
+			h->seq = m_unreliableSendSeq;
+		}
+		m_traffic.sendBytes += len;
+		m_traffic.sendMsgs++;
+		m_socket->sendUnreliable(data, len);
+	}
+	else
+	{
+		m_traffic.dropMsgs++;
+	}
 	fc_free(data);
 }
 
+void KCPSession::on_socket_recv_unreliable(char* data, uint32_t len, uint32_t seq)
+{
+	if (!isOnline())
+		return;
+
+	m_traffic.recvBytes += len;
+
+#if KCP_OPEN_UV_THREAD_HEARTBEAT == 1
+	m_curHeartCount = m_resetHeartCount;
+	m_curHeartTime = 0;
+#endif
+
+	// Ϣ
+	if (seq != 0 && m_unreliableRecvSeq != 0 && (int32_t)(seq - m_unreliableRecvSeq) <= 0)
+	{
+		m_traffic.dropMsgs++;
+		return;
+	}
+
+#if KCP_UV_OPEN_MD5_CHECK == 1
+	if (len <= sizeof(uint32_t))
+	{
+		m_traffic.dropMsgs++;
+		return;
+	}
+
+	uint32_t recvLen = 0;
+	char* recvData = kcp_uv_decode(data, len, recvLen);
+
+	// ɿϢУʧʱֱӶϿ
+	if (recvData == NULL || recvLen <= 0)
+	{
+		NET_UV_LOG(NET_UV_L_WARNING, "ɿϢУʧ");
+		m_traffic.dropMsgs++;
+		return;
+	}
+#else
+	uint32_t recvLen = len;
+	char* recvData = (char*)fc_malloc(len + 1);
+	memcpy(recvData, data, len);
+	recvData[len] = '\0';
+#endif
+	if (seq != 0)
+	{
+		m_unreliableRecvSeq = seq;
+	}
+	m_traffic.recvMsgs++;
+	m_sessionRecvCallback(this, recvData, recvLen);
+}
+#endif
+
 void KCPSession::executeDisconnect()
 {
 	if (isOnline())
@@ -96,10 +262,17 @@ void KCPSession::setIsOnline(bool isOnline)
 	m_curHeartCount = m_resetHeartCount;
 	m_curHeartTime = 0;
 #endif
+#if KCP_OPEN_UNRELIABLE_MSG == 1
+	m_unreliableSendSeq = 0;
+	m_unreliableRecvSeq = 0;
+#endif
 }
 
 void KCPSession::on_socket_close(Socket* socket)
 {
+#if KCP_OPEN_COMPRESS == 1
+	net_logCompressStats("kcp", m_sessionID, m_compressStats);
+#endif
 	this->setIsOnline(false);
 	if (m_sessionCloseCallback)
 	{
@@ -117,28 +290,26 @@ void KCPSession::on_socket_recv(char* data, ssize_t len)
 	m_curHeartTime = 0;
 #endif
 	
+	// ׽ֱдm_recvBuffer
+	(void)data;
 	if (len <= 0)
 		return;
 
-	m_recvBuffer->add(data, len);
-
 	const static uint32_t headlen = sizeof(KCPMsgHead);
 
 	while (m_recvBuffer->getDataLength() >= headlen)
 	{
-		KCPMsgHead* h = (KCPMsgHead*)m_recvBuffer->getHeadBlockData();
+		KCPMsgHead* h = (KCPMsgHead*)m_recvBuffer->getReadData();
 
 		//ȴ򳤶Сڵ㣬Ϸͻ
 		if (h->len > KCP_BIG_MSG_MAX_LEN || h->len <= 0)
 		{
 #if OPEN_NET_UV_DEBUG == 1
-			char* pMsg = (char*)fc_malloc(m_recvBuffer->getDataLength());
-			m_recvBuffer->get(pMsg);
-			std::string errdata(pMsg, m_recvBuffer->getDataLength());
-			fc_free(pMsg);
+			std::string errdata(m_recvBuffer->getReadData(), m_recvBuffer->getDataLength());
 			NET_UV_LOG(NET_UV_L_WARNING, errdata.c_str());
 #endif
 			m_recvBuffer->clear();
+			m_traffic.dropMsgs++;
 			NET_UV_LOG(NET_UV_L_WARNING, "ݲϷ (1)!!!!");
 			executeDisconnect();
 			return;
@@ -150,70 +321,58 @@ void KCPSession::on_socket_recv(char* data, ssize_t len)
 			NET_UV_LOG(NET_UV_L_WARNING, "ݲϷ (2)!!!!");
 
 #if OPEN_NET_UV_DEBUG == 1
-			char* pMsg = (char*)fc_malloc(m_recvBuffer->getDataLength());
-			m_recvBuffer->get(pMsg);
-			std::string errdata(pMsg, m_recvBuffer->getDataLength());
-			fc_free(pMsg);
+			std::string errdata(m_recvBuffer->getReadData(), m_recvBuffer->getDataLength());
 			NET_UV_LOG(NET_UV_L_WARNING, errdata.c_str());
 #endif
 			m_recvBuffer->clear();
+			m_traffic.dropMsgs++;
 			executeDisconnect();
 			return;
 		}
 #endif
 
-		int32_t subv = m_recvBuffer->getDataLength() - (h->len + headlen);
-
 		//Ϣ
-		if (subv >= 0)
+		if (m_recvBuffer->getDataLength() >= h->len + headlen)
 		{
-			char* pMsg = (char*)fc_malloc(m_recvBuffer->getDataLength());
-			m_recvBuffer->get(pMsg);
-
-			char* src = pMsg + headlen;
-
-#if KCP_UV_OPEN_MD5_CHECK == 1
-			uint32_t recvLen = 0;
-			char* recvData = kcp_uv_decode(src, h->len, recvLen);
-
-			if (recvData != NULL && recvLen > 0)
-			{
+			char* src = m_recvBuffer->getReadData() + headlen;
+			uint32_t msgLen = h->len;
 #if KCP_OPEN_UV_THREAD_HEARTBEAT == 1
-				onRecvMsgPackage(recvData, recvLen, h->tag);
+			NET_HEART_TYPE msgTag = h->tag;
 #else
-				onRecvMsgPackage(recvData, recvLen, NET_MSG_TYPE::MT_DEFAULT);
+			NET_HEART_TYPE msgTag = NET_MSG_TYPE::MT_DEFAULT;
 #endif
+			// 
+			if (msgTag != NET_MSG_TYPE::MT_HEARTBEAT)
+			{
+				m_traffic.recvBytes += headlen + msgLen;
 			}
-			else//ݲϷ
+
+#if KCP_UV_OPEN_MD5_CHECK == 1
+			uint32_t recvLen = 0;
+			char* recvData = kcp_uv_decode(src, msgLen, recvLen);
+
+			if (recvData == NULL || recvLen <= 0)//ݲϷ
 			{
 				NET_UV_LOG(NET_UV_L_WARNING, "ݲϷ (3)!!!!");
 #if OPEN_NET_UV_DEBUG == 1
-				std::string errdata(pMsg, m_recvBuffer->getDataLength());
+				std::string errdata(m_recvBuffer->getReadData(), m_recvBuffer->getDataLength());
 				NET_UV_LOG(NET_UV_L_WARNING, errdata.c_str());
 #endif
 				m_recvBuffer->clear();
-				fc_free(pMsg);
+				m_traffic.dropMsgs++;
 				executeDisconnect();
 				return;
 			}
 #else
-			char* recvData = (char*)fc_malloc(h->len + 1);
-			memcpy(recvData, src, h->len);
-			recvData[h->len] = '\0';
-
-#if KCP_OPEN_UV_THREAD_HEARTBEAT == 1
-			onRecvMsgPackage(recvData, h->len, h->tag);
-#else
-			onRecvMsgPackage(recvData, h->len, NET_MSG_TYPE::MT_DEFAULT);
-#endif
+			uint32_t recvLen = msgLen;
+			char* recvData = (char*)fc_malloc(msgLen + 1);
+			memcpy(recvData, src, msgLen);
+			recvData[msgLen] = '\0';
 #endif
-			m_recvBuffer->clear();
+			// Ƴѽ,صпܶϿӲջ
+			m_recvBuffer->skip(headlen + msgLen);
 
-			if (subv > 0)
-			{
-				m_recvBuffer->add(data + (len - subv), subv);
-			}
-			fc_free(pMsg);
+			onRecvMsgPackage(recvData, recvLen, msgTag);
 		}
 		else
 		{
@@ -231,16 +390,12 @@ void KCPSession::onRecvMsgPackage(char* data, uint32_t len, NET_HEART_TYPE type)
 			NET_HEART_TYPE msg = *((NET_HEART_TYPE*)data);
 			if (msg == NET_HEARTBEAT_MSG_C2S)
 			{
-				uint32_t sendlen = 0;
-				char* senddata = kcp_packageHeartMsgData(NET_HEARTBEAT_RET_MSG_S2C, &sendlen);
-				executeSend(senddata, sendlen);
+				executeSendHeartMsg(NET_HEARTBEAT_RET_MSG_S2C);
 				NET_UV_LOG(NET_UV_L_HEART, "recv heart c->s");
 			}
 			else if (msg == NET_HEARTBEAT_MSG_S2C)
 			{
-				uint32_t sendlen = 0;
-				char* senddata = kcp_packageHeartMsgData(NET_HEARTBEAT_RET_MSG_C2S, &sendlen);
-				executeSend(senddata, sendlen);
+				executeSendHeartMsg(NET_HEARTBEAT_RET_MSG_C2S);
 				NET_UV_LOG(NET_UV_L_HEART, "recv heart s->c");
 			}
 			else if (msg > NET_HEARTBEAT_RET_MSG_S2C) // Ƿ
@@ -251,8 +406,27 @@ void KCPSession::onRecvMsgPackage(char* data, uint32_t len, NET_HEART_TYPE type)
 		}
 		fc_free(data);
 	}
+#if KCP_OPEN_COMPRESS == 1
+	else if (type == NET_MSG_TYPE::MT_COMPRESS)
+	{
+		uint32_t rawLen = 0;
+		char* rawData = net_decompressMsg(data, len, KCP_BIG_MSG_MAX_LEN, &rawLen, &m_compressStats);
+		fc_free(data);
+
+		if (rawData == NULL)
+		{
+			NET_UV_LOG(NET_UV_L_WARNING, "ѹʧܣݲϷ");
+			m_traffic.dropMsgs++;
+			executeDisconnect();
+			return;
+		}
+		m_traffic.recvMsgs++;
+		m_sessionRecvCallback(this, rawData, rawLen);
+	}
+#endif
 	else
 	{
+		m_traffic.recvMsgs++;
 		m_sessionRecvCallback(this, data, len);
 	}
 }
@@ -278,15 +452,22 @@ void KCPSession::update(uint32_t time)
 			}
 			else
 			{
-				uint32_t sendlen = 0;
-				char* senddata = kcp_packageHeartMsgData(m_sendHeartMsg, &sendlen);
-				executeSend(senddata, sendlen);
+				executeSendHeartMsg(m_sendHeartMsg);
 				NET_UV_LOG(NET_UV_L_HEART, "kcp send heart %d", m_sendHeartMsg);
 			}
 		}
 	}
 }
 
+uint32_t KCPSession::getWriteQueueSize()
+{
+	if (m_socket == NULL)
+	{
+		return 0;
+	}
+	return m_socket->getWaitSendSize();
+}
+
 void KCPSession::updateKcp(IUINT32 update_clock)
 {
 	getKCPSocket()->socketUpdate(update_clock);
@@ -36,6 +36,22 @@ protected:
 
 	virtual void update(uint32_t time)override;
 
+	virtual uint32_t getWriteQueueSize()override;
+
+	void executeSendHeartMsg(NET_HEART_TYPE msg);
+
+	// UV߳аỰѹģʽϢ
+	void executeSendMsg(char* data, uint32_t len);
+
+	inline void setCompressMode(NetCompressMode mode);
+
+#if KCP_OPEN_UNRELIABLE_MSG == 1
+	// ͲɿϢdatakcp_packageUnreliableData
+	void executeSendUnreliable(char* data, uint32_t len);
+
+	void on_socket_recv_unreliable(char* data, uint32_t len, uint32_t seq);
+#endif
+
 	/// KCPSession
 	inline void setKCPSocket(KCPSocket* socket);
 
@@ -73,6 +89,16 @@ protected:
 	int32_t m_curHeartMaxCount;
 	NET_HEART_TYPE m_sendHeartMsg;
 #endif
+
+#if KCP_OPEN_COMPRESS == 1
+	NetCompressMode m_compressMode;
+	NetCompressStats m_compressStats;
+#endif
+
+#if KCP_OPEN_UNRELIABLE_MSG == 1
+	uint32_t m_unreliableSendSeq;	// ͵ĲɿϢ
+	uint32_t m_unreliableRecvSeq;	// յĲɿϢţŲڸֵϢΪϢ
+#endif
 };
 
 void KCPSession::setKCPSocket(KCPSocket* socket)
@@ -107,4 +133,11 @@ void KCPSession::setHeartMaxCount(int32_t maxCount)
 #endif
 }
 
+void KCPSession::setCompressMode(NetCompressMode mode)
+{
+#if KCP_OPEN_COMPRESS == 1
+	m_compressMode = mode;
+#endif
+}
+
 NS_NET_UV_END
\ No newline at end of file
@@ -27,9 +27,11 @@ KCPSocket::KCPSocket(uv_loop_t* loop)
 	, m_runIdle(false)
 	, m_connectTimeoutTime(KCP_SOCKET_CONNECT_FIRST_TIMEOUT)
 	, m_burrowCount(0)
+	, m_profile(KCP_PROFILE_DEFAULT)
+#if KCP_OPEN_UNRELIABLE_MSG == 1
+	, m_recvUnreliableCall(nullptr)
+#endif
 {
-	m_recvBuf = (char*)fc_malloc(KCP_MAX_MSG_SIZE);
-	memset(m_recvBuf, 0, KCP_MAX_MSG_SIZE);
 	m_loop = loop;
 }
 
@@ -41,12 +43,6 @@ KCPSocket::~KCPSocket()
 		m_socketAddr = NULL;
 	}
 
-	if (m_recvBuf)
-	{
-		fc_free(m_recvBuf);
-		m_recvBuf = NULL;
-	}
-
 	if (m_udp)
 	{
 		net_closeHandle((uv_handle_t*)m_udp, net_closehandle_defaultcallback);
@@ -291,6 +287,7 @@ bool KCPSocket::accept(const struct sockaddr* addr, IUINT32 conv)
 
 	KCPSocket* socket = (KCPSocket*)fc_malloc(sizeof(KCPSocket));
 	new (socket) KCPSocket(m_loop);
+	socket->setProfile(m_profile);
 	socket->setIp(strip);
 	socket->setPort(port);
 	socket->setIsIPV6(socker_addr->sa_family == AF_INET6);
@@ -341,6 +338,15 @@ void KCPSocket::svr_connect(struct sockaddr* addr, IUINT32 conv)
 	startIdle();
 }
 
+uint32_t KCPSocket::getWaitSendSize()
+{
+	if (m_kcp == NULL)
+	{
+		return 0;
+	}
+	return (uint32_t)ikcp_waitsnd(m_kcp) * m_kcp->mss;
+}
+
 void KCPSocket::svrIdleRun()
 {
 	if (m_socketMng)
@@ -515,6 +521,18 @@ void KCPSocket::udpSend(const char* data, int32_t len, const struct sockaddr* ad
 	}
 }
 
+#if KCP_OPEN_UNRELIABLE_MSG == 1
+void KCPSocket::sendUnreliable(char* data, uint32_t len)
+{
+	if (m_kcpState != State::CONNECT || len <= sizeof(KCPUnreliableHead))
+	{
+		return;
+	}
+	((KCPUnreliableHead*)data)->conv = getConv();
+	udpSend(data, (int32_t)len);
+}
+#endif
+
 void KCPSocket::kcpInput(const char* data, long size)
 {
 	if (size <= 0 || m_kcp == NULL)
@@ -524,18 +542,38 @@ void KCPSocket::kcpInput(const char* data, long size)
 	
 	ikcp_input(m_kcp, data, size);
 
-	int32_t kcp_recvd_bytes = 0;
-	do
+	if (m_recvBuffer == NULL)
 	{
-		if(m_kcp == NULL) break;
-		kcp_recvd_bytes = ikcp_recv(m_kcp, m_recvBuf, KCP_MAX_MSG_SIZE);
+		return;
+	}
 
-		if (kcp_recvd_bytes < 0)
+	// ʵʴСֱջ,ȫصһ
+	uint32_t recvLen = 0;
+	while (true)
+	{
+		int32_t peekSize = ikcp_peeksize(m_kcp);
+		if (peekSize <= 0)
 		{
-			kcp_recvd_bytes = 0;
+			break;
+		}
+
+		char* p = m_recvBuffer->getWriteData((uint32_t)peekSize);
+		if (p == NULL)
+		{
+			NET_UV_LOG(NET_UV_L_WARNING, "ջ");
+			disconnect();
+			return;
 		}
-		m_recvCall(m_recvBuf, kcp_recvd_bytes);
-	} while (kcp_recvd_bytes > 0);
+
+		int32_t kcp_recvd_bytes = ikcp_recv(m_kcp, p, peekSize);
+		if (kcp_recvd_bytes <= 0)
+		{
+			break;
+		}
+		m_recvBuffer->commit((uint32_t)kcp_recvd_bytes);
+		recvLen += (uint32_t)kcp_recvd_bytes;
+	}
+	m_recvCall(m_recvBuffer->getReadData() + m_recvBuffer->getDataLength() - recvLen, recvLen);
 }
 
 void KCPSocket::initKcp(IUINT32 conv)
@@ -549,15 +587,7 @@ void KCPSocket::initKcp(IUINT32 conv)
 	m_kcp->output = &KCPSocket::udp_output;
 	m_kcp->stream = 1;
 
-	ikcp_wndsize(m_kcp, 128, 128);
-
-	// ģʽ
-	// ڶ nodelay-Ժɳٽ
-	//  intervalΪڲʱӣĬΪ 10ms
-	// ĸ resendΪشָ꣬Ϊ2
-	//  ΪǷóأֹ
-	ikcp_nodelay(m_kcp, 1, 10, 2, 1);
-	//ikcp_nodelay(m_kcp, 1, 5, 1, 1); // ó1ACKԽֱش, ӦٶȻ. ڲʱ5.
+	kcp_setProfile(m_kcp, m_profile);
 }
 
 void KCPSocket::onUdpRead(uv_udp_t* handle, ssize_t nread, const uv_buf_t* buf, const struct sockaddr* addr, uint32_t flags)
@@ -701,6 +731,21 @@ void KCPSocket::onUdpRead(uv_udp_t* handle, ssize_t nread, const uv_buf_t* buf,
 	// 󣬿ͻ˲дϢڴ򶴣Ӱkcpinput
 	else if (kcp_is_connect_packet(buf->base, nread))
 	{}
+#if KCP_OPEN_UNRELIABLE_MSG == 1
+	// ɿϢ
+	else if (kcp_is_unreliable_packet(buf->base, nread))
+	{
+		if (m_kcpState == State::CONNECT)
+		{
+			KCPUnreliableHead* h = (KCPUnreliableHead*)buf->base;
+			if (h->conv == getConv() && m_recvUnreliableCall != nullptr)
+			{
+				m_last_kcp_packet_recv_time = m_last_update_time;
+				m_recvUnreliableCall(buf->base + sizeof(KCPUnreliableHead), (uint32_t)(nread - sizeof(KCPUnreliableHead)), h->seq);
+			}
+		}
+	}
+#endif
 	else
 	{
 		if (m_kcpState == State::CONNECT)
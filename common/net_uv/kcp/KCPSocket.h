@@ -6,11 +6,14 @@
 
 NS_NET_UV_BEGIN
 
-#define KCP_MAX_MSG_SIZE (1024*2)
 
 // ӹ˻صڹ˺ falseʾܸ
 using KCPSocketConnectFilterCall = std::function<bool(const struct sockaddr*)>;
 using KCPSocketNewConnectionCall = std::function<void(Socket*)>;
+#if KCP_OPEN_UNRELIABLE_MSG == 1
+// յɿϢ dataKCPUnreliableHead
+using KCPSocketRecvUnreliableCall = std::function<void(char* data, uint32_t len, uint32_t seq)>;
+#endif
 
 class KCPSocket : public Socket
 {
@@ -40,8 +43,20 @@ public:
 	inline void setNewConnectionCallback(const KCPSocketNewConnectionCall& call);
 	inline void setConnectFilterCallback(const KCPSocketConnectFilterCall& call);
 
+	// kcp,ӽ֮ǰ,׽ֽܵʹͬĲ
+	inline void setProfile(const KCPProfile& profile);
+#if KCP_OPEN_UNRELIABLE_MSG == 1
+	inline void setRecvUnreliableCallback(const KCPSocketRecvUnreliableCall& call);
+
+	// ƹkcpֱӷͲɿϢdataKCPUnreliableHeadͷconvɱд
+	void sendUnreliable(char* data, uint32_t len);
+#endif
+
 	void svrIdleRun();
 
+	// kcpеȴͺ͵ȴȷϵֽ(Ƭ)
+	uint32_t getWaitSendSize();
+
 protected:
 	inline uv_udp_t* getUdp();
 	
@@ -105,7 +120,6 @@ protected:
 	bool m_runIdle;
 
 	State m_kcpState;
-	char* m_recvBuf;
 
 	ikcpcb* m_kcp;
 	IUINT32 m_first_send_connect_msg_time;
@@ -118,12 +132,17 @@ protected:
 
 	uint32_t m_connectTimeoutTime;
 	uint32_t m_burrowCount;
+
+	KCPProfile m_profile;
 	
 	KCPSocketManager* m_socketMng;
 	bool m_weakRefSocketMng;
 
 	KCPSocketNewConnectionCall m_newConnectionCall;
 	KCPSocketConnectFilterCall m_connectFilterCall;
+#if KCP_OPEN_UNRELIABLE_MSG == 1
+	KCPSocketRecvUnreliableCall m_recvUnreliableCall;
+#endif
 
 	friend class KCPSocketManager;
 	friend class KCPServer;
@@ -161,6 +180,18 @@ void KCPSocket::setConnectFilterCallback(const KCPSocketConnectFilterCall& call)
 	m_connectFilterCall = std::move(call);
 }
 
+void KCPSocket::setProfile(const KCPProfile& profile)
+{
+	m_profile = profile;
+}
+
+#if KCP_OPEN_UNRELIABLE_MSG == 1
+void KCPSocket::setRecvUnreliableCallback(const KCPSocketRecvUnreliableCall& call)
+{
+	m_recvUnreliableCall = std::move(call);
+}
+#endif
+
 void KCPSocket::setConv(IUINT32 conv)
 {
 	m_conv = conv;
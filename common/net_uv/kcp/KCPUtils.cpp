@@ -11,9 +11,10 @@ NS_NET_UV_BEGIN
 #define NET_KCP_HEART_PACKET "kcp_heart_package"
 #define NET_KCP_HEART_BACK_PACKET "kcp_heart_back_package"
 
-std::string kcp_making_connect_packet(void)
+const std::string& kcp_making_connect_packet(void)
 {
-	return std::string(NET_KCP_CONNECT_PACKET, sizeof(NET_KCP_CONNECT_PACKET));
+	static const std::string packet(NET_KCP_CONNECT_PACKET, sizeof(NET_KCP_CONNECT_PACKET));
+	return packet;
 }
 
 bool kcp_is_connect_packet(const char* data, size_t len)
@@ -146,9 +147,10 @@ uint32_t kcp_grab_conv_from_disconnect_packet(const char* data, size_t len)
 
 
 
-std::string kcp_making_heart_packet()
+const std::string& kcp_making_heart_packet()
 {
-	return std::string(NET_KCP_HEART_PACKET, sizeof(NET_KCP_HEART_PACKET));
+	static const std::string packet(NET_KCP_HEART_PACKET, sizeof(NET_KCP_HEART_PACKET));
+	return packet;
 }
 
 bool kcp_is_heart_packet(const char* data, size_t len)
@@ -157,9 +159,10 @@ bool kcp_is_heart_packet(const char* data, size_t len)
 		memcmp(data, NET_KCP_HEART_PACKET, sizeof(NET_KCP_HEART_PACKET) - 1) == 0);
 }
 
-std::string kcp_making_heart_back_packet()
+const std::string& kcp_making_heart_back_packet()
 {
-	return std::string(NET_KCP_HEART_BACK_PACKET, sizeof(NET_KCP_HEART_BACK_PACKET));
+	static const std::string packet(NET_KCP_HEART_BACK_PACKET, sizeof(NET_KCP_HEART_BACK_PACKET));
+	return packet;
 }
 
 bool kcp_is_heart_back_packet(const char* data, size_t len)
@@ -250,7 +253,19 @@ char* kcp_uv_decode(const char* data, uint32_t len, uint32_t &outLen)
 
 
 // 
-uv_buf_t* kcp_packageData(char* data, uint32_t len, int32_t* bufCount)
+void kcp_setProfile(ikcpcb* kcp, const KCPProfile& profile)
+{
+	ikcp_wndsize(kcp, profile.sndwnd, profile.rcvwnd);
+
+	// ģʽ
+	// ڶ nodelay-Ժɳٽ
+	//  intervalΪڲʱӣĬΪ 10ms
+	// ĸ resendΪشָ꣬Ϊ2
+	//  ΪǷóأֹ
+	ikcp_nodelay(kcp, profile.nodelay, profile.interval, profile.resend, profile.nc);
+}
+
+uv_buf_t* kcp_packageData(char* data, uint32_t len, int32_t* bufCount, NET_HEART_TYPE tag)
 {
 	*bufCount = 0;
 	if (data == NULL || len <= 0)
@@ -284,7 +299,7 @@ uv_buf_t* kcp_packageData(char* data, uint32_t len, int32_t* bufCount)
 	KCPMsgHead* h = (KCPMsgHead*)p;
 	h->len = encodelen;
 #if KCP_OPEN_UV_THREAD_HEARTBEAT == 1
-	h->tag = NET_MSG_TYPE::MT_DEFAULT;
+	h->tag = tag;
 #endif
 	memcpy(p + kcp_msg_headlen, encodedata, encodelen);
 
@@ -295,7 +310,7 @@ uv_buf_t* kcp_packageData(char* data, uint32_t len, int32_t* bufCount)
 	KCPMsgHead* h = (KCPMsgHead*)p;
 	h->len = len;
 #if KCP_OPEN_UV_THREAD_HEARTBEAT == 1
-	h->tag = NET_MSG_TYPE::MT_DEFAULT;
+	h->tag = tag;
 #endif
 	memcpy(p + kcp_msg_headlen, data, len);
 #endif
@@ -401,4 +416,87 @@ char* kcp_packageHeartMsgData(NET_HEART_TYPE msg, uint32_t* outBufSize)
 	return p;
 }
 
-NS_NET_UV_END
+// Ϣ
+#define KCP_HEART_MSG_CACHE_COUNT (NET_HEARTBEAT_RET_MSG_S2C + 1)
+#define KCP_HEART_MSG_CACHE_MAX_LEN (64)
+
+struct KCPHeartMsgCache
+{
+	char data[KCP_HEART_MSG_CACHE_COUNT][KCP_HEART_MSG_CACHE_MAX_LEN];
+	uint32_t len[KCP_HEART_MSG_CACHE_COUNT];
+
+	KCPHeartMsgCache()
+	{
+		for (NET_HEART_TYPE i = 0; i < KCP_HEART_MSG_CACHE_COUNT; ++i)
+		{
+			uint32_t sendlen = 0;
+			char* p = kcp_packageHeartMsgData(i, &sendlen);
+			assert(p != NULL && sendlen <= KCP_HEART_MSG_CACHE_MAX_LEN);
+
+			memcpy(data[i], p, sendlen);
+			len[i] = sendlen;
+			fc_free(p);
+		}
+	}
+};
+
+const char* kcp_getHeartMsgData(NET_HEART_TYPE msg, uint32_t* outBufSize)
+{
+	// ֲ̬ĳʼ̰߳ȫ,loop߳ͬʱҲֻһ
+	static KCPHeartMsgCache cache;
+
+	if (msg >= KCP_HEART_MSG_CACHE_COUNT)
+	{
+		*outBufSize = 0;
+		return NULL;
+	}
+	*outBufSize = cache.len[msg];
+	return cache.data[msg];
+}
+
+#if KCP_OPEN_UNRELIABLE_MSG == 1
+// ɿϢ
+// |-KCPUnreliableHead-|-DATA(УʱΪܺ)-|
+char* kcp_packageUnreliableData(char* data, uint32_t len, bool isSequenced, uint32_t* outBufSize)
+{
+	*outBufSize = 0;
+	if (data == NULL || len <= 0 || len > KCP_UNRELIABLE_MSG_MAX_LEN)
+	{
+		return NULL;
+	}
+
+	const static uint32_t headlen = sizeof(KCPUnreliableHead);
+
+#if KCP_UV_OPEN_MD5_CHECK == 1
+	uint32_t encodelen = 0;
+	char* encodedata = kcp_uv_encode(data, len, encodelen);
+	if (encodedata == NULL)
+	{
+		return NULL;
+	}
+	uint32_t sendlen = headlen + encodelen;
+	char* p = (char*)fc_malloc(sendlen);
+	memcpy(p + headlen, encodedata, encodelen);
+	fc_free(encodedata);
+#else
+	uint32_t sendlen = headlen + len;
+	char* p = (char*)fc_malloc(sendlen);
+	memcpy(p + headlen, data, len);
+#endif
+
+	KCPUnreliableHead* h = (KCPUnreliableHead*)p;
+	h->magic = KCP_UNRELIABLE_MAGIC;
+	h->conv = 0;
+	h->seq = isSequenced ? 1 : 0;
+
+	*outBufSize = sendlen;
+	return p;
+}
+
+bool kcp_is_unreliable_packet(const char* data, size_t len)
+{
+	return (len > sizeof(KCPUnreliableHead) && ((KCPUnreliableHead*)data)->magic == KCP_UNRELIABLE_MAGIC);
+}
+#endif
+
+NS_NET_UV_END
\ No newline at end of file
@@ -19,7 +19,7 @@
 
 NS_NET_UV_BEGIN
 
-std::string kcp_making_connect_packet(void);
+const std::string& kcp_making_connect_packet(void);
 bool kcp_is_connect_packet(const char* data, size_t len);
 
 std::string kcp_making_send_back_conv_packet(uint32_t conv, uint32_t port);
@@ -39,20 +39,31 @@ std::string kcp_making_disconnect_packet(uint32_t conv);
 bool kcp_is_disconnect_packet(const char* data, size_t len);
 uint32_t kcp_grab_conv_from_disconnect_packet(const char* data, size_t len);
 
-std::string kcp_making_heart_packet();
+const std::string& kcp_making_heart_packet();
 bool kcp_is_heart_packet(const char* data, size_t len);
 
-std::string kcp_making_heart_back_packet();
+const std::string& kcp_making_heart_back_packet();
 bool kcp_is_heart_back_packet(const char* data, size_t len);
 
 //
 char* kcp_uv_encode(const char* data, uint32_t len, uint32_t &outLen);
 //
 char* kcp_uv_decode(const char* data, uint32_t len, uint32_t &outLen);
+// kcp
+void kcp_setProfile(ikcpcb* kcp, const KCPProfile& profile);
 // 
-uv_buf_t* kcp_packageData(char* data, uint32_t len, int32_t* bufCount);
+uv_buf_t* kcp_packageData(char* data, uint32_t len, int32_t* bufCount, NET_HEART_TYPE tag = NET_MSG_TYPE::MT_DEFAULT);
 // Ϣ
 char* kcp_packageHeartMsgData(NET_HEART_TYPE msg, uint32_t* outBufSize);
+// ȡԤȴõϢ(ֻһΣصݲͷ)
+const char* kcp_getHeartMsgData(NET_HEART_TYPE msg, uint32_t* outBufSize);
+
+#if KCP_OPEN_UNRELIABLE_MSG == 1
+// ɿϢconvseqUV̷߳ʱд
+// isSequencedΪtrueʱseqֶ1Ϊ
+char* kcp_packageUnreliableData(char* data, uint32_t len, bool isSequenced, uint32_t* outBufSize);
+bool kcp_is_unreliable_packet(const char* data, size_t len);
+#endif
 
 
 /* get system time */
@@ -15,5 +15,6 @@
 #include "../thirdparty/rapidjson/writer.h"
 #include "../thirdparty/rapidjson/reader.h"
 #include "../thirdparty/rapidjson/document.h"
+#include "P2PConfig.h"
 
 
@@ -0,0 +1,68 @@
+#pragma once
+
+NS_NET_UV_BEGIN
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/// ת
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Ƿת
+// ʧʱͨturnתKCP
+#define P2P_OPEN_RELAY 1
+
+// Դ(ÿμ200ms)
+// ôδӳɹлΪתתҲʧӳʱ
+#define P2P_BURROW_MAX_TRY_COUNT 10
+
+// תÿÿתֽ
+// Ϊ0ʱ 
+// (1MB)
+#define P2P_RELAY_MAX_BYTES_PER_SECOND (1024 * 1024)
+
+// תͳ־(λ)
+#define P2P_RELAY_STAT_LOG_INTERVAL (1000 * 60)
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/// 
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// ϢǷJSONʽ(ڵ)
+// ʱָʽɽ
+#define P2P_SIGNAL_USE_JSON 0
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/// ַ
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// ڵǷIPV6
+// ڵ˫ջ׽("::"),ͬʱIPV4IPV6ڵͨ,ʧʱ˻IPV4
+#define P2P_OPEN_IPV6 1
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/// turn
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// turnĬϷƬ
+// 1ʱ߳,԰ͬһ˿(SO_REUSEPORT),ں˰Դַݰ
+// ϵͳ֧SO_REUSEPORT(Windows)ʱֻʹһƬ
+#define P2P_TURN_SHARD_COUNT 1
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/// ·
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// ÿڵӵ
+// ɿӵжKCP,;0ΪĬ
+#define P2P_STREAM_MAX_COUNT 8
+
+// ɿѷKCPδȷϵƬ
+// ĵȴŶ,ȼηKCP
+#define P2P_STREAM_MAX_WAITSND 256
+
+// ɿݱ󳤶
+#define P2P_DATAGRAM_MAX_LEN (1024)
+
+NS_NET_UV_END
\ No newline at end of file
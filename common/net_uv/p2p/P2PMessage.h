@@ -9,7 +9,7 @@ enum P2PMessageID
 {
 	P2P_MSG_ID_BEGIN = 1000,
 
-	P2P_MSG_ID_JSON_BEGIN,
+	P2P_MSG_ID_SIGNAL_BEGIN,
 
 	P2P_MSG_ID_PING,
 	P2P_MSG_ID_PONG,
@@ -27,11 +27,19 @@ enum P2PMessageID
 	P2P_MSG_ID_T2C_START_BURROW,			// ʼָ 1010
 
 	P2P_MSG_ID_C2C_HELLO,					// Ϣ 1011
+
+	P2P_MSG_ID_C2T_WANT_TO_RELAY,			// ʧ,turnת 1012
+
+	P2P_MSG_ID_T2C_START_RELAY,				// תѽ 1013
+
+	P2P_MSG_ID_STOP_RELAY,					// ֹͣת 1014
 	
-	P2P_MSG_ID_JSON_END,
+	P2P_MSG_ID_SIGNAL_END,
 
 	P2P_MSG_ID_KCP,							// KCPϢ
 
+	P2P_MSG_ID_RELAY_KCP,					// turnתKCPϢ uniqueID: turnʱΪĿڵkey,turnתʱΪԴڵkey
+
 	P2P_MSG_ID_END,
 };
 
@@ -43,7 +51,7 @@ struct P2PMessage
 	uint64_t uniqueID;  // ϢΨһID
 };
 
-// ַϢ
+// IPV4ַϢ
 union AddrInfo
 {
 	uint64_t key;		// key : ǰֽΪIP,ֽΪ˿
@@ -54,6 +62,12 @@ union AddrInfo
 	};
 };
 
+// IPV6ַkey
+// IPV6ַ޷64λkey,keyΪַͶ˿ڵĹϣֵλ,IPV4key(λΪ˿)ظ
+// ַͨỰЯP2PSignalAddrȡ
+// ϣֵܳͻ,Ựбַ,յʱַỰһ
+#define P2P_KEY_IPV6_FLAG (0x8000000000000000ULL)
+
 // P2PڵϢ
 struct P2PNodeInfo
 {
@@ -61,7 +75,47 @@ struct P2PNodeInfo
 	AddrInfo addr;
 };
 
-static const char* P2P_NULL_JSON = "{}";
-static uint32_t P2P_NULL_JSON_LEN = 3;
+// Ϣʽ汾
+// Ƹʽ԰汾ſͷ,JSONʽ'{'ͷ
+#define P2P_SIGNAL_VERSION (0x01)
+
+// Ϣ(Ƹʽ)
+#pragma pack(1)
+struct P2PSignalMsg
+{
+	uint8_t version;	// ʽ汾
+	uint64_t key;		// ڵkey
+	uint32_t time;		// ʱ
+};
+
+// ЯĽڵַ,P2PSignalMsg֮
+// ڸ֪Է޷keyԭĵַ(IPV6)
+struct P2PSignalAddr
+{
+	uint8_t family;		// 4:IPV4 6:IPV6
+	uint16_t port;		// ˿
+	uint8_t ip[16];		// IP(ֽ),IPV4ֻʹǰֽ
+};
+#pragma pack()
+
+// Ϣ󳤶(P2PMessage)
+#define P2P_SIGNAL_MAX_LEN (sizeof(P2PMessage) + 128)
+
+// KCPỰʶ,nʹ P2P_KCP_CONV + n
+#define P2P_KCP_CONV (0xFFFF)
+
+// ɿݱʶ
+// ݱKCPݹP2P_MSG_ID_KCP/P2P_MSG_ID_RELAY_KCP,Կͷconv,turnתʱ
+#define P2P_DATAGRAM_CONV (0xFFFE)
+
+// ɿݱͷ
+#pragma pack(1)
+struct P2PDatagramHead
+{
+	uint32_t conv;		// P2P_DATAGRAM_CONV
+	uint8_t streamID;	// ID
+	uint32_t seq;		//  Ϊ0ʱʾ,շж
+};
+#pragma pack()
 
 NS_NET_UV_END
@@ -10,6 +10,9 @@ enum P2POperationCMD
 	P2P_CONNECT_TO_TURN,
 	P2P_SEND_TO_PEER,
 	P2P_DISCONNECT_TO_PEER,
+	P2P_SET_STREAM_CONFIG,
+	P2P_SEND_UNRELIABLE_TO_PEER,
+	P2P_SET_STREAM_KCP_PROFILE,
 
 	/// output
 	P2P_START_FAIL,
@@ -28,6 +31,8 @@ enum P2POperationCMD
 P2PPeer::P2PPeer()
 	: m_state(PeerState::STOP)
 	, m_turnPort(0)
+	, m_turnKey(0)
+	, m_selfKey(0)
 	, m_tryConnectTurnCount(0)
 	, m_isConnectTurn(false)
 	, m_isStopConnectToTurn(true)
@@ -38,13 +43,15 @@ P2PPeer::P2PPeer()
 	, m_disConnectToPeerCallback(nullptr)
 	, m_disConnectToTurnCallback(nullptr)
 	, m_recvCallback(nullptr)
+	, m_recvStreamCallback(nullptr)
 {
 	memset(&m_loop, 0, sizeof(m_loop));
 	memset(&m_idle, 0, sizeof(m_idle));
 	memset(&m_timer, 0, sizeof(m_timer));
+	memset(&m_turnAddr, 0, sizeof(m_turnAddr));
 
-	m_pipe.setRecvJsonCallback(std::bind(&P2PPeer::onPipeRecvJsonCallback, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3, std::placeholders::_4));
-	m_pipe.setRecvKcpCallback(std::bind(&P2PPeer::onPipeRecvKcpCallback, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3, std::placeholders::_4));
+	m_pipe.setRecvSignalCallback(std::bind(&P2PPeer::onPipeRecvSignalCallback, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3, std::placeholders::_4, std::placeholders::_5));
+	m_pipe.setRecvKcpCallback(std::bind(&P2PPeer::onPipeRecvKcpCallback, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3, std::placeholders::_4, std::placeholders::_5));
 	m_pipe.setNewSessionCallback(std::bind(&P2PPeer::onPipeNewSessionCallback, this, std::placeholders::_1));
 	m_pipe.setNewKcpCreateCallback(std::bind(&P2PPeer::onPipeNewKcpCreateCallback, this, std::placeholders::_1));
 	m_pipe.setRemoveSessionCallback(std::bind(&P2PPeer::onPipeRemoveSessionCallback, this, std::placeholders::_1));
@@ -74,7 +81,17 @@ bool P2PPeer::start(const char* ip, uint32_t port)
 
 	uv_loop_init(&m_loop);
 
-	if (m_pipe.bind("0.0.0.0", 0, &m_loop) == false)
+#if P2P_OPEN_IPV6 == 1
+	// Ȱ˫ջ׽(ʽرIPV6_V6ONLY),ϵͳ֧IPV6޷رʱ˻IPV4
+	bool isBind = m_pipe.bind("::", 0, &m_loop);
+	if (isBind == false)
+	{
+		isBind = m_pipe.bind("0.0.0.0", 0, &m_loop);
+	}
+#else
+	bool isBind = m_pipe.bind("0.0.0.0", 0, &m_loop);
+#endif
+	if (isBind == false)
 	{
 		startFailureLogic();
 		return false;
@@ -114,7 +131,7 @@ bool P2PPeer::connectToPeer(uint64_t key)
 		return false;
 	}
 
-	if (key == m_selfAddrInfo.key)
+	if (key == m_selfKey)
 	{
 		return false;
 	}
@@ -160,7 +177,7 @@ void P2PPeer::updateFrame()
 		}break;
 		case P2POperationCMD::P2P_CONNECT_TURN_SUC:
 		{
-			m_connectToTurnCallback(true, m_selfAddrInfo.key);
+			m_connectToTurnCallback(true, m_selfKey);
 		}break;
 		case P2POperationCMD::P2P_CONNECT_TURN_FAIL:
 		{
@@ -184,7 +201,14 @@ void P2PPeer::updateFrame()
 		}break;
 		case P2POperationCMD::P2P_RECV_KCP_DATA:
 		{
-			m_recvCallback(opData.key, (char*)opData.data, opData.datalen);
+			if (opData.streamID == 0)
+			{
+				m_recvCallback(opData.key, (char*)opData.data, opData.datalen);
+			}
+			else if (m_recvStreamCallback != nullptr)
+			{
+				m_recvStreamCallback(opData.key, opData.streamID, (char*)opData.data, opData.datalen);
+			}
 			fc_free(opData.data);
 		}break;
 		case P2POperationCMD::P2P_NEWCONNECT:
@@ -209,9 +233,40 @@ void P2PPeer::updateFrame()
 
 void P2PPeer::send(uint64_t key, char* data, uint32_t len)
 {
+	send(key, 0, data, len);
+}
+
+void P2PPeer::send(uint64_t key, uint32_t streamID, char* data, uint32_t len)
+{
+	char* sendData = (char*)fc_malloc(len);
+	memcpy(sendData, data, len);
+	pushInputOperation(key, P2POperationCMD::P2P_SEND_TO_PEER, sendData, len, streamID);
+}
+
+void P2PPeer::sendUnreliable(uint64_t key, char* data, uint32_t len, bool isSequenced)
+{
+	if (len > P2P_DATAGRAM_MAX_LEN)
+	{
+		NET_UV_LOG(NET_UV_L_WARNING, "unreliable data too long: %u", len);
+		return;
+	}
 	char* sendData = (char*)fc_malloc(len);
 	memcpy(sendData, data, len);
-	pushInputOperation(key, P2POperationCMD::P2P_SEND_TO_PEER, sendData, len);
+	// streamID:Ƿ
+	pushInputOperation(key, P2POperationCMD::P2P_SEND_UNRELIABLE_TO_PEER, sendData, len, isSequenced ? 1 : 0);
+}
+
+void P2PPeer::setStreamConfig(uint32_t streamID, P2PStreamType type, uint8_t priority)
+{
+	// key:ȼ datalen:
+	pushInputOperation(priority, P2POperationCMD::P2P_SET_STREAM_CONFIG, NULL, type, streamID);
+}
+
+void P2PPeer::setStreamKcpProfile(uint32_t streamID, const KCPProfile& profile)
+{
+	KCPProfile* data = (KCPProfile*)fc_malloc(sizeof(KCPProfile));
+	*data = profile;
+	pushInputOperation(0, P2POperationCMD::P2P_SET_STREAM_KCP_PROFILE, data, sizeof(KCPProfile), streamID);
 }
 
 void P2PPeer::disconnect(uint64_t key)
@@ -223,8 +278,20 @@ void P2PPeer::disconnect(uint64_t key)
 void P2PPeer::run()
 {
 	struct sockaddr* turnAddr = net_getsocketAddr(m_turnIP.c_str(), m_turnPort, NULL);
-	// ʧܻΪIPV6
-	if (turnAddr == NULL || turnAddr->sa_family != AF_INET)
+
+	// תΪ׽ֿõĵַ,IPV4׽޷IPV6turn
+	P2PSignalAddr turnSignalAddr;
+	bool isValid = turnAddr != NULL 
+		&& P2PPipe::toSignalAddr(turnAddr, &turnSignalAddr) 
+		&& m_pipe.toSendAddr(turnSignalAddr, &m_turnAddr);
+
+	if (turnAddr != NULL)
+	{
+		fc_free(turnAddr);
+	}
+
+	// ʧַܻ
+	if (!isValid)
 	{
 		startFailureLogic();
 		pushOutputOperation(0, P2POperationCMD::P2P_START_FAIL, NULL, 0);
@@ -232,12 +299,7 @@ void P2PPeer::run()
 	}
 	pushOutputOperation(0, P2POperationCMD::P2P_START_SUC, NULL, 0);
 
-	struct sockaddr_in* addr4 = (struct sockaddr_in*)turnAddr;
-
-	m_turnAddrInfo.ip = addr4->sin_addr.s_addr;
-	m_turnAddrInfo.port = ntohs(addr4->sin_port);
-
-	fc_free(turnAddr);
+	m_turnKey = P2PPipe::addrToKey((const struct sockaddr*)&m_turnAddr);
 
 	uv_idle_init(&m_loop, &m_idle);
 	m_idle.data = this;
@@ -287,7 +349,7 @@ void P2PPeer::onTimerRun()
 			}
 			else
 			{
-				m_pipe.send(P2PMessageID::P2P_MSG_ID_C2C_HELLO, P2P_NULL_JSON, P2P_NULL_JSON_LEN, (const struct sockaddr*)&it->second.targetAddr);
+				m_pipe.sendSignal(P2PMessageID::P2P_MSG_ID_C2C_HELLO, 0, (const struct sockaddr*)&it->second.targetAddr);
 				it->second.sendCount++;
 				it++;
 			}
@@ -307,8 +369,20 @@ void P2PPeer::onTimerRun()
 			if (it->second.state != SessionState::CONNECT)
 			{
 				// ӳԴ
-				if (it->second.tryConnectCount > 10)
+				if (it->second.tryConnectCount > P2P_BURROW_MAX_TRY_COUNT)
 				{
+#if P2P_OPEN_RELAY == 1
+					// ʧ,Ϊturnת
+					if (!it->second.isRelay && m_isConnectTurn)
+					{
+						NET_UV_LOG(NET_UV_L_INFO, "%llu ʧ,ת", it->first);
+						it->second.isRelay = true;
+						it->second.tryConnectCount = 0;
+						m_burrowManager.erase(it->first);
+						it++;
+						continue;
+					}
+#endif
 					pushOutputOperation(it->first, P2POperationCMD::P2P_CONNECT_PEER_TIMEOUT, NULL, 0);
 					it = m_sessionManager.erase(it);
 					continue;
@@ -318,7 +392,8 @@ void P2PPeer::onTimerRun()
 					it->second.tryConnectCount++;
 					if (m_isConnectTurn)
 					{
-						m_pipe.send(P2PMessageID::P2P_MSG_ID_C2T_WANT_TO_CONNECT, it->second.sendData.c_str(), it->second.sendData.length(), m_turnAddrInfo.ip, m_turnAddrInfo.port);
+						P2PMessageID msgID = it->second.isRelay ? P2PMessageID::P2P_MSG_ID_C2T_WANT_TO_RELAY : P2PMessageID::P2P_MSG_ID_C2T_WANT_TO_CONNECT;
+						m_pipe.sendSignal(msgID, it->first, (const struct sockaddr*)&m_turnAddr);
 					}
 				}
 			}
@@ -335,35 +410,21 @@ void P2PPeer::startFailureLogic()
 	m_state = PeerState::STOP;
 }
 
-void P2PPeer::onPipeRecvJsonCallback(P2PMessageID msgID, rapidjson::Document& document, uint64_t key, const struct sockaddr* addr)
+void P2PPeer::onPipeRecvSignalCallback(P2PMessageID msgID, const P2PSignalMsg& msg, const P2PSignalAddr* msgAddr, uint64_t key, const struct sockaddr* addr)
 {
 	switch (msgID)
 	{
 	case P2PMessageID::P2P_MSG_ID_T2C_CLIENT_LOGIN_RESULT:
 	{
-		if (document.HasMember("key"))
-		{
-			rapidjson::Value& key_value = document["key"];
-			if (key_value.IsUint64())
-			{
-				m_selfAddrInfo.key = key_value.GetUint64();
-			}
-			m_isConnectTurn = true;
-			m_isStopConnectToTurn = true;
-			pushOutputOperation(0, P2POperationCMD::P2P_CONNECT_TURN_SUC, NULL, 0);
-		}
+		m_selfKey = msg.key;
+		m_isConnectTurn = true;
+		m_isStopConnectToTurn = true;
+		pushOutputOperation(0, P2POperationCMD::P2P_CONNECT_TURN_SUC, NULL, 0);
 	}
 	break;
 	case P2PMessageID::P2P_MSG_ID_T2C_START_BURROW:
 	{
-		if (document.HasMember("key"))
-		{
-			rapidjson::Value& key_value = document["key"];
-			if (key_value.IsUint64())
-			{
-				startBurrow(key_value.GetUint64());
-			}
-		}
+		startBurrow(msg.key, msgAddr);
 	}
 	case P2PMessageID::P2P_MSG_ID_C2C_HELLO:
 	{
@@ -374,21 +435,39 @@ void P2PPeer::onPipeRecvJsonCallback(P2PMessageID msgID, rapidjson::Document& do
 		}
 	}
 	break;
+#if P2P_OPEN_RELAY == 1
+	case P2PMessageID::P2P_MSG_ID_T2C_START_RELAY:
+	{
+		if (key == m_turnKey)
+		{
+			startRelay(msg.key, addr);
+		}
+	}
+	break;
+	case P2PMessageID::P2P_MSG_ID_STOP_RELAY:
+	{
+		if (key == m_turnKey)
+		{
+			m_pipe.removeSession(msg.key);
+		}
+	}
+	break;
+#endif
 	default:
 		break;
 	}
 }
 
-void P2PPeer::onPipeRecvKcpCallback(char* data, uint32_t len, uint64_t key, const struct sockaddr* addr)
+void P2PPeer::onPipeRecvKcpCallback(char* data, uint32_t len, uint64_t key, uint32_t streamID, const struct sockaddr* addr)
 {
 	char* pData = (char*)fc_malloc(len);
 	memcpy(pData, data, len);
-	pushOutputOperation(key, P2POperationCMD::P2P_RECV_KCP_DATA, pData, len);
+	pushOutputOperation(key, P2POperationCMD::P2P_RECV_KCP_DATA, pData, len, streamID);
 }
 
 void P2PPeer::onPipeNewSessionCallback(uint64_t key)
 {
-	if (m_turnAddrInfo.key != key)
+	if (m_turnKey != key)
 	{
 		auto it = m_sessionManager.find(key);
 		if (it == m_sessionManager.end())
@@ -397,6 +476,7 @@ void P2PPeer::onPipeNewSessionCallback(uint64_t key)
 			sessionData.state = DISCONNECT;
 			sessionData.tryConnectCount = 0;
 			sessionData.isClient = false;
+			sessionData.isRelay = false;
 			m_sessionManager[key] = sessionData;
 			NET_UV_LOG(NET_UV_L_INFO, "new session %llu  new connect", key);
 		}
@@ -405,7 +485,7 @@ void P2PPeer::onPipeNewSessionCallback(uint64_t key)
 
 void P2PPeer::onPipeNewKcpCreateCallback(uint64_t key)
 {
-	if (m_turnAddrInfo.key != key)
+	if (m_turnKey != key)
 	{
 		auto it = m_sessionManager.find(key);
 		if (it != m_sessionManager.end())
@@ -425,7 +505,7 @@ void P2PPeer::onPipeNewKcpCreateCallback(uint64_t key)
 
 void P2PPeer::onPipeRemoveSessionCallback(uint64_t key)
 {
-	if (m_turnAddrInfo.key == key)
+	if (m_turnKey == key)
 	{
 		m_isConnectTurn = false;
 		m_isStopConnectToTurn = true;
@@ -443,26 +523,28 @@ void P2PPeer::onPipeRemoveSessionCallback(uint64_t key)
 	}
 }
 
-void P2PPeer::pushInputOperation(uint64_t key, uint32_t what, void* data, uint32_t datalen)
+void P2PPeer::pushInputOperation(uint64_t key, uint32_t what, void* data, uint32_t datalen, uint32_t streamID)
 {
 	OperationData opData;
 	opData.key = key;
 	opData.what = what;
 	opData.data = data;
 	opData.datalen = datalen;
+	opData.streamID = streamID;
 
 	m_inputLock.lock();
 	m_inputQue.emplace(opData);
 	m_inputLock.unlock();
 }
 
-void P2PPeer::pushOutputOperation(uint64_t key, uint32_t what, void* data, uint32_t datalen)
+void P2PPeer::pushOutputOperation(uint64_t key, uint32_t what, void* data, uint32_t datalen, uint32_t streamID)
 {
 	OperationData opData;
 	opData.key = key;
 	opData.what = what;
 	opData.data = data;
 	opData.datalen = datalen;
+	opData.streamID = streamID;
 
 	m_outputLock.lock();
 	m_outputQue.emplace(opData);
@@ -497,24 +579,16 @@ void P2PPeer::runInputOperation()
 		{
 		case P2POperationCMD::P2P_CONNECT_TO_PEER:
 		{
-			rapidjson::StringBuffer s;
-			rapidjson::Writer<rapidjson::StringBuffer> writer(s);
-
-			writer.StartObject();
-			writer.Key("toKey");
-			writer.Uint64(opData.key);
-			writer.EndObject();
-
 			SessionData sessionData;
 			sessionData.state = DISCONNECT;
 			sessionData.tryConnectCount = 0;
 			sessionData.isClient = true;
-			sessionData.sendData = std::string(s.GetString(), s.GetLength());
+			sessionData.isRelay = false;
 			m_sessionManager[opData.key] = sessionData;
 
 			NET_UV_LOG(NET_UV_L_INFO, "new session %llu  client", opData.key);
 
-			startBurrow(opData.key);
+			startBurrow(opData.key, NULL);
 		}break;
 		case P2POperationCMD::P2P_CONNECT_TO_TURN:
 		{
@@ -530,10 +604,28 @@ void P2PPeer::runInputOperation()
 			auto it = m_sessionManager.find(opData.key);
 			if (it != m_sessionManager.end())
 			{
-				m_pipe.kcpSend((char*)opData.data, opData.datalen, opData.key);
+				m_pipe.kcpSend((char*)opData.data, opData.datalen, opData.key, opData.streamID);
+			}
+			fc_free(opData.data);
+		}break;
+		case P2POperationCMD::P2P_SEND_UNRELIABLE_TO_PEER:
+		{
+			auto it = m_sessionManager.find(opData.key);
+			if (it != m_sessionManager.end())
+			{
+				m_pipe.sendUnreliable((char*)opData.data, opData.datalen, opData.key, 0, opData.streamID != 0);
 			}
 			fc_free(opData.data);
 		}break;
+		case P2POperationCMD::P2P_SET_STREAM_CONFIG:
+		{
+			m_pipe.setStreamConfig(opData.streamID, (P2PStreamType)opData.datalen, (uint8_t)opData.key);
+		}break;
+		case P2POperationCMD::P2P_SET_STREAM_KCP_PROFILE:
+		{
+			m_pipe.setStreamKcpProfile(opData.streamID, *(KCPProfile*)opData.data);
+			fc_free(opData.data);
+		}break;
 		case P2POperationCMD::P2P_DISCONNECT_TO_PEER:
 		{
 			m_pipe.disconnect(opData.key);
@@ -545,28 +637,34 @@ void P2PPeer::runInputOperation()
 	}
 }
 
-void P2PPeer::startBurrow(uint64_t toKey)
+void P2PPeer::startBurrow(uint64_t toKey, const P2PSignalAddr* toAddr)
 {
 	auto it = m_burrowManager.find(toKey);
 	if (it == m_burrowManager.end())
 	{
-		AddrInfo info;
-		info.key = toKey;
-
-		char * ipaddr = NULL;
-		char addr[20];
-		in_addr inaddr;
-		inaddr.s_addr = info.ip;
-		ipaddr = inet_ntoa(inaddr);
-		strcpy(addr, ipaddr);
-
 		BurrowData burrowData;
 		burrowData.sendCount = 0;
-		uv_ip4_addr(addr, info.port, &burrowData.targetAddr);
+
+		bool isValid = false;
+		if (toAddr != NULL)
+		{
+			isValid = m_pipe.toSendAddr(*toAddr, &burrowData.targetAddr) 
+				&& P2PPipe::addrToKey((const struct sockaddr*)&burrowData.targetAddr) == toKey;
+		}
+		else
+		{
+			isValid = m_pipe.getSendAddr(toKey, &burrowData.targetAddr);
+		}
+
+		// IPV6ڵĵַturnĴָЯ,˴ȴָ
+		if (!isValid)
+		{
+			return;
+		}
 
 		m_burrowManager.insert(std::make_pair(toKey, burrowData));
 
-		m_pipe.send(P2PMessageID::P2P_MSG_ID_C2C_HELLO, P2P_NULL_JSON, P2P_NULL_JSON_LEN, (const struct sockaddr*)&burrowData.targetAddr);
+		m_pipe.sendSignal(P2PMessageID::P2P_MSG_ID_C2C_HELLO, 0, (const struct sockaddr*)&burrowData.targetAddr);
 	}
 	else
 	{
@@ -574,6 +672,33 @@ void P2PPeer::startBurrow(uint64_t toKey)
 	}
 }
 
+void P2PPeer::startRelay(uint64_t toKey, const struct sockaddr* turnAddr)
+{
+	auto it = m_sessionManager.find(toKey);
+	if (it == m_sessionManager.end())
+	{
+		SessionData sessionData;
+		sessionData.state = DISCONNECT;
+		sessionData.tryConnectCount = 0;
+		sessionData.isClient = false;
+		sessionData.isRelay = true;
+		m_sessionManager[toKey] = sessionData;
+		NET_UV_LOG(NET_UV_L_INFO, "new session %llu  relay", toKey);
+	}
+	else if (it->second.state == SessionState::CONNECT)
+	{
+		// ѽ,
+		return;
+	}
+	else
+	{
+		it->second.isRelay = true;
+	}
+	m_burrowManager.erase(toKey);
+
+	m_pipe.createRelaySession(toKey, turnAddr);
+}
+
 void P2PPeer::doConnectToTurn()
 {
 	if (m_isStopConnectToTurn)
@@ -587,14 +712,12 @@ void P2PPeer::doConnectToTurn()
 	}
 
 	m_tryConnectTurnCount++;
-	m_pipe.send(P2PMessageID::P2P_MSG_ID_C2T_CLIENT_LOGIN, P2P_NULL_JSON, P2P_NULL_JSON_LEN, m_turnAddrInfo.ip, m_turnAddrInfo.port);
+	m_pipe.sendSignal(P2PMessageID::P2P_MSG_ID_C2T_CLIENT_LOGIN, 0, (const struct sockaddr*)&m_turnAddr);
 }
 
 void P2PPeer::doSendCreateKcp(uint64_t toKey)
 {
-	AddrInfo info;
-	info.key = toKey;
-	m_pipe.send(P2PMessageID::P2P_MSG_ID_CREATE_KCP, P2P_NULL_JSON, P2P_NULL_JSON_LEN, info.ip, info.port);
+	m_pipe.sendSignal(P2PMessageID::P2P_MSG_ID_CREATE_KCP, 0, toKey);
 }
 
 void P2PPeer::clearData()
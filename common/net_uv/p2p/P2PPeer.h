@@ -11,6 +11,8 @@ using P2PPeerConnectToTurnCallback = std::function<void(bool isSuccess, uint64_t
 using P2PPeerDisConnectToPeerCallback = std::function<void(uint64_t key)>;
 using P2PPeerDisConnectToTurnCallback = std::function<void()>;
 using P2PPeerRecvCallback = std::function<void(uint64_t key, char* data, uint32_t len)>;
+// 0P2PPeerRecvCallbackص
+using P2PPeerRecvStreamCallback = std::function<void(uint64_t key, uint32_t streamID, char* data, uint32_t len)>;
 using P2PPeerCloseCallback = std::function<void()>;
 
 class P2PPeer : public Runnable
@@ -33,8 +35,24 @@ public:
 
 	void updateFrame();
 
+	// ͨĬ(0)
 	void send(uint64_t key, char* data, uint32_t len);
 
+	// ָͨ,ɿݳȲܳP2P_DATAGRAM_MAX_LEN
+	void send(uint64_t key, uint32_t streamID, char* data, uint32_t len);
+
+	// KCPֱӷݱ,Ĭ(0)Ľջص,ݳȲܳP2P_DATAGRAM_MAX_LEN
+	// isSequenced:Ƿ,ʱշյݸɵ
+	void sendUnreliable(uint64_t key, char* data, uint32_t len, bool isSequenced = true);
+
+	// ͺȼ(ֵԽСȼԽ),˫һ
+	// 0ֻΪɿ
+	void setStreamConfig(uint32_t streamID, P2PStreamType type, uint8_t priority);
+
+	// ÿɿkcp,֮󴴽Ч
+	// ݴʹKCP_PROFILE_BULK
+	void setStreamKcpProfile(uint32_t streamID, const KCPProfile& profile);
+
 	void disconnect(uint64_t key);
 
 	inline void setStartCallback(const P2PPeerStartCallback& call);
@@ -51,6 +69,8 @@ public:
 
 	inline void setRecvCallback(const P2PPeerRecvCallback& call);
 
+	inline void setRecvStreamCallback(const P2PPeerRecvStreamCallback& call);
+
 	inline void setCloseCallback(const P2PPeerCloseCallback& call);
 
 
@@ -64,9 +84,9 @@ protected:
 
 	void startFailureLogic();
 
-	void onPipeRecvJsonCallback(P2PMessageID msgID, rapidjson::Document& document, uint64_t key, const struct sockaddr* addr);
+	void onPipeRecvSignalCallback(P2PMessageID msgID, const P2PSignalMsg& msg, const P2PSignalAddr* msgAddr, uint64_t key, const struct sockaddr* addr);
 
-	void onPipeRecvKcpCallback(char* data, uint32_t len, uint64_t key, const struct sockaddr* addr);
+	void onPipeRecvKcpCallback(char* data, uint32_t len, uint64_t key, uint32_t streamID, const struct sockaddr* addr);
 
 	void onPipeNewSessionCallback(uint64_t key);
 
@@ -74,13 +94,16 @@ protected:
 
 	void onPipeRemoveSessionCallback(uint64_t key);
 
-	void pushInputOperation(uint64_t key, uint32_t what, void* data, uint32_t datalen);
+	void pushInputOperation(uint64_t key, uint32_t what, void* data, uint32_t datalen, uint32_t streamID = 0);
 
-	void pushOutputOperation(uint64_t key, uint32_t what, void* data, uint32_t datalen);
+	void pushOutputOperation(uint64_t key, uint32_t what, void* data, uint32_t datalen, uint32_t streamID = 0);
 
 	void runInputOperation();
 
-	void startBurrow(uint64_t toKey);
+	// toAddr:turn֪Ŀַ,ΪNULLʱkeyԭ
+	void startBurrow(uint64_t toKey, const P2PSignalAddr* toAddr);
+
+	void startRelay(uint64_t toKey, const struct sockaddr* turnAddr);
 
 	void doConnectToTurn();
 
@@ -111,8 +134,9 @@ protected:
 	
 	std::string m_turnIP;
 	uint32_t m_turnPort;
-	AddrInfo m_turnAddrInfo;
-	AddrInfo m_selfAddrInfo;
+	uint64_t m_turnKey;
+	sockaddr_storage m_turnAddr;
+	uint64_t m_selfKey;
 	bool m_isConnectTurn;
 	bool m_isStopConnectToTurn;
 	uint16_t m_tryConnectTurnCount;
@@ -123,6 +147,7 @@ protected:
 		uint32_t what;
 		void* data;
 		uint32_t datalen;
+		uint32_t streamID;
 	};
 	std::queue<OperationData> m_inputQue;
 	std::queue<OperationData> m_inputQueCache;
@@ -141,15 +166,16 @@ protected:
 	{
 		SessionState state;
 		uint16_t tryConnectCount;
-		std::string sendData;
 		bool isClient;
+		// Ƿturnת
+		bool isRelay;
 	};
 	std::map<uint64_t, SessionData> m_sessionManager;
 
 	// 
 	struct BurrowData
 	{
-		sockaddr_in targetAddr;
+		sockaddr_storage targetAddr;
 		uint16_t sendCount;
 	};
 	std::map<uint64_t, BurrowData> m_burrowManager;
@@ -161,6 +187,7 @@ protected:
 	P2PPeerDisConnectToPeerCallback	m_disConnectToPeerCallback;
 	P2PPeerDisConnectToTurnCallback m_disConnectToTurnCallback;
 	P2PPeerRecvCallback			m_recvCallback;
+	P2PPeerRecvStreamCallback	m_recvStreamCallback;
 	P2PPeerCloseCallback		m_closeCallback;
 };
 
@@ -200,6 +227,11 @@ void P2PPeer::setRecvCallback(const P2PPeerRecvCallback& call)
 	m_recvCallback = std::move(call);
 }
 
+void P2PPeer::setRecvStreamCallback(const P2PPeerRecvStreamCallback& call)
+{
+	m_recvStreamCallback = std::move(call);
+}
+
 void P2PPeer::setCloseCallback(const P2PPeerCloseCallback& call)
 {
 	m_closeCallback = std::move(call);
@@ -4,17 +4,36 @@ NS_NET_UV_BEGIN
 
 #define P2P_KCP_MAX_RECV (1024 * 2)
 
+// IPV4ӳַǰ׺ ::ffff:0:0/96
+static const uint8_t P2P_V4_MAPPED_PREFIX[12] = { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xFF, 0xFF };
+
+static uint32_t p2p_getAddrLen(const struct sockaddr* addr)
+{
+	return addr->sa_family == AF_INET6 ? sizeof(struct sockaddr_in6) : sizeof(struct sockaddr_in);
+}
+
 P2PPipe::P2PPipe()
 	: m_socket(NULL)
 	, m_updateInterval(0U)
 	, m_updateTime(0U)
-	, m_recvJsonCallback(nullptr)
+	, m_recvSignalCallback(nullptr)
 	, m_recvKcpCallback(nullptr)
 	, m_newSessionCallback(nullptr)
 	, m_newKcpCreateCallback(nullptr)
 	, m_removeSessionCallback(nullptr)
+	, m_recvRelayCallback(nullptr)
 {
 	m_recvBuf = (char*)fc_malloc(P2P_KCP_MAX_RECV);
+	m_recvBufLen = P2P_KCP_MAX_RECV;
+
+	for (uint32_t i = 0; i < P2P_STREAM_MAX_COUNT; ++i)
+	{
+		m_streamConfig[i].type = P2P_STREAM_RELIABLE;
+		m_streamConfig[i].priority = 0;
+		m_streamConfig[i].profile = KCP_PROFILE_DEFAULT;
+		m_streamConfig[i].maxWaitSnd = P2P_STREAM_MAX_WAITSND;
+	}
+	updateStreamOrder();
 }
 
 P2PPipe::~P2PPipe()
@@ -23,9 +42,9 @@ P2PPipe::~P2PPipe()
 	fc_free(m_recvBuf);
 }
 
-bool P2PPipe::bind(const char* bindIP, uint32 binPort, uv_loop_t* loop)
+bool P2PPipe::bind(const char* bindIP, uint32 binPort, uv_loop_t* loop, bool reusePort)
 {
-	assert(m_recvJsonCallback != nullptr);
+	assert(m_recvSignalCallback != nullptr);
 	assert(m_recvKcpCallback != nullptr);
 	assert(m_newSessionCallback != nullptr);
 	assert(m_newKcpCreateCallback != nullptr);
@@ -39,9 +58,19 @@ bool P2PPipe::bind(const char* bindIP, uint32 binPort, uv_loop_t* loop)
 	m_socket = (UDPSocket*)fc_malloc(sizeof(UDPSocket));
 	new (m_socket)UDPSocket(loop);
 
+	m_socket->setReusePort(reusePort);
 	m_socket->setReadCallback(std::bind(&P2PPipe::on_udp_read, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3, std::placeholders::_4, std::placeholders::_5));
 
-	uint32 bindPort = m_socket->bind(bindIP, binPort);
+	uint32 bindPort = 0;
+	// ':'ĵַΪIPV6׽,"::"Ϊ˫ջ
+	if (strchr(bindIP, ':') != NULL)
+	{
+		bindPort = m_socket->bind6(bindIP, binPort);
+	}
+	else
+	{
+		bindPort = m_socket->bind(bindIP, binPort);
+	}
 
 	NET_UV_LOG(NET_UV_L_INFO, "bind [%u]", bindPort);
 
@@ -53,67 +82,125 @@ bool P2PPipe::bind(const char* bindIP, uint32 binPort, uv_loop_t* loop)
 	return true;
 }
 
-bool P2PPipe::kcpSend(char* data, uint32_t len, uint32_t toIP, uint32_t toPort)
+bool P2PPipe::kcpSend(char* data, uint32_t len, uint64_t key, uint32_t streamID)
 {
-	AddrInfo info;
-	info.ip = toIP;
-	info.port = toPort;
-	return kcpSend(data, len, info.key);
-}
+	if (streamID >= P2P_STREAM_MAX_COUNT)
+	{
+		return false;
+	}
 
-bool P2PPipe::kcpSend(char* data, uint32_t len, uint64_t key)
-{
-	auto it = m_allSessionDataMap.find(key);
-	if (it != m_allSessionDataMap.end() && it->second.kcp)
+	SessionData* session = m_sessionMap.find(key);
+	if (session == NULL || session->stream[0] == NULL)
 	{
-		return (ikcp_send(it->second.kcp, data, len) == 0);
+		return false;
 	}
-	return false;
-}
 
-void P2PPipe::send(P2PMessageID msgID, const char* data, int32_t len, uint32_t toIP, uint32_t toPort)
-{
-	if (msgID != P2P_MSG_ID_PING && msgID != P2P_MSG_ID_PONG && msgID != P2P_MSG_ID_KCP)
+	if (m_streamConfig[streamID].type != P2P_STREAM_RELIABLE)
 	{
-		std::string logstr(data, len);
-		NET_UV_LOG(NET_UV_L_INFO, "send to [%u]:[%u]  [%d]%s", toIP, toPort, msgID, logstr.c_str());
+		if (len > P2P_DATAGRAM_MAX_LEN)
+		{
+			return false;
+		}
+		sendDatagram(session, streamID, data, len, m_streamConfig[streamID].type == P2P_STREAM_UNRELIABLE_SEQUENCED);
+		return true;
 	}
 
-	const int32_t alloc_len = sizeof(P2PMessage) + len;
+	P2PKcpStream* stream = session->stream[streamID];
+	if (stream == NULL)
+	{
+		stream = createStream(session, streamID);
+	}
 
-	char* pData = (char*)fc_malloc(alloc_len);
+	// ȼûŶӵδʱֱӷKCP
+	// ȼͬȼŶӲӰ챾
+	if (stream->pendingQue.empty() && ikcp_waitsnd(stream->kcp) < (int32_t)m_streamConfig[streamID].maxWaitSnd &&
+		(!session->isPending || !isHigherPriorityPending(session, m_streamConfig[streamID].priority)))
+	{
+		return (ikcp_send(stream->kcp, data, len) == 0);
+	}
 
-	P2PMessage* msg = (P2PMessage*)pData;
-	msg->msgID = msgID;
-	msg->msgLen = len;
-	msg->uniqueID = 0;
+	char* pData = (char*)fc_malloc(len);
+	memcpy(pData, data, len);
+	stream->pendingQue.push(std::make_pair(pData, len));
 
-	memcpy((char*)&msg[1], data, len);
-	
-	AddrInfo info;
-	info.ip = toIP;
-	info.port = toPort;
+	if (!session->isPending)
+	{
+		session->isPending = true;
+		m_pendingSessionArr.push_back(session);
+	}
+	return true;
+}
 
-	auto it = m_allSessionDataMap.find(info.key);
-	if (it == m_allSessionDataMap.end())
+bool P2PPipe::sendUnreliable(char* data, uint32_t len, uint64_t key, uint32_t streamID, bool isSequenced)
+{
+	if (streamID >= P2P_STREAM_MAX_COUNT || len > P2P_DATAGRAM_MAX_LEN)
 	{
-		char * ipaddr = NULL;
-		char addr[32] = {0};
-		in_addr inaddr;
-		inaddr.s_addr = toIP;
-		ipaddr = inet_ntoa(inaddr);
-		strcpy(addr, ipaddr);
+		return false;
+	}
 
-		sockaddr_in send_addr;
-		uv_ip4_addr(addr, toPort, &send_addr);
+	SessionData* session = m_sessionMap.find(key);
+	if (session == NULL || session->stream[0] == NULL)
+	{
+		return false;
+	}
+	sendDatagram(session, streamID, data, len, isSequenced);
+	return true;
+}
 
-		m_socket->udpSend((const char*)msg, alloc_len, (const struct sockaddr*)&send_addr);
+bool P2PPipe::setStreamConfig(uint32_t streamID, P2PStreamType type, uint8_t priority)
+{
+	// 0ӽ,ֻΪɿ
+	if (streamID >= P2P_STREAM_MAX_COUNT || (streamID == 0 && type != P2P_STREAM_RELIABLE))
+	{
+		return false;
 	}
-	else
+	m_streamConfig[streamID].type = type;
+	m_streamConfig[streamID].priority = priority;
+	updateStreamOrder();
+	return true;
+}
+
+bool P2PPipe::setStreamKcpProfile(uint32_t streamID, const KCPProfile& profile)
+{
+	if (streamID >= P2P_STREAM_MAX_COUNT)
 	{
-		m_socket->udpSend((const char*)msg, alloc_len, (const struct sockaddr*)&it->second.send_addr);
+		return false;
 	}
-	fc_free(pData);
+	m_streamConfig[streamID].profile = profile;
+	m_streamConfig[streamID].maxWaitSnd = profile.sndwnd > P2P_STREAM_MAX_WAITSND ? profile.sndwnd : P2P_STREAM_MAX_WAITSND;
+	return true;
+}
+
+void P2PPipe::updateStreamOrder()
+{
+	m_streamOrderCount = 0;
+	for (uint32_t i = 0; i < P2P_STREAM_MAX_COUNT; ++i)
+	{
+		if (m_streamConfig[i].type != P2P_STREAM_RELIABLE)
+		{
+			continue;
+		}
+
+		// ,ͬȼID˳
+		uint32_t n = m_streamOrderCount++;
+		while (n > 0 && m_streamConfig[m_streamOrder[n - 1]].priority > m_streamConfig[i].priority)
+		{
+			m_streamOrder[n] = m_streamOrder[n - 1];
+			n--;
+		}
+		m_streamOrder[n] = i;
+	}
+}
+
+void P2PPipe::send(P2PMessageID msgID, const char* data, int32_t len, uint64_t toKey)
+{
+	struct sockaddr_storage send_addr;
+	if (!getSendAddr(toKey, &send_addr))
+	{
+		NET_UV_LOG(NET_UV_L_WARNING, "send [%d] unknown address: %llu", msgID, toKey);
+		return;
+	}
+	send(msgID, data, len, (const struct sockaddr*)&send_addr);
 }
 
 void P2PPipe::send(P2PMessageID msgID, const char* data, int32_t len, const struct sockaddr* addr)
@@ -140,13 +227,101 @@ void P2PPipe::send(P2PMessageID msgID, const char* data, int32_t len, const stru
 	fc_free(pData);
 }
 
+void P2PPipe::sendRaw(const char* data, uint32_t len, const struct sockaddr* addr)
+{
+	m_socket->udpTrySend(data, len, addr);
+}
+
+void P2PPipe::sendRelayKcp(const char* data, int32_t len, uint64_t toKey, const struct sockaddr* addr)
+{
+	const int32_t alloc_len = sizeof(P2PMessage) + len;
+
+	char* pData = (char*)fc_malloc(alloc_len);
+
+	P2PMessage* msg = (P2PMessage*)pData;
+	msg->msgID = P2PMessageID::P2P_MSG_ID_RELAY_KCP;
+	msg->msgLen = len;
+	msg->uniqueID = toKey;
+
+	memcpy((char*)&msg[1], data, len);
+
+	m_socket->udpTrySend((const char*)msg, alloc_len, addr);
+
+	fc_free(pData);
+}
+
+bool P2PPipe::createRelaySession(uint64_t key, const struct sockaddr* turnAddr)
+{
+	SessionData* session = m_sessionMap.find(key);
+	if (session == NULL)
+	{
+		createSession(key, turnAddr, true);
+		m_newSessionCallback(key);
+	}
+	else
+	{
+		// ֱɹ
+		if (session->stream[0] != NULL)
+		{
+			return false;
+		}
+		session->isRelay = true;
+		memcpy(&session->send_addr, turnAddr, p2p_getAddrLen(turnAddr));
+	}
+	createKcp(key);
+	return true;
+}
+
+void P2PPipe::removeSession(uint64_t key)
+{
+	SessionData* session = m_sessionMap.find(key);
+	if (session != NULL)
+	{
+		destroySession(session);
+	}
+}
+
+void P2PPipe::sendSignal(P2PMessageID msgID, uint64_t key, uint64_t toKey, const P2PSignalAddr* keyAddr)
+{
+	struct sockaddr_storage send_addr;
+	if (!getSendAddr(toKey, &send_addr))
+	{
+		NET_UV_LOG(NET_UV_L_WARNING, "send signal [%d] unknown address: %llu", msgID, toKey);
+		return;
+	}
+	sendSignal(msgID, key, (const struct sockaddr*)&send_addr, keyAddr);
+}
+
+void P2PPipe::sendSignal(P2PMessageID msgID, uint64_t key, const struct sockaddr* addr, const P2PSignalAddr* keyAddr)
+{
+	if (msgID != P2P_MSG_ID_PING && msgID != P2P_MSG_ID_PONG)
+	{
+		NET_UV_LOG(NET_UV_L_INFO, "send signal [%d] key: %llu", msgID, key);
+	}
+
+	char buf[P2P_SIGNAL_MAX_LEN];
+	uint32_t len = encodeSignal(buf, msgID, key, m_updateTime, keyAddr);
+	m_socket->udpTrySend(buf, len, addr);
+}
+
 void P2PPipe::disconnect(uint64_t key)
 {
-	if (isContain(key))
+	SessionData* session = m_sessionMap.find(key);
+	if (session == NULL)
+	{
+		return;
+	}
+
+	// תỰ֪ͨturnֹͣת
+	if (session->isRelay)
+	{
+		sendSignal(P2PMessageID::P2P_MSG_ID_STOP_RELAY, key, (const struct sockaddr*)&session->send_addr);
+
+		destroySession(session);
+	}
+	else
 	{
-		AddrInfo info;
-		info.key = key;
-		send(P2PMessageID::P2P_MSG_ID_C2C_DISCONNECT, P2P_NULL_JSON, P2P_NULL_JSON_LEN, info.ip, info.port);
+		sendSignal(P2PMessageID::P2P_MSG_ID_C2C_DISCONNECT, 0, (const struct sockaddr*)&session->send_addr);
 	}
 }
 
@@ -157,13 +332,34 @@ void P2PPipe::update(uint32_t updateTime)
 
 	heartCheck(interval);
 
-	for (auto & it : m_allSessionDataMap)
+	// ȴе
+	for (int32_t i = (int32_t)m_pendingSessionArr.size() - 1; i >= 0; --i)
 	{
-		if (it.second.kcp)
+		SessionData* session = m_pendingSessionArr[i];
+		schedulePending(session);
+		if (!session->isPending)
 		{
-			ikcp_update(it.second.kcp, updateTime);
+			m_pendingSessionArr[i] = m_pendingSessionArr.back();
+			m_pendingSessionArr.pop_back();
 		}
 	}
+
+	// ֻµڵ,´θʱikcp_check
+	while (!m_kcpHeap.empty())
+	{
+		P2PKcpStream* stream = m_kcpHeap[0];
+		if ((int32_t)(stream->kcpUpdateTime - updateTime) > 0)
+		{
+			break;
+		}
+
+		ikcp_update(stream->kcp, updateTime);
+
+		uint32_t nextTime = ikcp_check(stream->kcp, updateTime);
+		// ֹͬһʱظ
+		stream->kcpUpdateTime = (nextTime == updateTime) ? updateTime + 1 : nextTime;
+		kcpHeapSiftDown(0);
+	}
 }
 
 void P2PPipe::heartCheck(uint32_t interval)
@@ -175,41 +371,37 @@ void P2PPipe::heartCheck(uint32_t interval)
 	}
 	m_updateInterval = 0;
 
-	if (m_allSessionDataMap.empty())
+	if (m_sessionArr.empty())
 	{
 		return;
 	}
 
-	rapidjson::StringBuffer s;
-	rapidjson::Writer<rapidjson::StringBuffer> writer(s);
+	// лỰͬһϢ
+	char pingBuf[P2P_SIGNAL_MAX_LEN];
+	uint32_t pingLen = encodeSignal(pingBuf, P2PMessageID::P2P_MSG_ID_PING, 0, m_updateTime, NULL);
 
-	writer.StartObject();
-	writer.Key("time");
-	writer.Uint(m_updateTime);
-	writer.EndObject();
-
-	for (auto it = m_allSessionDataMap.begin(); it != m_allSessionDataMap.end(); )
+	// Ӻǰ,ƳỰʱĩβỰλ,ӰδĲ
+	for (int32_t i = (int32_t)m_sessionArr.size() - 1; i >= 0; --i)
 	{
-		if (it->second.isStartCheck)
+		if (i >= (int32_t)m_sessionArr.size())
 		{
-			if (it->second.noResponseCount > 10)
-			{
-				onSessionRemove(it);
-				it = m_allSessionDataMap.erase(it);
-			}
-			else
-			{
-				if (m_updateTime - it->second.lastCheckTime > 1500)
-				{
-					it->second.noResponseCount++;
-					send(P2PMessageID::P2P_MSG_ID_PING, s.GetString(), s.GetLength(), (const struct sockaddr*)&it->second.send_addr);
-				}
-				it++;
-			}
+			continue;
 		}
-		else
+
+		SessionData* session = m_sessionArr[i];
+		if (!session->isStartCheck)
+		{
+			continue;
+		}
+
+		if (session->noResponseCount > 10)
+		{
+			destroySession(session);
+		}
+		else if (m_updateTime - session->lastCheckTime > 1500)
 		{
-			it++;
+			session->noResponseCount++;
+			m_socket->udpTrySend(pingBuf, pingLen, (const struct sockaddr*)&session->send_addr);
 		}
 	}
 }
@@ -223,42 +415,44 @@ void P2PPipe::shutdownSocket()
 		m_socket = NULL;
 	}
 
-	for (auto it = m_allSessionDataMap.begin(); it != m_allSessionDataMap.end(); ++it)
+	while (!m_sessionArr.empty())
 	{
-		onSessionRemove(it);
+		destroySession(m_sessionArr.back());
 	}
-	m_allSessionDataMap.clear();
+	m_sessionMap.clear();
 }
 
 void P2PPipe::setSessionStartCheck(uint64_t key, bool isStartCheck)
 {
-	auto it = m_allSessionDataMap.find(key);
-	if (it != m_allSessionDataMap.end() && it->second.isStartCheck != isStartCheck)
+	SessionData* session = m_sessionMap.find(key);
+	if (session != NULL && session->isStartCheck != isStartCheck)
 	{
-		it->second.isStartCheck = isStartCheck;
-		it->second.lastCheckTime = m_updateTime;
-		it->second.noResponseCount = 0;
+		session->isStartCheck = isStartCheck;
+		session->lastCheckTime = m_updateTime;
+		session->noResponseCount = 0;
 	}
 }
 
 bool P2PPipe::isContain(uint64_t key)
 {
-	return (m_allSessionDataMap.find(key) != m_allSessionDataMap.end());
+	return (m_sessionMap.find(key) != NULL);
 }
 
 void P2PPipe::close()
 {
-	for (auto& it : m_allSessionDataMap)
+	for (auto session : m_sessionArr)
 	{
-		send(P2PMessageID::P2P_MSG_ID_C2C_DISCONNECT, P2P_NULL_JSON, P2P_NULL_JSON_LEN, (const struct sockaddr*)&it.second.send_addr);
+		// תỰturn֪ͨԷ
+		if (session->isRelay)
+			continue;
+		sendSignal(P2PMessageID::P2P_MSG_ID_C2C_DISCONNECT, 0, (const struct sockaddr*)&session->send_addr);
 	}
 	shutdownSocket();
 }
 
 void P2PPipe::on_udp_read(uv_udp_t* handle, ssize_t nread, const uv_buf_t* buf, const struct sockaddr* addr, unsigned flags)
 {
-	// ֧IPV6
-	if (addr->sa_family != AF_INET)
+	if (addr->sa_family != AF_INET && addr->sa_family != AF_INET6)
 		return;
 
 	// Уʧ
@@ -277,216 +471,771 @@ void P2PPipe::on_udp_read(uv_udp_t* handle, ssize_t nread, const uv_buf_t* buf,
 	if (msg->msgID <= P2PMessageID::P2P_MSG_ID_BEGIN || P2PMessageID::P2P_MSG_ID_END <= msg->msgID)
 		return;
 
-	const struct sockaddr_in* recv_addr = (const struct sockaddr_in*)addr;
+	uint64_t key = addrToKey(addr);
 
-	AddrInfo info;
-	info.ip = recv_addr->sin_addr.s_addr;
-	info.port = ntohs(recv_addr->sin_port);
+	// IPV6keyΪϣֵ,лỰͻ,ַһʱ
+	if (key & P2P_KEY_IPV6_FLAG)
+	{
+		SessionData* session = m_sessionMap.find(key);
+		if (session != NULL && !session->isRelay && !isSameAddr(addr, (const struct sockaddr*)&session->send_addr))
+		{
+			NET_UV_LOG(NET_UV_L_WARNING, "ipv6 key conflict: %llu", key);
+			return;
+		}
+	}
 	
 	// ϷϢ
 	char* data = buf->base + sizeof(P2PMessage);
 
+	recvData(key, addr);
+
+	// kcpʽ
+	if (msg->msgID == P2PMessageID::P2P_MSG_ID_KCP)
+	{
+		on_recv_kcpMsg(key, data, msg->msgLen, addr);
+		return;
+	}
+
+	// ת
+	if (msg->msgID == P2PMessageID::P2P_MSG_ID_RELAY_KCP)
+	{
+		SessionData* session = m_sessionMap.find(msg->uniqueID);
+		if (session != NULL && session->isRelay)
+		{
+			// תỰ¼turnַ,ֻܸturnת
+			if (isSameAddr(addr, (const struct sockaddr*)&session->send_addr))
+			{
+				on_recv_kcpMsg(msg->uniqueID, data, msg->msgLen, addr);
+			}
+		}
+		else if (m_recvRelayCallback != nullptr)
+		{
+			m_recvRelayCallback(msg, (uint32_t)nread, key, addr);
+		}
+		return;
+	}
+
+	// 
+	if (P2PMessageID::P2P_MSG_ID_SIGNAL_BEGIN < msg->msgID && msg->msgID < P2PMessageID::P2P_MSG_ID_SIGNAL_END)
+	{
+		on_recv_signal(key, msg, addr);
+	}
+}
+
+void P2PPipe::on_recv_signal(uint64_t key, P2PMessage* msg, const struct sockaddr* addr)
+{
+	P2PSignalMsg jsonMsg;
+	P2PSignalAddr jsonAddr;
+	const P2PSignalAddr* msgAddr = NULL;
+	const P2PSignalMsg* signal = decodeSignal((const char*)&msg[1], msg->msgLen, &jsonMsg, &jsonAddr, &msgAddr);
+	if (signal == NULL)
+	{
+		NET_UV_LOG(NET_UV_L_ERROR, "signal decode error: %u", msg->msgID);
+		return;
+	}
+
 #if OPEN_NET_UV_DEBUG
 	if (msg->msgID != P2PMessageID::P2P_MSG_ID_PING && msg->msgID != P2PMessageID::P2P_MSG_ID_PONG)
 	{
-		std::string recv_str(data, msg->msgLen);
-		NET_UV_LOG(NET_UV_L_INFO, "recv[%u]:[%u] : [%d]%s", info.ip, info.port, msg->msgID, recv_str.c_str());
+		NET_UV_LOG(NET_UV_L_INFO, "recv %llu : [%d] key: %llu", key, msg->msgID, (uint64_t)signal->key);
 	}
 #endif
 
-	recvData(info.key, addr);
-
-	// ping
-	if (msg->msgID == P2PMessageID::P2P_MSG_ID_PING)
+	switch (msg->msgID)
 	{
-		this->send(P2PMessageID::P2P_MSG_ID_PONG, data, msg->msgLen, addr);
-		return;
+	case P2PMessageID::P2P_MSG_ID_PING:
+	{
+		char buf[P2P_SIGNAL_MAX_LEN];
+		uint32_t len = encodeSignal(buf, P2PMessageID::P2P_MSG_ID_PONG, 0, signal->time, NULL);
+		m_socket->udpTrySend(buf, len, addr);
+	}break;
+	case P2PMessageID::P2P_MSG_ID_PONG:
+	{
+		on_recv_pong(key, *signal, addr);
+	}break;
+	case P2PMessageID::P2P_MSG_ID_CREATE_KCP:
+	{
+		on_recv_createKcp(key, *signal, addr);
+	}break;
+	case P2PMessageID::P2P_MSG_ID_CREATE_KCP_RESULT:
+	{
+		on_recv_createKcpResult(key, *signal, addr);
+	}break;
+	case P2PMessageID::P2P_MSG_ID_C2C_DISCONNECT:
+	{
+		on_recv_disconnect(key, *signal, addr);
+	}break;
+	default:
+	{
+		m_recvSignalCallback((P2PMessageID)msg->msgID, *signal, msgAddr, key, addr);
+	}break;
 	}
+}
 
-	// kcpʽ
-	if (msg->msgID == P2PMessageID::P2P_MSG_ID_KCP)
+void P2PPipe::on_recv_kcpMsg(uint64_t key, char* data, uint32_t len, const struct sockaddr* addr)
+{
+	SessionData* session = m_sessionMap.find(key);
+
+	// ӽǰֱӶ
+	if (session == NULL || session->stream[0] == NULL || len < sizeof(uint32_t))
 	{
-		on_recv_kcpMsg(info.key, data, msg->msgLen, addr);
 		return;
 	}
 
-	// jsonʽ
-	if (P2PMessageID::P2P_MSG_ID_JSON_BEGIN < msg->msgID && msg->msgID < P2PMessageID::P2P_MSG_ID_JSON_END)
+	uint32_t conv = ikcp_getconv(data);
+
+	// ɿݱ
+	if (conv == P2P_DATAGRAM_CONV)
 	{
-		rapidjson::Document document;
-		document.Parse(data, msg->msgLen);
+		P2PDatagramHead* head = (P2PDatagramHead*)data;
+		if (len < sizeof(P2PDatagramHead) || head->streamID >= P2P_STREAM_MAX_COUNT)
+		{
+			return;
+		}
 
-		if (!document.HasParseError())
+		// 
+		if (head->seq != 0)
 		{
-			// pong
-			if (msg->msgID == P2PMessageID::P2P_MSG_ID_PONG)
+			uint32_t& recvSeq = session->datagramRecvSeq[head->streamID];
+			if (recvSeq != 0 && (int32_t)(head->seq - recvSeq) <= 0)
 			{
-				on_recv_pong(info.key, document, addr);
-			}
-			// kcp create
-			else if (msg->msgID == P2PMessageID::P2P_MSG_ID_CREATE_KCP)
-			{
-				on_recv_createKcp(info.key, document, addr);
-			}
-			// kcp create result
-			else if (msg->msgID == P2PMessageID::P2P_MSG_ID_CREATE_KCP_RESULT)
-			{
-				on_recv_createKcpResult(info.key, document, addr);
-			}
-			// disconnect
-			else if (msg->msgID == P2PMessageID::P2P_MSG_ID_C2C_DISCONNECT)
-			{
-				on_recv_disconnect(info.key, document, addr);
-			}
-			else
-			{
-				m_recvJsonCallback((P2PMessageID)msg->msgID, document, info.key, addr);
+				return;
 			}
+			recvSeq = head->seq;
 		}
-		else
+		m_recvKcpCallback(data + sizeof(P2PDatagramHead), len - sizeof(P2PDatagramHead), key, head->streamID, addr);
+		return;
+	}
+
+	uint32_t streamID = conv - P2P_KCP_CONV;
+	if (conv < P2P_KCP_CONV || streamID >= P2P_STREAM_MAX_COUNT)
+	{
+		return;
+	}
+
+	P2PKcpStream* stream = session->stream[streamID];
+	if (stream == NULL)
+	{
+		// Է״ʹø
+		stream = createStream(session, streamID);
+	}
+
+	auto kcp = stream->kcp;
+	ikcp_input(kcp, data, len);
+
+	while (true)
+	{
+		int32_t size = ikcp_peeksize(kcp);
+		if (size <= 0)
+		{
+			break;
+		}
+
+		if ((uint32_t)size > m_recvBufLen)
+		{
+			fc_free(m_recvBuf);
+			m_recvBuf = (char*)fc_malloc(size);
+			m_recvBufLen = size;
+		}
+
+		int32_t kcp_recvd_bytes = ikcp_recv(kcp, m_recvBuf, m_recvBufLen);
+		if (kcp_recvd_bytes < 0)
 		{
-			NET_UV_LOG(NET_UV_L_ERROR, "json parse error: %u", document.GetParseError());
+			break;
 		}
+		m_recvKcpCallback(m_recvBuf, kcp_recvd_bytes, key, streamID, addr);
 	}
 }
 
-void P2PPipe::on_recv_kcpMsg(uint64_t key, char* data, uint32_t len, const struct sockaddr* addr)
+void P2PPipe::on_recv_pong(uint64_t key, const P2PSignalMsg& msg, const struct sockaddr* addr)
+{
+	SessionData* session = m_sessionMap.find(key);
+	if (session != NULL)
+	{
+		int32_t sub = m_updateTime - msg.time;
+		session->delayTime = sub >= 0 ? sub : -sub;
+	}
+}
+
+void P2PPipe::on_recv_createKcp(uint64_t key, const P2PSignalMsg& msg, const struct sockaddr* addr)
+{
+	createKcp(key);
+	this->sendSignal(P2PMessageID::P2P_MSG_ID_CREATE_KCP_RESULT, 0, addr);
+}
+
+void P2PPipe::on_recv_createKcpResult(uint64_t key, const P2PSignalMsg& msg, const struct sockaddr* addr)
+{
+	createKcp(key);
+}
+
+void P2PPipe::on_recv_disconnect(uint64_t key, const P2PSignalMsg& msg, const struct sockaddr* addr)
 {
-	auto it = m_allSessionDataMap.find(key);
+	removeSession(key);
+}
 
-	if (it == m_allSessionDataMap.end())
+void P2PPipe::createKcp(uint64_t key)
+{
+	SessionData* session = m_sessionMap.find(key);
+	if (session != NULL && session->stream[0] == NULL)
 	{
-		return;
+		createStream(session, 0);
+
+		// ½,ԷݱŴͷʼ
+		memset(session->datagramSendSeq, 0, sizeof(session->datagramSendSeq));
+		memset(session->datagramRecvSeq, 0, sizeof(session->datagramRecvSeq));
+
+		// תỰĴturn
+		session->isStartCheck = !session->isRelay;
+
+		m_newKcpCreateCallback(key);
 	}
+}
+
+P2PKcpStream* P2PPipe::createStream(SessionData* session, uint32_t streamID)
+{
+	P2PKcpStream* stream = (P2PKcpStream*)fc_malloc(sizeof(P2PKcpStream));
+	new (stream)P2PKcpStream();
+
+	ikcpcb* kcp = ikcp_create(P2P_KCP_CONV + streamID, stream);
+	kcp->output = P2PPipe::udp_output;
+
+	kcp_setProfile(kcp, m_streamConfig[streamID].profile);
+
+	stream->kcp = kcp;
+	stream->session = session;
+	stream->streamID = streamID;
+	stream->kcpIndex = -1;
+	stream->kcpUpdateTime = m_updateTime;
+	kcpHeapPush(stream);
+
+	session->stream[streamID] = stream;
+	return stream;
+}
+
+void P2PPipe::destroyStream(P2PKcpStream* stream)
+{
+	kcpHeapRemove(stream);
+	ikcp_release(stream->kcp);
 
-	auto kcp = it->second.kcp;
-	if (kcp == NULL)
+	while (!stream->pendingQue.empty())
 	{
-		return;
+		fc_free(stream->pendingQue.front().first);
+		stream->pendingQue.pop();
 	}
 
-	ikcp_input(kcp, data, len);
+	stream->session->stream[stream->streamID] = NULL;
+	stream->~P2PKcpStream();
+	fc_free(stream);
+}
+
+void P2PPipe::sendDatagram(SessionData* session, uint32_t streamID, const char* data, uint32_t len, bool isSequenced)
+{
+	char buf[sizeof(P2PDatagramHead) + P2P_DATAGRAM_MAX_LEN];
+	P2PDatagramHead* head = (P2PDatagramHead*)buf;
+	head->conv = P2P_DATAGRAM_CONV;
+	head->streamID = (uint8_t)streamID;
+	head->seq = 0;
+	if (isSequenced)
+	{
+		// 0ʾ,ʱ
+		uint32_t& sendSeq = session->datagramSendSeq[streamID];
+		sendSeq++;
+		if (sendSeq == 0)
+		{
+			sendSeq = 1;
+		}
+		head->seq = sendSeq;
+	}
+	memcpy(&head[1], data, len);
+
+	sendKcpOutput(session, buf, sizeof(P2PDatagramHead) + len);
+}
 
-	int32_t kcp_recvd_bytes = 0;
-	do
+void P2PPipe::sendKcpOutput(SessionData* session, const char* data, int32_t len)
+{
+	if (session->isRelay)
+	{
+		sendRelayKcp(data, len, session->key, (const sockaddr*)&session->send_addr);
+	}
+	else
 	{
-		kcp_recvd_bytes = ikcp_recv(kcp, m_recvBuf, P2P_KCP_MAX_RECV);
+		send(P2PMessageID::P2P_MSG_ID_KCP, data, len, (const sockaddr*)&session->send_addr);
+	}
+}
 
-		if (kcp_recvd_bytes < 0)
+void P2PPipe::schedulePending(SessionData* session)
+{
+	// ȼ,ȼĵȴպŴһȼ
+	// ͬȼÿָһϢ,ݶռ
+	bool isPending = false;
+	uint32_t begin = 0;
+	while (begin < m_streamOrderCount && !isPending)
+	{
+		uint8_t priority = m_streamConfig[m_streamOrder[begin]].priority;
+		uint32_t end = begin;
+		while (end < m_streamOrderCount && m_streamConfig[m_streamOrder[end]].priority == priority)
 		{
-			kcp_recvd_bytes = 0;
+			end++;
 		}
-		else
+
+		bool isSend = true;
+		while (isSend)
+		{
+			isSend = false;
+			for (uint32_t i = begin; i < end; ++i)
+			{
+				P2PKcpStream* stream = session->stream[m_streamOrder[i]];
+				if (stream == NULL || stream->pendingQue.empty() || ikcp_waitsnd(stream->kcp) >= (int32_t)m_streamConfig[stream->streamID].maxWaitSnd)
+				{
+					continue;
+				}
+
+				auto& data = stream->pendingQue.front();
+				if (ikcp_send(stream->kcp, data.first, data.second) != 0)
+				{
+					NET_UV_LOG(NET_UV_L_ERROR, "kcp send error, stream: %u len: %u", stream->streamID, data.second);
+				}
+				fc_free(data.first);
+				stream->pendingQue.pop();
+				isSend = true;
+			}
+		}
+
+		for (uint32_t i = begin; i < end; ++i)
 		{
-			m_recvKcpCallback(m_recvBuf, kcp_recvd_bytes, key, addr);
+			P2PKcpStream* stream = session->stream[m_streamOrder[i]];
+			if (stream != NULL && !stream->pendingQue.empty())
+			{
+				isPending = true;
+			}
 		}
-	} while (kcp_recvd_bytes > 0);
+		begin = end;
+	}
+	session->isPending = isPending;
 }
 
-void P2PPipe::on_recv_pong(uint64_t key, rapidjson::Document& document, const struct sockaddr* addr)
+bool P2PPipe::isHigherPriorityPending(SessionData* session, uint8_t priority)
 {
-	auto it = m_allSessionDataMap.find(key);
-	if (it != m_allSessionDataMap.end())
+	for (uint32_t i = 0; i < m_streamOrderCount; ++i)
 	{
-		if (document.HasMember("time"))
+		uint32_t streamID = m_streamOrder[i];
+		if (m_streamConfig[streamID].priority >= priority)
 		{
-			rapidjson::Value& time_value = document["time"];
-			if (time_value.IsUint())
+			break;
+		}
+		P2PKcpStream* stream = session->stream[streamID];
+		if (stream != NULL && !stream->pendingQue.empty())
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+void P2PPipe::recvData(uint64_t key, const struct sockaddr* addr)
+{
+	SessionData* session = m_sessionMap.find(key);
+	if (session == NULL)
+	{
+		createSession(key, addr, false);
+		m_newSessionCallback(key);
+	}
+	else
+	{
+		session->lastCheckTime = m_updateTime;
+		session->noResponseCount = 0;
+	}
+}
+
+SessionData* P2PPipe::createSession(uint64_t key, const struct sockaddr* addr, bool isRelay)
+{
+	SessionData* session = (SessionData*)fc_malloc(sizeof(SessionData));
+	memset(session, 0, sizeof(SessionData));
+	session->lastCheckTime = m_updateTime;
+	session->noResponseCount = 0;
+	// תỰkcpǰ
+	session->isStartCheck = !isRelay;
+	session->delayTime = 0;
+	session->pipe = this;
+	session->key = key;
+	session->isRelay = isRelay;
+	session->index = (uint32_t)m_sessionArr.size();
+	session->isPending = false;
+	memcpy(&session->send_addr, addr, p2p_getAddrLen(addr));
+
+	m_sessionMap.insert(key, session);
+	m_sessionArr.push_back(session);
+	return session;
+}
+
+void P2PPipe::destroySession(SessionData* session)
+{
+	for (uint32_t i = 0; i < P2P_STREAM_MAX_COUNT; ++i)
+	{
+		if (session->stream[i])
+		{
+			destroyStream(session->stream[i]);
+		}
+	}
+
+	if (session->isPending)
+	{
+		for (auto it = m_pendingSessionArr.begin(); it != m_pendingSessionArr.end(); ++it)
+		{
+			if (*it == session)
 			{
-				int32_t sub = m_updateTime - time_value.GetUint();
-				it->second.delayTime = sub >= 0 ? sub : -sub;
+				m_pendingSessionArr.erase(it);
+				break;
 			}
 		}
 	}
+	m_removeSessionCallback(session->key);
+
+	m_sessionMap.erase(session->key);
+
+	SessionData* last = m_sessionArr.back();
+	m_sessionArr[session->index] = last;
+	last->index = session->index;
+	m_sessionArr.pop_back();
+
+	fc_free(session);
+}
+
+void P2PPipe::kcpHeapPush(P2PKcpStream* stream)
+{
+	stream->kcpIndex = (int32_t)m_kcpHeap.size();
+	m_kcpHeap.push_back(stream);
+	kcpHeapSiftUp(stream->kcpIndex);
+}
+
+void P2PPipe::kcpHeapRemove(P2PKcpStream* stream)
+{
+	if (stream->kcpIndex < 0)
+	{
+		return;
+	}
+
+	uint32_t index = (uint32_t)stream->kcpIndex;
+	P2PKcpStream* last = m_kcpHeap.back();
+	m_kcpHeap.pop_back();
+	stream->kcpIndex = -1;
+
+	if (last != stream)
+	{
+		m_kcpHeap[index] = last;
+		last->kcpIndex = index;
+		kcpHeapSiftUp(index);
+		kcpHeapSiftDown(last->kcpIndex);
+	}
+}
+
+void P2PPipe::kcpHeapSiftUp(uint32_t index)
+{
+	P2PKcpStream* stream = m_kcpHeap[index];
+	while (index > 0)
+	{
+		uint32_t parent = (index - 1) / 2;
+		if ((int32_t)(stream->kcpUpdateTime - m_kcpHeap[parent]->kcpUpdateTime) >= 0)
+		{
+			break;
+		}
+		m_kcpHeap[index] = m_kcpHeap[parent];
+		m_kcpHeap[index]->kcpIndex = index;
+		index = parent;
+	}
+	m_kcpHeap[index] = stream;
+	stream->kcpIndex = index;
 }
 
-void P2PPipe::on_recv_createKcp(uint64_t key, rapidjson::Document& document, const struct sockaddr* addr)
+void P2PPipe::kcpHeapSiftDown(uint32_t index)
 {
-	createKcp(key, 0xFFFF);
-	this->send(P2PMessageID::P2P_MSG_ID_CREATE_KCP_RESULT, P2P_NULL_JSON, P2P_NULL_JSON_LEN, addr);
+	uint32_t count = (uint32_t)m_kcpHeap.size();
+	P2PKcpStream* stream = m_kcpHeap[index];
+	while (true)
+	{
+		uint32_t child = index * 2 + 1;
+		if (child >= count)
+		{
+			break;
+		}
+		if (child + 1 < count && (int32_t)(m_kcpHeap[child + 1]->kcpUpdateTime - m_kcpHeap[child]->kcpUpdateTime) < 0)
+		{
+			child++;
+		}
+		if ((int32_t)(m_kcpHeap[child]->kcpUpdateTime - stream->kcpUpdateTime) >= 0)
+		{
+			break;
+		}
+		m_kcpHeap[index] = m_kcpHeap[child];
+		m_kcpHeap[index]->kcpIndex = index;
+		index = child;
+	}
+	m_kcpHeap[index] = stream;
+	stream->kcpIndex = index;
 }
 
-void P2PPipe::on_recv_createKcpResult(uint64_t key, rapidjson::Document& document, const struct sockaddr* addr)
+int32_t P2PPipe::udp_output(const char *buf, int32_t len, ikcpcb *kcp, void *user)
 {
-	createKcp(key, 0xFFFF);
+	SessionData* sessionData = ((P2PKcpStream*)user)->session;
+	sessionData->pipe->sendKcpOutput(sessionData, buf, len);
+	return 0;
 }
 
-void P2PPipe::on_recv_disconnect(uint64_t key, rapidjson::Document& document, const struct sockaddr* addr)
+uint32_t P2PPipe::encodeSignal(char* buf, P2PMessageID msgID, uint64_t key, uint32_t time, const P2PSignalAddr* keyAddr)
 {
-	auto it = m_allSessionDataMap.find(key);
-	if (it != m_allSessionDataMap.end())
+	P2PMessage* msg = (P2PMessage*)buf;
+	msg->msgID = msgID;
+	msg->uniqueID = 0;
+
+	char* data = (char*)&msg[1];
+#if P2P_SIGNAL_USE_JSON == 1
+	const int32_t maxLen = P2P_SIGNAL_MAX_LEN - sizeof(P2PMessage);
+	int32_t len = snprintf(data, maxLen, "{\"key\":%llu,\"time\":%u", (unsigned long long)key, time);
+	if (keyAddr != NULL)
+	{
+		char ip[64] = { 0 };
+		uv_inet_ntop(keyAddr->family == 6 ? AF_INET6 : AF_INET, keyAddr->ip, ip, sizeof(ip));
+		len += snprintf(data + len, maxLen - len, ",\"family\":%u,\"ip\":\"%s\",\"port\":%u", keyAddr->family, ip, keyAddr->port);
+	}
+	len += snprintf(data + len, maxLen - len, "}");
+	msg->msgLen = (uint32_t)len;
+#else
+	P2PSignalMsg* signal = (P2PSignalMsg*)data;
+	signal->version = P2P_SIGNAL_VERSION;
+	signal->key = key;
+	signal->time = time;
+	msg->msgLen = sizeof(P2PSignalMsg);
+
+	if (keyAddr != NULL)
 	{
-		onSessionRemove(it);
-		m_allSessionDataMap.erase(it);
+		memcpy(data + sizeof(P2PSignalMsg), keyAddr, sizeof(P2PSignalAddr));
+		msg->msgLen += sizeof(P2PSignalAddr);
 	}
+#endif
+	return sizeof(P2PMessage) + msg->msgLen;
 }
 
-void P2PPipe::createKcp(uint64_t key, uint32_t conv)
+const P2PSignalMsg* P2PPipe::decodeSignal(const char* data, uint32_t len, P2PSignalMsg* jsonMsg, P2PSignalAddr* jsonAddr, const P2PSignalAddr** outAddr)
 {
-	auto it = m_allSessionDataMap.find(key);
-	if (it != m_allSessionDataMap.end() && it->second.kcp == NULL)
+	*outAddr = NULL;
+
+	if (len <= 0)
 	{
-		ikcpcb* kcp = ikcp_create(conv, &it->second);
-		kcp->output = P2PPipe::udp_output;
+		return NULL;
+	}
 
-		ikcp_wndsize(kcp, 128, 128);
+	// Ƹʽ,ԭؽ
+	if ((uint8_t)data[0] == P2P_SIGNAL_VERSION)
+	{
+		if (len == sizeof(P2PSignalMsg) + sizeof(P2PSignalAddr))
+		{
+			*outAddr = (const P2PSignalAddr*)(data + sizeof(P2PSignalMsg));
+		}
+		else if (len != sizeof(P2PSignalMsg))
+		{
+			return NULL;
+		}
+		return (const P2PSignalMsg*)data;
+	}
 
-		// ģʽ
-		// ڶ nodelay-Ժɳٽ
-		//  intervalΪڲʱӣĬΪ 10ms
-		// ĸ resendΪشָ꣬Ϊ2
-		//  ΪǷóأֹ
-		ikcp_nodelay(kcp, 1, 10, 2, 1);
-		//ikcp_nodelay(m_kcp, 1, 5, 1, 1); // ó1ACKԽֱش, ӦٶȻ. ڲʱ5.
+	// JSONʽ
+	if (data[0] == '{')
+	{
+		rapidjson::Document document;
+		document.Parse(data, len);
+		if (document.HasParseError() || !document.IsObject())
+		{
+			return NULL;
+		}
 
-		it->second.kcp = kcp;
+		jsonMsg->version = P2P_SIGNAL_VERSION;
+		jsonMsg->key = 0;
+		jsonMsg->time = 0;
 
-		it->second.isStartCheck = true;
+		if (document.HasMember("key") && document["key"].IsUint64())
+		{
+			jsonMsg->key = document["key"].GetUint64();
+		}
+		else if (document.HasMember("toKey") && document["toKey"].IsUint64())
+		{
+			jsonMsg->key = document["toKey"].GetUint64();
+		}
+		if (document.HasMember("time") && document["time"].IsUint())
+		{
+			jsonMsg->time = document["time"].GetUint();
+		}
 
-		m_newKcpCreateCallback(key);
+		if (document.HasMember("family") && document["family"].IsUint() &&
+			document.HasMember("ip") && document["ip"].IsString() &&
+			document.HasMember("port") && document["port"].IsUint())
+		{
+			memset(jsonAddr, 0, sizeof(P2PSignalAddr));
+			jsonAddr->family = document["family"].GetUint() == 6 ? 6 : 4;
+			jsonAddr->port = (uint16_t)document["port"].GetUint();
+			if (uv_inet_pton(jsonAddr->family == 6 ? AF_INET6 : AF_INET, document["ip"].GetString(), jsonAddr->ip) == 0)
+			{
+				*outAddr = jsonAddr;
+			}
+		}
+		return jsonMsg;
 	}
+	return NULL;
 }
 
-void P2PPipe::recvData(uint64_t key, const struct sockaddr* addr)
+uint64_t P2PPipe::addrToKey(const struct sockaddr* addr)
 {
-	auto it = m_allSessionDataMap.find(key);
-	if (it == m_allSessionDataMap.end())
+	AddrInfo info;
+	info.key = 0;
+
+	if (addr->sa_family == AF_INET)
 	{
-		SessionData sessionData;
-		sessionData.lastCheckTime = m_updateTime;
-		sessionData.noResponseCount = 0;
-		sessionData.isStartCheck = true;
-		sessionData.delayTime = 0;
-		sessionData.pipe = this;
-		sessionData.kcp = NULL;
-		memcpy(&sessionData.send_addr, addr, sizeof(sessionData.send_addr));
+		const struct sockaddr_in* addr4 = (const struct sockaddr_in*)addr;
+		info.ip = addr4->sin_addr.s_addr;
+		info.port = ntohs(addr4->sin_port);
+	}
+	else if (addr->sa_family == AF_INET6)
+	{
+		const struct sockaddr_in6* addr6 = (const struct sockaddr_in6*)addr;
+		const uint8_t* ip = (const uint8_t*)&addr6->sin6_addr;
+
+		// IPV4ӳַ,IPV4׽յĵַõͬkey
+		if (memcmp(ip, P2P_V4_MAPPED_PREFIX, sizeof(P2P_V4_MAPPED_PREFIX)) == 0)
+		{
+			memcpy(&info.ip, ip + 12, 4);
+			info.port = ntohs(addr6->sin6_port);
+		}
+		else
+		{
+			// FNV-1a
+			uint64_t h = 14695981039346656037ULL;
+			for (int32_t i = 0; i < 16; ++i)
+			{
+				h ^= ip[i];
+				h *= 1099511628211ULL;
+			}
+			uint16_t port = ntohs(addr6->sin6_port);
+			h ^= (port & 0xFF);
+			h *= 1099511628211ULL;
+			h ^= (port >> 8);
+			h *= 1099511628211ULL;
+			info.key = h | P2P_KEY_IPV6_FLAG;
+		}
+	}
+	return info.key;
+}
 
-		m_allSessionDataMap.insert(std::make_pair(key, sessionData));
+bool P2PPipe::toSignalAddr(const struct sockaddr* addr, P2PSignalAddr* outAddr)
+{
+	memset(outAddr, 0, sizeof(P2PSignalAddr));
 
-		m_newSessionCallback(key);
+	if (addr->sa_family == AF_INET)
+	{
+		const struct sockaddr_in* addr4 = (const struct sockaddr_in*)addr;
+		outAddr->family = 4;
+		outAddr->port = ntohs(addr4->sin_port);
+		memcpy(outAddr->ip, &addr4->sin_addr, 4);
+		return true;
 	}
-	else
+	if (addr->sa_family == AF_INET6)
 	{
-		it->second.lastCheckTime = m_updateTime;
-		it->second.noResponseCount = 0;
+		const struct sockaddr_in6* addr6 = (const struct sockaddr_in6*)addr;
+		const uint8_t* ip = (const uint8_t*)&addr6->sin6_addr;
+		outAddr->port = ntohs(addr6->sin6_port);
+		if (memcmp(ip, P2P_V4_MAPPED_PREFIX, sizeof(P2P_V4_MAPPED_PREFIX)) == 0)
+		{
+			outAddr->family = 4;
+			memcpy(outAddr->ip, ip + 12, 4);
+		}
+		else
+		{
+			outAddr->family = 6;
+			memcpy(outAddr->ip, ip, 16);
+		}
+		return true;
 	}
+	return false;
 }
 
-void P2PPipe::onSessionRemove(std::map<uint64_t, SessionData>::iterator& it)
+bool P2PPipe::isSameAddr(const struct sockaddr* addr1, const struct sockaddr* addr2)
 {
-	if (it->second.kcp)
+	P2PSignalAddr signalAddr1;
+	P2PSignalAddr signalAddr2;
+	if (!toSignalAddr(addr1, &signalAddr1) || !toSignalAddr(addr2, &signalAddr2))
 	{
-		ikcp_release(it->second.kcp);
-		it->second.kcp = NULL;
+		return false;
 	}
-	m_removeSessionCallback(it->first);
+	return memcmp(&signalAddr1, &signalAddr2, sizeof(P2PSignalAddr)) == 0;
 }
 
-int32_t P2PPipe::udp_output(const char *buf, int32_t len, ikcpcb *kcp, void *user)
+bool P2PPipe::getSendAddr(uint64_t key, struct sockaddr_storage* outAddr)
 {
-	SessionData* sessionData = (SessionData*)user;
-	sessionData->pipe->send(P2PMessageID::P2P_MSG_ID_KCP, buf, len, (const sockaddr*)&sessionData->send_addr);
-	return 0;
+	// תỰ¼turnַ
+	SessionData* session = m_sessionMap.find(key);
+	if (session != NULL && !session->isRelay)
+	{
+		memcpy(outAddr, &session->send_addr, sizeof(struct sockaddr_storage));
+		return true;
+	}
+
+	// IPV6key޷ԭַ
+	if (key & P2P_KEY_IPV6_FLAG)
+	{
+		return false;
+	}
+
+	AddrInfo info;
+	info.key = key;
+
+	P2PSignalAddr signalAddr;
+	memset(&signalAddr, 0, sizeof(signalAddr));
+	signalAddr.family = 4;
+	signalAddr.port = (uint16_t)info.port;
+	memcpy(signalAddr.ip, &info.ip, 4);
+	return toSendAddr(signalAddr, outAddr);
+}
+
+bool P2PPipe::getSignalAddr(uint64_t key, P2PSignalAddr* outAddr)
+{
+	struct sockaddr_storage send_addr;
+	if (!getSendAddr(key, &send_addr))
+	{
+		return false;
+	}
+	return toSignalAddr((const struct sockaddr*)&send_addr, outAddr);
+}
+
+bool P2PPipe::toSendAddr(const P2PSignalAddr& signalAddr, struct sockaddr_storage* outAddr)
+{
+	memset(outAddr, 0, sizeof(struct sockaddr_storage));
+
+	if (isIPV6())
+	{
+		struct sockaddr_in6* addr6 = (struct sockaddr_in6*)outAddr;
+		addr6->sin6_family = AF_INET6;
+		addr6->sin6_port = htons(signalAddr.port);
+		if (signalAddr.family == 4)
+		{
+			memcpy(&addr6->sin6_addr, P2P_V4_MAPPED_PREFIX, sizeof(P2P_V4_MAPPED_PREFIX));
+			memcpy(((uint8_t*)&addr6->sin6_addr) + 12, signalAddr.ip, 4);
+		}
+		else
+		{
+			memcpy(&addr6->sin6_addr, signalAddr.ip, 16);
+		}
+		return true;
+	}
+
+	// IPV4׽޷IPV6ַ
+	if (signalAddr.family != 4)
+	{
+		return false;
+	}
+
+	struct sockaddr_in* addr4 = (struct sockaddr_in*)outAddr;
+	addr4->sin_family = AF_INET;
+	addr4->sin_port = htons(signalAddr.port);
+	memcpy(&addr4->sin_addr, signalAddr.ip, 4);
+	return true;
 }
 
 NS_NET_UV_END
@@ -2,16 +2,44 @@
 
 #include "P2PCommon.h"
 #include "P2PMessage.h"
+#include "P2PSessionMap.h"
 
 NS_NET_UV_BEGIN
 
-using P2PPipeRecvJsonCallback = std::function<void(P2PMessageID msgID, rapidjson::Document& document, uint64_t key, const struct sockaddr* addr)>;
-using P2PPipeRecvKcpCallback = std::function<void(char* data, uint32_t len, uint64_t key, const struct sockaddr* addr)>;
+// msgAddr:Яmsg.keyӦĵַ,δЯʱΪNULL
+using P2PPipeRecvSignalCallback = std::function<void(P2PMessageID msgID, const P2PSignalMsg& msg, const P2PSignalAddr* msgAddr, uint64_t key, const struct sockaddr* addr)>;
+using P2PPipeRecvKcpCallback = std::function<void(char* data, uint32_t len, uint64_t key, uint32_t streamID, const struct sockaddr* addr)>;
 using P2PPipeNewSessionCallback = std::function<void(uint64_t key)>;
 using P2PPipeNewKcpCreateCallback = std::function<void(uint64_t key)>;
 using P2PPipeRemoveSessionCallback = std::function<void(uint64_t key)>;
+// յҪתתϢ,msgָջ,ԭ޸ĺֱת
+using P2PPipeRecvRelayCallback = std::function<void(P2PMessage* msg, uint32_t len, uint64_t key, const struct sockaddr* addr)>;
+
+// 
+enum P2PStreamType
+{
+	P2P_STREAM_RELIABLE,	// ɿ(KCP)
+	P2P_STREAM_UNRELIABLE,	// ɿ(ݱ)
+	P2P_STREAM_UNRELIABLE_SEQUENCED,	// ɿ(ݱ),շյݸɵ
+};
 
 class P2PPipe;
+struct SessionData;
+
+// ɿ
+struct P2PKcpStream
+{
+	ikcpcb* kcp;
+	SessionData* session;
+	uint32_t streamID;
+	// KCP¶еλ
+	int32_t kcpIndex;
+	// ´ִikcp_updateʱ
+	uint32_t kcpUpdateTime;
+	// ȴkcp
+	std::queue<std::pair<char*, uint32_t>> pendingQue;
+};
+
 struct SessionData
 {
 	// Ӧ
@@ -19,15 +47,26 @@ struct SessionData
 	// һʱ
 	uint32_t lastCheckTime;
 	// ַ
-	sockaddr_in send_addr;
+	sockaddr_storage send_addr;
 	// Ƿʼ
 	bool isStartCheck;
 	// ӳʱ
 	uint32_t delayTime;
-	// kcp
-	ikcpcb* kcp;
+	// ɿ,stream[0]ʾѽ
+	P2PKcpStream* stream[P2P_STREAM_MAX_COUNT];
 	//pipe
 	P2PPipe* pipe;
+	// Ựkey
+	uint64_t key;
+	// Ƿturnת,תỰĵַΪturnַ
+	bool isRelay;
+	// ڻỰеλ
+	uint32_t index;
+	// ǷĵȴвΪ
+	bool isPending;
+	// ݱ,0ʾ
+	uint32_t datagramSendSeq[P2P_STREAM_MAX_COUNT];
+	uint32_t datagramRecvSeq[P2P_STREAM_MAX_COUNT];
 };
 
 class P2PPipe
@@ -40,16 +79,40 @@ public:
 
 	virtual ~P2PPipe();
 	
-	bool bind(const char* bindIP, uint32 binPort, uv_loop_t* loop);
+	// reusePort:ǷSO_REUSEPORT,ܵͬһ˿ʱʹ
+	bool bind(const char* bindIP, uint32 binPort, uv_loop_t* loop, bool reusePort = false);
 
-	bool kcpSend(char* data, uint32_t len, uint32_t toIP, uint32_t toPort);
+	bool kcpSend(char* data, uint32_t len, uint64_t key, uint32_t streamID = 0);
 
-	bool kcpSend(char* data, uint32_t len, uint64_t key);
+	// KCPֱӷݱ,,ȲܳP2P_DATAGRAM_MAX_LEN
+	// isSequenced:Ƿ,ʱշ
+	bool sendUnreliable(char* data, uint32_t len, uint64_t key, uint32_t streamID, bool isSequenced);
 
-	void send(P2PMessageID msgID, const char* data, int32_t len, uint32_t toIP, uint32_t toPort);
+	// ͺȼ(ֵԽСȼԽ),˫һ
+	bool setStreamConfig(uint32_t streamID, P2PStreamType type, uint8_t priority);
+
+	// ÿɿkcp,֮󴴽Ч,˫ɲͬ
+	// ڴP2P_STREAM_MAX_WAITSNDʱ,ĵȴ淢ʹ
+	bool setStreamKcpProfile(uint32_t streamID, const KCPProfile& profile);
+
+	void send(P2PMessageID msgID, const char* data, int32_t len, uint64_t toKey);
 
 	void send(P2PMessageID msgID, const char* data, int32_t len, const struct sockaddr* addr);
 
+	// Ϣ
+	// keyAddr:͵keyӦַ,ΪNULL
+	void sendSignal(P2PMessageID msgID, uint64_t key, uint64_t toKey, const P2PSignalAddr* keyAddr = NULL);
+
+	void sendSignal(P2PMessageID msgID, uint64_t key, const struct sockaddr* addr, const P2PSignalAddr* keyAddr = NULL);
+
+	// ԭʼ,
+	void sendRaw(const char* data, uint32_t len, const struct sockaddr* addr);
+
+	// turnתĻỰ
+	bool createRelaySession(uint64_t key, const struct sockaddr* turnAddr);
+
+	void removeSession(uint64_t key);
+
 	void disconnect(uint64_t key);
 
 	void update(uint32_t updateTime);
@@ -58,9 +121,29 @@ public:
 
 	bool isContain(uint64_t key);
 
+	// ȡkeyĵַ,ʹûỰм¼ĵַ,IPV4 keyԭ
+	bool getSendAddr(uint64_t key, struct sockaddr_storage* outAddr);
+
+	// ȡkeyӦַ
+	bool getSignalAddr(uint64_t key, P2PSignalAddr* outAddr);
+
+	// ַתΪ׽ֿõķ͵ַ,˫ջ׽IPV4ַתΪIPV4ӳַ
+	bool toSendAddr(const P2PSignalAddr& signalAddr, struct sockaddr_storage* outAddr);
+
+	inline bool isIPV6();
+
+	// ɵַkey,IPV4ӳַIPV4
+	static uint64_t addrToKey(const struct sockaddr* addr);
+
+	// ȽϵַͶ˿,IPV4ӳַIPV4ַΪͬ
+	static bool isSameAddr(const struct sockaddr* addr1, const struct sockaddr* addr2);
+
+	// ַתΪַ,IPV4ӳַתΪIPV4
+	static bool toSignalAddr(const struct sockaddr* addr, P2PSignalAddr* outAddr);
+
 	void close();
 
-	inline void setRecvJsonCallback(const P2PPipeRecvJsonCallback& call);
+	inline void setRecvSignalCallback(const P2PPipeRecvSignalCallback& call);
 
 	inline void setRecvKcpCallback(const P2PPipeRecvKcpCallback& call);
 
@@ -70,6 +153,8 @@ public:
 
 	inline void setRemoveSessionCallback(const P2PPipeRemoveSessionCallback& call);
 
+	inline void setRecvRelayCallback(const P2PPipeRecvRelayCallback& call);
+
 protected:
 
 	void heartCheck(uint32_t interval);
@@ -80,46 +165,108 @@ protected:
 
 	void on_recv_kcpMsg(uint64_t key, char* data, uint32_t len, const struct sockaddr* addr);
 
-	void on_recv_pong(uint64_t key, rapidjson::Document& document, const struct sockaddr* addr);
+	void on_recv_signal(uint64_t key, P2PMessage* msg, const struct sockaddr* addr);
+
+	void on_recv_pong(uint64_t key, const P2PSignalMsg& msg, const struct sockaddr* addr);
+
+	void on_recv_createKcp(uint64_t key, const P2PSignalMsg& msg, const struct sockaddr* addr);
+
+	void on_recv_createKcpResult(uint64_t key, const P2PSignalMsg& msg, const struct sockaddr* addr);
+
+	void on_recv_disconnect(uint64_t key, const P2PSignalMsg& msg, const struct sockaddr* addr);
+
+	void createKcp(uint64_t key);
 
-	void on_recv_createKcp(uint64_t key, rapidjson::Document& document, const struct sockaddr* addr);
+	P2PKcpStream* createStream(SessionData* session, uint32_t streamID);
 
-	void on_recv_createKcpResult(uint64_t key, rapidjson::Document& document, const struct sockaddr* addr);
+	void destroyStream(P2PKcpStream* stream);
 
-	void on_recv_disconnect(uint64_t key, rapidjson::Document& document, const struct sockaddr* addr);
+	void sendDatagram(SessionData* session, uint32_t streamID, const char* data, uint32_t len, bool isSequenced);
 
-	void createKcp(uint64_t key, uint32_t conv);
+	void sendKcpOutput(SessionData* session, const char* data, int32_t len);
+
+	// ȼȴеݷKCP
+	void schedulePending(SessionData* session);
+
+	// Ƿȼpriorityڵȴ
+	bool isHigherPriorityPending(SessionData* session, uint8_t priority);
+
+	void updateStreamOrder();
+
+	void sendRelayKcp(const char* data, int32_t len, uint64_t toKey, const struct sockaddr* addr);
 
 	void recvData(uint64_t key, const struct sockaddr* addr);
 
-	void onSessionRemove(std::map<uint64_t, SessionData>::iterator& it);
+	SessionData* createSession(uint64_t key, const struct sockaddr* addr, bool isRelay);
+
+	// ƳͷŻỰ
+	void destroySession(SessionData* data);
+
+	/// KCP¶
+	// kcpUpdateTimeС,ÿֻµڵ
+	void kcpHeapPush(P2PKcpStream* stream);
+
+	void kcpHeapRemove(P2PKcpStream* stream);
+
+	void kcpHeapSiftUp(uint32_t index);
+
+	void kcpHeapSiftDown(uint32_t index);
 
 protected:
 
 	static int32_t udp_output(const char *buf, int32_t len, ikcpcb *kcp, void *user);
 
+	// Ϣ(P2PMessage),رĳ
+	static uint32_t encodeSignal(char* buf, P2PMessageID msgID, uint64_t key, uint32_t time, const P2PSignalAddr* keyAddr);
+
+	// Ϣ,Ƹʽֱָdata,JSONʽjsonMsg/jsonAddr
+	// outAddr:Яĵַ,δЯʱΪNULL
+	static const P2PSignalMsg* decodeSignal(const char* data, uint32_t len, P2PSignalMsg* jsonMsg, P2PSignalAddr* jsonAddr, const P2PSignalAddr** outAddr);
+
 protected:
 
 	UDPSocket* m_socket;
 
-	std::map<uint64_t, SessionData> m_allSessionDataMap;
+	// Ự
+	P2PSessionMap<SessionData> m_sessionMap;
+	// лỰ,ȱ
+	std::vector<SessionData*> m_sessionArr;
+	// пɿ
+	std::vector<P2PKcpStream*> m_kcpHeap;
+	// ݵȴKCPĻỰ
+	std::vector<SessionData*> m_pendingSessionArr;
+
+	struct StreamConfig
+	{
+		P2PStreamType type;
+		uint8_t priority;
+		KCPProfile profile;
+		// ѷKCPδȷϵƬ
+		uint32_t maxWaitSnd;
+	};
+	StreamConfig m_streamConfig[P2P_STREAM_MAX_COUNT];
+	// ȼĿɿID
+	uint32_t m_streamOrder[P2P_STREAM_MAX_COUNT];
+	uint32_t m_streamOrderCount;
 	// ¼
 	uint32_t m_updateInterval;
 	// ʱ
 	uint32_t m_updateTime;
 
 	char *m_recvBuf;
+	uint32_t m_recvBufLen;
 
-	P2PPipeRecvJsonCallback m_recvJsonCallback;
+	P2PPipeRecvSignalCallback m_recvSignalCallback;
 	P2PPipeRecvKcpCallback m_recvKcpCallback;
 	P2PPipeNewSessionCallback m_newSessionCallback;
 	P2PPipeNewKcpCreateCallback m_newKcpCreateCallback;
 	P2PPipeRemoveSessionCallback m_removeSessionCallback;
+	P2PPipeRecvRelayCallback m_recvRelayCallback;
 };
 
-void P2PPipe::setRecvJsonCallback(const P2PPipeRecvJsonCallback& call)
+void P2PPipe::setRecvSignalCallback(const P2PPipeRecvSignalCallback& call)
 {
-	m_recvJsonCallback = std::move(call);
+	m_recvSignalCallback = std::move(call);
 }
 
 void P2PPipe::setRecvKcpCallback(const P2PPipeRecvKcpCallback& call)
@@ -142,4 +289,14 @@ void P2PPipe::setRemoveSessionCallback(const P2PPipeRemoveSessionCallback& call)
 	m_removeSessionCallback = std::move(call);
 }
 
+bool P2PPipe::isIPV6()
+{
+	return m_socket != NULL && m_socket->isIPV6();
+}
+
+void P2PPipe::setRecvRelayCallback(const P2PPipeRecvRelayCallback& call)
+{
+	m_recvRelayCallback = std::move(call);
+}
+
 NS_NET_UV_END
@@ -0,0 +1,199 @@
+#pragma once
+
+#include "P2PCommon.h"
+
+NS_NET_UV_BEGIN
+
+// uint64_tΪkeyĹϣ(Ѱַ,̽)
+// ָֻ,ɵ߷,ݺɾʱֲַ
+// ʼΪ2,س3/4ʱ,ɾʱǰƺԪ,ʹĹ
+template<typename T>
+class P2PSessionMap
+{
+	enum { MIN_CAPACITY = 16 };
+
+	struct Slot
+	{
+		uint64_t key;
+		T* value;	// ΪNULLʱʾղ
+	};
+
+	Slot* m_slots;
+	uint32_t m_capacity;
+	uint32_t m_size;
+	uint32_t m_shift;	// 64 - log2(m_capacity)
+public:
+	P2PSessionMap()
+		: m_slots(NULL)
+		, m_capacity(0)
+		, m_size(0)
+		, m_shift(64)
+	{}
+
+	P2PSessionMap(const P2PSessionMap&) = delete;
+
+	~P2PSessionMap()
+	{
+		if (m_slots)
+		{
+			fc_free(m_slots);
+		}
+	}
+
+	inline uint32_t size()
+	{
+		return m_size;
+	}
+
+	inline bool empty()
+	{
+		return m_size == 0;
+	}
+
+	T* find(uint64_t key)
+	{
+		if (m_size == 0)
+		{
+			return NULL;
+		}
+
+		uint32_t mask = m_capacity - 1;
+		for (uint32_t i = hashKey(key) & mask; ; i = (i + 1) & mask)
+		{
+			Slot& slot = m_slots[i];
+			if (slot.value == NULL)
+			{
+				return NULL;
+			}
+			if (slot.key == key)
+			{
+				return slot.value;
+			}
+		}
+		return NULL;
+	}
+
+	// keyѴʱfalse
+	bool insert(uint64_t key, T* value)
+	{
+		assert(value != NULL);
+
+		if ((m_size + 1) * 4 > m_capacity * 3)
+		{
+			rehash(m_capacity == 0 ? (uint32_t)MIN_CAPACITY : m_capacity * 2);
+		}
+
+		uint32_t mask = m_capacity - 1;
+		for (uint32_t i = hashKey(key) & mask; ; i = (i + 1) & mask)
+		{
+			Slot& slot = m_slots[i];
+			if (slot.value == NULL)
+			{
+				slot.key = key;
+				slot.value = value;
+				m_size++;
+				return true;
+			}
+			if (slot.key == key)
+			{
+				return false;
+			}
+		}
+		return false;
+	}
+
+	// رƳĶ,ʱNULL
+	T* erase(uint64_t key)
+	{
+		if (m_size == 0)
+		{
+			return NULL;
+		}
+
+		uint32_t mask = m_capacity - 1;
+		uint32_t i = hashKey(key) & mask;
+		for (; ; i = (i + 1) & mask)
+		{
+			if (m_slots[i].value == NULL)
+			{
+				return NULL;
+			}
+			if (m_slots[i].key == key)
+			{
+				break;
+			}
+		}
+
+		T* value = m_slots[i].value;
+		m_slots[i].value = NULL;
+		m_size--;
+
+		// ̽ϵĺԪǰ,֤Ҳǰղ
+		for (uint32_t j = (i + 1) & mask; m_slots[j].value != NULL; j = (j + 1) & mask)
+		{
+			uint32_t home = hashKey(m_slots[j].key) & mask;
+			// home(i, j]ʱſƶi
+			if (((j - home) & mask) >= ((j - i) & mask))
+			{
+				m_slots[i] = m_slots[j];
+				m_slots[j].value = NULL;
+				i = j;
+			}
+		}
+		return value;
+	}
+
+	void clear()
+	{
+		if (m_slots)
+		{
+			memset(m_slots, 0, sizeof(Slot) * m_capacity);
+		}
+		m_size = 0;
+	}
+
+private:
+
+	inline uint32_t hashKey(uint64_t key)
+	{
+		// Fibonacciϣ,ȡ˻ĸλ,IPV4 keyIPͶ˿ڶֻܳ
+		return (uint32_t)((key * 0x9E3779B97F4A7C15ULL) >> m_shift);
+	}
+
+	void rehash(uint32_t newCapacity)
+	{
+		Slot* oldSlots = m_slots;
+		uint32_t oldCapacity = m_capacity;
+
+		m_slots = (Slot*)fc_malloc(sizeof(Slot) * newCapacity);
+		memset(m_slots, 0, sizeof(Slot) * newCapacity);
+		m_capacity = newCapacity;
+		m_shift = 64;
+		for (uint32_t n = newCapacity; n > 1; n >>= 1)
+		{
+			m_shift--;
+		}
+
+		uint32_t mask = m_capacity - 1;
+		for (uint32_t n = 0; n < oldCapacity; ++n)
+		{
+			if (oldSlots[n].value == NULL)
+			{
+				continue;
+			}
+			uint32_t i = hashKey(oldSlots[n].key) & mask;
+			while (m_slots[i].value != NULL)
+			{
+				i = (i + 1) & mask;
+			}
+			m_slots[i] = oldSlots[n];
+		}
+
+		if (oldSlots)
+		{
+			fc_free(oldSlots);
+		}
+	}
+};
+
+NS_NET_UV_END
\ No newline at end of file
@@ -3,139 +3,101 @@
 NS_NET_UV_BEGIN
 
 P2PTurn::P2PTurn()
-	: m_state(TurnState::STOP)
-{
-	memset(&m_loop, 0, sizeof(m_loop));
-	memset(&m_idle, 0, sizeof(m_idle));
-
-	m_pipe.setRecvJsonCallback(std::bind(&P2PTurn::onPipeRecvJsonCallback, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3, std::placeholders::_4));
-	m_pipe.setRecvKcpCallback(std::bind(&P2PTurn::onPipeRecvKcpCallback, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3, std::placeholders::_4));
-	m_pipe.setNewSessionCallback(std::bind(&P2PTurn::onPipeNewSessionCallback, this, std::placeholders::_1));
-	m_pipe.setNewKcpCreateCallback(std::bind(&P2PTurn::onPipeNewKcpCreateCallback, this, std::placeholders::_1));
-	m_pipe.setRemoveSessionCallback(std::bind(&P2PTurn::onPipeRemoveSessionCallback, this, std::placeholders::_1));
-}
+{}
 
 P2PTurn::~P2PTurn()
 {
 	stop();
-	this->join();
+	destroyShards();
 }
 
-bool P2PTurn::start(const char* ip, uint32_t port)
+bool P2PTurn::start(const char* ip, uint32_t port, uint32_t shardCount)
 {
-	if (m_state != TurnState::STOP)
+	if (!m_shardArr.empty())
 	{
 		return false;
 	}
-	
-	uv_loop_init(&m_loop);
 
-	if (m_pipe.bind(ip, port, &m_loop) == false)
+	if (shardCount < 1)
 	{
-		uv_run(&m_loop, UV_RUN_DEFAULT);
-		uv_loop_close(&m_loop);
-		return false;
+		shardCount = 1;
+	}
+
+#if !defined(SO_REUSEPORT)
+	if (shardCount > 1)
+	{
+		NET_UV_LOG(NET_UV_L_WARNING, "SO_REUSEPORT not supported, turn shard count: 1");
+		shardCount = 1;
 	}
-	m_state = TurnState::START;
+#endif
 
-	startThread();
+	// Ƭͬһ˿
+	if (port == 0 && shardCount > 1)
+	{
+		NET_UV_LOG(NET_UV_L_WARNING, "turn port is 0, turn shard count: 1");
+		shardCount = 1;
+	}
 
+	// ȴзƬ,Ƭ߳ʱƬ鲻ٸı
+	for (uint32_t i = 0; i < shardCount; ++i)
+	{
+		P2PTurnShard* shard = (P2PTurnShard*)fc_malloc(sizeof(P2PTurnShard));
+		new (shard)P2PTurnShard(this, i);
+		m_shardArr.push_back(shard);
+	}
+
+	for (auto shard : m_shardArr)
+	{
+		if (shard->start(ip, port, shardCount > 1) == false)
+		{
+			stop();
+			destroyShards();
+			return false;
+		}
+	}
 	return true;
 }
 
 void P2PTurn::stop()
 {
-	m_state = TurnState::WILL_STOP;
-}
-
-/// Runnable
-void P2PTurn::run()
-{
-	uv_idle_init(&m_loop, &m_idle);
-	m_idle.data = this;
-	uv_idle_start(&m_idle, P2PTurn::uv_on_idle_run);
-	
-	uv_run(&m_loop, UV_RUN_DEFAULT);
-	uv_loop_close(&m_loop);
-
-	m_state = TurnState::STOP;
+	for (auto shard : m_shardArr)
+	{
+		shard->stop();
+	}
 }
 
-void P2PTurn::onIdleRun()
+void P2PTurn::postMail(uint32_t toShard, const P2PTurnMail& mail)
 {
-	m_pipe.update(iclock());
-	if (m_state == TurnState::WILL_STOP)
+	if (toShard < m_shardArr.size())
 	{
-		m_pipe.close();
-		uv_idle_stop(&m_idle);
+		m_shardArr[toShard]->postMail(mail);
 	}
-	ThreadSleep(1);
 }
 
-void P2PTurn::onPipeRecvJsonCallback(P2PMessageID msgID, rapidjson::Document& document, uint64_t key, const struct sockaddr* addr)
+void P2PTurn::broadcastMail(uint32_t fromShard, const P2PTurnMail& mail)
 {
-	switch (msgID)
+	for (uint32_t i = 0; i < m_shardArr.size(); ++i)
 	{
-	case net_uv::P2P_MSG_ID_C2T_CLIENT_LOGIN:
-	{
-		rapidjson::StringBuffer s;
-		rapidjson::Writer<rapidjson::StringBuffer> writer(s);
-
-		writer.StartObject();
-		writer.Key("key");
-		writer.Uint64(key);
-		writer.EndObject();
-
-		m_pipe.send(P2PMessageID::P2P_MSG_ID_T2C_CLIENT_LOGIN_RESULT, s.GetString(), s.GetLength(), addr);
-	}
-		break;
-	case net_uv::P2P_MSG_ID_C2T_WANT_TO_CONNECT:
-	{
-		if (document.HasMember("toKey"))
+		if (i != fromShard)
 		{
-			rapidjson::Value& key_value = document["toKey"];
-			if (key_value.IsUint64())
-			{
-				rapidjson::StringBuffer s;
-				rapidjson::Writer<rapidjson::StringBuffer> writer(s);
-
-				writer.StartObject();
-				writer.Key("key");
-				writer.Uint64(key);
-				writer.EndObject();
-
-				AddrInfo info;
-				info.key = key_value.GetUint64();
-
-				m_pipe.send(P2PMessageID::P2P_MSG_ID_T2C_START_BURROW, s.GetString(), s.GetLength(), info.ip, info.port);
-			}
+			m_shardArr[i]->postMail(mail);
 		}
 	}
-		break;
-	default:
-		break;
-	}
 }
 
-void P2PTurn::onPipeRecvKcpCallback(char* data, uint32_t len, uint64_t key, const struct sockaddr* addr)
-{}
-
-void P2PTurn::onPipeNewSessionCallback(uint64_t key)
+void P2PTurn::destroyShards()
 {
-	NET_UV_LOG(NET_UV_L_INFO,"%llu\t", key);
-}
-
-void P2PTurn::onPipeNewKcpCreateCallback(uint64_t key)
-{}
-
-void P2PTurn::onPipeRemoveSessionCallback(uint64_t key)
-{
-	NET_UV_LOG(NET_UV_L_INFO, "%llu\t뿪\n", key);
-}
-
-void P2PTurn::uv_on_idle_run(uv_idle_t* handle)
-{
-	((P2PTurn*)handle->data)->onIdleRun();
+	// Ƭ֮ụͶϢ,ȫ߳˳ͷ
+	for (auto shard : m_shardArr)
+	{
+		shard->join();
+	}
+	for (auto shard : m_shardArr)
+	{
+		shard->~P2PTurnShard();
+		fc_free(shard);
+	}
+	m_shardArr.clear();
 }
 
-NS_NET_UV_END
+NS_NET_UV_END
\ No newline at end of file
@@ -1,10 +1,13 @@
 #pragma once
 
-#include "P2PPipe.h"
+#include "P2PTurnShard.h"
 
 NS_NET_UV_BEGIN
 
-class P2PTurn : public Runnable
+// turn
+// Ƭ1ʱÿƬһ¼ѭ,ͨSO_REUSEPORT˿
+// Ŀڵ㲻ڱƬʱ,򶴺ת󾭷ƬϢת
+class P2PTurn
 {
 public:
 
@@ -14,42 +17,31 @@ public:
 
 	virtual ~P2PTurn();
 
-	bool start(const char* ip, uint32_t port);
+	// shardCount:Ƭ,ϵͳ֧SO_REUSEPORT˿Ϊ0ʱֻʹһƬ
+	bool start(const char* ip, uint32_t port, uint32_t shardCount = P2P_TURN_SHARD_COUNT);
 
 	void stop();
 
-protected:
-	/// Runnable
-	virtual void run()override;
+	inline uint32_t getShardCount();
 
-	void onIdleRun();
+	/// P2PTurnShard
+	void postMail(uint32_t toShard, const P2PTurnMail& mail);
 
-	void onPipeRecvJsonCallback(P2PMessageID msgID, rapidjson::Document& document, uint64_t key, const struct sockaddr* addr);
-	
-	void onPipeRecvKcpCallback(char* data, uint32_t len, uint64_t key, const struct sockaddr* addr);
-	
-	void onPipeNewSessionCallback(uint64_t key);
-	
-	void onPipeNewKcpCreateCallback(uint64_t key);
-	
-	void onPipeRemoveSessionCallback(uint64_t key);
+	// ͶݸfromShardзƬ
+	void broadcastMail(uint32_t fromShard, const P2PTurnMail& mail);
 
 protected:
 
-	static void uv_on_idle_run(uv_idle_t* handle);
+	void destroyShards();
 
 protected:
-	P2PPipe m_pipe;
-
-	enum TurnState
-	{
-		STOP,
-		START,
-		WILL_STOP,
-	};
-	TurnState m_state;
-	uv_loop_t m_loop;
-	uv_idle_t m_idle;
+
+	std::vector<P2PTurnShard*> m_shardArr;
 };
 
-NS_NET_UV_END
+uint32_t P2PTurn::getShardCount()
+{
+	return (uint32_t)m_shardArr.size();
+}
+
+NS_NET_UV_END
\ No newline at end of file
@@ -0,0 +1,526 @@
+#include "P2PTurnShard.h"
+#include "P2PTurn.h"
+
+NS_NET_UV_BEGIN
+
+P2PTurnShard::P2PTurnShard(P2PTurn* turn, uint32_t shardIndex)
+	: m_turn(turn)
+	, m_shardIndex(shardIndex)
+	, m_state(TurnState::STOP)
+{
+	memset(&m_loop, 0, sizeof(m_loop));
+	memset(&m_idle, 0, sizeof(m_idle));
+
+	m_pipe.setRecvSignalCallback(std::bind(&P2PTurnShard::onPipeRecvSignalCallback, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3, std::placeholders::_4, std::placeholders::_5));
+	m_pipe.setRecvKcpCallback(std::bind(&P2PTurnShard::onPipeRecvKcpCallback, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3, std::placeholders::_4, std::placeholders::_5));
+	m_pipe.setNewSessionCallback(std::bind(&P2PTurnShard::onPipeNewSessionCallback, this, std::placeholders::_1));
+	m_pipe.setNewKcpCreateCallback(std::bind(&P2PTurnShard::onPipeNewKcpCreateCallback, this, std::placeholders::_1));
+	m_pipe.setRemoveSessionCallback(std::bind(&P2PTurnShard::onPipeRemoveSessionCallback, this, std::placeholders::_1));
+#if P2P_OPEN_RELAY == 1
+	m_pipe.setRecvRelayCallback(std::bind(&P2PTurnShard::onPipeRecvRelayCallback, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3, std::placeholders::_4));
+	m_curTime = 0;
+	m_relayStatTime = 0;
+#endif
+}
+
+P2PTurnShard::~P2PTurnShard()
+{
+	stop();
+	this->join();
+}
+
+bool P2PTurnShard::start(const char* ip, uint32_t port, bool reusePort)
+{
+	if (m_state != TurnState::STOP)
+	{
+		return false;
+	}
+	
+	uv_loop_init(&m_loop);
+
+	if (m_pipe.bind(ip, port, &m_loop, reusePort) == false)
+	{
+		uv_run(&m_loop, UV_RUN_DEFAULT);
+		uv_loop_close(&m_loop);
+		return false;
+	}
+	m_state = TurnState::START;
+
+	startThread();
+
+	return true;
+}
+
+void P2PTurnShard::stop()
+{
+	m_state = TurnState::WILL_STOP;
+}
+
+void P2PTurnShard::postMail(const P2PTurnMail& mail)
+{
+	m_mailMutex.lock();
+	m_mailQue.push(mail);
+	m_mailMutex.unlock();
+}
+
+/// Runnable
+void P2PTurnShard::run()
+{
+	uv_idle_init(&m_loop, &m_idle);
+	m_idle.data = this;
+	uv_idle_start(&m_idle, P2PTurnShard::uv_on_idle_run);
+	
+	uv_run(&m_loop, UV_RUN_DEFAULT);
+	uv_loop_close(&m_loop);
+
+	m_state = TurnState::STOP;
+}
+
+void P2PTurnShard::onIdleRun()
+{
+	uint32_t curTime = iclock();
+	m_pipe.update(curTime);
+
+	executeMail();
+
+#if P2P_OPEN_RELAY == 1
+	m_curTime = curTime;
+	if (m_curTime - m_relayStatTime >= P2P_RELAY_STAT_LOG_INTERVAL)
+	{
+		m_relayStatTime = m_curTime;
+		logRelayStat();
+	}
+#endif
+
+	if (m_state == TurnState::WILL_STOP)
+	{
+		m_pipe.close();
+		uv_idle_stop(&m_idle);
+	}
+	ThreadSleep(1);
+}
+
+void P2PTurnShard::onPipeRecvSignalCallback(P2PMessageID msgID, const P2PSignalMsg& msg, const P2PSignalAddr*, uint64_t key, const struct sockaddr* addr)
+{
+	switch (msgID)
+	{
+	case net_uv::P2P_MSG_ID_C2T_CLIENT_LOGIN:
+	{
+		m_pipe.sendSignal(P2PMessageID::P2P_MSG_ID_T2C_CLIENT_LOGIN_RESULT, key, addr);
+	}
+		break;
+	case net_uv::P2P_MSG_ID_C2T_WANT_TO_CONNECT:
+	{
+		P2PSignalAddr fromAddr;
+		if (!P2PPipe::toSignalAddr(addr, &fromAddr))
+		{
+			break;
+		}
+
+		if (m_pipe.isContain(msg.key) || m_turn->getShardCount() == 1)
+		{
+			sendStartBurrow(key, fromAddr, msg.key, addr);
+		}
+		else
+		{
+			// ĿڵƬ
+			P2PTurnMail mail;
+			mail.what = P2PTurnMail::WANT_TO_CONNECT;
+			mail.fromShard = m_shardIndex;
+			mail.fromKey = key;
+			mail.toKey = msg.key;
+			mail.addr = fromAddr;
+			m_turn->broadcastMail(m_shardIndex, mail);
+		}
+	}
+		break;
+#if P2P_OPEN_RELAY == 1
+	case net_uv::P2P_MSG_ID_C2T_WANT_TO_RELAY:
+	{
+		startRelay(key, msg.key);
+	}
+		break;
+	case net_uv::P2P_MSG_ID_STOP_RELAY:
+	{
+		stopRelay(key, msg.key);
+	}
+		break;
+#endif
+	default:
+		break;
+	}
+}
+
+void P2PTurnShard::onPipeRecvKcpCallback(char*, uint32_t, uint64_t, uint32_t, const struct sockaddr*)
+{}
+
+void P2PTurnShard::onPipeNewSessionCallback(uint64_t key)
+{
+	NET_UV_LOG(NET_UV_L_INFO,"%llu\t", key);
+}
+
+void P2PTurnShard::onPipeNewKcpCreateCallback(uint64_t)
+{}
+
+void P2PTurnShard::onPipeRemoveSessionCallback(uint64_t key)
+{
+	NET_UV_LOG(NET_UV_L_INFO, "%llu\t뿪\n", key);
+
+#if P2P_OPEN_RELAY == 1
+	// رʱ׽ͷ,֪ͨ
+	if (m_state == TurnState::WILL_STOP)
+	{
+		m_relayPairMap.clear();
+		m_relayPeerMap.clear();
+		return;
+	}
+
+	// Ƴýڵת֪ͨԷ
+	auto it = m_relayPeerMap.find(key);
+	if (it == m_relayPeerMap.end())
+	{
+		return;
+	}
+	std::vector<uint64_t> peerKeys(it->second.begin(), it->second.end());
+	for (auto peerKey : peerKeys)
+	{
+		stopRelay(key, peerKey);
+	}
+#endif
+}
+
+void P2PTurnShard::onPipeRecvRelayCallback(P2PMessage* msg, uint32_t len, uint64_t key, const struct sockaddr*)
+{
+#if P2P_OPEN_RELAY == 1
+	RelayKey relayKey;
+	relayKey.key1 = key < msg->uniqueID ? key : msg->uniqueID;
+	relayKey.key2 = key < msg->uniqueID ? msg->uniqueID : key;
+
+	// δתֱӶ
+	auto it = m_relayPairMap.find(relayKey);
+	if (it == m_relayPairMap.end())
+	{
+		return;
+	}
+
+	RelayPair& pair = it->second;
+	int32_t from = (pair.nodeKey[0] == key) ? 0 : 1;
+	RelayStat& stat = pair.stat[from];
+
+	if (m_curTime - pair.windowTime >= 1000)
+	{
+		pair.windowTime = m_curTime;
+		pair.stat[0].windowBytes = 0;
+		pair.stat[1].windowBytes = 0;
+	}
+
+#if P2P_RELAY_MAX_BYTES_PER_SECOND > 0
+	// ,KCPش
+	if (stat.windowBytes + len > P2P_RELAY_MAX_BYTES_PER_SECOND)
+	{
+		stat.dropBytes += len;
+		return;
+	}
+#endif
+
+	stat.windowBytes += len;
+	stat.bytes += len;
+	stat.packets++;
+
+	// дΪԴkeyԭת
+	msg->uniqueID = key;
+	m_pipe.sendRaw((const char*)msg, len, (const struct sockaddr*)&pair.addr[1 - from]);
+#else
+	(void)msg;
+	(void)len;
+	(void)key;
+#endif
+}
+
+void P2PTurnShard::executeMail()
+{
+	if (m_mailMutex.trylock() != 0)
+	{
+		return;
+	}
+
+	if (m_mailQue.empty())
+	{
+		m_mailMutex.unlock();
+		return;
+	}
+
+	while (!m_mailQue.empty())
+	{
+		m_mailDispatchQue.push(m_mailQue.front());
+		m_mailQue.pop();
+	}
+	m_mailMutex.unlock();
+
+	while (!m_mailDispatchQue.empty())
+	{
+		if (m_state == TurnState::START)
+		{
+			onRecvMail(m_mailDispatchQue.front());
+		}
+		m_mailDispatchQue.pop();
+	}
+}
+
+void P2PTurnShard::onRecvMail(const P2PTurnMail& mail)
+{
+	switch (mail.what)
+	{
+	case P2PTurnMail::WANT_TO_CONNECT:
+	{
+		// ֻĿڵڷƬ
+		if (!m_pipe.isContain(mail.toKey))
+		{
+			break;
+		}
+
+		sockaddr_storage fromSendAddr;
+		if (m_pipe.toSendAddr(mail.addr, &fromSendAddr))
+		{
+			sendStartBurrow(mail.fromKey, mail.addr, mail.toKey, (const struct sockaddr*)&fromSendAddr);
+		}
+	}
+		break;
+#if P2P_OPEN_RELAY == 1
+	case P2PTurnMail::WANT_TO_RELAY:
+	{
+		if (!m_pipe.isContain(mail.toKey))
+		{
+			break;
+		}
+
+		sockaddr_storage fromAddr;
+		sockaddr_storage toAddr;
+		P2PTurnMail reply;
+		if (!m_pipe.toSendAddr(mail.addr, &fromAddr) || !m_pipe.getSendAddr(mail.toKey, &toAddr) || !m_pipe.getSignalAddr(mail.toKey, &reply.addr))
+		{
+			break;
+		}
+
+		addRelayPair(mail.fromKey, fromAddr, mail.toKey, toAddr);
+
+		// ڷƬ,ת𷽷
+		reply.what = P2PTurnMail::ADD_RELAY;
+		reply.fromShard = m_shardIndex;
+		reply.fromKey = mail.toKey;
+		reply.toKey = mail.fromKey;
+		m_turn->postMail(mail.fromShard, reply);
+
+		m_pipe.sendSignal(P2PMessageID::P2P_MSG_ID_T2C_START_RELAY, mail.toKey, (const struct sockaddr*)&fromAddr);
+		m_pipe.sendSignal(P2PMessageID::P2P_MSG_ID_T2C_START_RELAY, mail.fromKey, (const struct sockaddr*)&toAddr);
+	}
+		break;
+	case P2PTurnMail::ADD_RELAY:
+	{
+		sockaddr_storage fromAddr;
+		sockaddr_storage toAddr;
+		if (m_pipe.toSendAddr(mail.addr, &fromAddr) && m_pipe.getSendAddr(mail.toKey, &toAddr))
+		{
+			addRelayPair(mail.fromKey, fromAddr, mail.toKey, toAddr);
+		}
+	}
+		break;
+	case P2PTurnMail::STOP_RELAY:
+	{
+		RelayKey relayKey;
+		relayKey.key1 = mail.fromKey < mail.toKey ? mail.fromKey : mail.toKey;
+		relayKey.key2 = mail.fromKey < mail.toKey ? mail.toKey : mail.fromKey;
+		removeRelayPair(relayKey);
+	}
+		break;
+#endif
+	default:
+		break;
+	}
+}
+
+void P2PTurnShard::sendStartBurrow(uint64_t fromKey, const P2PSignalAddr& fromAddr, uint64_t toKey, const struct sockaddr* fromSendAddr)
+{
+	P2PSignalAddr toAddr;
+	if (!m_pipe.getSignalAddr(toKey, &toAddr))
+	{
+		return;
+	}
+
+	// ָЯ𷽵ַ
+	m_pipe.sendSignal(P2PMessageID::P2P_MSG_ID_T2C_START_BURROW, fromKey, toKey, &fromAddr);
+
+	// IPV6ڵ޷keyԭַ,ͬʱĿַ֪
+	if (toKey & P2P_KEY_IPV6_FLAG)
+	{
+		m_pipe.sendSignal(P2PMessageID::P2P_MSG_ID_T2C_START_BURROW, toKey, fromSendAddr, &toAddr);
+	}
+}
+
+void P2PTurnShard::startRelay(uint64_t fromKey, uint64_t toKey)
+{
+#if P2P_OPEN_RELAY == 1
+	// ֻΪѵ¼Ľڵ㽨ת
+	if (fromKey == toKey || !m_pipe.isContain(fromKey))
+	{
+		return;
+	}
+
+	if (!m_pipe.isContain(toKey))
+	{
+		// ĿڵƬ,ڷƬת
+		P2PTurnMail mail;
+		if (m_turn->getShardCount() > 1 && m_pipe.getSignalAddr(fromKey, &mail.addr))
+		{
+			mail.what = P2PTurnMail::WANT_TO_RELAY;
+			mail.fromShard = m_shardIndex;
+			mail.fromKey = fromKey;
+			mail.toKey = toKey;
+			m_turn->broadcastMail(m_shardIndex, mail);
+		}
+		return;
+	}
+
+	sockaddr_storage fromAddr;
+	sockaddr_storage toAddr;
+	if (!m_pipe.getSendAddr(fromKey, &fromAddr) || !m_pipe.getSendAddr(toKey, &toAddr))
+	{
+		return;
+	}
+
+	addRelayPair(fromKey, fromAddr, toKey, toAddr);
+
+	// ֪ͨ˫תѽ,ظʱط,ֹ֪ͨʧ
+	m_pipe.sendSignal(P2PMessageID::P2P_MSG_ID_T2C_START_RELAY, toKey, (const struct sockaddr*)&fromAddr);
+	m_pipe.sendSignal(P2PMessageID::P2P_MSG_ID_T2C_START_RELAY, fromKey, (const struct sockaddr*)&toAddr);
+#else
+	(void)fromKey;
+	(void)toKey;
+#endif
+}
+
+void P2PTurnShard::stopRelay(uint64_t fromKey, uint64_t toKey)
+{
+#if P2P_OPEN_RELAY == 1
+	RelayKey relayKey;
+	relayKey.key1 = fromKey < toKey ? fromKey : toKey;
+	relayKey.key2 = fromKey < toKey ? toKey : fromKey;
+
+	auto it = m_relayPairMap.find(relayKey);
+	if (it == m_relayPairMap.end())
+	{
+		return;
+	}
+
+	RelayPair& pair = it->second;
+	NET_UV_LOG(NET_UV_L_INFO, "[shard %u] relay stop %llu <-> %llu  time: %us  bytes: %llu/%llu  packets: %llu/%llu  drop: %llu/%llu",
+		m_shardIndex, relayKey.key1, relayKey.key2, (m_curTime - pair.createTime) / 1000,
+		pair.stat[0].bytes, pair.stat[1].bytes,
+		pair.stat[0].packets, pair.stat[1].packets,
+		pair.stat[0].dropBytes, pair.stat[1].dropBytes);
+
+	sockaddr_storage toAddr = pair.addr[pair.nodeKey[0] == toKey ? 0 : 1];
+	removeRelayPair(relayKey);
+
+	// ֪ͨԷתֹͣ
+	m_pipe.sendSignal(P2PMessageID::P2P_MSG_ID_STOP_RELAY, fromKey, (const struct sockaddr*)&toAddr);
+
+	// ƳƬеľ
+	if (!m_pipe.isContain(toKey) && m_turn->getShardCount() > 1)
+	{
+		P2PTurnMail mail;
+		memset(&mail, 0, sizeof(mail));
+		mail.what = P2PTurnMail::STOP_RELAY;
+		mail.fromShard = m_shardIndex;
+		mail.fromKey = fromKey;
+		mail.toKey = toKey;
+		m_turn->broadcastMail(m_shardIndex, mail);
+	}
+#else
+	(void)fromKey;
+	(void)toKey;
+#endif
+}
+
+#if P2P_OPEN_RELAY == 1
+P2PTurnShard::RelayPair* P2PTurnShard::addRelayPair(uint64_t key1, const sockaddr_storage& addr1, uint64_t key2, const sockaddr_storage& addr2)
+{
+	RelayKey relayKey;
+	relayKey.key1 = key1 < key2 ? key1 : key2;
+	relayKey.key2 = key1 < key2 ? key2 : key1;
+
+	if (m_relayPairMap.find(relayKey) != m_relayPairMap.end())
+	{
+		return NULL;
+	}
+
+	RelayPair pair;
+	memset(&pair, 0, sizeof(pair));
+	pair.nodeKey[0] = relayKey.key1;
+	pair.nodeKey[1] = relayKey.key2;
+	pair.addr[0] = key1 < key2 ? addr1 : addr2;
+	pair.addr[1] = key1 < key2 ? addr2 : addr1;
+	pair.windowTime = m_curTime;
+	pair.createTime = m_curTime;
+
+	NET_UV_LOG(NET_UV_L_INFO, "[shard %u] relay start %llu <-> %llu", m_shardIndex, relayKey.key1, relayKey.key2);
+
+	m_relayPeerMap[relayKey.key1].insert(relayKey.key2);
+	m_relayPeerMap[relayKey.key2].insert(relayKey.key1);
+	return &m_relayPairMap.insert(std::make_pair(relayKey, pair)).first->second;
+}
+
+void P2PTurnShard::removeRelayPair(const RelayKey& relayKey)
+{
+	if (m_relayPairMap.erase(relayKey) == 0)
+	{
+		return;
+	}
+
+	uint64_t keyArr[2] = { relayKey.key1, relayKey.key2 };
+	for (int32_t i = 0; i < 2; ++i)
+	{
+		auto it = m_relayPeerMap.find(keyArr[i]);
+		if (it != m_relayPeerMap.end())
+		{
+			it->second.erase(keyArr[1 - i]);
+			if (it->second.empty())
+			{
+				m_relayPeerMap.erase(it);
+			}
+		}
+	}
+}
+#endif
+
+void P2PTurnShard::logRelayStat()
+{
+#if P2P_OPEN_RELAY == 1
+	if (m_relayPairMap.empty())
+	{
+		return;
+	}
+
+	uint64_t totalBytes = 0;
+	uint64_t totalPackets = 0;
+	uint64_t totalDropBytes = 0;
+	for (auto& it : m_relayPairMap)
+	{
+		for (int32_t i = 0; i < 2; ++i)
+		{
+			totalBytes += it.second.stat[i].bytes;
+			totalPackets += it.second.stat[i].packets;
+			totalDropBytes += it.second.stat[i].dropBytes;
+		}
+	}
+	NET_UV_LOG(NET_UV_L_INFO, "[shard %u] relay pairs: %u  bytes: %llu  packets: %llu  drop: %llu",
+		m_shardIndex, (uint32_t)m_relayPairMap.size(), totalBytes, totalPackets, totalDropBytes);
+#endif
+}
+
+void P2PTurnShard::uv_on_idle_run(uv_idle_t* handle)
+{
+	((P2PTurnShard*)handle->data)->onIdleRun();
+}
+
+NS_NET_UV_END
@@ -0,0 +1,155 @@
+#pragma once
+
+#include "P2PPipe.h"
+#include <unordered_map>
+#include <unordered_set>
+
+NS_NET_UV_BEGIN
+
+class P2PTurn;
+
+// ƬϢ
+struct P2PTurnMail
+{
+	enum What
+	{
+		WANT_TO_CONNECT,	// תĿڵڷƬ
+		WANT_TO_RELAY,		// תתĿڵڷƬ
+		ADD_RELAY,			// ĿڵڷƬѽת,֪ͨڷƬ
+		STOP_RELAY,			// תֹͣ,ƬƳ
+	};
+	uint32_t what;
+	uint32_t fromShard;
+	uint64_t fromKey;
+	uint64_t toKey;
+	// fromKeyӦĵַ
+	P2PSignalAddr addr;
+};
+
+// turnƬ
+// ÿƬӵж¼ѭ߳,ƬͨSO_REUSEPORTͬһ˿
+// ں˰Դַݰ̶ĳƬ,ڵĻỰֻһƬ
+class P2PTurnShard : public Runnable
+{
+public:
+
+	P2PTurnShard(P2PTurn* turn, uint32_t shardIndex);
+
+	P2PTurnShard(const P2PTurnShard&) = delete;
+
+	virtual ~P2PTurnShard();
+
+	bool start(const char* ip, uint32_t port, bool reusePort);
+
+	void stop();
+
+	// ͶݷƬϢ,̵߳
+	void postMail(const P2PTurnMail& mail);
+
+protected:
+	/// Runnable
+	virtual void run()override;
+
+	void onIdleRun();
+
+	void onPipeRecvSignalCallback(P2PMessageID msgID, const P2PSignalMsg& msg, const P2PSignalAddr* msgAddr, uint64_t key, const struct sockaddr* addr);
+
+	void onPipeRecvKcpCallback(char* data, uint32_t len, uint64_t key, uint32_t streamID, const struct sockaddr* addr);
+
+	void onPipeNewSessionCallback(uint64_t key);
+
+	void onPipeNewKcpCreateCallback(uint64_t key);
+
+	void onPipeRemoveSessionCallback(uint64_t key);
+
+	void onPipeRecvRelayCallback(P2PMessage* msg, uint32_t len, uint64_t key, const struct sockaddr* addr);
+
+	void executeMail();
+
+	void onRecvMail(const P2PTurnMail& mail);
+
+	// ֪ͨĿڵ㿪ʼ,fromAddrΪ𷽵ַ
+	void sendStartBurrow(uint64_t fromKey, const P2PSignalAddr& fromAddr, uint64_t toKey, const struct sockaddr* fromSendAddr);
+
+	void startRelay(uint64_t fromKey, uint64_t toKey);
+
+	void stopRelay(uint64_t fromKey, uint64_t toKey);
+
+	void logRelayStat();
+
+protected:
+
+	static void uv_on_idle_run(uv_idle_t* handle);
+
+protected:
+	P2PPipe m_pipe;
+	P2PTurn* m_turn;
+	uint32_t m_shardIndex;
+
+	enum TurnState
+	{
+		STOP,
+		START,
+		WILL_STOP,
+	};
+	TurnState m_state;
+	uv_loop_t m_loop;
+	uv_idle_t m_idle;
+
+	// ƬϢ
+	Mutex m_mailMutex;
+	std::queue<P2PTurnMail> m_mailQue;
+	std::queue<P2PTurnMail> m_mailDispatchQue;
+
+#if P2P_OPEN_RELAY == 1
+	// תͳ
+	struct RelayStat
+	{
+		uint64_t bytes;			// תֽ
+		uint64_t packets;		// ת
+		uint64_t dropBytes;		// ƶֽ
+		uint32_t windowBytes;	// ǰͳתֽ
+	};
+	// ת nodeKey[0] < nodeKey[1]
+	struct RelayPair
+	{
+		uint64_t nodeKey[2];
+		sockaddr_storage addr[2];
+		RelayStat stat[2];		// stat[i] : nodeKey[i]
+		uint32_t windowTime;	// ǰͳʼʱ
+		uint32_t createTime;
+	};
+	struct RelayKey
+	{
+		uint64_t key1;
+		uint64_t key2;
+		bool operator==(const RelayKey& other) const
+		{
+			return key1 == other.key1 && key2 == other.key2;
+		}
+	};
+	struct RelayKeyHash
+	{
+		size_t operator()(const RelayKey& k) const
+		{
+			uint64_t h = k.key1 * 0x9E3779B97F4A7C15ULL;
+			h ^= k.key2 + 0x9E3779B97F4A7C15ULL + (h << 6) + (h >> 2);
+			return (size_t)h;
+		}
+	};
+
+	// ת,ѴʱNULL
+	RelayPair* addRelayPair(uint64_t key1, const sockaddr_storage& addr1, uint64_t key2, const sockaddr_storage& addr2);
+
+	// ƳתԼ
+	void removeRelayPair(const RelayKey& relayKey);
+
+	std::unordered_map<RelayKey, RelayPair, RelayKeyHash> m_relayPairMap;
+	// ڵkey -> 佨תĽڵkey,ڵ뿪ʱȫת
+	std::unordered_map<uint64_t, std::unordered_set<uint64_t>> m_relayPeerMap;
+	uint32_t m_curTime;
+	uint32_t m_relayStatTime;
+#endif
+};
+
+NS_NET_UV_END
\ No newline at end of file
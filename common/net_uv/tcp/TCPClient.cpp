@@ -20,6 +20,12 @@ enum
 	TCP_CLI_OP_CLIENT_CLOSE,	//ͻ˳
 	TCP_CLI_OP_REMOVE_SESSION,	//ƳỰ
 	TCP_CLI_OP_DELETE_SESSION,	//ɾỰ
+	TCP_CLI_OP_STREAM_CONSUMED,	//ӦòѴ
+	TCP_CLI_OP_SEND_MSG,		//UV߳дϢ
+	TCP_CLI_OP_SET_COMPRESS,	//ûỰѹģʽ
+	TCP_CLI_OP_SET_WRITE_MERGE,	//ûỰͺϲ
+	TCP_CLI_OP_QUERY_HOT_SESSION,	//ѯȵỰ
+	TCP_CLI_OP_SEND_STREAM,		//Ƭ
 };
 
 // Ӳ
@@ -65,6 +71,7 @@ TCPClient::TCPClient()
 	, m_enableKeepAlive(true)
 	, m_keepAliveDelay(10)
 	, m_isStop(false)
+	, m_recvStreamCall(nullptr)
 {
 	uv_loop_init(&m_loop);
 	
@@ -77,6 +84,12 @@ TCPClient::TCPClient()
 	m_clientUpdateTimer.data = this;
 	uv_timer_start(&m_clientUpdateTimer, uv_client_update_timer_run, (uint64_t)(TCP_CLIENT_TIMER_DELAY * 1000), (uint64_t)(TCP_CLIENT_TIMER_DELAY * 1000));
 
+#if TCP_OPEN_WRITE_MERGE == 1
+	uv_check_init(&m_loop, &m_writeMergeCheck);
+	m_writeMergeCheck.data = this;
+	uv_check_start(&m_writeMergeCheck, uv_on_write_merge_check_run);
+#endif
+
 	this->startThread();
 }
 
@@ -125,6 +138,7 @@ void TCPClient::updateFrame()
 		return;
 	}
 
+	m_loopStats.onDispatchMsg(m_msgQue.size());
 	while (!m_msgQue.empty())
 	{
 		m_msgDispatchQue.push(m_msgQue.front());
@@ -140,9 +154,21 @@ void TCPClient::updateFrame()
 		{
 		case NetThreadMsgType::RECV_DATA:
 		{
+			m_loopStats.onRecvMsg(Msg.pushTime, Msg.dataLen);
 			m_recvCall(this, Msg.pSession, Msg.data, Msg.dataLen);
 			fc_free(Msg.data);
 		}break;
+		case NetThreadMsgType::RECV_STREAM:
+		{
+			m_loopStats.onRecvMsg(Msg.pushTime, Msg.dataLen);
+			TCPStreamHead* sh = (TCPStreamHead*)Msg.data;
+			if (m_recvStreamCall != nullptr)
+			{
+				m_recvStreamCall(this, Msg.pSession, sh->streamID, sh->state, Msg.data + sizeof(TCPStreamHead), Msg.dataLen - sizeof(TCPStreamHead));
+			}
+			fc_free(Msg.data);
+			pushOperation(TCP_CLI_OP_STREAM_CONSUMED, NULL, Msg.dataLen, Msg.pSession->getSessionID());
+		}break;
 		case NetThreadMsgType::CONNECT_FAIL:
 		{
 			if (m_connectCall != nullptr)
@@ -166,6 +192,7 @@ void TCPClient::updateFrame()
 		}break;
 		case NetThreadMsgType::DIS_CONNECT:
 		{
+			clearStreamSendLen(Msg.pSession->getSessionID());
 			if (m_disconnectCall != nullptr)
 			{
 				m_disconnectCall(this, Msg.pSession);
@@ -175,8 +202,20 @@ void TCPClient::updateFrame()
 		{
 			closeClientTag = true;
 		}break;
+		case NetThreadMsgType::HOT_SESSION:
+		{
+			if (m_hotSessionCall != nullptr)
+			{
+				m_hotSessionCall(this, (NetSessionTraffic*)Msg.data, Msg.dataLen);
+			}
+			if (Msg.data)
+			{
+				fc_free(Msg.data);
+			}
+		}break;
 		case NetThreadMsgType::REMOVE_SESSION:
 		{
+			setCompressSession(Msg.pSession->getSessionID(), false);
 			if (m_removeSessionCall != nullptr)
 			{
 				m_removeSessionCall(this, Msg.pSession);
@@ -201,6 +240,14 @@ void TCPClient::removeSession(uint32_t sessionId)
 
 /// SessionManager
 
+void TCPClient::queryHotSession(uint32_t count, NetHotSessionSort sort)
+{
+	if (m_isStop)
+		return;
+
+	pushOperation(TCP_CLI_OP_QUERY_HOT_SESSION, NULL, count, (uint32_t)sort);
+}
+
 void TCPClient::disconnect(uint32_t sessionId)
 {
 	if (m_isStop)
@@ -216,6 +263,20 @@ void TCPClient::send(uint32_t sessionId, char* data, uint32_t len)
 
 	if (data == 0 || len <= 0)
 		return;
+
+	m_loopStats.onSendMsg(len);
+
+#if TCP_OPEN_COMPRESS == 1
+	// ѹĻỰϢUV̰߳Ựѹģʽ
+	if (len >= TCP_COMPRESS_MIN_LEN && isCompressSession(sessionId))
+	{
+		char* p = (char*)fc_malloc(len);
+		memcpy(p, data, len);
+		pushOperation(TCP_CLI_OP_SEND_MSG, p, len, sessionId);
+		return;
+	}
+#endif
+
 	int32_t bufCount = 0;
 
 	uv_buf_t* bufArr = tcp_packageData(data, len, &bufCount);
@@ -231,6 +292,77 @@ void TCPClient::send(uint32_t sessionId, char* data, uint32_t len)
 }
 
 /// TCPClient
+bool TCPClient::sendStream(uint32_t sessionId, uint32_t streamID, TCPStreamState state, char* data, uint32_t len)
+{
+	if (m_isStop)
+		return false;
+
+#if TCP_OPEN_STREAM_MSG == 1
+	// BEGIN/ENDƬ
+	if (state != TCPStreamState::DATA && len > TCP_STREAM_CHUNK_MAX_LEN)
+		return false;
+
+	// ͻ,ɵ÷Ժ
+	if (!checkStreamSendLen(sessionId, len, TCP_STREAM_SEND_MAX_LEN))
+		return false;
+
+	// ȫƬɹύ,Զյ
+	uint32_t msgLen = len;
+	std::vector<uv_buf_t> bufArr;
+	do
+	{
+		uint32_t chunklen = (len > TCP_STREAM_CHUNK_MAX_LEN) ? TCP_STREAM_CHUNK_MAX_LEN : len;
+
+		uint32_t sendlen = 0;
+		char* senddata = tcp_packageStreamData(streamID, state, data, chunklen, &sendlen);
+		if (senddata == NULL)
+		{
+			for (auto& buf : bufArr)
+			{
+				fc_free(buf.base);
+			}
+			return false;
+		}
+		bufArr.push_back(uv_buf_init(senddata, sendlen));
+
+		data = data + chunklen;
+		len = len - chunklen;
+	} while (len > 0);
+
+	m_loopStats.onSendMsg(msgLen);
+	for (auto& buf : bufArr)
+	{
+		addStreamSendLen(sessionId, (uint32_t)buf.len);
+		pushOperation(TCP_CLI_OP_SEND_STREAM, buf.base, (uint32_t)buf.len, sessionId);
+	}
+	return true;
+#else
+	assert(0);
+	return false;
+#endif
+}
+
+void TCPClient::setSessionCompressMode(uint32_t sessionId, NetCompressMode mode)
+{
+	if (m_isStop)
+		return;
+
+	setCompressSession(sessionId, mode != NetCompressMode::NONE);
+	pushOperation(TCP_CLI_OP_SET_COMPRESS, NULL, (uint32_t)mode, sessionId);
+}
+
+void TCPClient::setSessionWriteMerge(uint32_t sessionId, bool enable, uint32_t flushLen, uint32_t flushDelay)
+{
+	if (m_isStop)
+		return;
+
+	TCPWriteMergeConfig* config = (TCPWriteMergeConfig*)fc_malloc(sizeof(TCPWriteMergeConfig));
+	config->enable = enable;
+	config->flushLen = flushLen;
+	config->flushDelay = flushDelay;
+	pushOperation(TCP_CLI_OP_SET_WRITE_MERGE, config, sizeof(TCPWriteMergeConfig), sessionId);
+}
+
 bool TCPClient::isCloseFinish()
 {
 	return (m_clientStage == clientStage::STOP);
@@ -348,6 +480,7 @@ void TCPClient::executeOperation()
 		return;
 	}
 
+	m_loopStats.onDispatchOperation(m_operationQue.size());
 	while (!m_operationQue.empty())
 	{
 		m_operationDispatchQue.push(m_operationQue.front());
@@ -358,6 +491,7 @@ void TCPClient::executeOperation()
 	while (!m_operationDispatchQue.empty())
 	{
 		auto & curOperation = m_operationDispatchQue.front();
+		m_loopStats.onExecuteOperation(curOperation.pushTime);
 		switch (curOperation.operationType)
 		{
 		case TCP_CLI_OP_SENDDATA:		// ݷ
@@ -372,6 +506,58 @@ void TCPClient::executeOperation()
 				fc_free(curOperation.operationData);
 			}
 		}break;
+		case TCP_CLI_OP_SEND_STREAM:	// Ƭ
+		{
+			uint32_t writeQueLen = 0;
+			auto sessionData = getClientSessionDataBySessionId(curOperation.sessionID);
+			if (sessionData && !sessionData->removeTag)
+			{
+				sessionData->session->executeSendStream((char*)curOperation.operationData, curOperation.operationDataLen);
+				writeQueLen = sessionData->session->getWriteQueueSize();
+			}
+			else
+			{
+				fc_free(curOperation.operationData);
+			}
+			updateStreamSendLen(curOperation.sessionID, curOperation.operationDataLen, writeQueLen);
+		}break;
+		case TCP_CLI_OP_STREAM_CONSUMED://ӦòѴ
+		{
+			auto sessionData = getClientSessionDataBySessionId(curOperation.sessionID);
+			if (sessionData)
+			{
+				sessionData->session->onStreamDataConsumed(curOperation.operationDataLen);
+			}
+		}break;
+		case TCP_CLI_OP_SEND_MSG:		// Ϣ
+		{
+			auto sessionData = getClientSessionDataBySessionId(curOperation.sessionID);
+			if (sessionData && !sessionData->removeTag)
+			{
+				sessionData->session->executeSendMsg((char*)curOperation.operationData, curOperation.operationDataLen);
+			}
+			else
+			{
+				fc_free(curOperation.operationData);
+			}
+		}break;
+		case TCP_CLI_OP_SET_COMPRESS:	// ѹģʽ
+		{
+			auto sessionData = getClientSessionDataBySessionId(curOperation.sessionID);
+			if (sessionData)
+			{
+				sessionData->session->setCompressMode((NetCompressMode)curOperation.operationDataLen);
+			}
+		}break;
+		case TCP_CLI_OP_SET_WRITE_MERGE:	// ÷ͺϲ
+		{
+			auto sessionData = getClientSessionDataBySessionId(curOperation.sessionID);
+			if (sessionData)
+			{
+				sessionData->session->setWriteMerge(*(TCPWriteMergeConfig*)curOperation.operationData);
+			}
+			fc_free(curOperation.operationData);
+		}break;
 		case TCP_CLI_OP_DISCONNECT:	// Ͽ
 		{
 			auto sessionData = getClientSessionDataBySessionId(curOperation.sessionID);
@@ -497,6 +683,17 @@ void TCPClient::executeOperation()
 				m_allSessionMap.erase(it);
 			}
 		}break;
+		case TCP_CLI_OP_QUERY_HOT_SESSION:	// ѯȵỰ
+		{
+			std::vector<Session*> sessionArr;
+			for (auto& it : m_allSessionMap)
+			{
+				sessionArr.push_back(it.second->session);
+			}
+			uint32_t count = 0;
+			NetSessionTraffic* arr = makeHotSessionReport(sessionArr, curOperation.operationDataLen, (NetHotSessionSort)curOperation.sessionID, &count);
+			pushThreadMsg(NetThreadMsgType::HOT_SESSION, NULL, (char*)arr, count);
+		}break;
 		default:
 			break;
 		}
@@ -514,6 +711,8 @@ void TCPClient::onSessionUpdateRun()
 	for (auto& it : m_allSessionMap)
 	{
 		it.second->session->update(TCP_HEARTBEAT_TIMER_DELAY);
+		it.second->session->updateTraffic(TCP_HEARTBEAT_TIMER_DELAY);
+		m_loopStats.onSampleWriteQue(it.second->session->getWriteQueueSize());
 	}
 }
 
@@ -629,6 +828,9 @@ void TCPClient::createNewConnect(void* data)
 		}
 		session->setSessionRecvCallback(std::bind(&TCPClient::onSessionRecvData, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
 		session->setSessionClose(std::bind(&TCPClient::onSessionClose, this, std::placeholders::_1));
+		session->setSessionRecvStreamCallback(std::bind(&TCPClient::onSessionRecvStream, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
+		session->setSessionWriteMergeCallback(std::bind(&TCPClient::onSessionWriteMerge, this, std::placeholders::_1));
+		session->setSessionStreamWriteCallback(std::bind(&TCPClient::onSessionStreamWrite, this, std::placeholders::_1));
 		session->setSessionID(opData->sessionID);
 		session->setSendHeartMsg(NET_HEARTBEAT_MSG_C2S);
 		session->setHeartMaxCount(TCP_HEARTBEAT_MAX_COUNT_CLIENT);
@@ -665,6 +867,11 @@ void TCPClient::onSessionRecvData(Session* session, char* data, uint32_t len)
 	pushThreadMsg(NetThreadMsgType::RECV_DATA, session, data, len);
 }
 
+void TCPClient::onSessionRecvStream(Session* session, char* data, uint32_t len)
+{
+	pushThreadMsg(NetThreadMsgType::RECV_STREAM, session, data, len);
+}
+
 TCPClient::clientSessionData* TCPClient::getClientSessionDataBySessionId(uint32_t sessionId)
 {
 	auto it = m_allSessionMap.find(sessionId);
@@ -712,6 +919,8 @@ void TCPClient::clearData()
 		auto & curOperation = m_operationQue.front();
 		switch (curOperation.operationType)
 		{
+		case TCP_CLI_OP_SEND_MSG:
+		case TCP_CLI_OP_SET_WRITE_MERGE:
 		case TCP_CLI_OP_SENDDATA:			// ݷ
 		{
 			if (curOperation.operationData)
@@ -719,6 +928,13 @@ void TCPClient::clearData()
 				fc_free(curOperation.operationData);
 			}
 		}break;
+		case TCP_CLI_OP_SEND_STREAM:		// Ƭ
+		{
+			if (curOperation.operationData)
+			{
+				fc_free(curOperation.operationData);
+			}
+		}break;
 		case TCP_CLI_OP_CONNECT:			// 
 		{
 			if (curOperation.operationData)
@@ -805,10 +1021,48 @@ void TCPClient::onClientUpdate()
 	{
 		stopIdle();
 		uv_timer_stop(&m_clientUpdateTimer);
+#if TCP_OPEN_WRITE_MERGE == 1
+		uv_check_stop(&m_writeMergeCheck);
+#endif
 		uv_stop(&m_loop);
 	}
 }
 
+void TCPClient::onSessionWriteMerge(TCPSession* session)
+{
+#if TCP_OPEN_WRITE_MERGE == 1
+	m_writeMergeSessionArr.push_back(session->getSessionID());
+#endif
+}
+
+void TCPClient::onSessionStreamWrite(TCPSession* session)
+{
+	updateStreamSendLen(session->getSessionID(), 0, session->getWriteQueueSize());
+}
+
+void TCPClient::onWriteMergeRun()
+{
+#if TCP_OPEN_WRITE_MERGE == 1
+	if (m_writeMergeSessionArr.empty())
+		return;
+
+	uint64_t curTime = uv_hrtime();
+	for (size_t i = 0; i < m_writeMergeSessionArr.size(); )
+	{
+		auto sessionData = getClientSessionDataBySessionId(m_writeMergeSessionArr[i]);
+		if (sessionData && sessionData->session->updateMergeFlush(curTime))
+		{
+			++i;
+		}
+		else
+		{
+			m_writeMergeSessionArr[i] = m_writeMergeSessionArr.back();
+			m_writeMergeSessionArr.pop_back();
+		}
+	}
+#endif
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 void TCPClient::uv_client_update_timer_run(uv_timer_t* handle)
 {
@@ -816,4 +1070,10 @@ void TCPClient::uv_client_update_timer_run(uv_timer_t* handle)
 	c->onClientUpdate();
 }
 
+void TCPClient::uv_on_write_merge_check_run(uv_check_t* handle)
+{
+	TCPClient* c = (TCPClient*)handle->data;
+	c->onWriteMergeRun();
+}
+
 NS_NET_UV_END
@@ -5,6 +5,9 @@
 
 NS_NET_UV_BEGIN
 
+// Ƭص,dataƬͷ,صdataͷ
+using TCPClientRecvStreamCall = std::function<void(Client* client, Session* session, uint32_t streamID, TCPStreamState state, char* data, uint32_t len)>;
+
 class TCPClient : public Client
 {
 protected:
@@ -41,9 +44,24 @@ public:
 	/// SessionManager
 	virtual void disconnect(uint32_t sessionId)override;
 
+	virtual void queryHotSession(uint32_t count, NetHotSessionSort sort)override;
+
 	virtual void send(uint32_t sessionId, char* data, uint32_t len)override;
 
 	/// TCPClient
+	// Ƭ,DATA͵ݳTCP_STREAM_CHUNK_MAX_LENʱԶ
+	// Ựδд׽ֵݳTCP_STREAM_SEND_MAX_LENʱfalse,Ժ
+	bool sendStream(uint32_t sessionId, uint32_t streamID, TCPStreamState state, char* data, uint32_t len);
+
+	inline void setRecvStreamCallback(const TCPClientRecvStreamCall& call);
+
+	// ûỰѹģʽ
+	void setSessionCompressMode(uint32_t sessionId, NetCompressMode mode);
+
+	// ûỰͺϲ
+	// flushLen:ˢ³ flushDelay:ϲӳ(λ΢),Ϊ0ʱڱ¼ѭʱ
+	void setSessionWriteMerge(uint32_t sessionId, bool enable, uint32_t flushLen = TCP_WRITE_MERGE_FLUSH_LEN, uint32_t flushDelay = TCP_WRITE_MERGE_FLUSH_DELAY);
+
 	bool isCloseFinish();
 
 	//ǷTCP_NODELAY
@@ -84,6 +102,14 @@ protected:
 
 	void onSessionRecvData(Session* session, char* data, uint32_t len);
 
+	void onSessionRecvStream(Session* session, char* data, uint32_t len);
+
+	void onSessionWriteMerge(TCPSession* session);
+
+	void onSessionStreamWrite(TCPSession* session);
+
+	void onWriteMergeRun();
+
 	void createNewConnect(void* data);
 
 	void clearData();
@@ -107,10 +133,26 @@ protected:
 	std::map<uint32_t, clientSessionData*> m_allSessionMap;
 	
 	bool m_isStop;
+
+	TCPClientRecvStreamCall m_recvStreamCall;
+
+#if TCP_OPEN_WRITE_MERGE == 1
+	// ¼ѭʱͺϲ
+	uv_check_t m_writeMergeCheck;
+	// ϲݵȴ͵ĻỰ
+	std::vector<uint32_t> m_writeMergeSessionArr;
+#endif
 protected:
 
 	static void uv_client_update_timer_run(uv_timer_t* handle);
+
+	static void uv_on_write_merge_check_run(uv_check_t* handle);
 };
+
+void TCPClient::setRecvStreamCallback(const TCPClientRecvStreamCall& call)
+{
+	m_recvStreamCall = std::move(call);
+}
 NS_NET_UV_END
 
 
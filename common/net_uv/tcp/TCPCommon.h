@@ -5,6 +5,7 @@
 #include "../base/Client.h"
 #include "../base/Runnable.h"
 #include "../base/Misc.h"
+#include "../base/Compress.h"
 #include "../base/Mutex.h"
 #include "../base/Session.h"
 #include "../base/SessionManager.h"
@@ -29,5 +30,34 @@ struct TCPMsgHead
 };
 #pragma pack()
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/// ʽϢ
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Ƭ
+enum class TCPStreamState : uint32_t
+{
+	BEGIN,	// ʼ
+	DATA,	// 
+	END		// 
+};
+
+// Ƭͷ,λMT_STREAMϢݵʼλ
+#pragma pack(4)
+struct TCPStreamHead
+{
+	uint32_t streamID;
+	TCPStreamState state;
+};
+#pragma pack()
+
+// ͺϲ
+struct TCPWriteMergeConfig
+{
+	bool enable;
+	uint32_t flushLen;		// ˢ³
+	uint32_t flushDelay;	// ϲӳ(λ΢)
+};
+
 
 NS_NET_UV_END
\ No newline at end of file
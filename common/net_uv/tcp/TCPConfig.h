@@ -16,6 +16,10 @@ NS_NET_UV_BEGIN
 // ׽СͻС
 #define TCP_UV_SOCKET_SEND_BUF_LEN (1024 * 8)
 
+// ÿζȡʱջԤĿдռ
+// ֱӶỰĽջ,ʱѹ
+#define TCP_RECV_MIN_WRITE_LEN (1024 * 16)
+
 // ϢʹС
 // Ϣͷĳֶδڸֵ
 // ֱ϶Ϊÿͻ˷͵ϢΪǷϢ
@@ -66,4 +70,72 @@ NS_NET_UV_BEGIN
 #define TCP_HEARTBEAT_COUNT_RESET_VALUE_CLIENT (-1)	
 
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/// ѹ
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Ƿѹ
+// ΪÿỰѹģʽշϢͷԶѹ
+// ѹϢͨϢͷ֣ҪTCP_OPEN_UV_THREAD_HEARTBEAT
+#define TCP_OPEN_COMPRESS 1
+
+#if TCP_OPEN_UV_THREAD_HEARTBEAT == 0
+#undef TCP_OPEN_COMPRESS
+#define TCP_OPEN_COMPRESS 0
+#endif
+
+// Ϣȴﵽֵʱųѹ
+#define TCP_COMPRESS_MIN_LEN (256)
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/// ͺϲ
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Ƿͺϲ
+// ΪÿỰ÷ͺϲϢдỰĺϲ
+// ﵽˢ³ȡ¼ѭ򳬹ϲӳʱһԷͣwriteô
+#define TCP_OPEN_WRITE_MERGE 1
+
+// ĬϺϲˢ³
+// (16K)
+#define TCP_WRITE_MERGE_FLUSH_LEN (1024 * 16)
+
+// Ĭϲӳ(λ΢)
+// Ϊ0ʱڱ¼ѭʱ
+#define TCP_WRITE_MERGE_FLUSH_DELAY (0)
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/// ʽϢ
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// ǷʽϢ
+// TCP_BIG_MSG_MAX_LENݿɲΪƬͣշƬص建
+// ƬͨϢͷ֣ҪTCP_OPEN_UV_THREAD_HEARTBEAT
+#define TCP_OPEN_STREAM_MSG 1
+
+#if TCP_OPEN_UV_THREAD_HEARTBEAT == 0
+#undef TCP_OPEN_STREAM_MSG
+#define TCP_OPEN_STREAM_MSG 0
+#endif
+
+// Ƭ󳤶
+// (64K)
+#define TCP_STREAM_CHUNK_MAX_LEN (1024 * 64)
+
+// ỰδӦò㴦ݳֵʱͣȡ׽
+// (1MB)
+#define TCP_STREAM_PAUSE_READ_LEN (1024 * 1024)
+
+// δӦò㴦ݵڸֵʱָȡ׽
+// (256K)
+#define TCP_STREAM_RESUME_READ_LEN (1024 * 256)
+
+// Ựύδд׽ֵ,еķƬͻỰд
+// ʱsendStreamfalse,÷Ժ,η͵ݲֵܳ
+// (4MB)
+#define TCP_STREAM_SEND_MAX_LEN (1024 * 1024 * 4)
+
+
 NS_NET_UV_END
\ No newline at end of file
@@ -9,6 +9,12 @@ enum
 	TCP_SVR_OP_SEND_DATA,	// ϢĳỰ
 	TCP_SVR_OP_DIS_SESSION,	// ϿĳỰ
 	TCP_SVR_OP_SEND_DIS_SESSION_MSG_TO_MAIN_THREAD,//̷߳ͻỰѶϿ
+	TCP_SVR_OP_STREAM_CONSUMED,	// ӦòѴ
+	TCP_SVR_OP_SEND_MSG,	// UV߳дϢ
+	TCP_SVR_OP_SET_COMPRESS,// ûỰѹģʽ
+	TCP_SVR_OP_SET_WRITE_MERGE,// ûỰͺϲ
+	TCP_SVR_OP_QUERY_HOT_SESSION,// ѯȵỰ
+	TCP_SVR_OP_SEND_STREAM,	// Ƭ
 };
 
 
@@ -18,7 +24,11 @@ TCPServer::TCPServer()
 	: m_start(false)
 	, m_server(NULL)
 	, m_sessionID(0)
+	, m_recvStreamCall(nullptr)
 {
+#if TCP_OPEN_WRITE_MERGE == 1
+	memset(&m_writeMergeCheck, 0, sizeof(uv_check_t));
+#endif
 }
 
 TCPServer::~TCPServer()
@@ -106,6 +116,7 @@ void TCPServer::updateFrame()
 		return;
 	}
 	
+	m_loopStats.onDispatchMsg(m_msgQue.size());
 	while (!m_msgQue.empty())
 	{
 		m_msgDispatchQue.push(m_msgQue.front());
@@ -122,15 +133,29 @@ void TCPServer::updateFrame()
 		{
 		case NetThreadMsgType::RECV_DATA:
 		{
+			m_loopStats.onRecvMsg(Msg.pushTime, Msg.dataLen);
 			m_recvCall(this, Msg.pSession, Msg.data, Msg.dataLen);
 			fc_free(Msg.data);
 		}break;
+		case NetThreadMsgType::RECV_STREAM:
+		{
+			m_loopStats.onRecvMsg(Msg.pushTime, Msg.dataLen);
+			TCPStreamHead* sh = (TCPStreamHead*)Msg.data;
+			if (m_recvStreamCall != nullptr)
+			{
+				m_recvStreamCall(this, Msg.pSession, sh->streamID, sh->state, Msg.data + sizeof(TCPStreamHead), Msg.dataLen - sizeof(TCPStreamHead));
+			}
+			fc_free(Msg.data);
+			pushOperation(TCP_SVR_OP_STREAM_CONSUMED, NULL, Msg.dataLen, Msg.pSession->getSessionID());
+		}break;
 		case NetThreadMsgType::NEW_CONNECT:
 		{
 			m_newConnectCall(this, Msg.pSession);
 		}break;
 		case NetThreadMsgType::DIS_CONNECT:
 		{
+			setCompressSession(Msg.pSession->getSessionID(), false);
+			clearStreamSendLen(Msg.pSession->getSessionID());
 			m_disconnectCall(this, Msg.pSession);
 			pushOperation(TCP_SVR_OP_SEND_DIS_SESSION_MSG_TO_MAIN_THREAD, NULL, 0, Msg.pSession->getSessionID());
 		}break;
@@ -138,6 +163,17 @@ void TCPServer::updateFrame()
 		{
 			closeServerTag = true;
 		}break;
+		case NetThreadMsgType::HOT_SESSION:
+		{
+			if (m_hotSessionCall != nullptr)
+			{
+				m_hotSessionCall(this, (NetSessionTraffic*)Msg.data, Msg.dataLen);
+			}
+			if (Msg.data)
+			{
+				fc_free(Msg.data);
+			}
+		}break;
 		default:
 			break;
 		}
@@ -151,6 +187,19 @@ void TCPServer::updateFrame()
 
 void TCPServer::send(uint32_t sessionID, char* data, uint32_t len)
 {
+	m_loopStats.onSendMsg(len);
+
+#if TCP_OPEN_COMPRESS == 1
+	// ѹĻỰϢUV̰߳Ựѹģʽ
+	if (len >= TCP_COMPRESS_MIN_LEN && isCompressSession(sessionID))
+	{
+		char* p = (char*)fc_malloc(len);
+		memcpy(p, data, len);
+		pushOperation(TCP_SVR_OP_SEND_MSG, p, len, sessionID);
+		return;
+	}
+#endif
+
 	int32_t bufCount = 0;
 
 	uv_buf_t* bufArr = tcp_packageData(data, len, &bufCount);
@@ -165,16 +214,89 @@ void TCPServer::send(uint32_t sessionID, char* data, uint32_t len)
 	fc_free(bufArr);
 }
 
+void TCPServer::queryHotSession(uint32_t count, NetHotSessionSort sort)
+{
+	pushOperation(TCP_SVR_OP_QUERY_HOT_SESSION, NULL, count, (uint32_t)sort);
+}
+
 void TCPServer::disconnect(uint32_t sessionID)
 {
 	pushOperation(TCP_SVR_OP_DIS_SESSION, NULL, 0, sessionID);
 }
 
+bool TCPServer::sendStream(uint32_t sessionID, uint32_t streamID, TCPStreamState state, char* data, uint32_t len)
+{
+#if TCP_OPEN_STREAM_MSG == 1
+	// BEGIN/ENDƬ
+	if (state != TCPStreamState::DATA && len > TCP_STREAM_CHUNK_MAX_LEN)
+		return false;
+
+	// ͻ,ɵ÷Ժ
+	if (!checkStreamSendLen(sessionID, len, TCP_STREAM_SEND_MAX_LEN))
+		return false;
+
+	// ȫƬɹύ,Զյ
+	uint32_t msgLen = len;
+	std::vector<uv_buf_t> bufArr;
+	do
+	{
+		uint32_t chunklen = (len > TCP_STREAM_CHUNK_MAX_LEN) ? TCP_STREAM_CHUNK_MAX_LEN : len;
+
+		uint32_t sendlen = 0;
+		char* senddata = tcp_packageStreamData(streamID, state, data, chunklen, &sendlen);
+		if (senddata == NULL)
+		{
+			for (auto& buf : bufArr)
+			{
+				fc_free(buf.base);
+			}
+			return false;
+		}
+		bufArr.push_back(uv_buf_init(senddata, sendlen));
+
+		data = data + chunklen;
+		len = len - chunklen;
+	} while (len > 0);
+
+	m_loopStats.onSendMsg(msgLen);
+	for (auto& buf : bufArr)
+	{
+		addStreamSendLen(sessionID, (uint32_t)buf.len);
+		pushOperation(TCP_SVR_OP_SEND_STREAM, buf.base, (uint32_t)buf.len, sessionID);
+	}
+	return true;
+#else
+	assert(0);
+	return false;
+#endif
+}
+
+void TCPServer::setSessionCompressMode(uint32_t sessionID, NetCompressMode mode)
+{
+	setCompressSession(sessionID, mode != NetCompressMode::NONE);
+	pushOperation(TCP_SVR_OP_SET_COMPRESS, NULL, (uint32_t)mode, sessionID);
+}
+
+void TCPServer::setSessionWriteMerge(uint32_t sessionID, bool enable, uint32_t flushLen, uint32_t flushDelay)
+{
+	TCPWriteMergeConfig* config = (TCPWriteMergeConfig*)fc_malloc(sizeof(TCPWriteMergeConfig));
+	config->enable = enable;
+	config->flushLen = flushLen;
+	config->flushDelay = flushDelay;
+	pushOperation(TCP_SVR_OP_SET_WRITE_MERGE, config, sizeof(TCPWriteMergeConfig), sessionID);
+}
+
 void TCPServer::run()
 {
 	startIdle();
 	startSessionUpdate(TCP_HEARTBEAT_TIMER_DELAY);
 
+#if TCP_OPEN_WRITE_MERGE == 1
+	uv_check_init(&m_loop, &m_writeMergeCheck);
+	m_writeMergeCheck.data = this;
+	uv_check_start(&m_writeMergeCheck, uv_on_write_merge_check_run);
+#endif
+
 	uv_run(&m_loop, UV_RUN_DEFAULT);
 
 	m_server->~TCPSocket();
@@ -202,6 +324,9 @@ void TCPServer::onNewConnect(uv_stream_t* server, int32_t status)
 		{
 			session->setSessionRecvCallback(std::bind(&TCPServer::onSessionRecvData, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
 			session->setSessionClose(std::bind(&TCPServer::onSessionClose, this, std::placeholders::_1));
+			session->setSessionRecvStreamCallback(std::bind(&TCPServer::onSessionRecvStream, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
+			session->setSessionWriteMergeCallback(std::bind(&TCPServer::onSessionWriteMerge, this, std::placeholders::_1));
+			session->setSessionStreamWriteCallback(std::bind(&TCPServer::onSessionStreamWrite, this, std::placeholders::_1));
 			session->setSendHeartMsg(NET_HEARTBEAT_MSG_S2C);
 			session->setHeartMaxCount(TCP_HEARTBEAT_MAX_COUNT_SERVER);
 			session->setResetHeartCount(TCP_HEARTBEAT_COUNT_RESET_VALUE_SERVER);
@@ -271,6 +396,11 @@ void TCPServer::onSessionRecvData(Session* session, char* data, uint32_t len)
 	pushThreadMsg(NetThreadMsgType::RECV_DATA, session, data, len);
 }
 
+void TCPServer::onSessionRecvStream(Session* session, char* data, uint32_t len)
+{
+	pushThreadMsg(NetThreadMsgType::RECV_STREAM, session, data, len);
+}
+
 void TCPServer::executeOperation()
 {
 	if (m_operationMutex.trylock() != 0)
@@ -284,6 +414,7 @@ void TCPServer::executeOperation()
 		return;
 	}
 
+	m_loopStats.onDispatchOperation(m_operationQue.size());
 	while (!m_operationQue.empty())
 	{
 		m_operationDispatchQue.push(m_operationQue.front());
@@ -294,6 +425,7 @@ void TCPServer::executeOperation()
 	while (!m_operationDispatchQue.empty())
 	{
 		auto & curOperation = m_operationDispatchQue.front();
+		m_loopStats.onExecuteOperation(curOperation.pushTime);
 		switch (curOperation.operationType)
 		{
 		case TCP_SVR_OP_SEND_DATA :		// ݷ
@@ -308,6 +440,58 @@ void TCPServer::executeOperation()
 				fc_free(curOperation.operationData);
 			}
 		}break;
+		case TCP_SVR_OP_SEND_STREAM:	// Ƭ
+		{
+			uint32_t writeQueLen = 0;
+			auto it = m_allSession.find(curOperation.sessionID);
+			if (it != m_allSession.end())
+			{
+				it->second.session->executeSendStream((char*)curOperation.operationData, curOperation.operationDataLen);
+				writeQueLen = it->second.session->getWriteQueueSize();
+			}
+			else//ûỰʧЧ
+			{
+				fc_free(curOperation.operationData);
+			}
+			updateStreamSendLen(curOperation.sessionID, curOperation.operationDataLen, writeQueLen);
+		}break;
+		case TCP_SVR_OP_STREAM_CONSUMED:
+		{
+			auto it = m_allSession.find(curOperation.sessionID);
+			if (it != m_allSession.end())
+			{
+				it->second.session->onStreamDataConsumed(curOperation.operationDataLen);
+			}
+		}break;
+		case TCP_SVR_OP_SEND_MSG:	// Ϣ
+		{
+			auto it = m_allSession.find(curOperation.sessionID);
+			if (it != m_allSession.end())
+			{
+				it->second.session->executeSendMsg((char*)curOperation.operationData, curOperation.operationDataLen);
+			}
+			else//ûỰʧЧ
+			{
+				fc_free(curOperation.operationData);
+			}
+		}break;
+		case TCP_SVR_OP_SET_COMPRESS:	// ѹģʽ
+		{
+			auto it = m_allSession.find(curOperation.sessionID);
+			if (it != m_allSession.end())
+			{
+				it->second.session->setCompressMode((NetCompressMode)curOperation.operationDataLen);
+			}
+		}break;
+		case TCP_SVR_OP_SET_WRITE_MERGE:	// ÷ͺϲ
+		{
+			auto it = m_allSession.find(curOperation.sessionID);
+			if (it != m_allSession.end())
+			{
+				it->second.session->setWriteMerge(*(TCPWriteMergeConfig*)curOperation.operationData);
+			}
+			fc_free(curOperation.operationData);
+		}break;
 		case TCP_SVR_OP_DIS_SESSION:	// Ͽ
 		{
 			auto it = m_allSession.find(curOperation.sessionID);
@@ -340,6 +524,17 @@ void TCPServer::executeOperation()
 
 			stopSessionUpdate();
 		}break;
+		case TCP_SVR_OP_QUERY_HOT_SESSION:	// ѯȵỰ
+		{
+			std::vector<Session*> sessionArr;
+			for (auto& it : m_allSession)
+			{
+				sessionArr.push_back(it.second.session);
+			}
+			uint32_t count = 0;
+			NetSessionTraffic* arr = makeHotSessionReport(sessionArr, curOperation.operationDataLen, (NetHotSessionSort)curOperation.sessionID, &count);
+			pushThreadMsg(NetThreadMsgType::HOT_SESSION, NULL, (char*)arr, count);
+		}break;
 		default:
 			break;
 		}
@@ -361,7 +556,10 @@ void TCPServer::clearData()
 	m_msgMutex.unlock();
 	while (!m_operationQue.empty())
 	{
-		if (m_operationQue.front().operationType == TCP_SVR_OP_SEND_DATA)
+		if (m_operationQue.front().operationType == TCP_SVR_OP_SEND_DATA ||
+			m_operationQue.front().operationType == TCP_SVR_OP_SEND_MSG ||
+			m_operationQue.front().operationType == TCP_SVR_OP_SEND_STREAM ||
+			m_operationQue.front().operationType == TCP_SVR_OP_SET_WRITE_MERGE)
 		{
 			fc_free(m_operationQue.front().operationData);
 		}
@@ -391,6 +589,9 @@ void TCPServer::onIdleRun()
 		if (m_allSession.empty())
 		{
 			stopIdle();
+#if TCP_OPEN_WRITE_MERGE == 1
+			uv_check_stop(&m_writeMergeCheck);
+#endif
 			uv_stop(&m_loop);
 		}
 	}
@@ -405,7 +606,51 @@ void TCPServer::onSessionUpdateRun()
 	for (auto& it : m_allSession)
 	{
 		it.second.session->update(TCP_HEARTBEAT_TIMER_DELAY);
+		it.second.session->updateTraffic(TCP_HEARTBEAT_TIMER_DELAY);
+		m_loopStats.onSampleWriteQue(it.second.session->getWriteQueueSize());
 	}
 }
 
+void TCPServer::onSessionWriteMerge(TCPSession* session)
+{
+#if TCP_OPEN_WRITE_MERGE == 1
+	m_writeMergeSessionArr.push_back(session->getSessionID());
+#endif
+}
+
+void TCPServer::onSessionStreamWrite(TCPSession* session)
+{
+	updateStreamSendLen(session->getSessionID(), 0, session->getWriteQueueSize());
+}
+
+void TCPServer::onWriteMergeRun()
+{
+#if TCP_OPEN_WRITE_MERGE == 1
+	if (m_writeMergeSessionArr.empty())
+		return;
+
+	uint64_t curTime = uv_hrtime();
+	for (size_t i = 0; i < m_writeMergeSessionArr.size(); )
+	{
+		auto it = m_allSession.find(m_writeMergeSessionArr[i]);
+		if (it != m_allSession.end() && it->second.session->updateMergeFlush(curTime))
+		{
+			++i;
+		}
+		else
+		{
+			m_writeMergeSessionArr[i] = m_writeMergeSessionArr.back();
+			m_writeMergeSessionArr.pop_back();
+		}
+	}
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void TCPServer::uv_on_write_merge_check_run(uv_check_t* handle)
+{
+	TCPServer* svr = (TCPServer*)handle->data;
+	svr->onWriteMergeRun();
+}
+
 NS_NET_UV_END
\ No newline at end of file
@@ -6,6 +6,9 @@
 
 NS_NET_UV_BEGIN
 
+// Ƭص,dataƬͷ,صdataͷ
+using TCPServerRecvStreamCall = std::function<void(Server* svr, Session* session, uint32_t streamID, TCPStreamState state, char* data, uint32_t len)>;
+
 class TCPServer : public Server
 {
 	struct serverSessionData
@@ -38,6 +41,22 @@ public:
 
 	virtual void disconnect(uint32_t sessionID)override;
 
+	virtual void queryHotSession(uint32_t count, NetHotSessionSort sort)override;
+
+	/// TCPServer
+	// Ƭ,DATA͵ݳTCP_STREAM_CHUNK_MAX_LENʱԶ
+	// Ựδд׽ֵݳTCP_STREAM_SEND_MAX_LENʱfalse,Ժ
+	bool sendStream(uint32_t sessionID, uint32_t streamID, TCPStreamState state, char* data, uint32_t len);
+
+	inline void setRecvStreamCallback(const TCPServerRecvStreamCall& call);
+
+	// ûỰѹģʽ
+	void setSessionCompressMode(uint32_t sessionID, NetCompressMode mode);
+
+	// ûỰͺϲ
+	// flushLen:ˢ³ flushDelay:ϲӳ(λ΢),Ϊ0ʱڱ¼ѭʱ
+	void setSessionWriteMerge(uint32_t sessionID, bool enable, uint32_t flushLen = TCP_WRITE_MERGE_FLUSH_LEN, uint32_t flushDelay = TCP_WRITE_MERGE_FLUSH_DELAY);
+
 protected:
 
 	/// Runnable
@@ -53,6 +72,14 @@ protected:
 	
 	void onSessionRecvData(Session* session, char* data, uint32_t len);
 
+	void onSessionRecvStream(Session* session, char* data, uint32_t len);
+
+	void onSessionWriteMerge(TCPSession* session);
+
+	void onSessionStreamWrite(TCPSession* session);
+
+	void onWriteMergeRun();
+
 	/// Server
 	virtual void onIdleRun()override;
 
@@ -77,8 +104,25 @@ protected:
 	std::map<uint32_t, serverSessionData> m_allSession;
 
 	uint32_t m_sessionID;
+
+	TCPServerRecvStreamCall m_recvStreamCall;
+
+#if TCP_OPEN_WRITE_MERGE == 1
+	// ¼ѭʱͺϲ
+	uv_check_t m_writeMergeCheck;
+	// ϲݵȴ͵ĻỰ
+	std::vector<uint32_t> m_writeMergeSessionArr;
+#endif
+
+protected:
+
+	static void uv_on_write_merge_check_run(uv_check_t* handle);
 };
 
+void TCPServer::setRecvStreamCallback(const TCPServerRecvStreamCall& call)
+{
+	m_recvStreamCall = std::move(call);
+}
 
 
 NS_NET_UV_END
@@ -41,12 +41,50 @@ TCPSession::TCPSession(SessionManager* sessionManager)
 	m_sendHeartMsg = NET_HEARTBEAT_MSG_C2S;
 	m_curHeartMaxCount = TCP_HEARTBEAT_MAX_COUNT_CLIENT;
 #endif
+
+#if TCP_OPEN_COMPRESS == 1
+	m_compressMode = NetCompressMode::NONE;
+	memset(&m_compressStats, 0, sizeof(m_compressStats));
+#endif
+
+#if TCP_OPEN_STREAM_MSG == 1
+	m_sessionRecvStreamCallback = nullptr;
+	m_sessionStreamWriteCallback = nullptr;
+	m_pendingStreamLen = 0;
+	m_isPauseRead = false;
+	m_isRecvStream = false;
+	m_streamHeartTime = 0;
+	m_isStreamSending = false;
+#endif
+
+#if TCP_OPEN_WRITE_MERGE == 1
+	m_sessionWriteMergeCallback = nullptr;
+	m_mergeBuf = NULL;
+	m_mergeLen = 0;
+	m_mergeFlushLen = TCP_WRITE_MERGE_FLUSH_LEN;
+	m_mergeFlushDelay = TCP_WRITE_MERGE_FLUSH_DELAY;
+	m_mergeStartTime = 0;
+	m_isOpenMerge = false;
+	m_isWaitMergeFlush = false;
+#endif
 }
 
 TCPSession::~TCPSession()
 {
+#if TCP_OPEN_WRITE_MERGE == 1
+	if (m_mergeBuf)
+	{
+		fc_free(m_mergeBuf);
+		m_mergeBuf = NULL;
+	}
+#endif
+
 	if (m_recvBuffer)
 	{
+		if (m_socket)
+		{
+			m_socket->setRecvBuffer(NULL);
+		}
 		m_recvBuffer->~Buffer();
 		fc_free(m_recvBuffer);
 		m_recvBuffer = NULL;
@@ -72,10 +110,17 @@ bool TCPSession::initWithSocket(TCPSocket* socket)
 		fc_free(socket);
 		return false;
 	}
-	new (m_recvBuffer)Buffer(1024 * 4);
+	new (m_recvBuffer)Buffer(TCP_RECV_MIN_WRITE_LEN);
 
 	socket->setRecvCallback(std::bind(&TCPSession::on_socket_recv, this, std::placeholders::_1, std::placeholders::_2));
+#if TCP_USE_NET_UV_MSG_STRUCT == 1
+	// ׽ֱӶm_recvBuffer
+	socket->setRecvBuffer(m_recvBuffer);
+#endif
 	socket->setCloseCallback(std::bind(&TCPSession::on_socket_close, this, std::placeholders::_1));
+#if TCP_OPEN_STREAM_MSG == 1
+	socket->setWriteCallback(std::bind(&TCPSession::on_socket_write, this));
+#endif
 
 	m_socket = socket;
 	return true;
@@ -88,6 +133,15 @@ void TCPSession::executeSend(char* data, uint32_t len)
 
 	if (isOnline())
 	{
+		m_traffic.sendBytes += len;
+		m_traffic.sendMsgs++;
+#if TCP_OPEN_WRITE_MERGE == 1
+		if (m_isOpenMerge)
+		{
+			executeMergeSend(data, len);
+			return;
+		}
+#endif
 		if (!m_socket->send(data, len))
 		{
 			executeDisconnect();
@@ -95,10 +149,187 @@ void TCPSession::executeSend(char* data, uint32_t len)
 	}
 	else
 	{
+		m_traffic.dropMsgs++;
 		fc_free(data);
 	}
 }
 
+void TCPSession::executeMergeSend(char* data, uint32_t len)
+{
+#if TCP_OPEN_WRITE_MERGE == 1
+	// ʣռ䲻㣬ȷѺϲ
+	if (m_mergeLen > 0 && m_mergeLen + len > m_mergeFlushLen)
+	{
+		flushMergeData();
+		if (!isOnline())
+		{
+			m_traffic.dropMsgs++;
+			fc_free(data);
+			return;
+		}
+	}
+
+	// ݱѴﵽˢ³ȣϲ
+	if (len >= m_mergeFlushLen)
+	{
+		if (!m_socket->send(data, len))
+		{
+			executeDisconnect();
+		}
+		return;
+	}
+
+	if (m_mergeBuf == NULL)
+	{
+		m_mergeBuf = (char*)fc_malloc(m_mergeFlushLen);
+	}
+	if (m_mergeLen == 0)
+	{
+		m_mergeStartTime = uv_hrtime();
+	}
+	memcpy(m_mergeBuf + m_mergeLen, data, len);
+	m_mergeLen += len;
+	fc_free(data);
+
+	if (m_mergeLen >= m_mergeFlushLen)
+	{
+		flushMergeData();
+	}
+	else if (!m_isWaitMergeFlush && m_sessionWriteMergeCallback != nullptr)
+	{
+		m_isWaitMergeFlush = true;
+		m_sessionWriteMergeCallback(this);
+	}
+#else
+	assert(0);
+#endif
+}
+
+void TCPSession::flushMergeData()
+{
+#if TCP_OPEN_WRITE_MERGE == 1
+	if (m_mergeLen <= 0)
+		return;
+
+	if (!isOnline())
+	{
+		m_mergeLen = 0;
+		return;
+	}
+
+	// ֱӽsocket,´κϲʱ·
+	char* data = m_mergeBuf;
+	uint32_t len = m_mergeLen;
+	m_mergeBuf = NULL;
+	m_mergeLen = 0;
+
+	if (!m_socket->send(data, len))
+	{
+		executeDisconnect();
+	}
+#endif
+}
+
+bool TCPSession::updateMergeFlush(uint64_t curTime)
+{
+#if TCP_OPEN_WRITE_MERGE == 1
+	if (m_mergeLen > 0 && isOnline())
+	{
+		if (m_mergeFlushDelay > 0 && curTime - m_mergeStartTime < (uint64_t)m_mergeFlushDelay * 1000)
+		{
+			return true;
+		}
+		flushMergeData();
+	}
+	m_isWaitMergeFlush = false;
+#endif
+	return false;
+}
+
+void TCPSession::setWriteMerge(const TCPWriteMergeConfig& config)
+{
+#if TCP_OPEN_WRITE_MERGE == 1
+	flushMergeData();
+	if (m_mergeBuf)
+	{
+		fc_free(m_mergeBuf);
+		m_mergeBuf = NULL;
+	}
+	m_isOpenMerge = config.enable;
+	m_mergeFlushLen = config.flushLen > 0 ? config.flushLen : TCP_WRITE_MERGE_FLUSH_LEN;
+	m_mergeFlushDelay = config.flushDelay;
+#endif
+}
+
+void TCPSession::executeSendHeartMsg(NET_HEART_TYPE msg)
+{
+	if (!isOnline())
+		return;
+
+	uint32_t sendlen = 0;
+	const char* senddata = tcp_getHeartMsgData(msg, &sendlen);
+	if (senddata == NULL)
+		return;
+
+#if TCP_OPEN_WRITE_MERGE == 1
+	// ֤뵽Ѻϲ֮ǰ
+	flushMergeData();
+	if (!isOnline())
+		return;
+#endif
+
+	if (!m_socket->sendStaticData(senddata, sendlen))
+	{
+		executeDisconnect();
+	}
+}
+
+void TCPSession::executeSendMsg(char* data, uint32_t len)
+{
+	if (data == NULL || len <= 0)
+		return;
+
+	if (!isOnline())
+	{
+		m_traffic.dropMsgs++;
+		fc_free(data);
+		return;
+	}
+
+	char* senddata = data;
+	uint32_t sendlen = len;
+	NET_HEART_TYPE tag = NET_MSG_TYPE::MT_DEFAULT;
+
+#if TCP_OPEN_COMPRESS == 1
+	uint32_t compressLen = 0;
+	char* compressData = net_compressMsg(m_compressMode, data, len, &compressLen, &m_compressStats);
+	if (compressData != NULL)
+	{
+		senddata = compressData;
+		sendlen = compressLen;
+		tag = NET_MSG_TYPE::MT_COMPRESS;
+	}
+#endif
+
+	int32_t bufCount = 0;
+	uv_buf_t* bufArr = tcp_packageData(senddata, sendlen, &bufCount, tag);
+
+	if (senddata != data)
+	{
+		fc_free(senddata);
+	}
+	fc_free(data);
+
+	if (bufArr == NULL)
+		return;
+
+	for (int32_t i = 0; i < bufCount; ++i)
+	{
+		executeSend((bufArr + i)->base, (bufArr + i)->len);
+	}
+	fc_free(bufArr);
+}
+
 void TCPSession::executeDisconnect()
 {
 	if (isOnline())
@@ -125,30 +356,31 @@ void TCPSession::on_socket_recv(char* data, ssize_t len)
 
 #if TCP_USE_NET_UV_MSG_STRUCT == 0
 
+	m_traffic.recvBytes += len;
+
 	char* buf = (char*)fc_malloc(sizeof(char) * len);
 	memcpy(buf, data, len);
 	onRecvMsgPackage(buf, len, NET_MSG_TYPE::MT_DEFAULT);
 
 #else
-	m_recvBuffer->add(data, len);
+	// ׽ֱдm_recvBuffer
+	(void)data;
 
 	const static uint32_t headlen = sizeof(TCPMsgHead);
 
 	while (m_recvBuffer->getDataLength() >= headlen)
 	{
-		TCPMsgHead* h = (TCPMsgHead*)m_recvBuffer->getHeadBlockData();
+		TCPMsgHead* h = (TCPMsgHead*)m_recvBuffer->getReadData();
 
 		//ȴ򳤶Сڵ㣬Ϸͻ
 		if (h->len > TCP_BIG_MSG_MAX_LEN || h->len <= 0)
 		{
 #if OPEN_NET_UV_DEBUG == 1
-			char* pMsg = (char*)fc_malloc(m_recvBuffer->getDataLength());
-			m_recvBuffer->get(pMsg);
-			std::string errdata(pMsg, m_recvBuffer->getDataLength());
-			fc_free(pMsg);
+			std::string errdata(m_recvBuffer->getReadData(), m_recvBuffer->getDataLength());
 			NET_UV_LOG(NET_UV_L_WARNING, errdata.c_str());
 #endif
 			m_recvBuffer->clear();
+			m_traffic.dropMsgs++;
 			NET_UV_LOG(NET_UV_L_WARNING, "ݲϷ (1)!!!!");
 			executeDisconnect();
 			return;
@@ -160,70 +392,58 @@ void TCPSession::on_socket_recv(char* data, ssize_t len)
 			NET_UV_LOG(NET_UV_L_WARNING, "ݲϷ (2)!!!!");
 
 #if OPEN_NET_UV_DEBUG == 1
-			char* pMsg = (char*)fc_malloc(m_recvBuffer->getDataLength());
-			m_recvBuffer->get(pMsg);
-			std::string errdata(pMsg, m_recvBuffer->getDataLength());
-			fc_free(pMsg);
+			std::string errdata(m_recvBuffer->getReadData(), m_recvBuffer->getDataLength());
 			NET_UV_LOG(NET_UV_L_WARNING, errdata.c_str());
 #endif
 			m_recvBuffer->clear();
+			m_traffic.dropMsgs++;
 			executeDisconnect();
 			return;
 		}
 #endif
 
-		int32_t subv = m_recvBuffer->getDataLength() - (h->len + headlen);
-
 		//Ϣ
-		if (subv >= 0)
+		if (m_recvBuffer->getDataLength() >= h->len + headlen)
 		{
-			char* pMsg = (char*)fc_malloc(m_recvBuffer->getDataLength());
-			m_recvBuffer->get(pMsg);
-
-			char* src = pMsg + headlen;
-
-#if TCP_UV_OPEN_MD5_CHECK == 1
-			uint32_t recvLen = 0;
-			char* recvData = tcp_uv_decode(src, h->len, recvLen);
-
-			if (recvData != NULL && recvLen > 0)
-			{
+			char* src = m_recvBuffer->getReadData() + headlen;
+			uint32_t msgLen = h->len;
 #if TCP_OPEN_UV_THREAD_HEARTBEAT == 1
-				onRecvMsgPackage(recvData, recvLen, h->tag);
+			NET_HEART_TYPE msgTag = h->tag;
 #else
-				onRecvMsgPackage(recvData, recvLen, NET_MSG_TYPE::MT_DEFAULT);
+			NET_HEART_TYPE msgTag = NET_MSG_TYPE::MT_DEFAULT;
 #endif
+			// 
+			if (msgTag != NET_MSG_TYPE::MT_HEARTBEAT)
+			{
+				m_traffic.recvBytes += headlen + msgLen;
 			}
-			else//ݲϷ
+
+#if TCP_UV_OPEN_MD5_CHECK == 1
+			uint32_t recvLen = 0;
+			char* recvData = tcp_uv_decode(src, msgLen, recvLen);
+
+			if (recvData == NULL || recvLen <= 0)//ݲϷ
 			{
 				NET_UV_LOG(NET_UV_L_WARNING, "ݲϷ (3)!!!!");
 #if OPEN_NET_UV_DEBUG == 1
-				std::string errdata(pMsg, m_recvBuffer->getDataLength());
+				std::string errdata(m_recvBuffer->getReadData(), m_recvBuffer->getDataLength());
 				NET_UV_LOG(NET_UV_L_WARNING, errdata.c_str());
 #endif
 				m_recvBuffer->clear();
-				fc_free(pMsg);
+				m_traffic.dropMsgs++;
 				executeDisconnect();
 				return;
 			}
 #else
-			char* recvData = (char*)fc_malloc(h->len + 1);
-			memcpy(recvData, src, h->len);
-			recvData[h->len] = '\0';
-
-#if TCP_OPEN_UV_THREAD_HEARTBEAT == 1
-			onRecvMsgPackage(recvData, h->len, h->tag);
-#else
-			onRecvMsgPackage(recvData, h->len, NET_MSG_TYPE::MT_DEFAULT);
-#endif
+			uint32_t recvLen = msgLen;
+			char* recvData = (char*)fc_malloc(msgLen + 1);
+			memcpy(recvData, src, msgLen);
+			recvData[msgLen] = '\0';
 #endif
-			m_recvBuffer->clear();
+			// Ƴѽ,صпܶϿӲջ
+			m_recvBuffer->skip(headlen + msgLen);
 
-			if (subv > 0)
-			{
-				m_recvBuffer->add(data + (len - subv), subv);
-			}
-			fc_free(pMsg);
+			onRecvMsgPackage(recvData, recvLen, msgTag);
 		}
 		else
 		{
@@ -242,16 +462,12 @@ void TCPSession::onRecvMsgPackage(char* data, uint32_t len, NET_HEART_TYPE type)
 			NET_HEART_TYPE msg = *((NET_HEART_TYPE*)data);
 			if (msg == NET_HEARTBEAT_MSG_C2S)
 			{
-				uint32_t sendlen = 0;
-				char* senddata = tcp_packageHeartMsgData(NET_HEARTBEAT_RET_MSG_S2C, &sendlen);
-				executeSend(senddata, sendlen);
+				executeSendHeartMsg(NET_HEARTBEAT_RET_MSG_S2C);
 				NET_UV_LOG(NET_UV_L_HEART, "recv heart c->s");
 			}
 			else if (msg == NET_HEARTBEAT_MSG_S2C)
 			{
-				uint32_t sendlen = 0;
-				char* senddata = tcp_packageHeartMsgData(NET_HEARTBEAT_RET_MSG_C2S, &sendlen);
-				executeSend(senddata, sendlen);
+				executeSendHeartMsg(NET_HEARTBEAT_RET_MSG_C2S);
 				NET_UV_LOG(NET_UV_L_HEART, "recv heart s->c");
 			}
 			else if(msg > NET_HEARTBEAT_RET_MSG_S2C) // Ƿ
@@ -262,14 +478,102 @@ void TCPSession::onRecvMsgPackage(char* data, uint32_t len, NET_HEART_TYPE type)
 		}
 		fc_free(data);
 	}
+#if TCP_OPEN_STREAM_MSG == 1
+	else if (type == NET_MSG_TYPE::MT_STREAM)
+	{
+		if (len < sizeof(TCPStreamHead) || m_sessionRecvStreamCallback == nullptr)
+		{
+			m_traffic.dropMsgs++;
+			fc_free(data);
+			return;
+		}
+
+		m_traffic.recvMsgs++;
+		m_pendingStreamLen += len;
+		m_isRecvStream = true;
+		// Ӧò㴦ͣȡTCPڷѹͷ
+		if (!m_isPauseRead && m_pendingStreamLen >= TCP_STREAM_PAUSE_READ_LEN)
+		{
+			m_isPauseRead = m_socket->stopRead();
+		}
+		m_sessionRecvStreamCallback(this, data, len);
+	}
+#endif
+#if TCP_OPEN_COMPRESS == 1
+	else if (type == NET_MSG_TYPE::MT_COMPRESS)
+	{
+		uint32_t rawLen = 0;
+		char* rawData = net_decompressMsg(data, len, TCP_BIG_MSG_MAX_LEN, &rawLen, &m_compressStats);
+		fc_free(data);
+
+		if (rawData == NULL)
+		{
+			NET_UV_LOG(NET_UV_L_WARNING, "ѹʧܣݲϷ");
+			m_traffic.dropMsgs++;
+			executeDisconnect();
+			return;
+		}
+		m_traffic.recvMsgs++;
+		m_sessionRecvCallback(this, rawData, rawLen);
+	}
+#endif
 	else
 	{
+		m_traffic.recvMsgs++;
 		m_sessionRecvCallback(this, data, len);
 	}
 }
 
+void TCPSession::onStreamDataConsumed(uint32_t len)
+{
+#if TCP_OPEN_STREAM_MSG == 1
+	m_pendingStreamLen = (m_pendingStreamLen > len) ? (m_pendingStreamLen - len) : 0;
+
+	if (m_isPauseRead && isOnline() && m_pendingStreamLen <= TCP_STREAM_RESUME_READ_LEN)
+	{
+		if (m_socket->startRead())
+		{
+			m_isPauseRead = false;
+		}
+		else
+		{
+			executeDisconnect();
+		}
+	}
+#endif
+}
+
+void TCPSession::executeSendStream(char* data, uint32_t len)
+{
+	executeSend(data, len);
+#if TCP_OPEN_STREAM_MSG == 1
+	m_isStreamSending = isOnline();
+#endif
+}
+
+void TCPSession::on_socket_write()
+{
+#if TCP_OPEN_STREAM_MSG == 1
+	if (!m_isStreamSending)
+	{
+		return;
+	}
+	if (getWriteQueueSize() == 0)
+	{
+		m_isStreamSending = false;
+	}
+	if (m_sessionStreamWriteCallback != nullptr)
+	{
+		m_sessionStreamWriteCallback(this);
+	}
+#endif
+}
+
 void TCPSession::on_socket_close(Socket* socket)
 {
+#if TCP_OPEN_COMPRESS == 1
+	net_logCompressStats("tcp", m_sessionID, m_compressStats);
+#endif
 	this->setIsOnline(false);
 	if (m_sessionCloseCallback)
 	{
@@ -286,6 +590,18 @@ void TCPSession::setIsOnline(bool isOnline)
 	m_curHeartCount = m_resetHeartCount;
 	m_curHeartTime = 0;
 #endif
+
+#if TCP_OPEN_STREAM_MSG == 1
+	m_pendingStreamLen = 0;
+	m_isPauseRead = false;
+	m_isRecvStream = false;
+	m_streamHeartTime = 0;
+	m_isStreamSending = false;
+#endif
+
+#if TCP_OPEN_WRITE_MERGE == 1
+	m_mergeLen = 0;
+#endif
 }
 
 void TCPSession::update(uint32_t time)
@@ -294,6 +610,24 @@ void TCPSession::update(uint32_t time)
 	if (!isOnline())
 		return;
 
+#if TCP_OPEN_STREAM_MSG == 1
+	// ڼԶ˵ڴ֮ͣȡڼҲղԶ˵ظ
+	// ʱʱֶԶ˻Ծ
+	if (m_isPauseRead || m_isRecvStream)
+	{
+		m_streamHeartTime += time;
+		if (m_streamHeartTime >= TCP_HEARTBEAT_CHECK_DELAY)
+		{
+			m_streamHeartTime = 0;
+			m_isRecvStream = false;
+			m_curHeartCount = m_resetHeartCount;
+			m_curHeartTime = 0;
+			executeSendHeartMsg(m_sendHeartMsg);
+		}
+		return;
+	}
+#endif
+
 	m_curHeartTime += time;
 	if (m_curHeartTime >= TCP_HEARTBEAT_CHECK_DELAY)
 	{
@@ -309,9 +643,7 @@ void TCPSession::update(uint32_t time)
 			}
 			else
 			{
-				uint32_t sendlen = 0;
-				char* senddata = tcp_packageHeartMsgData(m_sendHeartMsg, &sendlen);
-				executeSend(senddata, sendlen);
+				executeSendHeartMsg(m_sendHeartMsg);
 				NET_UV_LOG(NET_UV_L_HEART, "tcp send heart %d", m_sendHeartMsg);
 			}
 		}
@@ -319,6 +651,19 @@ void TCPSession::update(uint32_t time)
 #endif
 }
 
+uint32_t TCPSession::getWriteQueueSize()
+{
+	uint32_t size = 0;
+	if (m_socket && m_socket->getTcp())
+	{
+		size = (uint32_t)m_socket->getTcp()->write_queue_size;
+	}
+#if TCP_OPEN_WRITE_MERGE == 1
+	size += m_mergeLen;
+#endif
+	return size;
+}
+
 uint32_t TCPSession::getPort()
 {
 	return getTCPSocket()->getPort();
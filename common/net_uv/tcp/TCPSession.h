@@ -4,6 +4,9 @@
 
 NS_NET_UV_BEGIN
 
+class TCPSession;
+using TCPSessionWriteMergeCall = std::function<void(TCPSession*)>;
+using TCPSessionStreamWriteCall = std::function<void(TCPSession*)>;
 
 class TCPSession : public Session
 {
@@ -34,6 +37,30 @@ protected:
 
 	virtual void update(uint32_t time)override;
 
+	virtual uint32_t getWriteQueueSize()override;
+
+	void executeSendHeartMsg(NET_HEART_TYPE msg);
+
+	// UV߳аỰѹģʽϢ
+	void executeSendMsg(char* data, uint32_t len);
+
+	inline void setCompressMode(NetCompressMode mode);
+
+	// ӦòѴ
+	void onStreamDataConsumed(uint32_t len);
+
+	// Ƭ,֮дб仯ʱ֪ͨ,ֱд
+	void executeSendStream(char* data, uint32_t len);
+
+	// ÷ͺϲ
+	void setWriteMerge(const TCPWriteMergeConfig& config);
+
+	// ͺϲе
+	void flushMergeData();
+
+	// ¼ѭʱ,trueʾȴϲӳ
+	bool updateMergeFlush(uint64_t curTime);
+
 protected:
 
 	bool initWithSocket(TCPSocket* socket);
@@ -45,15 +72,25 @@ protected:
 	inline void setSendHeartMsg(NET_HEART_TYPE msg);
 
 	inline void setHeartMaxCount(int32_t maxCount);
+
+	inline void setSessionRecvStreamCallback(const SessionRecvCall& call);
+
+	inline void setSessionWriteMergeCallback(const TCPSessionWriteMergeCall& call);
+
+	inline void setSessionStreamWriteCallback(const TCPSessionStreamWriteCall& call);
 	
 	void onRecvMsgPackage(char* data, uint32_t len, NET_HEART_TYPE type);
 
+	void executeMergeSend(char* data, uint32_t len);
+
 protected:
 
 	void on_socket_recv(char* data, ssize_t len);
 
 	void on_socket_close(Socket* socket);
 
+	void on_socket_write();
+
 	friend class TCPServer;
 	friend class TCPClient;
 
@@ -69,6 +106,39 @@ protected:
 	int32_t m_curHeartMaxCount;
 	NET_HEART_TYPE m_sendHeartMsg;
 #endif
+
+#if TCP_OPEN_COMPRESS == 1
+	NetCompressMode m_compressMode;
+	NetCompressStats m_compressStats;
+#endif
+
+#if TCP_OPEN_STREAM_MSG == 1
+	SessionRecvCall m_sessionRecvStreamCallback;
+	// ͶݵӦòδݳ
+	uint32_t m_pendingStreamLen;
+	// Ƿͣȡ
+	bool m_isPauseRead;
+	// Ƿյ
+	bool m_isRecvStream;
+	int32_t m_streamHeartTime;
+	TCPSessionStreamWriteCall m_sessionStreamWriteCallback;
+	// дǷƬ
+	bool m_isStreamSending;
+#endif
+
+#if TCP_OPEN_WRITE_MERGE == 1
+	TCPSessionWriteMergeCall m_sessionWriteMergeCallback;
+	char* m_mergeBuf;
+	uint32_t m_mergeLen;
+	uint32_t m_mergeFlushLen;
+	// ϲӳ(΢)
+	uint32_t m_mergeFlushDelay;
+	// дһݵʱ()
+	uint64_t m_mergeStartTime;
+	bool m_isOpenMerge;
+	// Ƿ֪ͨ¼ѭʱ
+	bool m_isWaitMergeFlush;
+#endif
 };
 
 TCPSocket* TCPSession::getTCPSocket()
@@ -98,4 +168,32 @@ void TCPSession::setHeartMaxCount(int32_t maxCount)
 #endif
 }
 
+void TCPSession::setSessionRecvStreamCallback(const SessionRecvCall& call)
+{
+#if TCP_OPEN_STREAM_MSG == 1
+	m_sessionRecvStreamCallback = std::move(call);
+#endif
+}
+
+void TCPSession::setSessionWriteMergeCallback(const TCPSessionWriteMergeCall& call)
+{
+#if TCP_OPEN_WRITE_MERGE == 1
+	m_sessionWriteMergeCallback = std::move(call);
+#endif
+}
+
+void TCPSession::setSessionStreamWriteCallback(const TCPSessionStreamWriteCall& call)
+{
+#if TCP_OPEN_STREAM_MSG == 1
+	m_sessionStreamWriteCallback = std::move(call);
+#endif
+}
+
+void TCPSession::setCompressMode(NetCompressMode mode)
+{
+#if TCP_OPEN_COMPRESS == 1
+	m_compressMode = mode;
+#endif
+}
+
 NS_NET_UV_END
@@ -10,6 +10,7 @@ NS_NET_UV_BEGIN
 TCPSocket::TCPSocket(uv_loop_t* loop)
 	: m_newConnectionCall(nullptr)
 	, m_tcp(NULL)
+	, m_writeCall(nullptr)
 {
 	m_loop = loop;
 }
@@ -18,6 +19,8 @@ TCPSocket::~TCPSocket()
 {
 	if (m_tcp)
 	{
+		// رʱȡдٻص
+		m_tcp->data = NULL;
 		net_closeHandle((uv_handle_t*)m_tcp, net_closehandle_defaultcallback);
 		m_tcp = NULL;
 	}
@@ -165,6 +168,27 @@ bool TCPSocket::send(char* data, int32_t len)
 	return (r == 0);
 }
 
+bool TCPSocket::sendStaticData(const char* data, int32_t len)
+{
+	if (m_tcp == NULL)
+	{
+		return false;
+	}
+
+	// uv_write´buf,ֻΪreqڴ
+	uv_buf_t buf = uv_buf_init((char*)data, len);
+
+	uv_write_t *req = (uv_write_t*)fc_malloc(sizeof(uv_write_t));
+	req->data = NULL;
+
+	int32_t r = uv_write(req, (uv_stream_t*)m_tcp, &buf, 1, uv_on_after_write_static);
+	if (r != 0)
+	{
+		fc_free(req);
+	}
+	return (r == 0);
+}
+
 TCPSocket* TCPSocket::accept(uv_stream_t* server, int32_t status)
 {
 	if (status != 0)
@@ -317,14 +341,42 @@ void TCPSocket::server_on_after_new_connection(uv_stream_t *server, int32_t stat
 	s->m_newConnectionCall(server, status);
 }
 
+void TCPSocket::uv_on_alloc_buffer(uv_handle_t* handle, size_t size, uv_buf_t* buf)
+{
+	TCPSocket* s = (TCPSocket*)handle->data;
+	if (s->m_recvBuffer == NULL)
+	{
+		Socket::uv_on_alloc_buffer(handle, size, buf);
+		return;
+	}
+
+	// ֱӶջȫдռ
+	// ʱؿջ,libuvUV_ENOBUFSصȡʧ
+	buf->base = s->m_recvBuffer->getWriteData(TCP_RECV_MIN_WRITE_LEN);
+	buf->len = (buf->base == NULL) ? 0 : s->m_recvBuffer->getWriteableLength();
+}
+
 void TCPSocket::uv_on_after_read(uv_stream_t *handle, ssize_t nread, const uv_buf_t *buf) 
 {
 	TCPSocket* s = (TCPSocket*)handle->data;
-	if (nread <= 0) 
+	// nreadΪ0ʾݿɶ(EAGAIN),ӶϿ
+	if (nread == 0)
+	{
+		return;
+	}
+	if (nread < 0) 
 	{
+		if (nread == UV_ENOBUFS)
+		{
+			NET_UV_LOG(NET_UV_L_WARNING, "ջ");
+		}
 		s->disconnect();
 		return;
 	}
+	if (s->m_recvBuffer != NULL)
+	{
+		s->m_recvBuffer->commit((uint32_t)nread);
+	}
 	s->m_recvCall(buf->base, nread);
 }
 
@@ -337,7 +389,41 @@ void TCPSocket::uv_on_after_write(uv_write_t* req, int32_t status)
 	uv_buf_t* buf = (uv_buf_t*)req->data;
 	fc_free(buf->base);
 	fc_free(buf);
+
+	TCPSocket* s = (TCPSocket*)req->handle->data;
+	fc_free(req);
+	if (s && s->m_writeCall != nullptr)
+	{
+		s->m_writeCall();
+	}
+}
+
+bool TCPSocket::stopRead()
+{
+	if (m_tcp == NULL)
+	{
+		return false;
+	}
+	return (uv_read_stop((uv_stream_t*)m_tcp) == 0);
+}
+
+bool TCPSocket::startRead()
+{
+	if (m_tcp == NULL)
+	{
+		return false;
+	}
+	return (uv_read_start((uv_stream_t*)m_tcp, uv_on_alloc_buffer, uv_on_after_read) == 0);
+}
+
+void TCPSocket::uv_on_after_write_static(uv_write_t* req, int32_t status)
+{
+	TCPSocket* s = (TCPSocket*)req->handle->data;
 	fc_free(req);
+	if (s && s->m_writeCall != nullptr)
+	{
+		s->m_writeCall();
+	}
 }
 
 NS_NET_UV_END
\ No newline at end of file
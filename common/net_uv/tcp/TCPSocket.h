@@ -5,6 +5,7 @@
 NS_NET_UV_BEGIN
 
 using TCPSocketNewConnectionCall = std::function<void(uv_stream_t*, int)>;
+using TCPSocketWriteCall = std::function<void()>;
 
 class TCPSocket : public Socket
 {
@@ -25,6 +26,9 @@ public:
 
 	virtual bool send(char* data, int len)override;
 
+	// ;̬(ɵ߳,ɺͷ)
+	bool sendStaticData(const char* data, int32_t len);
+
 	TCPSocket* accept(uv_stream_t* server, int status);
 
 	virtual void disconnect()override;
@@ -32,9 +36,18 @@ public:
 	bool setNoDelay(bool enable);
 
 	bool setKeepAlive(int enable, unsigned int delay);
+
+	// ͣȡ
+	bool stopRead();
+
+	// ָȡ
+	bool startRead();
 	
 	inline void setNewConnectionCallback(const TCPSocketNewConnectionCall& call);
 
+	// дɻص
+	inline void setWriteCallback(const TCPSocketWriteCall& call);
+
 protected:
 	void shutdownSocket();
 
@@ -51,12 +64,15 @@ protected:
 
 	static void uv_on_after_connect(uv_connect_t* handle, int status);
 	static void uv_on_after_write(uv_write_t* req, int status);
+	static void uv_on_after_write_static(uv_write_t* req, int status);
+	static void uv_on_alloc_buffer(uv_handle_t* handle, size_t size, uv_buf_t* buf);
 	static void uv_on_after_read(uv_stream_t *handle, ssize_t nread, const uv_buf_t *buf);
 	static void server_on_after_new_connection(uv_stream_t *server, int status);
 
 protected:
 	uv_tcp_t* m_tcp;
 	TCPSocketNewConnectionCall m_newConnectionCall;
+	TCPSocketWriteCall m_writeCall;
 };
 
 void TCPSocket::setTcp(uv_tcp_t* tcp)
@@ -79,5 +95,10 @@ void TCPSocket::setNewConnectionCallback(const TCPSocketNewConnectionCall& call)
 	m_newConnectionCall = std::move(call);
 }
 
+void TCPSocket::setWriteCallback(const TCPSocketWriteCall& call)
+{
+	m_writeCall = std::move(call);
+}
+
 NS_NET_UV_END
 
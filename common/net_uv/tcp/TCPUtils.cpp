@@ -82,7 +82,7 @@ char* tcp_uv_decode(const char* data, uint32_t len, uint32_t &outLen)
 
 
 // 
-uv_buf_t* tcp_packageData(char* data, uint32_t len, int32_t* bufCount)
+uv_buf_t* tcp_packageData(char* data, uint32_t len, int32_t* bufCount, NET_HEART_TYPE tag)
 {
 	*bufCount = 0;
 	if (data == NULL || len <= 0)
@@ -127,7 +127,7 @@ uv_buf_t* tcp_packageData(char* data, uint32_t len, int32_t* bufCount)
 	TCPMsgHead* h = (TCPMsgHead*)p;
 	h->len = encodelen;
 #if TCP_OPEN_UV_THREAD_HEARTBEAT == 1
-	h->tag = NET_MSG_TYPE::MT_DEFAULT;
+	h->tag = tag;
 #endif
 	memcpy(p + tcp_msg_headlen, encodedata, encodelen);
 
@@ -138,7 +138,7 @@ uv_buf_t* tcp_packageData(char* data, uint32_t len, int32_t* bufCount)
 	TCPMsgHead* h = (TCPMsgHead*)p;
 	h->len = len;
 #if TCP_OPEN_UV_THREAD_HEARTBEAT == 1
-	h->tag = NET_MSG_TYPE::MT_DEFAULT;
+	h->tag = tag;
 #endif
 	memcpy(p + tcp_msg_headlen, data, len);
 #endif
@@ -245,4 +245,95 @@ char* tcp_packageHeartMsgData(NET_HEART_TYPE msg, unsigned int* outBufSize)
 	return p;
 }
 
+// Ƭ
+char* tcp_packageStreamData(uint32_t streamID, TCPStreamState state, const char* data, uint32_t len, uint32_t* outBufSize)
+{
+	*outBufSize = 0;
+
+	const static uint32_t streamHeadLen = sizeof(TCPStreamHead);
+
+	uint32_t bodylen = streamHeadLen + len;
+	char* body = (char*)fc_malloc(bodylen);
+	if (body == NULL)
+	{
+		return NULL;
+	}
+	TCPStreamHead* sh = (TCPStreamHead*)body;
+	sh->streamID = streamID;
+	sh->state = state;
+	if (len > 0)
+	{
+		memcpy(body + streamHeadLen, data, len);
+	}
+
+#if TCP_UV_OPEN_MD5_CHECK == 1
+	uint32_t encodelen = 0;
+	char* encodedata = tcp_uv_encode(body, bodylen, encodelen);
+	fc_free(body);
+	if (encodedata == NULL)
+	{
+		return NULL;
+	}
+	body = encodedata;
+	bodylen = encodelen;
+#endif
+
+	uint32_t sendlen = tcp_msg_headlen + bodylen;
+	char* p = (char*)fc_malloc(sendlen);
+	if (p == NULL)
+	{
+		fc_free(body);
+		return NULL;
+	}
+	TCPMsgHead* h = (TCPMsgHead*)p;
+	h->len = bodylen;
+#if TCP_OPEN_UV_THREAD_HEARTBEAT == 1
+	h->tag = NET_MSG_TYPE::MT_STREAM;
+#endif
+	memcpy(p + tcp_msg_headlen, body, bodylen);
+	fc_free(body);
+
+	*outBufSize = sendlen;
+
+	return p;
+}
+
+// Ϣ
+#define TCP_HEART_MSG_CACHE_COUNT (NET_HEARTBEAT_RET_MSG_S2C + 1)
+#define TCP_HEART_MSG_CACHE_MAX_LEN (64)
+
+struct TCPHeartMsgCache
+{
+	char data[TCP_HEART_MSG_CACHE_COUNT][TCP_HEART_MSG_CACHE_MAX_LEN];
+	uint32_t len[TCP_HEART_MSG_CACHE_COUNT];
+
+	TCPHeartMsgCache()
+	{
+		for (NET_HEART_TYPE i = 0; i < TCP_HEART_MSG_CACHE_COUNT; ++i)
+		{
+			uint32_t sendlen = 0;
+			char* p = tcp_packageHeartMsgData(i, &sendlen);
+			assert(p != NULL && sendlen <= TCP_HEART_MSG_CACHE_MAX_LEN);
+
+			memcpy(data[i], p, sendlen);
+			len[i] = sendlen;
+			fc_free(p);
+		}
+	}
+};
+
+const char* tcp_getHeartMsgData(NET_HEART_TYPE msg, uint32_t* outBufSize)
+{
+	// ֲ̬ĳʼ̰߳ȫ,loop߳ͬʱҲֻһ
+	static TCPHeartMsgCache cache;
+
+	if (msg >= TCP_HEART_MSG_CACHE_COUNT)
+	{
+		*outBufSize = 0;
+		return NULL;
+	}
+	*outBufSize = cache.len[msg];
+	return cache.data[msg];
+}
+
 NS_NET_UV_END
\ No newline at end of file
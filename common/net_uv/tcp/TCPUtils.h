@@ -9,8 +9,12 @@ char* tcp_uv_encode(const char* data, uint32_t len, uint32_t &outLen);
 //
 char* tcp_uv_decode(const char* data, uint32_t len, uint32_t &outLen);
 // 
-uv_buf_t* tcp_packageData(char* data, uint32_t len, int32_t* bufCount);
+uv_buf_t* tcp_packageData(char* data, uint32_t len, int32_t* bufCount, NET_HEART_TYPE tag = NET_MSG_TYPE::MT_DEFAULT);
 // Ϣ
 char* tcp_packageHeartMsgData(NET_HEART_TYPE msg, uint32_t* outBufSize);
+// Ƭ
+char* tcp_packageStreamData(uint32_t streamID, TCPStreamState state, const char* data, uint32_t len, uint32_t* outBufSize);
+// ȡԤȴõϢ(ֻһΣصݲͷ)
+const char* tcp_getHeartMsgData(NET_HEART_TYPE msg, uint32_t* outBufSize);
 
 NS_NET_UV_END
\ No newline at end of file
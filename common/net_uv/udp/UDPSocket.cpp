@@ -7,6 +7,7 @@ NS_NET_UV_BEGIN
 UDPSocket::UDPSocket(uv_loop_t* loop)
 	: m_udp(NULL)
 	, m_readCall(nullptr)
+	, m_reusePort(false)
 {
 	m_loop = loop;
 }
@@ -36,9 +37,27 @@ uint32_t UDPSocket::bind(const char* ip, uint32_t port)
 	}
 
 	m_udp = (uv_udp_t*)fc_malloc(sizeof(uv_udp_t));
-	r = uv_udp_init(m_loop, m_udp);
-	CHECK_UV_ASSERT(r);
-	m_udp->data = this;
+	if (m_reusePort)
+	{
+		// Ҫȴ׽ֲSO_REUSEPORT
+		r = uv_udp_init_ex(m_loop, m_udp, AF_INET);
+		CHECK_UV_ASSERT(r);
+		m_udp->data = this;
+
+		if (!net_udp_setReusePort(m_udp))
+		{
+			// رպڻصͷ,°
+			net_closeHandle((uv_handle_t*)m_udp, net_closehandle_defaultcallback);
+			m_udp = NULL;
+			return 0;
+		}
+	}
+	else
+	{
+		r = uv_udp_init(m_loop, m_udp);
+		CHECK_UV_ASSERT(r);
+		m_udp->data = this;
+	}
 
 	r = uv_udp_bind(m_udp, (const struct sockaddr*) &bind_addr, UV_UDP_REUSEADDR);
 
@@ -81,11 +100,22 @@ uint32_t UDPSocket::bind6(const char* ip, uint32_t port)
 		return 0;
 	}
 
+	// ȴ׽,Աbind֮ǰѡ
 	m_udp = (uv_udp_t*)fc_malloc(sizeof(uv_udp_t));
-	r = uv_udp_init(m_loop, m_udp);
+	r = uv_udp_init_ex(m_loop, m_udp, AF_INET6);
 	CHECK_UV_ASSERT(r);
 	m_udp->data = this;
 
+	// ʽرIPV6_V6ONLY,ϵͳĬֵ,"::"ͬʱշIPV4
+	// ʧʱ0,ɵ÷˻IPV4
+	if (!net_udp_setIPV6Only(m_udp, false) || (m_reusePort && !net_udp_setReusePort(m_udp)))
+	{
+		// رպڻصͷ,°
+		net_closeHandle((uv_handle_t*)m_udp, net_closehandle_defaultcallback);
+		m_udp = NULL;
+		return 0;
+	}
+
 	r = uv_udp_bind(m_udp, (const struct sockaddr*) &bind_addr, UV_UDP_REUSEADDR);
 
 	if (r != 0)
@@ -150,6 +180,21 @@ bool UDPSocket::udpSend(const char* data, int32_t len, const struct sockaddr* ad
 	return true;
 }
 
+bool UDPSocket::udpTrySend(const char* data, int32_t len, const struct sockaddr* addr)
+{
+	if (m_udp == NULL)
+	{
+		return false;
+	}
+	uv_buf_t buf = uv_buf_init((char*)data, len);
+	int32_t r = uv_udp_try_send(m_udp, &buf, 1, addr);
+	if (r == UV_EAGAIN)
+	{
+		return udpSend(data, len, addr);
+	}
+	return (r >= 0);
+}
+
 void UDPSocket::shutdownSocket()
 {
 	if (m_udp == NULL)
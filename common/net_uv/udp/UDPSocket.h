@@ -32,10 +32,16 @@ public:
 
 	inline void setReadCallback(const UDPReadCallback& call);
 
+	// ʱǷSO_REUSEPORT,bind֮ǰ
+	inline void setReusePort(bool reusePort);
+
 	inline uv_udp_t* getUdp();
 
 	bool udpSend(const char* data, int32_t len, const struct sockaddr* addr);
 
+	// ,,ͶвΪʱ˻ΪudpSend
+	bool udpTrySend(const char* data, int32_t len, const struct sockaddr* addr);
+
 	void shutdownSocket();
 	
 protected:
@@ -46,6 +52,7 @@ protected:
 
 	uv_udp_t* m_udp;
 	UDPReadCallback m_readCall;
+	bool m_reusePort;
 	
 protected:
 	static void uv_on_udp_send(uv_udp_send_t *req, int status);
@@ -69,6 +76,11 @@ void UDPSocket::setReadCallback(const UDPReadCallback& call)
 	m_readCall = std::move(call);
 }
 
+void UDPSocket::setReusePort(bool reusePort)
+{
+	m_reusePort = reusePort;
+}
+
 
 NS_NET_UV_END
 
@@ -0,0 +1,307 @@
+#include "net_uv/net_uv.h"
+#include "net_uv/base/Compress.h"
+#include <vector>
+#include <random>
+
+NS_NET_UV_OPEN
+
+// Ϣѹ׼
+// 1. :ֳȺݵϢѹѹ,ԭʼһ
+// 2. ֵ:ƥԽֵĩβϢʼʱȷ,ֵ䲻һʱѹʧ
+// 3. ģ:޸/ضѹݼݽѹ,Խд,ѹɹʱȱȷ
+// 4. FAST/DICTģʽСϢѹٶ
+
+// ÿģʽϢ
+#define BENCH_ROUND_TRIP_COUNT (20000)
+// ģԴ
+#define BENCH_FUZZ_COUNT (200000)
+// ٶȲԵ
+#define BENCH_TOTAL_LEN (64 * 1024 * 1024)
+// ѹ󳤶
+#define BENCH_MAX_LEN (1024 * 1024 * 4)
+
+static std::mt19937 benchRand(12345);
+
+static uint32_t randRange(uint32_t minValue, uint32_t maxValue)
+{
+	return minValue + benchRand() % (maxValue - minValue + 1);
+}
+
+// JSONϢ,ظȽϸ
+static void makeJsonMsg(std::string& out, uint32_t len)
+{
+	static const char* keyArr[] = { "\"id\":", "\"name\":", "\"level\":", "\"pos\":", "\"items\":", "\"hp\":", "\"guild\":" };
+	out = "{";
+	while (out.size() < len)
+	{
+		out += keyArr[benchRand() % (sizeof(keyArr) / sizeof(keyArr[0]))];
+		out += std::to_string(benchRand() % 100000);
+		out += ",";
+	}
+	out.resize(len);
+}
+
+// ָ͵: 0 1ֽظ 2JSON 3ظ
+static void makeMsg(std::string& out, uint32_t len, uint32_t type)
+{
+	switch (type)
+	{
+	case 0:
+		out.resize(len);
+		for (uint32_t i = 0; i < len; ++i)
+		{
+			out[i] = (char)benchRand();
+		}
+		break;
+	case 1:
+		out.assign(len, (char)benchRand());
+		break;
+	case 2:
+		makeJsonMsg(out, len);
+		break;
+	default:
+	{
+		uint32_t period = randRange(1, 7);
+		out.resize(len);
+		for (uint32_t i = 0; i < len; ++i)
+		{
+			out[i] = (char)('a' + i % period);
+		}
+	}
+		break;
+	}
+}
+
+// ѹѹ,ѹûбСʱΪɹ
+static bool roundTrip(NetCompressMode mode, const std::string& msg)
+{
+	uint32_t compressLen = 0;
+	char* compressData = net_compressMsg(mode, msg.data(), (uint32_t)msg.size(), &compressLen, NULL);
+	if (compressData == NULL)
+	{
+		return true;
+	}
+
+	uint32_t rawLen = 0;
+	char* rawData = net_decompressMsg(compressData, compressLen, BENCH_MAX_LEN, &rawLen, NULL);
+	bool isSame = (rawData != NULL && rawLen == msg.size() && memcmp(rawData, msg.data(), rawLen) == 0 && rawData[rawLen] == '\0');
+
+	fc_free(compressData);
+	if (rawData)
+	{
+		fc_free(rawData);
+	}
+	return isSame;
+}
+
+static uint32_t runRoundTrip(NetCompressMode mode)
+{
+	uint32_t failCount = 0;
+	std::string msg;
+	for (uint32_t i = 0; i < BENCH_ROUND_TRIP_COUNT; ++i)
+	{
+		// 󲿷ΪСϢ,Ϣ
+		uint32_t len = (i % 100 == 0) ? randRange(1, 256 * 1024) : randRange(1, 2048);
+		makeMsg(msg, len, i % 4);
+		if (!roundTrip(mode, msg))
+		{
+			failCount++;
+		}
+	}
+	return failCount;
+}
+
+// ƥֵĩβϢʼ:Ϣмֵβ+Ϣͷ
+static uint32_t runDictBoundary(const std::string& dict)
+{
+	uint32_t failCount = 0;
+	std::string head;
+	std::string msg;
+	for (uint32_t i = 0; i < 1000; ++i)
+	{
+		makeMsg(head, randRange(8, 64), 0);
+		msg = head;
+		msg += dict.substr(dict.size() - randRange(4, 256));
+		msg += head;
+		makeMsg(head, randRange(0, 64), 0);
+		msg += head;
+		if (!roundTrip(NetCompressMode::DICT, msg))
+		{
+			failCount++;
+		}
+	}
+	return failCount;
+}
+
+// ֵ䲻һʱѹʧ,ʧܵļ
+static uint32_t runDictMismatch(const std::string& dict)
+{
+	std::string msg;
+	makeJsonMsg(msg, 512);
+
+	uint32_t compressLen = 0;
+	char* compressData = net_compressMsg(NetCompressMode::DICT, msg.data(), (uint32_t)msg.size(), &compressLen, NULL);
+	if (compressData == NULL)
+	{
+		return 1;
+	}
+
+	uint32_t failCount = 0;
+	uint32_t rawLen = 0;
+
+	// ֵݲͬ
+	std::string otherDict = dict;
+	otherDict[otherDict.size() / 2] ^= 0x5A;
+	net_setCompressDict(otherDict.data(), (uint32_t)otherDict.size());
+	char* rawData = net_decompressMsg(compressData, compressLen, BENCH_MAX_LEN, &rawLen, NULL);
+	if (rawData)
+	{
+		fc_free(rawData);
+		failCount++;
+	}
+
+	// δֵ
+	net_setCompressDict(NULL, 0);
+	rawData = net_decompressMsg(compressData, compressLen, BENCH_MAX_LEN, &rawLen, NULL);
+	if (rawData)
+	{
+		fc_free(rawData);
+		failCount++;
+	}
+
+	net_setCompressDict(dict.data(), (uint32_t)dict.size());
+	fc_free(compressData);
+	return failCount;
+}
+
+// ѹȱϢͷһ,Ƿͨ
+static bool fuzzDecompress(const std::string& data)
+{
+	uint32_t rawLen = 0;
+	char* rawData = net_decompressMsg(data.data(), (uint32_t)data.size(), BENCH_MAX_LEN, &rawLen, NULL);
+	if (rawData == NULL)
+	{
+		return true;
+	}
+	bool isOk = (rawLen == ((const NetCompressHead*)data.data())->rawLen);
+	fc_free(rawData);
+	return isOk;
+}
+
+static uint32_t runFuzz()
+{
+	uint32_t failCount = 0;
+	std::string msg;
+	std::string data;
+	for (uint32_t i = 0; i < BENCH_FUZZ_COUNT; ++i)
+	{
+		NetCompressMode mode = (i % 2 == 0) ? NetCompressMode::FAST : NetCompressMode::DICT;
+		makeMsg(msg, randRange(16, 4096), 2 + i % 2);
+
+		uint32_t compressLen = 0;
+		char* compressData = net_compressMsg(mode, msg.data(), (uint32_t)msg.size(), &compressLen, NULL);
+		if (compressData == NULL)
+		{
+			continue;
+		}
+		data.assign(compressData, compressLen);
+		fc_free(compressData);
+
+		switch (i % 4)
+		{
+		case 0:
+		{
+			// ޸ֽ(޸Ϣͷ)
+			uint32_t count = randRange(1, 8);
+			for (uint32_t k = 0; k < count; ++k)
+			{
+				uint32_t pos = randRange(sizeof(NetCompressHead), (uint32_t)data.size() - 1);
+				data[pos] = (char)benchRand();
+			}
+		}
+			break;
+		case 1:
+			// ض
+			data.resize(randRange(sizeof(NetCompressHead) + 1, (uint32_t)data.size()));
+			break;
+		case 2:
+			// ޸Ľѹ󳤶
+			((NetCompressHead*)&data[0])->rawLen = randRange(1, (uint32_t)msg.size() * 2);
+			break;
+		default:
+			// 
+			for (uint32_t k = sizeof(NetCompressHead); k < data.size(); ++k)
+			{
+				data[k] = (char)benchRand();
+			}
+			break;
+		}
+
+		if (!fuzzDecompress(data))
+		{
+			failCount++;
+		}
+	}
+	return failCount;
+}
+
+static void runSpeed(const char* name, NetCompressMode mode, uint32_t msgLen)
+{
+	std::vector<std::string> msgArr(256);
+	for (auto& msg : msgArr)
+	{
+		makeJsonMsg(msg, msgLen);
+	}
+
+	NetCompressStats stats;
+	memset(&stats, 0, sizeof(stats));
+
+	uint32_t count = BENCH_TOTAL_LEN / msgLen;
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		const std::string& msg = msgArr[i % msgArr.size()];
+		uint32_t compressLen = 0;
+		char* compressData = net_compressMsg(mode, msg.data(), (uint32_t)msg.size(), &compressLen, &stats);
+		if (compressData == NULL)
+		{
+			continue;
+		}
+		uint32_t rawLen = 0;
+		char* rawData = net_decompressMsg(compressData, compressLen, BENCH_MAX_LEN, &rawLen, &stats);
+		fc_free(compressData);
+		if (rawData)
+		{
+			fc_free(rawData);
+		}
+	}
+
+	double mb = stats.sendRawBytes / (1024.0 * 1024.0);
+	printf("%-4s %-5u ratio %5.1f%%  compress %8.1f MB/s  decompress %8.1f MB/s\n",
+		name, msgLen,
+		stats.sendRawBytes > 0 ? stats.sendCompressBytes * 100.0 / stats.sendRawBytes : 100.0,
+		stats.compressTime > 0 ? mb / (stats.compressTime / 1e9) : 0.0,
+		stats.decompressTime > 0 ? mb / (stats.decompressTime / 1e9) : 0.0);
+}
+
+int main()
+{
+	std::string dict;
+	makeJsonMsg(dict, 16 * 1024);
+	net_setCompressDict(dict.data(), (uint32_t)dict.size());
+
+	uint32_t fastFail = runRoundTrip(NetCompressMode::FAST);
+	uint32_t dictFail = runRoundTrip(NetCompressMode::DICT) + runDictBoundary(dict);
+	uint32_t mismatchFail = runDictMismatch(dict);
+	uint32_t fuzzFail = runFuzz();
+
+	printf("round trip FAST fail=%u DICT fail=%u  dict mismatch fail=%u  fuzz fail=%u\n", fastFail, dictFail, mismatchFail, fuzzFail);
+
+	runSpeed("FAST", NetCompressMode::FAST, 128);
+	runSpeed("DICT", NetCompressMode::DICT, 128);
+	runSpeed("FAST", NetCompressMode::FAST, 1024);
+	runSpeed("DICT", NetCompressMode::DICT, 1024);
+
+	bool isOk = (fastFail == 0 && dictFail == 0 && mismatchFail == 0 && fuzzFail == 0);
+	printf("%s\n", isOk ? "OK" : "FAIL");
+	return isOk ? 0 : 1;
+}
@@ -0,0 +1,332 @@
+#include "FSTransferPool.h"
+#include <deque>
+
+NS_NET_UV_OPEN
+
+// FSTransfer
+// ˺ضڲͬĿ¼,мɽӳתģӳ·
+//   fstBench s <port> [sizeMB]                  : ṩǰĿ¼µļ,ָsizeMBʱļfstbench.bin
+//   fstBench r <port> <targetPort> <delayMs>    : ӳת,յÿӳdelayMsת
+//   fstBench c <port> <filename> [connectCount] : ļǰĿ¼,ɺʱٶ
+// : ӳ50ms(RTT 100ms)
+//   (cd s && fstBench s 1005 64) ; fstBench r 1006 1005 50 ; (cd c && fstBench c 1006 fstbench.bin)
+
+#define FST_BENCH_FILE_NAME "fstbench.bin"
+#define FST_BENCH_IP "127.0.0.1"
+
+//////////////////////////////////////////////////////////////////////////
+// ӳת
+
+struct RelayPacket
+{
+	uint64_t sendTime;
+	char* data;
+	uint32_t len;
+};
+
+struct RelayConn;
+
+// 
+struct RelayDir
+{
+	RelayConn* conn;
+	uv_tcp_t* to;
+	std::deque<RelayPacket> que;
+};
+
+struct RelayConn
+{
+	uv_tcp_t client;
+	uv_tcp_t target;
+	uv_connect_t connectReq;
+	RelayDir up;	// client -> target
+	RelayDir down;	// target -> client
+	bool isClosing;
+	int32_t closeCount;
+};
+
+static uv_loop_t relayLoop;
+static uv_tcp_t relayListen;
+static uv_timer_t relayTimer;
+static uint32_t relayTargetPort = 0;
+static uint64_t relayDelay = 0;
+static std::vector<RelayConn*> relayConnArr;
+
+static void relay_on_alloc(uv_handle_t* handle, size_t suggested_size, uv_buf_t* buf)
+{
+	buf->base = (char*)fc_malloc((uint32_t)suggested_size);
+	buf->len = (uint32_t)suggested_size;
+}
+
+static void relay_on_close(uv_handle_t* handle)
+{
+	RelayConn* conn = (RelayConn*)handle->data;
+	conn->closeCount++;
+	if (conn->closeCount < 2)
+		return;
+
+	for (auto dir : { &conn->up, &conn->down })
+	{
+		for (auto& packet : dir->que)
+		{
+			fc_free(packet.data);
+		}
+	}
+	for (auto it = relayConnArr.begin(); it != relayConnArr.end(); ++it)
+	{
+		if (*it == conn)
+		{
+			relayConnArr.erase(it);
+			break;
+		}
+	}
+	delete conn;
+}
+
+static void relay_close(RelayConn* conn)
+{
+	if (conn->isClosing)
+		return;
+	conn->isClosing = true;
+	uv_close((uv_handle_t*)&conn->client, relay_on_close);
+	uv_close((uv_handle_t*)&conn->target, relay_on_close);
+}
+
+static void relay_on_read(uv_stream_t* stream, ssize_t nread, const uv_buf_t* buf)
+{
+	RelayConn* conn = (RelayConn*)stream->data;
+	if (nread <= 0)
+	{
+		fc_free(buf->base);
+		// һ˶Ͽʱرת
+		if (nread < 0)
+		{
+			relay_close(conn);
+		}
+		return;
+	}
+
+	RelayDir* dir = (stream == (uv_stream_t*)&conn->client) ? &conn->up : &conn->down;
+	RelayPacket packet;
+	packet.sendTime = uv_now(&relayLoop) + relayDelay;
+	packet.data = buf->base;
+	packet.len = (uint32_t)nread;
+	dir->que.push_back(packet);
+}
+
+static void relay_on_write(uv_write_t* req, int status)
+{
+	fc_free(req->data);
+	fc_free(req);
+}
+
+static void relay_on_timer(uv_timer_t* handle)
+{
+	uint64_t curTime = uv_now(&relayLoop);
+	for (auto conn : relayConnArr)
+	{
+		if (conn->isClosing)
+			continue;
+
+		for (auto dir : { &conn->up, &conn->down })
+		{
+			while (!dir->que.empty() && dir->que.front().sendTime <= curTime)
+			{
+				RelayPacket& packet = dir->que.front();
+				uv_write_t* req = (uv_write_t*)fc_malloc(sizeof(uv_write_t));
+				req->data = packet.data;
+				uv_buf_t buf = uv_buf_init(packet.data, packet.len);
+				if (uv_write(req, (uv_stream_t*)dir->to, &buf, 1, relay_on_write) != 0)
+				{
+					fc_free(packet.data);
+					fc_free(req);
+				}
+				dir->que.pop_front();
+			}
+		}
+	}
+}
+
+static void relay_on_connect(uv_connect_t* req, int status)
+{
+	RelayConn* conn = (RelayConn*)req->data;
+	if (status != 0)
+	{
+		printf("relay connect target error: %s\n", uv_strerror(status));
+		relay_close(conn);
+		return;
+	}
+	uv_read_start((uv_stream_t*)&conn->client, relay_on_alloc, relay_on_read);
+	uv_read_start((uv_stream_t*)&conn->target, relay_on_alloc, relay_on_read);
+}
+
+static void relay_on_new_connection(uv_stream_t* server, int status)
+{
+	if (status != 0)
+		return;
+
+	RelayConn* conn = new RelayConn();
+	conn->isClosing = false;
+	conn->closeCount = 0;
+	conn->up.conn = conn;
+	conn->up.to = &conn->target;
+	conn->down.conn = conn;
+	conn->down.to = &conn->client;
+
+	uv_tcp_init(&relayLoop, &conn->client);
+	uv_tcp_init(&relayLoop, &conn->target);
+	conn->client.data = conn;
+	conn->target.data = conn;
+	conn->connectReq.data = conn;
+	relayConnArr.push_back(conn);
+
+	if (uv_accept(server, (uv_stream_t*)&conn->client) != 0)
+	{
+		relay_close(conn);
+		return;
+	}
+	uv_tcp_nodelay(&conn->client, 1);
+	uv_tcp_nodelay(&conn->target, 1);
+
+	struct sockaddr_in addr;
+	uv_ip4_addr(FST_BENCH_IP, relayTargetPort, &addr);
+	uv_tcp_connect(&conn->connectReq, &conn->target, (const struct sockaddr*)&addr, relay_on_connect);
+}
+
+static int runRelay(uint32_t port, uint32_t targetPort, uint32_t delay)
+{
+	relayTargetPort = targetPort;
+	relayDelay = delay;
+
+	uv_loop_init(&relayLoop);
+	uv_tcp_init(&relayLoop, &relayListen);
+
+	struct sockaddr_in addr;
+	uv_ip4_addr(FST_BENCH_IP, port, &addr);
+	int32_t r = uv_tcp_bind(&relayListen, (const struct sockaddr*)&addr, 0);
+	if (r == 0)
+	{
+		r = uv_listen((uv_stream_t*)&relayListen, 128, relay_on_new_connection);
+	}
+	if (r != 0)
+	{
+		printf("relay listen %u error: %s\n", port, uv_strerror(r));
+		return 1;
+	}
+
+	uv_timer_init(&relayLoop, &relayTimer);
+	uv_timer_start(&relayTimer, relay_on_timer, 1, 1);
+
+	printf("relay %u -> %u, delay %ums each way\n", port, targetPort, delay);
+	uv_run(&relayLoop, UV_RUN_DEFAULT);
+	return 0;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+static bool createBenchFile(uint32_t sizeMB)
+{
+	FILE* fp = fopen(FST_BENCH_FILE_NAME, "wb");
+	if (fp == NULL)
+		return false;
+
+	const uint32_t blockSize = 1024 * 1024;
+	char* block = (char*)fc_malloc(blockSize);
+	uint32_t seed = 1;
+	for (uint32_t i = 0; i < sizeMB; ++i)
+	{
+		for (uint32_t j = 0; j < blockSize; ++j)
+		{
+			seed = seed * 1103515245 + 12345;
+			block[j] = (char)(seed >> 16);
+		}
+		fwrite(block, 1, blockSize, fp);
+	}
+	fc_free(block);
+	fclose(fp);
+	return true;
+}
+
+static int runServer(uint32_t port, uint32_t sizeMB)
+{
+	if (sizeMB > 0 && !createBenchFile(sizeMB))
+	{
+		printf("create %s failed\n", FST_BENCH_FILE_NAME);
+		return 1;
+	}
+
+	FSTransferPool* pool = new FSTransferPool();
+	if (!pool->listen(FST_BENCH_IP, port, false))
+	{
+		printf("listen %u failed\n", port);
+		return 1;
+	}
+	printf("listen %u\n", port);
+
+	while (true)
+	{
+		pool->updateFrame();
+		ThreadSleep(1);
+	}
+	return 0;
+}
+
+static int runClient(uint32_t port, const char* filename, uint32_t connectCount)
+{
+	FSTransferPool* pool = new FSTransferPool();
+
+	int32_t result = 0;
+	pool->setFinishCallback([&](const std::string& name, bool isDownload, bool isSuccess)
+	{
+		result = isSuccess ? 1 : -1;
+	});
+
+	uint64_t startTime = uv_hrtime();
+	pool->download(FST_BENCH_IP, port, filename, connectCount);
+
+	while (result == 0)
+	{
+		pool->updateFrame();
+		ThreadSleep(1);
+	}
+
+	if (result < 0)
+	{
+		printf("download %s failed\n", filename);
+		return 1;
+	}
+
+	double sec = (uv_hrtime() - startTime) / 1e9;
+	FILE* fp = fopen(filename, "rb");
+	uint64_t size = 0;
+	if (fp)
+	{
+		fseek(fp, 0, SEEK_END);
+		size = (uint64_t)ftell(fp);
+		fclose(fp);
+	}
+	printf("%s %llu bytes in %.2fs, %.1f KB/s\n", filename, (unsigned long long)size, sec, size / 1024.0 / sec);
+	return 0;
+}
+
+int main(int argc, char** argv)
+{
+	if (argc >= 3 && argv[1][0] == 's')
+	{
+		return runServer(atoi(argv[2]), argc > 3 ? atoi(argv[3]) : 0);
+	}
+	if (argc >= 5 && argv[1][0] == 'r')
+	{
+		return runRelay(atoi(argv[2]), atoi(argv[3]), atoi(argv[4]));
+	}
+	if (argc >= 4 && argv[1][0] == 'c')
+	{
+		return runClient(atoi(argv[2]), argv[3], argc > 4 ? atoi(argv[4]) : 1);
+	}
+
+	printf("usage:\n");
+	printf("  fstBench s <port> [sizeMB]\n");
+	printf("  fstBench r <port> <targetPort> <delayMs>\n");
+	printf("  fstBench c <port> <filename> [connectCount]\n");
+	return 1;
+}